@@ -0,0 +1,130 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "synthetic_game_data.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <loader/actor_image_package.hpp>
+#include <loader/cmp_file_package.hpp>
+#include <loader/movie_loader.hpp>
+#include <loader/music_loader.hpp>
+#include <loader/voc_decoder.hpp>
+
+#include <string>
+
+
+// These benchmarks run against synthetic game data, see
+// synthetic_game_data.hpp. Level loading is covered in
+// bench_level_loading.cpp.
+
+namespace sd = rigel::synthetic_data;
+
+namespace {
+
+using rigel::data::ActorID;
+
+constexpr auto NUM_ACTOR_IDS =
+  static_cast<int>(ActorID::Rigelatin_soldier_projectile) + 1;
+
+}
+
+
+static void BMOpenCmpPackage(benchmark::State& state) {
+  const auto packagePath =
+    (sd::benchmarkGameDirectory() / "NUKEM2.CMP").u8string();
+
+  for (auto _ : state) {
+    rigel::loader::CMPFilePackage package{packagePath};
+    auto level = package.file(sd::LEVEL_FILE);
+    benchmark::DoNotOptimize(level);
+  }
+}
+
+BENCHMARK(BMOpenCmpPackage)->Unit(benchmark::kMillisecond);
+
+
+// Loads all actors, with the given frame size in tiles (width and height)
+static void BMLoadAllActors(benchmark::State& state) {
+  auto sizes = sd::Sizes{};
+  sizes.mActorFrameWidth = static_cast<int>(state.range(0));
+  sizes.mActorFrameHeight = static_cast<int>(state.range(0));
+  const auto files = sd::makeActorPackage(sizes, 1);
+
+  const auto package =
+    rigel::loader::ActorImagePackage{files[0].second, files[1].second};
+
+  for (auto _ : state) {
+    for (int id = 0; id < NUM_ACTOR_IDS; ++id) {
+      // The font can't be loaded as a regular actor
+      const auto actorId = static_cast<ActorID>(id);
+      if (actorId != ActorID::Menu_font_grayscale) {
+        auto actor = package.loadActor(actorId);
+        benchmark::DoNotOptimize(actor);
+      }
+    }
+  }
+}
+
+BENCHMARK(BMLoadAllActors)->Arg(2)->Arg(4)->Arg(8)->Unit(
+  benchmark::kMillisecond);
+
+
+// Decodes 1 second of audio, with the given codec
+static void BMDecodeVoc(benchmark::State& state) {
+  const auto codec = static_cast<sd::VocCodec>(state.range(0));
+  const auto data = sd::makeVoc(11025, codec, 1);
+
+  for (auto _ : state) {
+    auto buffer = rigel::loader::decodeVoc(data);
+    benchmark::DoNotOptimize(buffer);
+  }
+}
+
+BENCHMARK(BMDecodeVoc)
+  ->Arg(static_cast<int>(sd::VocCodec::Unsigned8BitPcm))
+  ->Arg(static_cast<int>(sd::VocCodec::Adpcm4Bits))
+  ->Unit(benchmark::kMicrosecond);
+
+
+// Loads a song with the given number of commands
+static void BMLoadSong(benchmark::State& state) {
+  const auto data = sd::makeSong(static_cast<int>(state.range(0)), 1);
+
+  for (auto _ : state) {
+    auto song = rigel::loader::loadSong(data);
+    benchmark::DoNotOptimize(song);
+  }
+}
+
+BENCHMARK(BMLoadSong)->Arg(1000)->Arg(16000)->Arg(64000)->Unit(
+  benchmark::kMicrosecond);
+
+
+// Loads a full-screen movie with the given number of animation frames
+static void BMLoadMovie(benchmark::State& state) {
+  const auto data = sd::makeMovie(
+    320, 200, static_cast<int>(state.range(0)), 1);
+
+  for (auto _ : state) {
+    auto movie = rigel::loader::loadMovie(data);
+    benchmark::DoNotOptimize(movie);
+  }
+}
+
+BENCHMARK(BMLoadMovie)->Arg(1)->Arg(16)->Arg(64)->Unit(
+  benchmark::kMillisecond);
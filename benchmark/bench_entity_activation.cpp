@@ -0,0 +1,116 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <base/warnings.hpp>
+#include <data/game_traits.hpp>
+#include <engine/base_components.hpp>
+#include <engine/entity_activation_system.hpp>
+#include <engine/world_bounds_mirror.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <entityx/entityx.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstdint>
+#include <random>
+
+
+// Compares entity activation via the WorldBoundsMirror against walking the
+// entity pools. The mirror reads all positions and bounding boxes back from
+// the entity manager on every cull, so this measures whether contiguous
+// testing makes up for that.
+
+namespace {
+
+using namespace rigel;
+using engine::components::BoundingBox;
+using engine::components::WorldPosition;
+
+// Map size of a typical level, in tiles
+constexpr auto MAP_WIDTH = 128;
+constexpr auto MAP_HEIGHT = 128;
+
+
+// Scatters entities across the map. One in eight has no bounding box, like
+// e.g. particle effect spawners.
+void populate(entityx::EntityManager& entities, const int numEntities) {
+  auto rng = std::mt19937{42};
+  auto randomInt = [&](const int min, const int max) {
+    return std::uniform_int_distribution<int>{min, max}(rng);
+  };
+
+  for (int i = 0; i < numEntities; ++i) {
+    auto entity = entities.create();
+    entity.assign<WorldPosition>(
+      randomInt(0, MAP_WIDTH - 1), randomInt(0, MAP_HEIGHT - 1));
+
+    if (i % 8 != 0) {
+      const auto height = randomInt(1, 4);
+      entity.assign<BoundingBox>(
+        BoundingBox{{0, -(height - 1)}, {randomInt(1, 4), height}});
+    }
+  }
+}
+
+
+// Pans the camera across the map, so that the set of active entities
+// changes from one iteration to the next.
+base::Vector cameraPosition(const std::int64_t iteration) {
+  const auto x = static_cast<int>(iteration % MAP_WIDTH);
+  const auto y = static_cast<int>(iteration / 2 % MAP_HEIGHT);
+  return {x, y};
+}
+
+}
+
+
+static void BMMarkActiveEntitiesViaEntityPools(benchmark::State& state) {
+  entityx::EventManager events;
+  entityx::EntityManager entities{events};
+  populate(entities, static_cast<int>(state.range(0)));
+
+  const auto viewPortSize = data::GameTraits::mapViewPortSize;
+  auto iteration = std::int64_t{0};
+  for (auto _ : state) {
+    engine::markActiveEntities(
+      entities, cameraPosition(iteration++), viewPortSize);
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BMMarkActiveEntitiesViaEntityPools)->Arg(256)->Arg(1024)->Arg(4096);
+
+
+static void BMMarkActiveEntitiesViaBoundsMirror(benchmark::State& state) {
+  entityx::EventManager events;
+  entityx::EntityManager entities{events};
+  engine::WorldBoundsMirror bounds{events};
+  populate(entities, static_cast<int>(state.range(0)));
+
+  const auto viewPortSize = data::GameTraits::mapViewPortSize;
+  auto iteration = std::int64_t{0};
+  for (auto _ : state) {
+    engine::markActiveEntities(
+      bounds, cameraPosition(iteration++), viewPortSize);
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BMMarkActiveEntitiesViaBoundsMirror)->Arg(256)->Arg(1024)->Arg(4096);
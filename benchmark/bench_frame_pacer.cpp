@@ -0,0 +1,69 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <renderer/frame_pacer.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+
+using namespace std::chrono;
+
+
+// Measures pacing accuracy on the real system clock and sleep function.
+// Each iteration is one frame, with a bit of simulated render work.
+// Reported counters are in milliseconds.
+static void BMFramePacerAccuracy(benchmark::State& state) {
+  const auto targetFps = static_cast<int>(state.range(0));
+  const auto predictRenderCost = state.range(1) != 0;
+  const auto targetFrameTime = 1.0 / targetFps;
+
+  rigel::renderer::FramePacer pacer{targetFps, predictRenderCost};
+  rigel::renderer::FrameTimeStatistics stats;
+
+  auto lastPresentationTime = rigel::base::Clock::now();
+  auto largestError = 0.0;
+
+  for (auto _ : state) {
+    std::this_thread::sleep_for(microseconds{500});
+
+    pacer.waitForPresentation();
+    const auto presentationTime = rigel::base::Clock::now();
+    pacer.waitForNextFrame();
+
+    const auto frameTime =
+      duration<double>(presentationTime - lastPresentationTime).count();
+    stats.addSample(frameTime);
+    largestError =
+      std::max(largestError, std::abs(frameTime - targetFrameTime));
+    lastPresentationTime = presentationTime;
+  }
+
+  state.counters["mean_ms"] = stats.meanFrameTime() * 1000.0;
+  state.counters["jitter_ms"] = stats.jitter() * 1000.0;
+  state.counters["max_error_ms"] = largestError * 1000.0;
+}
+
+BENCHMARK(BMFramePacerAccuracy)
+  ->Args({60, 0})
+  ->Args({144, 0})
+  ->Args({240, 0})
+  ->Args({144, 1})
+  ->Iterations(600)
+  ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,111 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <benchmark/benchmark.h>
+
+#include <loader/file_utils.hpp>
+
+#include <cstdint>
+#include <vector>
+
+
+namespace {
+
+rigel::loader::ByteBuffer makeInput(const std::size_t size) {
+  rigel::loader::ByteBuffer data(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    data[i] = static_cast<std::uint8_t>(i * 31 + 7);
+  }
+
+  return data;
+}
+
+}
+
+
+// Decoding 16-bit words one at a time vs. in bulk. The argument is the
+// input size in bytes.
+static void BMReadU16Individually(benchmark::State& state) {
+  const auto data = makeInput(static_cast<std::size_t>(state.range(0)));
+  std::vector<std::uint16_t> values(data.size() / 2);
+
+  for (auto _ : state) {
+    rigel::loader::LeStreamReader reader(data);
+    for (auto& value : values) {
+      value = reader.readU16();
+    }
+    benchmark::DoNotOptimize(values.data());
+    benchmark::ClobberMemory();
+  }
+
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BMReadU16Individually)->Arg(64 << 10)->Arg(4 << 20);
+
+
+static void BMReadU16Array(benchmark::State& state) {
+  const auto data = makeInput(static_cast<std::size_t>(state.range(0)));
+  std::vector<std::uint16_t> values(data.size() / 2);
+
+  for (auto _ : state) {
+    rigel::loader::LeStreamReader reader(data);
+    reader.readU16Array(values.data(), values.size());
+    benchmark::DoNotOptimize(values.data());
+    benchmark::ClobberMemory();
+  }
+
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BMReadU16Array)->Arg(64 << 10)->Arg(4 << 20);
+
+
+static void BMReadU32Individually(benchmark::State& state) {
+  const auto data = makeInput(static_cast<std::size_t>(state.range(0)));
+  std::vector<std::uint32_t> values(data.size() / 4);
+
+  for (auto _ : state) {
+    rigel::loader::LeStreamReader reader(data);
+    for (auto& value : values) {
+      value = reader.readU32();
+    }
+    benchmark::DoNotOptimize(values.data());
+    benchmark::ClobberMemory();
+  }
+
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BMReadU32Individually)->Arg(64 << 10)->Arg(4 << 20);
+
+
+static void BMReadU32Array(benchmark::State& state) {
+  const auto data = makeInput(static_cast<std::size_t>(state.range(0)));
+  std::vector<std::uint32_t> values(data.size() / 4);
+
+  for (auto _ : state) {
+    rigel::loader::LeStreamReader reader(data);
+    reader.readU32Array(values.data(), values.size());
+    benchmark::DoNotOptimize(values.data());
+    benchmark::ClobberMemory();
+  }
+
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BMReadU32Array)->Arg(64 << 10)->Arg(4 << 20);
@@ -0,0 +1,149 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "synthetic_game_data.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <base/thread_pool.hpp>
+#include <loader/level_loader.hpp>
+#include <loader/resource_loader.hpp>
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+
+// To run these benchmarks with the original game files, point the
+// RIGEL_BENCHMARK_GAME_PATH environment variable to a directory containing
+// them. Otherwise, synthetic game data is used (see synthetic_game_data.hpp).
+
+namespace {
+
+const auto LEVEL_NAME = std::string{"L1.MNI"};
+
+
+const rigel::loader::ResourceLoader& resourceLoader() {
+  static const auto pResources =
+    []() -> std::unique_ptr<rigel::loader::ResourceLoader> {
+    if (const auto pGamePath = std::getenv("RIGEL_BENCHMARK_GAME_PATH")) {
+      auto gamePath = std::string{pGamePath};
+      if (!gamePath.empty() && gamePath.back() != '/') {
+        gamePath += '/';
+      }
+
+      return std::make_unique<rigel::loader::ResourceLoader>(gamePath);
+    }
+
+    const auto syntheticGamePath =
+      rigel::synthetic_data::benchmarkGameDirectory() / "";
+    return std::make_unique<rigel::loader::ResourceLoader>(
+      syntheticGamePath.u8string());
+  }();
+
+  return *pResources;
+}
+
+}
+
+
+// Stage: decoding the level's tileset
+static void BMLoadTileSet(benchmark::State& state) {
+  const auto& resources = resourceLoader();
+
+  const auto sourceFiles =
+    rigel::loader::levelSourceFiles(LEVEL_NAME, resources);
+  for (auto _ : state) {
+    auto tileSet = resources.loadCZone(sourceFiles[1]);
+    benchmark::DoNotOptimize(tileSet);
+  }
+}
+
+BENCHMARK(BMLoadTileSet)->Unit(benchmark::kMillisecond);
+
+
+// Stage: decoding the level's primary backdrop
+static void BMLoadBackdrop(benchmark::State& state) {
+  const auto& resources = resourceLoader();
+
+  const auto sourceFiles =
+    rigel::loader::levelSourceFiles(LEVEL_NAME, resources);
+  for (auto _ : state) {
+    auto backdrop = resources.loadBackdrop(sourceFiles[2]);
+    benchmark::DoNotOptimize(backdrop);
+  }
+}
+
+BENCHMARK(BMLoadBackdrop)->Unit(benchmark::kMillisecond);
+
+
+// Stage: decoding the level's secondary backdrop, used by levels which switch
+// backdrops on reactor destruction or teleportation
+static void BMLoadSecondaryBackdrop(benchmark::State& state) {
+  const auto& resources = resourceLoader();
+
+  const auto sourceFiles =
+    rigel::loader::levelSourceFiles(LEVEL_NAME, resources);
+  if (sourceFiles.size() < 4) {
+    state.SkipWithError("Level has no secondary backdrop");
+    return;
+  }
+
+  for (auto _ : state) {
+    auto backdrop = resources.loadBackdrop(sourceFiles[3]);
+    benchmark::DoNotOptimize(backdrop);
+  }
+}
+
+BENCHMARK(BMLoadSecondaryBackdrop)->Unit(benchmark::kMillisecond);
+
+
+// Stage: reading the actor list, applying the difficulty, assigning areas to
+// dynamic geometry, and sorting by draw index. Includes extracting the level
+// file from the game's file package.
+static void BMPreprocessActors(benchmark::State& state) {
+  const auto& resources = resourceLoader();
+
+  for (auto _ : state) {
+    auto actors = rigel::loader::loadLevelActors(
+      LEVEL_NAME, resources, rigel::data::Difficulty::Medium);
+    benchmark::DoNotOptimize(actors);
+  }
+}
+
+BENCHMARK(BMPreprocessActors)->Unit(benchmark::kMicrosecond);
+
+
+// Total: loading the whole level, with the given number of worker threads.
+// Zero threads runs all stages serially on the calling thread.
+static void BMLoadLevel(benchmark::State& state) {
+  const auto& resources = resourceLoader();
+
+  rigel::base::ThreadPool pool{static_cast<std::size_t>(state.range(0))};
+  for (auto _ : state) {
+    auto level = rigel::loader::loadLevel(
+      LEVEL_NAME, resources, rigel::data::Difficulty::Medium, pool);
+    benchmark::DoNotOptimize(level);
+  }
+}
+
+BENCHMARK(BMLoadLevel)
+  ->Arg(0)
+  ->Arg(1)
+  ->Arg(3)
+  ->UseRealTime()
+  ->Unit(benchmark::kMillisecond);
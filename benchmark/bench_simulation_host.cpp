@@ -0,0 +1,93 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synthetic_game_data.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <common/command_line_options.hpp>
+#include <data/game_options.hpp>
+#include <game_logic/simulation_host.hpp>
+#include <loader/resource_loader.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+
+// Runs against synthetic game data, see synthetic_game_data.hpp. The
+// synthetic level's contents are random, but it has a representative number
+// of actors.
+
+namespace {
+
+using namespace rigel::game_logic;
+
+// 30 seconds of game time
+constexpr auto FRAMES_PER_SEGMENT = 450;
+
+constexpr auto SEGMENTS_PER_THREAD = 4;
+
+}
+
+
+// Aggregate throughput across all worlds, with the given number of threads.
+// Zero threads runs everything on the calling thread. The frames_per_second
+// counter is based on wall clock time, and should grow linearly with the
+// number of threads, up to the number of cores.
+static void BMSimulationHost(benchmark::State& state) {
+  const auto numThreads = static_cast<std::size_t>(state.range(0));
+
+  const auto resources = rigel::loader::ResourceLoader{
+    (rigel::synthetic_data::benchmarkGameDirectory() / "").u8string()};
+  SimulationHost host{
+    &resources,
+    rigel::data::GameOptions{},
+    rigel::CommandLineOptions{},
+    numThreads};
+
+  const auto segments = std::vector<RecordingSegment>(
+    std::max(numThreads, std::size_t{1}) * SEGMENTS_PER_THREAD,
+    rigel::synthetic_data::makeTestSegment(FRAMES_PER_SEGMENT));
+
+  // Load the level outside of the measurement
+  host.run({segments.front()});
+
+  auto numFrames = std::size_t{0};
+  auto elapsedTime = std::chrono::duration<double>{};
+  for (auto _ : state) {
+    const auto startTime = std::chrono::steady_clock::now();
+    const auto results = host.run(segments);
+    elapsedTime += std::chrono::steady_clock::now() - startTime;
+
+    for (const auto& result : results) {
+      numFrames += result.mNumFramesSimulated;
+    }
+  }
+
+  state.counters["frames_per_second"] =
+    static_cast<double>(numFrames) / elapsedTime.count();
+}
+
+BENCHMARK(BMSimulationHost)
+  ->Arg(0)
+  ->Arg(1)
+  ->Arg(2)
+  ->Arg(4)
+  ->Arg(8)
+  ->UseRealTime()
+  ->Unit(benchmark::kMillisecond);
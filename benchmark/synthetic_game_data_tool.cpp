@@ -0,0 +1,76 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synthetic_game_data.hpp"
+
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+
+namespace
+{
+
+void printUsage()
+{
+  std::cout <<
+    R"(Usage:
+  SyntheticGameDataTool <output directory> [scale factor]
+
+Writes a game directory filled with synthetic data in the original game's
+file formats. The scale factor (default 1.0) multiplies the amount of data,
+e.g. number of actors in the level or number of movie frames.
+
+The data is meaningless and not playable, it only serves for benchmarking
+the loaders without needing the original game files.
+)";
+}
+
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+  if (argc < 2 || argc > 3)
+  {
+    printUsage();
+    return 1;
+  }
+
+  try
+  {
+    const auto outputPath = std::filesystem::u8path(argv[1]);
+    const auto scaleFactor = argc == 3 ? std::stod(argv[2]) : 1.0;
+    if (scaleFactor <= 0.0)
+    {
+      std::cerr << "ERROR: Scale factor must be positive\n";
+      return 1;
+    }
+
+    rigel::synthetic_data::writeGameDirectory(
+      outputPath, rigel::synthetic_data::Sizes{}.scaled(scaleFactor));
+    std::cout << "Wrote synthetic game data to " << outputPath.u8string()
+              << '\n';
+  }
+  catch (const std::exception& ex)
+  {
+    std::cerr << "ERROR: " << ex.what() << '\n';
+    return 1;
+  }
+
+  return 0;
+}
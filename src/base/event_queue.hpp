@@ -0,0 +1,78 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+
+namespace rigel::base
+{
+
+/** Queue for events which are produced often, and handled in batches
+ *
+ * Producers push() events while running, and the owner of the queue hands
+ * all queued events to each consumer at a defined point, then clear()s the
+ * queue. Compared to emitting events one by one, this avoids dispatching
+ * each event through a list of receivers, and lets consumers process all
+ * events of a kind in one go.
+ *
+ * The first Capacity events are stored inline, so there are no heap
+ * allocations as long as a batch doesn't exceed that. Excess events are
+ * kept in an overflow buffer instead of being dropped, in the same order.
+ */
+template <typename Event, std::size_t Capacity>
+class EventQueue
+{
+public:
+  void push(const Event& event)
+  {
+    if (mSize < Capacity)
+    {
+      mEvents[mSize] = event;
+    }
+    else
+    {
+      mOverflow.push_back(event);
+    }
+
+    ++mSize;
+  }
+
+  /** Events in the order in which they were pushed */
+  const Event& operator[](const std::size_t index) const
+  {
+    return index < Capacity ? mEvents[index] : mOverflow[index - Capacity];
+  }
+
+  std::size_t size() const { return mSize; }
+  bool empty() const { return mSize == 0; }
+
+  void clear()
+  {
+    mOverflow.clear();
+    mSize = 0;
+  }
+
+private:
+  std::array<Event, Capacity> mEvents{};
+  std::vector<Event> mOverflow;
+  std::size_t mSize = 0;
+};
+
+} // namespace rigel::base
@@ -0,0 +1,75 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "heap_allocation_counter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+
+#ifdef RIGEL_TRACK_HEAP_ALLOCATIONS
+
+namespace
+{
+
+thread_local std::uint64_t tlNumHeapAllocations = 0;
+
+} // namespace
+
+
+// The remaining forms of operator new (array, nothrow) forward to this one
+// by default, so replacing it is enough to see all allocations.
+void* operator new(const std::size_t size)
+{
+  ++tlNumHeapAllocations;
+
+  if (auto pMemory = std::malloc(size == 0 ? 1 : size))
+  {
+    return pMemory;
+  }
+
+  throw std::bad_alloc{};
+}
+
+
+void operator delete(void* pMemory) noexcept
+{
+  std::free(pMemory);
+}
+
+
+void operator delete(void* pMemory, std::size_t) noexcept
+{
+  std::free(pMemory);
+}
+
+#endif
+
+
+namespace rigel::base
+{
+
+std::optional<std::uint64_t> heapAllocationCount()
+{
+#ifdef RIGEL_TRACK_HEAP_ALLOCATIONS
+  return tlNumHeapAllocations;
+#else
+  return std::nullopt;
+#endif
+}
+
+} // namespace rigel::base
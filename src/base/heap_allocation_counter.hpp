@@ -1,4 +1,4 @@
-/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
  *
  *  This program is free software: you can redistribute it and/or modify
  *  it under the terms of the GNU General Public License as published by
@@ -14,25 +14,22 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#pragma once
 
-#include "base/clock.hpp"
+#pragma once
 
+#include <cstdint>
+#include <optional>
 
-namespace rigel::renderer
-{
 
-class FpsLimiter
+namespace rigel::base
 {
-public:
-  explicit FpsLimiter(int targetFps);
 
-  void updateAndWait();
-
-private:
-  base::Clock::time_point mLastTime = {};
-  double mTargetFrameTime;
-  double mError = 0.0;
-};
+/** Number of heap allocations made by the calling thread so far
+ *
+ * Counting requires replacing the global operator new, which is only done
+ * when building with the TRACK_HEAP_ALLOCATIONS CMake option. Without it,
+ * this always returns std::nullopt.
+ */
+std::optional<std::uint64_t> heapAllocationCount();
 
-} // namespace rigel::renderer
+} // namespace rigel::base
@@ -0,0 +1,163 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "memory_arena.hpp"
+
+#include <cassert>
+
+
+namespace rigel::base
+{
+
+namespace
+{
+
+thread_local MemoryArena* tlpActiveArena = nullptr;
+
+
+std::size_t sizeClassIndex(const std::size_t size)
+{
+  return size == 0 ? 0 : (size - 1) / MemoryArena::GRANULARITY;
+}
+
+} // namespace
+
+
+MemoryArena::MemoryArena(const std::size_t blockSize)
+  : mBlockSize(blockSize)
+{
+  assert(blockSize >= MAX_POOLED_SIZE);
+  assert(blockSize % GRANULARITY == 0);
+}
+
+
+void* MemoryArena::allocate(
+  const std::size_t size,
+  [[maybe_unused]] const std::size_t alignment)
+{
+  assert(alignment <= GRANULARITY);
+
+  if (size > MAX_POOLED_SIZE)
+  {
+    return ::operator new(size);
+  }
+
+  ++mNumLiveAllocations;
+
+  auto& pFreeList = mFreeLists[sizeClassIndex(size)];
+  if (pFreeList)
+  {
+    auto pNode = pFreeList;
+    pFreeList = pNode->mpNext;
+    return pNode;
+  }
+
+  return allocateFromBlock((sizeClassIndex(size) + 1) * GRANULARITY);
+}
+
+
+void MemoryArena::deallocate(
+  void* pMemory,
+  const std::size_t size,
+  [[maybe_unused]] const std::size_t alignment)
+{
+  assert(alignment <= GRANULARITY);
+
+  if (size > MAX_POOLED_SIZE)
+  {
+    ::operator delete(pMemory);
+    return;
+  }
+
+  assert(mNumLiveAllocations > 0);
+  --mNumLiveAllocations;
+
+  auto& pFreeList = mFreeLists[sizeClassIndex(size)];
+  pFreeList = new (pMemory) FreeListNode{pFreeList};
+}
+
+
+void* MemoryArena::allocateFromBlock(const std::size_t size)
+{
+  if (mRemainingInBlock < size)
+  {
+    // Whatever is left in the current block is small enough to be
+    // negligible, so we don't try to put it to use.
+    mBlocks.emplace_back(new std::byte[mBlockSize]);
+    mpNextFree = mBlocks.back().get();
+    mRemainingInBlock = mBlockSize;
+  }
+
+  auto pResult = mpNextFree;
+  mpNextFree += size;
+  mRemainingInBlock -= size;
+  return pResult;
+}
+
+
+MemoryArena* activeArena()
+{
+  return tlpActiveArena;
+}
+
+
+ArenaScope::ArenaScope(MemoryArena* pArena)
+  : mpPreviousArena(tlpActiveArena)
+{
+  tlpActiveArena = pArena;
+}
+
+
+ArenaScope::~ArenaScope()
+{
+  tlpActiveArena = mpPreviousArena;
+}
+
+
+void* allocateFrom(
+  MemoryArena* pArena,
+  const std::size_t size,
+  [[maybe_unused]] const std::size_t alignment)
+{
+  assert(alignment <= MemoryArena::GRANULARITY);
+
+  if (pArena)
+  {
+    return pArena->allocate(size, alignment);
+  }
+
+  return ::operator new(size);
+}
+
+
+void deallocateFrom(
+  MemoryArena* pArena,
+  void* pMemory,
+  const std::size_t size,
+  const std::size_t alignment)
+{
+  if (pArena)
+  {
+    pArena->deallocate(pMemory, size, alignment);
+  }
+  else
+  {
+    ::operator delete(pMemory);
+  }
+}
+
+} // namespace rigel::base
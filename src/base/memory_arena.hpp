@@ -0,0 +1,248 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace rigel::base
+{
+
+/** Pooling allocator for objects sharing a common lifetime
+ *
+ * Memory is carved out of large blocks. Freed memory goes into a free list
+ * per size class, and is handed out again by later allocations of the same
+ * size class. Blocks are only returned to the system when the arena is
+ * destroyed, which releases everything at once. Allocations which are too
+ * large for any size class are forwarded to the global allocator.
+ * Over-aligned types are not supported.
+ *
+ * This is essentially std::pmr::unsynchronized_pool_resource, which is not
+ * available in all standard libraries we need to support. Like its standard
+ * counterpart, it is not thread-safe.
+ */
+class MemoryArena
+{
+public:
+  static constexpr auto DEFAULT_BLOCK_SIZE = std::size_t{64 * 1024};
+  static constexpr auto MAX_POOLED_SIZE = std::size_t{512};
+  static constexpr auto GRANULARITY = alignof(std::max_align_t);
+
+  explicit MemoryArena(std::size_t blockSize = DEFAULT_BLOCK_SIZE);
+
+  MemoryArena(const MemoryArena&) = delete;
+  MemoryArena& operator=(const MemoryArena&) = delete;
+
+  void* allocate(std::size_t size, std::size_t alignment);
+  void deallocate(void* pMemory, std::size_t size, std::size_t alignment);
+
+  std::size_t numBlocks() const { return mBlocks.size(); }
+  std::size_t reservedBytes() const { return mBlocks.size() * mBlockSize; }
+  std::size_t numLiveAllocations() const { return mNumLiveAllocations; }
+
+private:
+  struct FreeListNode
+  {
+    FreeListNode* mpNext;
+  };
+
+  static constexpr auto NUM_SIZE_CLASSES = MAX_POOLED_SIZE / GRANULARITY;
+
+  void* allocateFromBlock(std::size_t size);
+
+  std::vector<std::unique_ptr<std::byte[]>> mBlocks;
+  std::array<FreeListNode*, NUM_SIZE_CLASSES> mFreeLists{};
+  std::byte* mpNextFree = nullptr;
+  std::size_t mRemainingInBlock = 0;
+  std::size_t mBlockSize;
+  std::size_t mNumLiveAllocations = 0;
+};
+
+
+/** Arena used by default-constructed ArenaAllocators on the calling thread
+ *
+ * Returns nullptr if no arena is active, in which case allocations go to the
+ * global allocator. This is the equivalent of
+ * std::pmr::get_default_resource(), but per thread and only changed via
+ * ArenaScope.
+ */
+MemoryArena* activeArena();
+
+
+/** Makes an arena the active one for the lifetime of the scope object */
+class ArenaScope
+{
+public:
+  explicit ArenaScope(MemoryArena* pArena);
+  ~ArenaScope();
+
+  ArenaScope(const ArenaScope&) = delete;
+  ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+  MemoryArena* mpPreviousArena;
+};
+
+
+void* allocateFrom(
+  MemoryArena* pArena,
+  std::size_t size,
+  std::size_t alignment);
+void deallocateFrom(
+  MemoryArena* pArena,
+  void* pMemory,
+  std::size_t size,
+  std::size_t alignment);
+
+
+/** Standard allocator interface for MemoryArena
+ *
+ * Binds to the arena that's active at the time of construction. Copies of a
+ * container end up in the arena that's active when copying, not in the arena
+ * of the original. This makes it safe to copy state between owners of
+ * different lifetime, like a quick save and the live game.
+ */
+template <typename T>
+class ArenaAllocator
+{
+public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::false_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  ArenaAllocator() noexcept
+    : mpArena(activeArena())
+  {
+  }
+
+  explicit ArenaAllocator(MemoryArena* pArena) noexcept
+    : mpArena(pArena)
+  {
+  }
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+    : mpArena(other.arena())
+  {
+  }
+
+  T* allocate(const std::size_t n)
+  {
+    return static_cast<T*>(allocateFrom(mpArena, n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T* p, const std::size_t n) noexcept
+  {
+    deallocateFrom(mpArena, p, n * sizeof(T), alignof(T));
+  }
+
+  ArenaAllocator select_on_container_copy_construction() const
+  {
+    return ArenaAllocator{};
+  }
+
+  MemoryArena* arena() const { return mpArena; }
+
+  template <typename U>
+  friend bool
+    operator==(const ArenaAllocator& lhs, const ArenaAllocator<U>& rhs)
+  {
+    return lhs.arena() == rhs.arena();
+  }
+
+  template <typename U>
+  friend bool
+    operator!=(const ArenaAllocator& lhs, const ArenaAllocator<U>& rhs)
+  {
+    return !(lhs == rhs);
+  }
+
+private:
+  MemoryArena* mpArena;
+};
+
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+
+/** Deleter for objects created via makeArenaUnique()
+ *
+ * Remembers the size of the allocated object, so that it can also be used
+ * with a pointer to a base class (which must have a virtual destructor).
+ */
+class ArenaDeleter
+{
+public:
+  ArenaDeleter() = default;
+  ArenaDeleter(
+    MemoryArena* pArena,
+    const std::size_t size,
+    const std::size_t alignment)
+    : mpArena(pArena)
+    , mSize(size)
+    , mAlignment(alignment)
+  {
+  }
+
+  template <typename T>
+  void operator()(T* pObject) const
+  {
+    pObject->~T();
+    deallocateFrom(mpArena, pObject, mSize, mAlignment);
+  }
+
+private:
+  MemoryArena* mpArena = nullptr;
+  std::size_t mSize = 0;
+  std::size_t mAlignment = 0;
+};
+
+
+template <typename T>
+using ArenaUniquePtr = std::unique_ptr<T, ArenaDeleter>;
+
+
+/** Like std::make_unique, but allocates from the active arena */
+template <typename T, typename... Args>
+ArenaUniquePtr<T> makeArenaUnique(Args&&... args)
+{
+  const auto pArena = activeArena();
+  const auto pMemory = allocateFrom(pArena, sizeof(T), alignof(T));
+
+  try
+  {
+    return ArenaUniquePtr<T>{
+      new (pMemory) T(std::forward<Args>(args)...),
+      ArenaDeleter{pArena, sizeof(T), alignof(T)}};
+  }
+  catch (...)
+  {
+    deallocateFrom(pArena, pMemory, sizeof(T), alignof(T));
+    throw;
+  }
+}
+
+} // namespace rigel::base
@@ -0,0 +1,80 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+
+
+namespace rigel::base
+{
+
+/** Fixed-capacity lock-free queue for one producer and one consumer thread
+ *
+ * push() must only ever be called from one thread, and pop() from one
+ * (other) thread. Neither of them blocks or allocates memory, which makes
+ * this suitable for sending data to real-time threads like an audio
+ * callback.
+ */
+template <typename T, std::size_t Capacity>
+class SpscQueue
+{
+  static_assert(
+    Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+    "Capacity must be a power of two");
+
+public:
+  /** Add value to the queue. Returns false if the queue is full. */
+  bool push(const T& value)
+  {
+    const auto tail = mTail.load(std::memory_order_relaxed);
+    if (tail - mHead.load(std::memory_order_acquire) == Capacity)
+    {
+      return false;
+    }
+
+    mItems[tail & (Capacity - 1)] = value;
+    mTail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  std::optional<T> pop()
+  {
+    const auto head = mHead.load(std::memory_order_relaxed);
+    if (head == mTail.load(std::memory_order_acquire))
+    {
+      return std::nullopt;
+    }
+
+    const auto value = mItems[head & (Capacity - 1)];
+    mHead.store(head + 1, std::memory_order_release);
+    return value;
+  }
+
+private:
+  std::array<T, Capacity> mItems{};
+
+  // Producer and consumer each write only one of these. Keeping them on
+  // separate cache lines avoids false sharing.
+  alignas(64) std::atomic<std::size_t> mHead{0};
+  alignas(64) std::atomic<std::size_t> mTail{0};
+};
+
+} // namespace rigel::base
@@ -0,0 +1,131 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "stage_scheduler.hpp"
+
+#include "base/memory_arena.hpp"
+#include "base/thread_pool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+
+namespace rigel::base
+{
+
+StageScheduler::StageScheduler(ThreadPool* pPool)
+  : mpPool(pPool)
+{
+}
+
+
+void StageScheduler::addStage(
+  const ResourceMask reads,
+  const ResourceMask writes,
+  std::function<void()> stage)
+{
+  auto conflicts = [&](const Stage& other) {
+    return (writes & (other.mReads | other.mWrites)) != 0 ||
+      (reads & other.mWrites) != 0;
+  };
+
+  auto batch = std::size_t{0};
+  for (const auto& other : mStages)
+  {
+    if (conflicts(other))
+    {
+      batch = std::max(batch, other.mBatch + 1);
+    }
+  }
+
+  if (batch == mBatches.size())
+  {
+    mBatches.emplace_back();
+  }
+
+  mBatches[batch].push_back(mStages.size());
+  mStages.push_back(Stage{reads, writes, batch, std::move(stage), nullptr});
+}
+
+
+void StageScheduler::run()
+{
+  mpArena = activeArena();
+
+  for (const auto& batch : mBatches)
+  {
+    {
+      const auto lock = std::lock_guard{mMutex};
+      mNumPendingStages = batch.size() - 1;
+    }
+
+    // The job only captures two words, so that std::function doesn't need
+    // to allocate. Pool threads therefore get the arena via mpArena.
+    for (auto i = std::size_t{1}; i < batch.size(); ++i)
+    {
+      mpPool->post([this, index = batch[i]]() { runPooledStage(index); });
+    }
+
+    runStage(batch.front());
+
+    // All stages of the batch must be done before we can return, even if
+    // one of them failed, since they might still access the caller's data.
+    {
+      auto lock = std::unique_lock{mMutex};
+      mPooledStagesFinished.wait(
+        lock, [this]() { return mNumPendingStages == 0; });
+    }
+
+    for (const auto index : batch)
+    {
+      if (auto pError = std::exchange(mStages[index].mpError, nullptr))
+      {
+        std::rethrow_exception(pError);
+      }
+    }
+  }
+}
+
+
+void StageScheduler::runStage(const std::size_t index)
+{
+  try
+  {
+    mStages[index].mFunc();
+  }
+  catch (...)
+  {
+    mStages[index].mpError = std::current_exception();
+  }
+}
+
+
+void StageScheduler::runPooledStage(const std::size_t index)
+{
+  {
+    const auto arenaScope = ArenaScope{mpArena};
+    runStage(index);
+  }
+
+  // Notifying while holding the lock makes sure that run() can't return
+  // (and the scheduler can't be destroyed) before we're done with it.
+  const auto lock = std::lock_guard{mMutex};
+  --mNumPendingStages;
+  mPooledStagesFinished.notify_one();
+}
+
+} // namespace rigel::base
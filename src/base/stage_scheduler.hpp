@@ -0,0 +1,105 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+
+namespace rigel::base
+{
+
+class MemoryArena;
+class ThreadPool;
+
+
+/** Runs a fixed sequence of stages, in parallel where possible
+ *
+ * Each stage declares the resources it reads and writes, as bit masks. What
+ * a resource stands for is up to the user, e.g. a set of components or the
+ * state of a subsystem. Two stages conflict if one of them writes a
+ * resource which the other one reads or writes. A stage never runs before
+ * or alongside a conflicting stage that was added before it. Given accurate
+ * declarations, running the stages thus gives the same results as running
+ * them one after another in the order they were added. This includes the
+ * order of side effects like drawing random numbers or emitting events, as
+ * long as these are declared as resources as well.
+ *
+ * When a stage is added, it is put into the earliest batch that comes after
+ * all batches holding a conflicting stage. run() runs the batches in order,
+ * with the stages of a batch running concurrently on the thread pool. The
+ * calling thread takes part by running the first stage of each batch.
+ * With a pool of zero threads, everything runs on the calling thread.
+ *
+ * Stages run with the calling thread's active MemoryArena. Since arenas
+ * aren't thread-safe, stages which allocate from it must declare a common
+ * resource for it.
+ *
+ * If stages throw, run() finishes the current batch, and then re-throws
+ * the first exception in stage order. Later batches are skipped.
+ *
+ * run() doesn't allocate, so that it can be used for the logic update (see
+ * GameWorld::updateGameLogic()).
+ */
+class StageScheduler
+{
+public:
+  using ResourceMask = std::uint64_t;
+
+  explicit StageScheduler(ThreadPool* pPool);
+
+  void addStage(
+    ResourceMask reads,
+    ResourceMask writes,
+    std::function<void()> stage);
+
+  void run();
+
+  std::size_t numStages() const { return mStages.size(); }
+  std::size_t numBatches() const { return mBatches.size(); }
+
+private:
+  struct Stage
+  {
+    ResourceMask mReads;
+    ResourceMask mWrites;
+    std::size_t mBatch;
+    std::function<void()> mFunc;
+    std::exception_ptr mpError;
+  };
+
+  void runStage(std::size_t index);
+  void runPooledStage(std::size_t index);
+
+  std::vector<Stage> mStages;
+  std::vector<std::vector<std::size_t>> mBatches;
+  ThreadPool* mpPool;
+
+  // State of the batch that's currently running
+  std::mutex mMutex;
+  std::condition_variable mPooledStagesFinished;
+  std::size_t mNumPendingStages = 0;
+  MemoryArena* mpArena = nullptr;
+};
+
+} // namespace rigel::base
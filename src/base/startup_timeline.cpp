@@ -0,0 +1,105 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "startup_timeline.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+
+
+namespace rigel::base
+{
+
+StartupTimeline::StartupTimeline()
+  : mStartTime(Clock::now())
+  , mThreadIds{std::this_thread::get_id()}
+{
+}
+
+
+void StartupTimeline::addStage(
+  std::string name,
+  const Clock::time_point start,
+  const Clock::time_point end)
+{
+  std::lock_guard<std::mutex> lock{mMutex};
+
+  const auto thread = threadNumber(std::this_thread::get_id());
+  mStages.push_back(Stage{std::move(name), thread, start, end});
+}
+
+
+auto StartupTimeline::stages() const -> std::vector<Stage>
+{
+  auto result = [&]() {
+    std::lock_guard<std::mutex> lock{mMutex};
+    return mStages;
+  }();
+
+  // Stages are recorded when they end, so nested or concurrent stages
+  // can appear out of order
+  std::stable_sort(
+    result.begin(), result.end(), [](const Stage& lhs, const Stage& rhs) {
+      return lhs.mStart < rhs.mStart;
+    });
+  return result;
+}
+
+
+void StartupTimeline::writeReport(std::ostream& stream) const
+{
+  using namespace std::chrono;
+
+  auto toMs = [](const Clock::duration time) {
+    return duration_cast<duration<double, std::milli>>(time).count();
+  };
+
+  const auto allStages = stages();
+
+  auto endTime = mStartTime;
+  for (const auto& stage : allStages)
+  {
+    endTime = std::max(endTime, stage.mEnd);
+  }
+
+  stream << std::fixed << std::setprecision(1);
+  stream << "Startup took " << toMs(endTime - mStartTime) << " ms\n\n";
+  stream << "   Start  Duration  Thread  Stage\n";
+
+  for (const auto& stage : allStages)
+  {
+    stream << std::setw(8) << toMs(stage.mStart - mStartTime) << std::setw(10)
+           << toMs(stage.mEnd - stage.mStart) << std::setw(8) << stage.mThread
+           << "  " << stage.mName << '\n';
+  }
+}
+
+
+int StartupTimeline::threadNumber(const std::thread::id id)
+{
+  const auto iThread = std::find(mThreadIds.begin(), mThreadIds.end(), id);
+  if (iThread != mThreadIds.end())
+  {
+    return int(std::distance(mThreadIds.begin(), iThread));
+  }
+
+  mThreadIds.push_back(id);
+  return int(mThreadIds.size()) - 1;
+}
+
+} // namespace rigel::base
@@ -0,0 +1,89 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/clock.hpp"
+#include "base/defer.hpp"
+
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace rigel::base
+{
+
+/** Records when the individual stages of startup ran, and on which thread
+ *
+ * Stages can be recorded from any thread. Threads are numbered in order of
+ * their first recorded stage, with the thread that created the timeline
+ * always being number 0.
+ */
+class StartupTimeline
+{
+public:
+  struct Stage
+  {
+    std::string mName;
+    int mThread;
+    Clock::time_point mStart;
+    Clock::time_point mEnd;
+  };
+
+  StartupTimeline();
+
+  /** Run func, and record how long it took as a stage with the given name
+   *
+   * Returns func's result. The stage is also recorded if func throws.
+   */
+  template <typename Func>
+  auto measure(std::string name, Func&& func) -> std::invoke_result_t<Func>
+  {
+    const auto start = Clock::now();
+    const auto guard =
+      defer([&]() { addStage(std::move(name), start, Clock::now()); });
+    return func();
+  }
+
+  void addStage(
+    std::string name,
+    Clock::time_point start,
+    Clock::time_point end);
+
+  /** Recorded stages, ordered by start time */
+  std::vector<Stage> stages() const;
+
+  /** Write a human-readable table of all stages
+   *
+   * Times are given in milliseconds, relative to the creation of the timeline.
+   */
+  void writeReport(std::ostream& stream) const;
+
+private:
+  int threadNumber(std::thread::id id);
+
+  Clock::time_point mStartTime;
+  mutable std::mutex mMutex;
+  std::vector<Stage> mStages;
+  std::vector<std::thread::id> mThreadIds;
+};
+
+} // namespace rigel::base
@@ -0,0 +1,126 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+
+namespace rigel::base
+{
+
+ThreadPool::ThreadPool(const std::size_t numThreads)
+{
+  mThreads.reserve(numThreads);
+  for (auto i = std::size_t{0}; i < numThreads; ++i)
+  {
+    mThreads.emplace_back([this]() { run(); });
+  }
+}
+
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock{mMutex};
+    mQuit = true;
+  }
+
+  mJobAvailableOrQuit.notify_all();
+
+  for (auto& thread : mThreads)
+  {
+    thread.join();
+  }
+}
+
+
+void ThreadPool::post(std::function<void()> job)
+{
+  if (mThreads.empty())
+  {
+    job();
+  }
+  else
+  {
+    enqueue(std::move(job));
+  }
+}
+
+
+void ThreadPool::enqueue(std::function<void()> job)
+{
+  {
+    std::lock_guard<std::mutex> lock{mMutex};
+
+    if (mNumJobs == mJobs.size())
+    {
+      growQueue();
+    }
+
+    mJobs[(mFirstJob + mNumJobs) % mJobs.size()] = std::move(job);
+    ++mNumJobs;
+  }
+
+  mJobAvailableOrQuit.notify_one();
+}
+
+
+void ThreadPool::growQueue()
+{
+  std::vector<std::function<void()>> jobs(
+    std::max(std::size_t{16}, mJobs.size() * 2));
+
+  for (auto i = std::size_t{0}; i < mNumJobs; ++i)
+  {
+    jobs[i] = std::move(mJobs[(mFirstJob + i) % mJobs.size()]);
+  }
+
+  mJobs = std::move(jobs);
+  mFirstJob = 0;
+}
+
+
+void ThreadPool::run()
+{
+  std::unique_lock<std::mutex> lock{mMutex};
+
+  for (;;)
+  {
+    mJobAvailableOrQuit.wait(
+      lock, [this]() { return mNumJobs != 0 || mQuit; });
+
+    // Pending jobs are still run when quitting, so that nobody waits
+    // forever for a future.
+    if (mNumJobs == 0)
+    {
+      return;
+    }
+
+    auto job = std::move(mJobs[mFirstJob]);
+    mJobs[mFirstJob] = nullptr;
+    mFirstJob = (mFirstJob + 1) % mJobs.size();
+    --mNumJobs;
+
+    lock.unlock();
+    job();
+    lock.lock();
+  }
+}
+
+} // namespace rigel::base
@@ -0,0 +1,109 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+namespace rigel::base
+{
+
+/** Runs jobs on a fixed set of threads
+ *
+ * Jobs are started in the order they were submitted. submit() returns a
+ * future for the job's result, which also transports any exception thrown
+ * by the job.
+ *
+ * A pool with zero threads runs each job right away inside submit(). This
+ * is meant for platforms without thread support, and for measuring serial
+ * performance.
+ *
+ * For jobs that run every frame, post() avoids the allocations needed for
+ * the future's shared state. Completion has to be tracked by the job itself
+ * then.
+ *
+ * The destructor waits for all submitted jobs to finish.
+ */
+class ThreadPool
+{
+public:
+  explicit ThreadPool(std::size_t numThreads);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  template <typename Func>
+  auto submit(Func func) -> std::future<std::invoke_result_t<Func>>
+  {
+    using Result = std::invoke_result_t<Func>;
+
+    auto pTask =
+      std::make_shared<std::packaged_task<Result()>>(std::move(func));
+    auto future = pTask->get_future();
+
+    if (mThreads.empty())
+    {
+      (*pTask)();
+    }
+    else
+    {
+      enqueue([pTask]() { (*pTask)(); });
+    }
+
+    return future;
+  }
+
+  /** Run job on the pool, without a future
+   *
+   * The job must not throw. Once the queue has grown to its working size,
+   * this doesn't allocate, as long as the job is small enough to be stored
+   * in std::function without allocating (e.g. a lambda capturing two
+   * pointers).
+   */
+  void post(std::function<void()> job);
+
+  std::size_t numThreads() const { return mThreads.size(); }
+
+private:
+  void enqueue(std::function<void()> job);
+  void growQueue();
+  void run();
+
+  std::mutex mMutex;
+  std::condition_variable mJobAvailableOrQuit;
+
+  // Ring buffer, which only grows. This way, enqueueing and running a job
+  // doesn't allocate once the queue has reached its working size.
+  std::vector<std::function<void()>> mJobs;
+  std::size_t mFirstJob = 0;
+  std::size_t mNumJobs = 0;
+
+  bool mQuit = false;
+  std::vector<std::thread> mThreads;
+};
+
+} // namespace rigel::base
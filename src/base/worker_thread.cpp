@@ -0,0 +1,107 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "worker_thread.hpp"
+
+#include <cassert>
+#include <utility>
+
+
+namespace rigel::base
+{
+
+WorkerThread::WorkerThread()
+  : mThread([this]() { run(); })
+{
+}
+
+
+WorkerThread::~WorkerThread()
+{
+  {
+    std::lock_guard<std::mutex> lock{mMutex};
+    mQuit = true;
+  }
+
+  mJobPostedOrQuit.notify_one();
+  mThread.join();
+}
+
+
+void WorkerThread::post(std::function<void()> job)
+{
+  {
+    std::lock_guard<std::mutex> lock{mMutex};
+    assert(!mJob);
+    mJob = std::move(job);
+  }
+
+  mJobPostedOrQuit.notify_one();
+}
+
+
+void WorkerThread::waitUntilIdle()
+{
+  std::unique_lock<std::mutex> lock{mMutex};
+  mJobFinished.wait(lock, [this]() { return !mJob; });
+
+  if (mpError)
+  {
+    std::rethrow_exception(std::exchange(mpError, nullptr));
+  }
+}
+
+
+bool WorkerThread::isIdle()
+{
+  std::lock_guard<std::mutex> lock{mMutex};
+  return !mJob;
+}
+
+
+void WorkerThread::run()
+{
+  std::unique_lock<std::mutex> lock{mMutex};
+
+  for (;;)
+  {
+    mJobPostedOrQuit.wait(lock, [this]() { return mJob || mQuit; });
+
+    if (mQuit)
+    {
+      return;
+    }
+
+    lock.unlock();
+
+    std::exception_ptr pError;
+    try
+    {
+      mJob();
+    }
+    catch (...)
+    {
+      pError = std::current_exception();
+    }
+
+    lock.lock();
+    mpError = pError;
+    mJob = nullptr;
+    mJobFinished.notify_all();
+  }
+}
+
+} // namespace rigel::base
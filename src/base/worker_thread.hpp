@@ -0,0 +1,64 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+
+namespace rigel::base
+{
+
+/** Runs jobs one at a time on a dedicated thread
+ *
+ * Only a single job can be pending at any time. The thread posting jobs
+ * must call waitUntilIdle() (or check isIdle()) before posting the next
+ * one, and before touching any data that the running job might access.
+ * Both establish the necessary synchronization with the job's writes.
+ *
+ * Exceptions thrown by a job are re-thrown by the next call to
+ * waitUntilIdle().
+ */
+class WorkerThread
+{
+public:
+  WorkerThread();
+  ~WorkerThread();
+
+  WorkerThread(const WorkerThread&) = delete;
+  WorkerThread& operator=(const WorkerThread&) = delete;
+
+  void post(std::function<void()> job);
+  void waitUntilIdle();
+  bool isIdle();
+
+private:
+  void run();
+
+  std::mutex mMutex;
+  std::condition_variable mJobPostedOrQuit;
+  std::condition_variable mJobFinished;
+  std::function<void()> mJob;
+  std::exception_ptr mpError;
+  bool mQuit = false;
+  std::thread mThread;
+};
+
+} // namespace rigel::base
@@ -44,7 +44,13 @@ struct CommandLineOptions
   bool mSkipIntro = false;
   bool mDebugModeEnabled = false;
   bool mPlayDemo = false;
+  bool mPipelinedGameLogic = false;
+  bool mParallelSystems = false;
   std::optional<base::Vector> mPlayerPosition;
+  std::string mInputRecordingFile;
+  std::string mReplayFile;
+  std::string mStartupTimelineFile;
+  std::string mMemoryReportFile = "memory_report.jsonl";
 };
 
 } // namespace rigel
@@ -33,6 +33,7 @@ namespace rigel
 {
 
 struct IGameServiceProvider;
+class MemoryRegistry;
 class UserProfile;
 
 namespace engine
@@ -41,6 +42,11 @@ class SpriteFactory;
 class TiledTexture;
 } // namespace engine
 
+namespace game_logic
+{
+class InputRecorder;
+}
+
 namespace loader
 {
 class ResourceLoader;
@@ -67,6 +73,11 @@ struct GameMode
     engine::TiledTexture* mpUiSpriteSheet;
     engine::SpriteFactory* mpSpriteFactory;
     UserProfile* mpUserProfile;
+
+    /** Only set when recording input was requested on the command line */
+    game_logic::InputRecorder* mpInputRecorder;
+
+    MemoryRegistry* mpMemoryRegistry;
   };
 
   virtual ~GameMode() = default;
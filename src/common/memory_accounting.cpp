@@ -0,0 +1,139 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "memory_accounting.hpp"
+
+#include <algorithm>
+
+
+namespace rigel
+{
+
+void MemoryReport::add(
+  std::string category,
+  std::string name,
+  const std::size_t bytes,
+  const std::size_t count)
+{
+  mEntries.push_back(Entry{std::move(category), std::move(name), bytes, count});
+}
+
+
+std::vector<std::string> MemoryReport::categories() const
+{
+  std::vector<std::string> result;
+  for (const auto& entry : mEntries)
+  {
+    const auto it = std::find(result.begin(), result.end(), entry.mCategory);
+    if (it == result.end())
+    {
+      result.push_back(entry.mCategory);
+    }
+  }
+
+  return result;
+}
+
+
+std::size_t MemoryReport::totalBytes(const std::string& category) const
+{
+  std::size_t total = 0;
+  for (const auto& entry : mEntries)
+  {
+    if (entry.mCategory == category)
+    {
+      total += entry.mBytes;
+    }
+  }
+
+  return total;
+}
+
+
+nlohmann::json toJson(const MemoryReport& report)
+{
+  auto result = nlohmann::json::object();
+
+  for (const auto& category : report.categories())
+  {
+    auto entries = nlohmann::json::array();
+    for (const auto& entry : report.entries())
+    {
+      if (entry.mCategory == category)
+      {
+        entries.push_back(
+          {{"name", entry.mName},
+           {"bytes", entry.mBytes},
+           {"count", entry.mCount}});
+      }
+    }
+
+    result[category] = {
+      {"totalBytes", report.totalBytes(category)}, {"entries", entries}};
+  }
+
+  return result;
+}
+
+
+MemoryRegistry::Registration::~Registration()
+{
+  if (mpRegistry)
+  {
+    mpRegistry->remove(mId);
+  }
+}
+
+
+auto MemoryRegistry::add(Reporter reporter) -> Registration
+{
+  std::lock_guard<std::mutex> lock{mMutex};
+
+  const auto id = mNextId++;
+  mReporters.emplace_back(id, std::move(reporter));
+  return Registration{this, id};
+}
+
+
+MemoryReport MemoryRegistry::collect() const
+{
+  // Reporters run while holding the lock, so that their owners can't be
+  // destroyed while they are running
+  std::lock_guard<std::mutex> lock{mMutex};
+
+  MemoryReport report;
+  for (const auto& [id, reporter] : mReporters)
+  {
+    reporter(report);
+  }
+
+  return report;
+}
+
+
+void MemoryRegistry::remove(const std::uint64_t id)
+{
+  std::lock_guard<std::mutex> lock{mMutex};
+
+  mReporters.erase(
+    std::remove_if(
+      mReporters.begin(),
+      mReporters.end(),
+      [id](const auto& entry) { return entry.first == id; }),
+    mReporters.end());
+}
+
+} // namespace rigel
@@ -0,0 +1,149 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/warnings.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <nlohmann/json.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace rigel
+{
+
+/** Snapshot of memory use, broken down by owner
+ *
+ * Each entry gives the number of bytes and/or objects that some owner holds,
+ * grouped into categories like "GPU" or "World". Entries within a category
+ * don't overlap. Categories can overlap, though, since some of them provide
+ * a more detailed view on memory which is also counted elsewhere, e.g. the
+ * sprite atlas is part of the GPU textures.
+ */
+class MemoryReport
+{
+public:
+  struct Entry
+  {
+    std::string mCategory;
+    std::string mName;
+    std::size_t mBytes = 0;
+    std::size_t mCount = 0;
+  };
+
+  void add(
+    std::string category,
+    std::string name,
+    std::size_t bytes,
+    std::size_t count = 0);
+
+  const std::vector<Entry>& entries() const { return mEntries; }
+
+  /** Categories in order of first appearance */
+  std::vector<std::string> categories() const;
+
+  std::size_t totalBytes(const std::string& category) const;
+
+private:
+  std::vector<Entry> mEntries;
+};
+
+
+nlohmann::json toJson(const MemoryReport& report);
+
+
+/** Collects memory reports from all registered owners
+ *
+ * Owners of significant amounts of memory register a reporter function,
+ * which adds the owner's current usage to a report. Reporters only run when
+ * a report is collected, so there is no cost during normal operation.
+ *
+ * add() returns a handle which unregisters the reporter when destroyed. A
+ * reporter usually refers to its owner, so the owner should keep the handle
+ * as a member, and must not be movable.
+ *
+ * Registering and unregistering is thread-safe. Reporters run on the thread
+ * calling collect(), which is responsible for making sure that the reported
+ * objects aren't modified concurrently. Reporters must not add or remove
+ * registrations.
+ */
+class MemoryRegistry
+{
+public:
+  using Reporter = std::function<void(MemoryReport&)>;
+
+  class Registration
+  {
+  public:
+    Registration() = default;
+    ~Registration();
+
+    Registration(Registration&& other) noexcept
+      : mpRegistry(std::exchange(other.mpRegistry, nullptr))
+      , mId(other.mId)
+    {
+    }
+
+    Registration& operator=(Registration&& other) noexcept
+    {
+      std::swap(mpRegistry, other.mpRegistry);
+      std::swap(mId, other.mId);
+      return *this;
+    }
+
+    Registration(const Registration&) = delete;
+    Registration& operator=(const Registration&) = delete;
+
+  private:
+    friend class MemoryRegistry;
+
+    Registration(MemoryRegistry* pRegistry, const std::uint64_t id)
+      : mpRegistry(pRegistry)
+      , mId(id)
+    {
+    }
+
+    MemoryRegistry* mpRegistry = nullptr;
+    std::uint64_t mId = 0;
+  };
+
+  MemoryRegistry() = default;
+  MemoryRegistry(const MemoryRegistry&) = delete;
+  MemoryRegistry& operator=(const MemoryRegistry&) = delete;
+
+  [[nodiscard]] Registration add(Reporter reporter);
+
+  /** Run all reporters, in order of registration */
+  MemoryReport collect() const;
+
+private:
+  void remove(std::uint64_t id);
+
+  mutable std::mutex mMutex;
+  std::vector<std::pair<std::uint64_t, Reporter>> mReporters;
+  std::uint64_t mNextId = 1;
+};
+
+} // namespace rigel
@@ -366,6 +366,7 @@ nlohmann::ordered_json serialize(const data::GameOptions& options)
   serialized["enableVsync"] = options.mEnableVsync;
   serialized["enableFpsLimit"] = options.mEnableFpsLimit;
   serialized["maxFps"] = options.mMaxFps;
+  serialized["predictRenderCost"] = options.mPredictRenderCost;
   serialized["showFpsCounter"] = options.mShowFpsCounter;
   serialized["enableScreenFlashes"] = options.mEnableScreenFlashes;
   serialized["upscalingFilter"] = options.mUpscalingFilter;
@@ -564,6 +565,7 @@ data::GameOptions deserialize<data::GameOptions>(const nlohmann::json& json)
   extractValueIfExists("enableVsync", result.mEnableVsync, json);
   extractValueIfExists("enableFpsLimit", result.mEnableFpsLimit, json);
   extractValueIfExists("maxFps", result.mMaxFps, json);
+  extractValueIfExists("predictRenderCost", result.mPredictRenderCost, json);
   extractValueIfExists("showFpsCounter", result.mShowFpsCounter, json);
   extractValueIfExists(
     "enableScreenFlashes", result.mEnableScreenFlashes, json);
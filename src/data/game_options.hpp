@@ -103,6 +103,7 @@ struct GameOptions
   bool mEnableVsync = ENABLE_VSYNC_DEFAULT;
   bool mEnableFpsLimit = true; // Only relevant when mEnableVsync == false
   int mMaxFps = 60; // Only relevant when mEnableFpsLimit == true
+  bool mPredictRenderCost = false; // Only relevant when mEnableFpsLimit == true
   bool mShowFpsCounter = false;
   bool mEnableScreenFlashes = true;
   UpscalingFilter mUpscalingFilter = UpscalingFilter::None;
@@ -16,6 +16,7 @@
 
 #include "image.hpp"
 
+#include <algorithm>
 #include <stdexcept>
 
 
@@ -83,4 +84,118 @@ void Image::insertImage(
 }
 
 
+IndexedImage::IndexedImage(
+  IndexBuffer&& indices,
+  const std::size_t width,
+  const std::size_t height)
+  : mIndices(std::move(indices))
+  , mWidth(width)
+  , mHeight(height)
+{
+  if (mIndices.size() != width * height)
+  {
+    throw invalid_argument("Index buffer doesn't match image size");
+  }
+}
+
+
+IndexedImage::IndexedImage(
+  const std::size_t width,
+  const std::size_t height,
+  const std::uint8_t index)
+  : IndexedImage(IndexBuffer(width * height, index), width, height)
+{
+}
+
+
+void IndexedImage::insertImage(
+  const size_t x,
+  const size_t y,
+  const IndexedImage& image)
+{
+  if (x + image.width() > mWidth || y + image.height() > mHeight)
+  {
+    throw invalid_argument("Source image doesn't fit");
+  }
+
+  auto sourceIter = image.indexData().begin();
+  for (size_t row = 0; row < image.height(); ++row)
+  {
+    const auto targetIter = mIndices.begin() + x + (y + row) * mWidth;
+    std::copy(sourceIter, sourceIter + image.width(), targetIter);
+    sourceIter += image.width();
+  }
+}
+
+
+void IndexedImage::insertImage(
+  const size_t x,
+  const size_t y,
+  const IndexedImage& image,
+  const std::vector<bool>& mask)
+{
+  if (x + image.width() > mWidth || y + image.height() > mHeight)
+  {
+    throw invalid_argument("Source image doesn't fit");
+  }
+
+  if (mask.size() != image.indexData().size())
+  {
+    throw invalid_argument("Mask size doesn't match image");
+  }
+
+  auto sourceIndex = size_t{0};
+  for (size_t row = 0; row < image.height(); ++row)
+  {
+    for (size_t col = 0; col < image.width(); ++col)
+    {
+      if (mask[sourceIndex])
+      {
+        const auto targetOffset = (x + col) + (y + row) * mWidth;
+        mIndices[targetOffset] = image.indexData()[sourceIndex];
+      }
+
+      ++sourceIndex;
+    }
+  }
+}
+
+
+Image IndexedImage::toRgba(const base::ArrayView<Pixel> palette) const
+{
+  PixelBuffer pixels;
+  pixels.reserve(mIndices.size());
+
+  for (const auto index : mIndices)
+  {
+    pixels.push_back(index < palette.size() ? palette[index] : Pixel{});
+  }
+
+  return Image(std::move(pixels), mWidth, mHeight);
+}
+
+
+std::size_t imageWidth(const AnyImage& image)
+{
+  return std::visit([](const auto& img) { return img.width(); }, image);
+}
+
+
+std::size_t imageHeight(const AnyImage& image)
+{
+  return std::visit([](const auto& img) { return img.height(); }, image);
+}
+
+
+Image toRgba(const AnyImage& image, const base::ArrayView<Pixel> palette)
+{
+  if (const auto pIndexed = std::get_if<IndexedImage>(&image))
+  {
+    return pIndexed->toRgba(palette);
+  }
+
+  return std::get<Image>(image);
+}
+
+
 } // namespace rigel::data
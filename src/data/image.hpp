@@ -16,9 +16,11 @@
 
 #pragma once
 
+#include "base/array_view.hpp"
 #include "base/color.hpp"
 
 #include <cstdint>
+#include <variant>
 #include <vector>
 
 
@@ -27,6 +29,7 @@ namespace rigel::data
 
 using Pixel = rigel::base::Color;
 using PixelBuffer = std::vector<Pixel>;
+using IndexBuffer = std::vector<std::uint8_t>;
 
 
 /** Simple technology-agnostic image data holder.
@@ -60,4 +63,61 @@ private:
 };
 
 
+/** Palette-based image data holder
+ *
+ * Stores one 8-bit palette index per pixel instead of a color, which is how
+ * the original game's art is stored. The palette itself is kept separately,
+ * so that the same image can be shown with different palettes.
+ *
+ * Indices which are outside of the palette used for converting or drawing
+ * the image are treated as fully transparent.
+ */
+class IndexedImage
+{
+public:
+  IndexedImage(IndexBuffer&& indices, std::size_t width, std::size_t height);
+
+  /** Create an image with all indices set to the given one */
+  IndexedImage(std::size_t width, std::size_t height, std::uint8_t index = 0);
+
+  const IndexBuffer& indexData() const { return mIndices; }
+
+  std::size_t width() const { return mWidth; }
+
+  std::size_t height() const { return mHeight; }
+
+  void insertImage(std::size_t x, std::size_t y, const IndexedImage& image);
+
+  /** Like insertImage() above, but only copies pixels which are set in the
+   * mask. The mask holds one entry per pixel of the source image.
+   */
+  void insertImage(
+    std::size_t x,
+    std::size_t y,
+    const IndexedImage& image,
+    const std::vector<bool>& mask);
+
+  Image toRgba(base::ArrayView<Pixel> palette) const;
+
+private:
+  IndexBuffer mIndices;
+  std::size_t mWidth;
+  std::size_t mHeight;
+};
+
+
+/** Image in either of the two representations
+ *
+ * Art from the original game files is loaded as indexed images, but
+ * replacement images loaded from PNG files are true color.
+ */
+using AnyImage = std::variant<Image, IndexedImage>;
+
+std::size_t imageWidth(const AnyImage& image);
+std::size_t imageHeight(const AnyImage& image);
+
+/** Returns true color images as they are, converts indexed ones */
+Image toRgba(const AnyImage& image, base::ArrayView<Pixel> palette);
+
+
 } // namespace rigel::data
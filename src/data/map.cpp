@@ -19,7 +19,9 @@
 #include "data/game_traits.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstring>
 #include <stdexcept>
 #include <utility>
 
@@ -29,6 +31,22 @@ namespace rigel::data::map
 
 using namespace std;
 
+namespace
+{
+
+// Revisions are unique across all maps, so that a map which is restored from
+// a copy (e.g. when quick loading) can never be confused with a different
+// modification of the same map.
+std::atomic<std::uint32_t> gNextRevision{1};
+
+
+std::uint32_t newRevision()
+{
+  return gNextRevision.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace
+
 
 Map::Map(
   const int widthInTiles,
@@ -40,6 +58,7 @@ Map::Map(
   , mWidthInTiles(static_cast<size_t>(widthInTiles))
   , mHeightInTiles(static_cast<size_t>(heightInTiles))
   , mAttributes(std::move(attributes))
+  , mRevision(newRevision())
 {
   assert(widthInTiles >= 0);
   assert(heightInTiles >= 0);
@@ -59,6 +78,7 @@ void Map::setTileAt(const int layer, const int x, const int y, TileIndex index)
     throw invalid_argument("Tile index too large for tile set");
   }
   tileRefAt(layer, x, y) = index;
+  markModified({{x, y}, {1, 1}});
 }
 
 
@@ -68,14 +88,163 @@ void Map::clearSection(
   const int width,
   const int height)
 {
-  for (auto row = y; row < y + height; ++row)
+  const auto section = base::Rect<int>{{x, y}, {width, height}};
+  if (width <= 0 || height <= 0)
+  {
+    return;
+  }
+
+  checkSection(0, section);
+  fillRowSpans(0, section, 0);
+  fillRowSpans(1, section, 0);
+  markModified(section);
+}
+
+
+void Map::fillSection(
+  const int layer,
+  const base::Rect<int>& section,
+  const TileIndex index)
+{
+  if (index >= GameTraits::CZone::numTilesTotal)
+  {
+    throw invalid_argument("Tile index too large for tile set");
+  }
+
+  if (section.size.width <= 0 || section.size.height <= 0)
+  {
+    return;
+  }
+
+  checkSection(layer, section);
+  fillRowSpans(layer, section, index);
+  markModified(section);
+}
+
+
+void Map::moveSection(
+  const base::Rect<int>& section,
+  const base::Vector& newTopLeft)
+{
+  const auto width = section.size.width;
+  const auto height = section.size.height;
+  if (width <= 0 || height <= 0 || newTopLeft == section.topLeft)
+  {
+    return;
+  }
+
+  const auto destination = base::Rect<int>{newTopLeft, section.size};
+  checkSection(0, section);
+  checkSection(0, destination);
+
+  // When moving down, we need to start with the bottom-most row, so that
+  // source rows aren't overwritten before they are copied. Within a row,
+  // memmove takes care of any overlap.
+  const auto movingDown = newTopLeft.y > section.top();
+
+  for (auto layer = 0; layer < int(mLayers.size()); ++layer)
+  {
+    for (auto i = 0; i < height; ++i)
+    {
+      const auto row = movingDown ? height - i - 1 : i;
+      memmove(
+        rowStart(layer, newTopLeft.x, newTopLeft.y + row),
+        rowStart(layer, section.left(), section.top() + row),
+        width * sizeof(TileIndex));
+    }
+
+    // Clear whatever part of the source isn't covered by the destination
+    for (auto y = section.top(); y <= section.bottom(); ++y)
+    {
+      if (y < destination.top() || y > destination.bottom())
+      {
+        fill_n(rowStart(layer, section.left(), y), width, TileIndex{0});
+        continue;
+      }
+
+      const auto coveredLeft = max(section.left(), destination.left());
+      const auto coveredRight = min(section.right(), destination.right());
+      if (coveredLeft > coveredRight)
+      {
+        fill_n(rowStart(layer, section.left(), y), width, TileIndex{0});
+        continue;
+      }
+
+      fill_n(
+        rowStart(layer, section.left(), y),
+        coveredLeft - section.left(),
+        TileIndex{0});
+      fill_n(
+        rowStart(layer, coveredRight + 1, y),
+        section.right() - coveredRight,
+        TileIndex{0});
+    }
+  }
+
+  const auto left = min(section.left(), destination.left());
+  const auto top = min(section.top(), destination.top());
+  const auto right = max(section.right(), destination.right());
+  const auto bottom = max(section.bottom(), destination.bottom());
+  markModified({{left, top}, {right - left + 1, bottom - top + 1}});
+}
+
+
+void Map::copyRowSpan(
+  const int layer,
+  const base::Vector& sourceStart,
+  const base::Vector& destinationStart,
+  const int length)
+{
+  if (length <= 0)
   {
-    for (auto col = x; col < x + width; ++col)
+    return;
+  }
+
+  const auto destination = base::Rect<int>{destinationStart, {length, 1}};
+  checkSection(layer, {sourceStart, {length, 1}});
+  checkSection(layer, destination);
+
+  memmove(
+    rowStart(layer, destinationStart.x, destinationStart.y),
+    rowStart(layer, sourceStart.x, sourceStart.y),
+    length * sizeof(TileIndex));
+  markModified(destination);
+}
+
+
+void Map::updateFrom(
+  const Map& source,
+  const std::initializer_list<base::Rect<int>> changedSections)
+{
+  assert(
+    source.mWidthInTiles == mWidthInTiles &&
+    source.mHeightInTiles == mHeightInTiles);
+
+  for (const auto& section : changedSections)
+  {
+    if (section.size.width <= 0 || section.size.height <= 0)
+    {
+      continue;
+    }
+
+    checkSection(0, section);
+
+    for (auto layer = 0; layer < int(mLayers.size()); ++layer)
     {
-      setTileAt(0, col, row, 0);
-      setTileAt(1, col, row, 0);
+      for (auto y = section.top(); y <= section.bottom(); ++y)
+      {
+        const auto offset = section.left() + y * mWidthInTiles;
+        copy_n(
+          source.mLayers[layer].begin() + offset,
+          section.size.width,
+          mLayers[layer].begin() + offset);
+      }
     }
   }
+
+  mRevision = source.mRevision;
+  mPreviousRevision = source.mPreviousRevision;
+  mLastModifiedSection = source.mLastModifiedSection;
 }
 
 
@@ -168,4 +337,38 @@ map::TileIndex& Map::tileRefAt(const int layer, const int x, const int y)
 }
 
 
+map::TileIndex* Map::rowStart(const int layer, const int x, const int y)
+{
+  return mLayers[layer].data() + x + y * mWidthInTiles;
+}
+
+
+void Map::checkSection(const int layer, const base::Rect<int>& section) const
+{
+  // Validating the corners is sufficient, since sections are rectangular
+  tileRefAt(layer, section.left(), section.top());
+  tileRefAt(layer, section.right(), section.bottom());
+}
+
+
+void Map::fillRowSpans(
+  const int layer,
+  const base::Rect<int>& section,
+  const TileIndex index)
+{
+  for (auto y = section.top(); y <= section.bottom(); ++y)
+  {
+    fill_n(rowStart(layer, section.left(), y), section.size.width, index);
+  }
+}
+
+
+void Map::markModified(const base::Rect<int>& section)
+{
+  mPreviousRevision = mRevision;
+  mRevision = newRevision();
+  mLastModifiedSection = section;
+}
+
+
 } // namespace rigel::data::map
@@ -22,6 +22,8 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
+#include <initializer_list>
 #include <optional>
 #include <string>
 #include <vector>
@@ -64,15 +66,79 @@ public:
 
   void clearSection(int x, int y, int width, int height);
 
+  /** Set all tiles of the given section on the given layer to index */
+  void fillSection(int layer, const base::Rect<int>& section, TileIndex index);
+
+  /** Move the tiles of the given section (both layers) to a new position
+   *
+   * Source and destination may overlap. Tiles in the source section which
+   * are not part of the destination are cleared afterwards. Counts as a
+   * single modification, whose section covers both source and destination.
+   */
+  void moveSection(
+    const base::Rect<int>& section,
+    const base::Vector& newTopLeft);
+
+  /** Copy length tiles in a row on the given layer
+   *
+   * Source and destination may overlap.
+   */
+  void copyRowSpan(
+    int layer,
+    const base::Vector& sourceStart,
+    const base::Vector& destinationStart,
+    int length);
+
   const TileAttributeDict& attributeDict() const;
   TileAttributes attributes(int x, int y) const;
 
   CollisionData collisionData(int x, int y) const;
 
+  /** Identifies the current contents of the map
+   *
+   * Changes whenever a tile is modified. Copies of a map share the revision
+   * of their source, so two maps with the same revision have identical
+   * contents. This allows cheaply detecting whether a copy of the map is
+   * outdated.
+   */
+  std::uint32_t revision() const { return mRevision; }
+
+  /** Revision the map had before the most recent modification */
+  std::uint32_t previousRevision() const { return mPreviousRevision; }
+
+  /** Area affected by the most recent modification
+   *
+   * Each modification - setTileAt(), or one of the section operations - bumps
+   * the revision exactly once. A cache derived from the map which is at
+   * previousRevision() can thus be brought up to date by only updating this
+   * section, instead of being rebuilt completely.
+   */
+  const base::Rect<int>& lastModifiedSection() const
+  {
+    return mLastModifiedSection;
+  }
+
+  /** Bring a copy of the given map up to date by only copying some sections
+   *
+   * Copies the given sections (both layers) from source, and then takes over
+   * its revision. This is only valid if the two maps differ in nothing but
+   * these sections - e.g., if this map is at source.previousRevision(), and
+   * the section is source.lastModifiedSection(). Both maps must have the
+   * same size.
+   */
+  void updateFrom(
+    const Map& source,
+    std::initializer_list<base::Rect<int>> changedSections);
+
 private:
   const TileIndex& tileRefAt(int layer, int x, int y) const;
   TileIndex& tileRefAt(int layer, int x, int y);
 
+  TileIndex* rowStart(int layer, int x, int y);
+  void checkSection(int layer, const base::Rect<int>& section) const;
+  void fillRowSpans(int layer, const base::Rect<int>& section, TileIndex index);
+  void markModified(const base::Rect<int>& section);
+
 private:
   using TileArray = std::vector<TileIndex>;
   std::array<TileArray, 2> mLayers;
@@ -81,6 +147,9 @@ private:
   std::size_t mHeightInTiles;
 
   TileAttributeDict mAttributes;
+  std::uint32_t mRevision = 0;
+  std::uint32_t mPreviousRevision = 0;
+  base::Rect<int> mLastModifiedSection;
 };
 
 
@@ -93,9 +162,9 @@ struct LevelData
     std::optional<base::Rect<int>> mAssignedArea;
   };
 
-  Image mTileSetImage;
-  Image mBackdropImage;
-  std::optional<Image> mSecondaryBackdropImage;
+  AnyImage mTileSetImage;
+  AnyImage mBackdropImage;
+  std::optional<AnyImage> mSecondaryBackdropImage;
 
   data::map::Map mMap;
   std::vector<Actor> mActors;
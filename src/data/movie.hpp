@@ -26,21 +26,37 @@ namespace rigel::data
 
 struct MovieFrame
 {
-  MovieFrame(Image&& replacementImage, const int startRow)
+  MovieFrame(
+    IndexedImage&& replacementImage,
+    std::vector<bool>&& changedPixels,
+    const int startRow)
     : mReplacementImage(std::move(replacementImage))
+    , mChangedPixels(std::move(changedPixels))
     , mStartRow(startRow)
   {
   }
 
-  Image mReplacementImage;
+  IndexedImage mReplacementImage;
+
+  /** One entry per pixel of the replacement image
+   *
+   * Pixels which are not marked as changed keep their color from the
+   * previous frame. Their index in the replacement image is meaningless.
+   */
+  std::vector<bool> mChangedPixels;
   int mStartRow;
 };
 
 
+/** Palette-based movie
+ *
+ * All images use the movie's palette, which has up to 256 entries.
+ */
 struct Movie
 {
-  Image mBaseImage;
+  IndexedImage mBaseImage;
   std::vector<MovieFrame> mFrames;
+  std::vector<Pixel> mPalette;
 };
 
 } // namespace rigel::data
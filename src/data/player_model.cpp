@@ -20,6 +20,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <iterator>
 
 
 namespace rigel::data
@@ -213,8 +214,7 @@ PlayerModel::LetterCollectionState
   PlayerModel::addLetter(const CollectableLetterType type)
 {
   using L = CollectableLetterType;
-  static std::vector<L> sExpectedOrder = {L::N, L::U, L::K, L::E, L::M};
-
+  constexpr L EXPECTED_ORDER[] = {L::N, L::U, L::K, L::E, L::M};
 
   mCollectedLetters.push_back(type);
 
@@ -224,7 +224,11 @@ PlayerModel::LetterCollectionState
   }
   else
   {
-    return mCollectedLetters == sExpectedOrder
+    return std::equal(
+             mCollectedLetters.begin(),
+             mCollectedLetters.end(),
+             std::begin(EXPECTED_ORDER),
+             std::end(EXPECTED_ORDER))
       ? LetterCollectionState::InOrder
       : LetterCollectionState::WrongOrder;
   }
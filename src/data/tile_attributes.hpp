@@ -100,6 +100,8 @@ public:
   TileAttributes attributes(TileIndex tile) const;
   CollisionData collisionData(TileIndex tile) const;
 
+  const AttributeArray& bitPacks() const { return mAttributeBitPacks; }
+
 private:
   std::uint16_t bitPackFor(TileIndex tile) const;
 
@@ -23,6 +23,7 @@
 #include "base/warnings.hpp"
 
 #include "base/defer.hpp"
+#include "base/startup_timeline.hpp"
 #include "common/user_profile.hpp"
 #include "frontend/game.hpp"
 #include "renderer/opengl.hpp"
@@ -107,7 +108,8 @@ int main()
   CommandLineOptions options;
   options.mGamePath = WASM_GAME_PATH;
 
-  Game game(options, &userProfile, pWindow.get(), false);
+  base::StartupTimeline startupTimeline;
+  Game game(options, &userProfile, pWindow.get(), false, &startupTimeline);
 
   // clang-format off
   EM_ASM(
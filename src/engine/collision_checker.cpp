@@ -17,6 +17,7 @@
 #include "collision_checker.hpp"
 
 #include <algorithm>
+#include <optional>
 
 
 namespace rigel::engine
@@ -134,6 +135,157 @@ bool CollisionChecker::testVerticalSpan(
 }
 
 
+namespace
+{
+
+/** First step at which a span moving along an axis overlaps the given range
+ *
+ * The span starts at firstPosition, and moves by step (1 or -1) each time.
+ * Returns nullopt if it never reaches the range.
+ */
+std::optional<int> firstOverlappingStep(
+  const int firstPosition,
+  const int step,
+  const int rangeStart,
+  const int rangeEnd)
+{
+  if (step > 0)
+  {
+    if (rangeEnd < firstPosition)
+    {
+      return std::nullopt;
+    }
+
+    return std::max(0, rangeStart - firstPosition);
+  }
+
+  if (rangeStart > firstPosition)
+  {
+    return std::nullopt;
+  }
+
+  return std::max(0, firstPosition - rangeEnd);
+}
+
+} // namespace
+
+
+int CollisionChecker::sweepHorizontalSpan(
+  const int startX,
+  const int endX,
+  const int firstY,
+  const int step,
+  const int maxDistance,
+  const SolidEdge edge) const
+{
+  auto distance = maxDistance;
+
+  // Solid bodies don't move while sweeping, so each one blocks at the first
+  // step where the span overlaps it. This matches testSolidBodyCollision(),
+  // which never reports collisions for empty spans or bodies.
+  if (endX >= startX)
+  {
+    for (const auto& entity : mSolidBodies)
+    {
+      if (
+        !entity.has_component<BoundingBox>() ||
+        !entity.has_component<WorldPosition>())
+      {
+        continue;
+      }
+
+      const auto bodyBbox = engine::toWorldSpace(
+        *entity.component<const BoundingBox>(),
+        *entity.component<const WorldPosition>());
+      if (
+        bodyBbox.size.width <= 0 || bodyBbox.size.height <= 0 ||
+        bodyBbox.right() < startX || bodyBbox.left() > endX)
+      {
+        continue;
+      }
+
+      if (
+        const auto blockingStep = firstOverlappingStep(
+          firstY, step, bodyBbox.top(), bodyBbox.bottom()))
+      {
+        distance = std::min(distance, *blockingStep);
+      }
+    }
+  }
+
+  for (int i = 0; i < distance; ++i)
+  {
+    const auto y = firstY + i * step;
+    for (int x = startX; x <= endX; ++x)
+    {
+      if (mpMap->collisionData(x, y).isSolidOn(edge))
+      {
+        return i;
+      }
+    }
+  }
+
+  return distance;
+}
+
+
+int CollisionChecker::sweepVerticalSpan(
+  const int startY,
+  const int endY,
+  const int firstX,
+  const int step,
+  const int maxDistance,
+  const SolidEdge edge) const
+{
+  auto distance = maxDistance;
+
+  // See sweepHorizontalSpan()
+  if (endY >= startY)
+  {
+    for (const auto& entity : mSolidBodies)
+    {
+      if (
+        !entity.has_component<BoundingBox>() ||
+        !entity.has_component<WorldPosition>())
+      {
+        continue;
+      }
+
+      const auto bodyBbox = engine::toWorldSpace(
+        *entity.component<const BoundingBox>(),
+        *entity.component<const WorldPosition>());
+      if (
+        bodyBbox.size.width <= 0 || bodyBbox.size.height <= 0 ||
+        bodyBbox.bottom() < startY || bodyBbox.top() > endY)
+      {
+        continue;
+      }
+
+      if (
+        const auto blockingStep = firstOverlappingStep(
+          firstX, step, bodyBbox.left(), bodyBbox.right()))
+      {
+        distance = std::min(distance, *blockingStep);
+      }
+    }
+  }
+
+  for (int i = 0; i < distance; ++i)
+  {
+    const auto x = firstX + i * step;
+    for (int y = startY; y <= endY; ++y)
+    {
+      if (mpMap->collisionData(x, y).isSolidOn(edge))
+      {
+        return i;
+      }
+    }
+  }
+
+  return distance;
+}
+
+
 bool CollisionChecker::testSolidBodyCollision(
   const BoundingBox& bboxToTest) const
 {
@@ -199,6 +351,62 @@ bool CollisionChecker::isTouchingRightWall(
 }
 
 
+int CollisionChecker::freeDistanceToLeftWall(
+  const BoundingBox& worldSpaceBbox,
+  const int maxDistance) const
+{
+  return sweepVerticalSpan(
+    worldSpaceBbox.top(),
+    worldSpaceBbox.bottom(),
+    worldSpaceBbox.left() - 1,
+    -1,
+    maxDistance,
+    SolidEdge::right());
+}
+
+
+int CollisionChecker::freeDistanceToRightWall(
+  const BoundingBox& worldSpaceBbox,
+  const int maxDistance) const
+{
+  return sweepVerticalSpan(
+    worldSpaceBbox.top(),
+    worldSpaceBbox.bottom(),
+    worldSpaceBbox.right() + 1,
+    1,
+    maxDistance,
+    SolidEdge::left());
+}
+
+
+int CollisionChecker::freeDistanceToCeiling(
+  const BoundingBox& worldSpaceBbox,
+  const int maxDistance) const
+{
+  return sweepHorizontalSpan(
+    worldSpaceBbox.left(),
+    worldSpaceBbox.right(),
+    worldSpaceBbox.top() - 1,
+    -1,
+    maxDistance,
+    SolidEdge::bottom());
+}
+
+
+int CollisionChecker::freeDistanceToGround(
+  const BoundingBox& worldSpaceBbox,
+  const int maxDistance) const
+{
+  return sweepHorizontalSpan(
+    worldSpaceBbox.left(),
+    worldSpaceBbox.right(),
+    worldSpaceBbox.bottom() + 1,
+    1,
+    maxDistance,
+    SolidEdge::top());
+}
+
+
 void CollisionChecker::receive(const ex::ComponentAddedEvent<SolidBody>& event)
 {
   mSolidBodies.push_back(event.entity);
@@ -60,6 +60,27 @@ public:
   bool isTouchingLeftWall(const engine::components::BoundingBox& bbox) const;
   bool isTouchingRightWall(const engine::components::BoundingBox& bbox) const;
 
+  /** Distance a bounding box can move until it's blocked
+   *
+   * These give the same result as moving the box one unit at a time (up to
+   * maxDistance times), and stopping as soon as the corresponding
+   * isTouchingXyz()/isOnSolidGround() test returns true. But they only visit
+   * each solid body once, and only scan the map up to the closest blocking
+   * solid body, instead of running a full test for each unit moved.
+   */
+  int freeDistanceToLeftWall(
+    const engine::components::BoundingBox& bbox,
+    int maxDistance) const;
+  int freeDistanceToRightWall(
+    const engine::components::BoundingBox& bbox,
+    int maxDistance) const;
+  int freeDistanceToCeiling(
+    const engine::components::BoundingBox& bbox,
+    int maxDistance) const;
+  int freeDistanceToGround(
+    const engine::components::BoundingBox& bbox,
+    int maxDistance) const;
+
   bool
     testHorizontalSpan(int startX, int endX, int y, data::map::SolidEdge edge)
       const;
@@ -74,6 +95,20 @@ public:
 private:
   bool
     testSolidBodyCollision(const engine::components::BoundingBox& bbox) const;
+  int sweepHorizontalSpan(
+    int startX,
+    int endX,
+    int firstY,
+    int step,
+    int maxDistance,
+    data::map::SolidEdge edge) const;
+  int sweepVerticalSpan(
+    int startY,
+    int endY,
+    int firstX,
+    int step,
+    int maxDistance,
+    data::map::SolidEdge edge) const;
 
   std::vector<entityx::Entity> mSolidBodies;
   const data::map::Map* mpMap;
@@ -20,6 +20,7 @@
 #include "engine/base_components.hpp"
 #include "engine/entity_tools.hpp"
 #include "engine/physical_components.hpp"
+#include "engine/world_bounds_mirror.hpp"
 
 
 namespace rigel::engine
@@ -61,6 +62,17 @@ bool determineActiveState(entityx::Entity entity, const bool inActiveRegion)
   return inActiveRegion;
 }
 
+
+void updateActiveState(entityx::Entity entity, const bool inActiveRegion)
+{
+  const auto active = determineActiveState(entity, inActiveRegion);
+  setTag<Active>(entity, active);
+  if (active)
+  {
+    entity.component<Active>()->mIsOnScreen = inActiveRegion;
+  }
+}
+
 } // namespace
 
 
@@ -88,14 +100,25 @@ void markActiveEntities(
                                         const WorldPosition& position,
                                         const BoundingBox& bbox) {
     const auto worldSpaceBbox = toWorldSpace(bbox, position);
-    const auto inActiveRegion = worldSpaceBbox.intersects(activeRegionBox);
-    const auto active = determineActiveState(entity, inActiveRegion);
-    setTag<Active>(entity, active);
-    if (active)
+    updateActiveState(entity, worldSpaceBbox.intersects(activeRegionBox));
+  });
+}
+
+
+void markActiveEntities(
+  WorldBoundsMirror& bounds,
+  const base::Vector& cameraPosition,
+  const base::Extents& viewPortSize)
+{
+  bounds.cull({cameraPosition, viewPortSize});
+
+  for (auto slot = std::size_t{0}; slot < bounds.size(); ++slot)
+  {
+    if (auto entity = bounds.entity(slot))
     {
-      entity.component<Active>()->mIsOnScreen = inActiveRegion;
+      updateActiveState(entity, bounds.isInRegion(slot));
     }
-  });
+  }
 }
 
 } // namespace rigel::engine
@@ -27,9 +27,22 @@ RIGEL_RESTORE_WARNINGS
 namespace rigel::engine
 {
 
+class WorldBoundsMirror;
+
+
 void markActiveEntities(
   entityx::EntityManager& es,
   const base::Vector& cameraPosition,
   const base::Extents& viewPortSize);
 
-}
+/** Same as above, but culls via the given mirror in one batch
+ *
+ * Produces identical results, the mirror must be tracking the same
+ * entity manager whose entities would be visited by the overload above.
+ */
+void markActiveEntities(
+  WorldBoundsMirror& bounds,
+  const base::Vector& cameraPosition,
+  const base::Extents& viewPortSize);
+
+} // namespace rigel::engine
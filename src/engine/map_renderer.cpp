@@ -19,6 +19,7 @@
 #include "base/math_tools.hpp"
 #include "data/game_traits.hpp"
 #include "data/unit_conversions.hpp"
+#include "loader/palette.hpp"
 
 #include <cfenv>
 #include <iostream>
@@ -122,6 +123,28 @@ float maxOffsetForScrollMode(const BackdropScrollMode mode)
 }
 
 
+map::TileIndex animatedTileIndex(
+  const MapRenderState& state,
+  const map::TileIndex tileIndex)
+{
+  const auto& attributes = state.mpMap->attributeDict().attributes(tileIndex);
+  if (attributes.isAnimated())
+  {
+    const auto fastAnimOffset =
+      (state.mAnimationFrame / FAST_ANIM_FRAME_DELAY) % ANIM_STATES;
+    const auto slowAnimOffset =
+      (state.mAnimationFrame / SLOW_ANIM_FRAME_DELAY) % ANIM_STATES;
+
+    return tileIndex +
+      (attributes.isFastAnimation() ? fastAnimOffset : slowAnimOffset);
+  }
+  else
+  {
+    return tileIndex;
+  }
+}
+
+
 constexpr auto TILE_SET_IMAGE_LOGICAL_SIZE = base::Extents{
   tilesToPixels(data::GameTraits::CZone::tileSetImageWidth),
   tilesToPixels(data::GameTraits::CZone::tileSetImageHeight)};
@@ -131,21 +154,20 @@ constexpr auto TILE_SET_IMAGE_LOGICAL_SIZE = base::Extents{
 
 MapRenderer::MapRenderer(
   renderer::Renderer* pRenderer,
-  const data::map::Map* pMap,
   MapRenderData&& renderData)
   : mpRenderer(pRenderer)
-  , mpMap(pMap)
+  , mPalette(pRenderer, loader::INGAME_PALETTE)
   , mTileSetTexture(
-      renderer::Texture(pRenderer, renderData.mTileSetImage),
+      renderer::Texture(pRenderer, renderData.mTileSetImage, mPalette),
       TILE_SET_IMAGE_LOGICAL_SIZE,
       pRenderer)
-  , mBackdropTexture(mpRenderer, renderData.mBackdropImage)
+  , mBackdropTexture(mpRenderer, renderData.mBackdropImage, mPalette)
   , mScrollMode(renderData.mBackdropScrollMode)
 {
   if (renderData.mSecondaryBackdropImage)
   {
-    mAlternativeBackdropTexture =
-      renderer::Texture(mpRenderer, *renderData.mSecondaryBackdropImage);
+    mAlternativeBackdropTexture = renderer::Texture(
+      mpRenderer, *renderData.mSecondaryBackdropImage, mPalette);
   }
 }
 
@@ -158,42 +180,50 @@ bool MapRenderer::hasHighResReplacements() const
 }
 
 
-void MapRenderer::switchBackdrops()
+bool MapRenderer::hasAutoScrollingBackdrop() const
 {
-  std::swap(mBackdropTexture, mAlternativeBackdropTexture);
+  return mScrollMode == BackdropScrollMode::AutoHorizontal ||
+    mScrollMode == BackdropScrollMode::AutoVertical;
 }
 
 
 void MapRenderer::renderBackground(
+  const MapRenderState& state,
   const base::Vector& sectionStart,
   const base::Extents& sectionSize) const
 {
-  renderMapTiles(sectionStart, sectionSize, DrawMode::Background);
+  renderMapTiles(state, sectionStart, sectionSize, DrawMode::Background);
 }
 
 
 void MapRenderer::renderForeground(
+  const MapRenderState& state,
   const base::Vector& sectionStart,
   const base::Extents& sectionSize) const
 {
-  renderMapTiles(sectionStart, sectionSize, DrawMode::Foreground);
+  renderMapTiles(state, sectionStart, sectionSize, DrawMode::Foreground);
 }
 
 
 void MapRenderer::renderBackdrop(
+  const MapRenderState& state,
   const base::Vector& cameraPosition,
   const base::Extents& viewPortSize) const
 {
+  const auto& backdropTexture = state.mBackdropSwitched
+    ? mAlternativeBackdropTexture
+    : mBackdropTexture;
+
   const auto numRepetitions = base::integerDivCeil(
     tilesToPixels(viewPortSize.width), GameTraits::viewPortWidthPx);
 
   const auto sourceRectSize = base::Extents{
-    mBackdropTexture.width() * numRepetitions, mBackdropTexture.height()};
+    backdropTexture.width() * numRepetitions, backdropTexture.height()};
   const auto destRectSize = base::Extents{
     GameTraits::viewPortWidthPx * numRepetitions, GameTraits::viewPortHeightPx};
 
   const auto widthFactor =
-    mBackdropTexture.width() / GameTraits::viewPortWidthPx;
+    backdropTexture.width() / GameTraits::viewPortWidthPx;
   const auto offset =
     backdropOffset(cameraPosition, mScrollMode, mBackdropAutoScrollOffset) *
     widthFactor;
@@ -201,20 +231,23 @@ void MapRenderer::renderBackdrop(
   const auto saved = renderer::saveState(mpRenderer);
   mpRenderer->setTextureRepeatEnabled(true);
   mpRenderer->drawTexture(
-    mBackdropTexture.data(),
+    backdropTexture.data(),
     renderer::toTexCoords(
       {offset, sourceRectSize},
-      mBackdropTexture.width(),
-      mBackdropTexture.height()),
+      backdropTexture.width(),
+      backdropTexture.height()),
     {{}, destRectSize});
 }
 
 
 void MapRenderer::renderMapTiles(
+  const MapRenderState& state,
   const base::Vector& sectionStart,
   const base::Extents& sectionSize,
   const DrawMode drawMode) const
 {
+  const auto& map = *state.mpMap;
+
   for (int layer = 0; layer < 2; ++layer)
   {
     for (int y = 0; y < sectionSize.height; ++y)
@@ -223,14 +256,14 @@ void MapRenderer::renderMapTiles(
       {
         const auto col = x + sectionStart.x;
         const auto row = y + sectionStart.y;
-        if (col >= mpMap->width() || row >= mpMap->height())
+        if (col >= map.width() || row >= map.height())
         {
           continue;
         }
 
-        const auto tileIndex = mpMap->tileAt(layer, col, row);
+        const auto tileIndex = map.tileAt(layer, col, row);
         const auto isForeground =
-          mpMap->attributeDict().attributes(tileIndex).isForeGround();
+          map.attributeDict().attributes(tileIndex).isForeGround();
         const auto shouldRenderForeground = drawMode == DrawMode::Foreground;
 
         if (isForeground != shouldRenderForeground)
@@ -238,19 +271,13 @@ void MapRenderer::renderMapTiles(
           continue;
         }
 
-        renderTile(tileIndex, x, y);
+        renderTile(state, tileIndex, x, y);
       }
     }
   }
 }
 
 
-void MapRenderer::updateAnimatedMapTiles()
-{
-  ++mElapsedFrames;
-}
-
-
 void MapRenderer::updateBackdropAutoScrolling(const engine::TimeDelta dt)
 {
   mBackdropAutoScrollOffset += dt * speedForScrollMode(mScrollMode);
@@ -260,16 +287,18 @@ void MapRenderer::updateBackdropAutoScrolling(const engine::TimeDelta dt)
 
 
 void MapRenderer::renderSingleTile(
+  const MapRenderState& state,
   const data::map::TileIndex index,
   const base::Vector& position,
   const base::Vector& cameraPosition) const
 {
   const auto screenPosition = position - cameraPosition;
-  renderTile(index, screenPosition.x, screenPosition.y);
+  renderTile(state, index, screenPosition.x, screenPosition.y);
 }
 
 
 void MapRenderer::renderTile(
+  const MapRenderState& state,
   const data::map::TileIndex tileIndex,
   const int x,
   const int y) const
@@ -278,30 +307,9 @@ void MapRenderer::renderTile(
   // should be visible. Therefore, don't draw if the index is 0.
   if (tileIndex != 0)
   {
-    const auto tileIndexToDraw = animatedTileIndex(tileIndex);
+    const auto tileIndexToDraw = animatedTileIndex(state, tileIndex);
     mTileSetTexture.renderTile(tileIndexToDraw, x, y);
   }
 }
 
-
-map::TileIndex
-  MapRenderer::animatedTileIndex(const map::TileIndex tileIndex) const
-{
-  if (mpMap->attributeDict().attributes(tileIndex).isAnimated())
-  {
-    const auto fastAnimOffset =
-      (mElapsedFrames / FAST_ANIM_FRAME_DELAY) % ANIM_STATES;
-    const auto slowAnimOffset =
-      (mElapsedFrames / SLOW_ANIM_FRAME_DELAY) % ANIM_STATES;
-
-    const auto isFastAnim =
-      mpMap->attributeDict().attributes(tileIndex).isFastAnimation();
-    return tileIndex + (isFastAnim ? fastAnimOffset : slowAnimOffset);
-  }
-  else
-  {
-    return tileIndex;
-  }
-}
-
 } // namespace rigel::engine
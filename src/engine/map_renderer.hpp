@@ -27,40 +27,52 @@
 namespace rigel::engine
 {
 
+/** Parts of the map's appearance that are controlled by game logic
+ *
+ * MapRenderer doesn't keep track of these itself, so that rendering can
+ * work from a snapshot while game logic is already advancing.
+ */
+struct MapRenderState
+{
+  const data::map::Map* mpMap = nullptr;
+  std::uint32_t mAnimationFrame = 0;
+  bool mBackdropSwitched = false;
+};
+
+
 class MapRenderer
 {
 public:
   struct MapRenderData
   {
-    data::Image mTileSetImage;
-    data::Image mBackdropImage;
-    std::optional<data::Image> mSecondaryBackdropImage;
+    data::AnyImage mTileSetImage;
+    data::AnyImage mBackdropImage;
+    std::optional<data::AnyImage> mSecondaryBackdropImage;
     data::map::BackdropScrollMode mBackdropScrollMode;
   };
 
-  MapRenderer(
-    renderer::Renderer* renderer,
-    const data::map::Map* pMap,
-    MapRenderData&& renderData);
+  MapRenderer(renderer::Renderer* renderer, MapRenderData&& renderData);
 
   bool hasHighResReplacements() const;
-
-  void switchBackdrops();
+  bool hasAutoScrollingBackdrop() const;
 
   void renderBackdrop(
+    const MapRenderState& state,
     const base::Vector& cameraPosition,
     const base::Extents& viewPortSize) const;
   void renderBackground(
+    const MapRenderState& state,
     const base::Vector& sectionStart,
     const base::Extents& sectionSize) const;
   void renderForeground(
+    const MapRenderState& state,
     const base::Vector& sectionStart,
     const base::Extents& sectionSize) const;
 
-  void updateAnimatedMapTiles();
   void updateBackdropAutoScrolling(engine::TimeDelta dt);
 
   void renderSingleTile(
+    const MapRenderState& state,
     data::map::TileIndex index,
     const base::Vector& position,
     const base::Vector& cameraPosition) const;
@@ -73,15 +85,22 @@ private:
   };
 
   void renderMapTiles(
+    const MapRenderState& state,
     const base::Vector& sectionStart,
     const base::Extents& sectionSize,
     DrawMode drawMode) const;
-  void renderTile(data::map::TileIndex index, int x, int y) const;
-  data::map::TileIndex animatedTileIndex(data::map::TileIndex) const;
+  void renderTile(
+    const MapRenderState& state,
+    data::map::TileIndex index,
+    int x,
+    int y) const;
 
 private:
   mutable renderer::Renderer* mpRenderer;
-  const data::map::Map* mpMap;
+
+  // For tileset and backdrop images from the original game files, which are
+  // indexed. Must outlive the textures using it.
+  renderer::PaletteTexture mPalette;
 
   TiledTexture mTileSetTexture;
   renderer::Texture mBackdropTexture;
@@ -90,7 +109,6 @@ private:
   data::map::BackdropScrollMode mScrollMode;
 
   double mBackdropAutoScrollOffset = 0.0;
-  std::uint32_t mElapsedFrames = 0;
 };
 
 } // namespace rigel::engine
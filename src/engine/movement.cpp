@@ -46,8 +46,9 @@ constexpr auto WALK_OFF_LEDGE_LEEWAY = 2;
 constexpr auto MAX_WIDTH_FOR_CONVEYOR_CHECK = 16u;
 
 
+/** Move by amount, going as far as freeDistance(desiredDistance) allows */
 template <typename CallableT>
-MovementResult move(int* pPosition, const int amount, CallableT isColliding)
+MovementResult move(int* pPosition, const int amount, CallableT freeDistance)
 {
   if (amount == 0)
   {
@@ -55,20 +56,9 @@ MovementResult move(int* pPosition, const int amount, CallableT isColliding)
   }
 
   const auto desiredDistance = std::abs(amount);
-  const auto movement = base::sgn(amount);
+  const auto actualDistance = freeDistance(desiredDistance);
+  *pPosition += actualDistance * base::sgn(amount);
 
-  const auto previousPosition = *pPosition;
-  for (int i = 0; i < desiredDistance; ++i)
-  {
-    if (isColliding())
-    {
-      break;
-    }
-
-    *pPosition += movement;
-  }
-
-  const auto actualDistance = std::abs(*pPosition - previousPosition);
   if (actualDistance == 0)
   {
     return MovementResult::Failed;
@@ -79,6 +69,18 @@ MovementResult move(int* pPosition, const int amount, CallableT isColliding)
 }
 
 
+int freeHorizontalDistance(
+  const CollisionChecker& collisionChecker,
+  const BoundingBox& worldSpaceBbox,
+  const int step,
+  const int maxDistance)
+{
+  return step < 0
+    ? collisionChecker.freeDistanceToLeftWall(worldSpaceBbox, maxDistance)
+    : collisionChecker.freeDistanceToRightWall(worldSpaceBbox, maxDistance);
+}
+
+
 bool canWalkUpStairStep(
   const CollisionChecker& collisionChecker,
   entityx::Entity entity,
@@ -174,9 +176,12 @@ MovementResult moveHorizontally(
   auto& position = *entity.component<WorldPosition>();
   auto& bbox = *entity.component<BoundingBox>();
 
-  return move(&position.x, amount, [&]() {
-    return amount < 0 ? collisionChecker.isTouchingLeftWall(position, bbox)
-                      : collisionChecker.isTouchingRightWall(position, bbox);
+  return move(&position.x, amount, [&](const int desiredDistance) {
+    return freeHorizontalDistance(
+      collisionChecker,
+      toWorldSpace(bbox, position),
+      base::sgn(amount),
+      desiredDistance);
   });
 }
 
@@ -189,9 +194,11 @@ MovementResult moveVertically(
   auto& position = *entity.component<WorldPosition>();
   auto& bbox = *entity.component<BoundingBox>();
 
-  return move(&position.y, amount, [&]() {
-    return amount < 0 ? collisionChecker.isTouchingCeiling(position, bbox)
-                      : collisionChecker.isOnSolidGround(position, bbox);
+  return move(&position.y, amount, [&](const int desiredDistance) {
+    const auto worldSpaceBbox = toWorldSpace(bbox, position);
+    return amount < 0
+      ? collisionChecker.freeDistanceToCeiling(worldSpaceBbox, desiredDistance)
+      : collisionChecker.freeDistanceToGround(worldSpaceBbox, desiredDistance);
   });
 }
 
@@ -210,28 +217,38 @@ MovementResult moveHorizontallyWithStairStepping(
   const auto step = base::sgn(amount);
 
   auto& position = *entity.component<WorldPosition>();
+  const auto& bbox = *entity.component<BoundingBox>();
 
-  MovementResult finalResult = MovementResult::Completed;
-  for (int i = 0; i < desiredDistance; ++i)
+  // Move as far as possible at the current height, then try to step up
+  // when blocked, and repeat.
+  auto distanceMoved = 0;
+  while (distanceMoved < desiredDistance)
   {
-    const auto result = moveHorizontally(collisionChecker, entity, step);
-    if (result != MovementResult::Completed)
+    const auto freeDistance = freeHorizontalDistance(
+      collisionChecker,
+      toWorldSpace(bbox, position),
+      step,
+      desiredDistance - distanceMoved);
+    position.x += freeDistance * step;
+    distanceMoved += freeDistance;
+
+    if (distanceMoved == desiredDistance)
     {
-      if (canWalkUpStairStep(collisionChecker, entity, step))
-      {
-        position.x += step;
-        position.y -= 1;
-      }
-      else
-      {
-        finalResult =
-          i > 0 ? MovementResult::MovedPartially : MovementResult::Failed;
-        break;
-      }
+      break;
     }
+
+    if (!canWalkUpStairStep(collisionChecker, entity, step))
+    {
+      return distanceMoved > 0 ? MovementResult::MovedPartially
+                               : MovementResult::Failed;
+    }
+
+    position.x += step;
+    position.y -= 1;
+    ++distanceMoved;
   }
 
-  return finalResult;
+  return MovementResult::Completed;
 }
 
 
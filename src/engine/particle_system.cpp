@@ -18,20 +18,14 @@
 
 #include "data/unit_conversions.hpp"
 #include "engine/random_number_generator.hpp"
-#include "renderer/renderer.hpp"
 
-#include <algorithm>
 #include <array>
 #include <cassert>
-#include <functional>
-#include <memory>
 
 
 namespace rigel::engine
 {
 
-using renderer::Renderer;
-
 namespace
 {
 
@@ -47,124 +41,57 @@ constexpr std::array<std::int16_t, 44> VERTICAL_MOVEMENT_TABLE{
 constexpr auto SPAWN_OFFSET = base::Vector{0, -1};
 
 
+// A group is rendered one more time after its last update, hence the + 1
+constexpr auto NUM_TRAJECTORY_STEPS = PARTICLE_SYSTEM_LIFE_TIME + 1;
+
 static_assert(
   INITIAL_INDEX_LIMIT + PARTICLE_SYSTEM_LIFE_TIME <
   VERTICAL_MOVEMENT_TABLE.size());
 
 
-auto yOffsetAtTime(
-  const std::int16_t initialOffsetIndex,
-  const int framesElapsed)
-{
-  assert(
-    initialOffsetIndex + framesElapsed <
-    static_cast<int>(VERTICAL_MOVEMENT_TABLE.size()));
-
-  const auto baseOffset =
-    VERTICAL_MOVEMENT_TABLE[initialOffsetIndex + framesElapsed];
-
-  return baseOffset - VERTICAL_MOVEMENT_TABLE[initialOffsetIndex];
-}
+using TrajectoryTable = std::array<
+  std::array<std::int16_t, INITIAL_INDEX_LIMIT + 1>,
+  NUM_TRAJECTORY_STEPS>;
 
 
-struct Particle
+/** Vertical offset for each combination of elapsed frames and initial index
+ *
+ * Indexed by frames elapsed first, so that all offsets needed for rendering
+ * a group at a given point in time are adjacent in memory.
+ */
+constexpr TrajectoryTable precomputeTrajectories()
 {
-  base::Vector offsetAtTime(const int framesElapsed) const
+  TrajectoryTable result{};
+
+  for (auto framesElapsed = 0; framesElapsed < NUM_TRAJECTORY_STEPS;
+       ++framesElapsed)
   {
-    return {
-      mVelocityX * framesElapsed,
-      yOffsetAtTime(mInitialOffsetIndexY, framesElapsed)};
+    for (auto initialIndex = 0; initialIndex <= INITIAL_INDEX_LIMIT;
+         ++initialIndex)
+    {
+      result[framesElapsed][initialIndex] = static_cast<std::int16_t>(
+        VERTICAL_MOVEMENT_TABLE[initialIndex + framesElapsed] -
+        VERTICAL_MOVEMENT_TABLE[initialIndex]);
+    }
   }
 
-  std::int16_t mVelocityX;
-  std::int16_t mInitialOffsetIndexY;
-};
+  return result;
+}
 
 
-using ParticlesList = std::array<Particle, 64>;
+constexpr auto Y_OFFSET_TABLE = precomputeTrajectories();
 
 
-std::unique_ptr<ParticlesList> createParticles(
-  RandomNumberGenerator& randomGenerator,
-  const int velocityScaleX)
+int groupIndexAt(const ParticlePool& pool, const int offset)
 {
-  auto pParticles = std::make_unique<ParticlesList>();
-  for (auto& particle : *pParticles)
-  {
-    const auto randomVariation = randomGenerator.gen() % 20;
-    particle.mVelocityX = static_cast<std::int16_t>(
-      velocityScaleX == 0 ? 10 - randomVariation
-                          : velocityScaleX * (randomVariation + 1));
-    particle.mInitialOffsetIndexY =
-      randomGenerator.gen() % (INITIAL_INDEX_LIMIT + 1);
-  }
-  return pParticles;
+  return (pool.mFirstGroup + offset) % MAX_PARTICLE_GROUPS;
 }
 
 } // namespace
 
 
-struct ParticleGroup
-{
-  ParticleGroup(
-    const base::Vector& origin,
-    const base::Color& color,
-    std::unique_ptr<ParticlesList> pParticles)
-    : mpParticles(std::move(pParticles))
-    , mOrigin(origin)
-    , mColor(color)
-  {
-  }
-
-  ParticleGroup(const ParticleGroup& other)
-    : mpParticles(std::make_unique<ParticlesList>(*other.mpParticles))
-    , mOrigin(other.mOrigin)
-    , mColor(other.mColor)
-  {
-  }
-
-  ParticleGroup& operator=(const ParticleGroup& other)
-  {
-    auto copy = other;
-    std::swap(mpParticles, copy.mpParticles);
-    mOrigin = copy.mOrigin;
-    mColor = copy.mColor;
-    mFramesElapsed = copy.mFramesElapsed;
-    return *this;
-  }
-
-  ParticleGroup(ParticleGroup&&) = default;
-  ParticleGroup& operator=(ParticleGroup&&) = default;
-
-  void update() { ++mFramesElapsed; }
-
-  void render(Renderer& renderer, const base::Vector& cameraPosition)
-  {
-    const auto screenSpaceOrigin =
-      data::tileVectorToPixelVector(mOrigin - cameraPosition);
-    for (auto& particle : *mpParticles)
-    {
-      const auto particlePosition =
-        screenSpaceOrigin + particle.offsetAtTime(mFramesElapsed);
-      renderer.drawPoint(particlePosition, mColor);
-    }
-  }
-
-
-  bool isExpired() const { return mFramesElapsed >= PARTICLE_SYSTEM_LIFE_TIME; }
-
-  std::unique_ptr<ParticlesList> mpParticles;
-  base::Vector mOrigin;
-  base::Color mColor;
-  int mFramesElapsed = 0;
-};
-
-
-ParticleSystem::ParticleSystem(
-  RandomNumberGenerator* pRandomGenerator,
-  Renderer* pRenderer)
+ParticleSystem::ParticleSystem(RandomNumberGenerator* pRandomGenerator)
   : mpRandomGenerator(pRandomGenerator)
-  , mpRenderer(pRenderer)
 {
 }
 
@@ -174,43 +101,109 @@ ParticleSystem::~ParticleSystem() = default;
 
 void ParticleSystem::synchronizeTo(const ParticleSystem& other)
 {
-  mParticleGroups = other.mParticleGroups;
+  mPool = other.mPool;
 }
 
 
 void ParticleSystem::spawnParticles(
   const base::Vector& origin,
   const base::Color& color,
-  int velocityScaleX)
+  const int velocityScaleX)
 {
-  auto pParticles = createParticles(*mpRandomGenerator, velocityScaleX);
-  mParticleGroups.emplace_back(
-    origin + SPAWN_OFFSET, color, std::move(pParticles));
+  // When the pool is full, the oldest group is replaced. We still need to
+  // generate all random numbers, in order to keep the random number
+  // generator's state consistent with the original game.
+  if (mPool.mNumGroups == MAX_PARTICLE_GROUPS)
+  {
+    mPool.mFirstGroup = groupIndexAt(mPool, 1);
+    --mPool.mNumGroups;
+  }
+
+  const auto index = groupIndexAt(mPool, mPool.mNumGroups);
+  ++mPool.mNumGroups;
+
+  auto& velocitiesX = mPool.mVelocitiesX[index];
+  auto& initialOffsetIndicesY = mPool.mInitialOffsetIndicesY[index];
+  for (auto i = 0; i < PARTICLES_PER_GROUP; ++i)
+  {
+    const auto randomVariation = mpRandomGenerator->gen() % 20;
+    velocitiesX[i] = static_cast<std::int16_t>(
+      velocityScaleX == 0 ? 10 - randomVariation
+                          : velocityScaleX * (randomVariation + 1));
+    initialOffsetIndicesY[i] = static_cast<std::int16_t>(
+      mpRandomGenerator->gen() % (INITIAL_INDEX_LIMIT + 1));
+  }
+
+  mPool.mOrigins[index] = origin + SPAWN_OFFSET;
+  mPool.mColors[index] = color;
+  mPool.mFramesElapsed[index] = 0;
 }
 
 
 void ParticleSystem::update()
 {
-  using namespace std;
-
-  const auto it = remove_if(
-    begin(mParticleGroups),
-    end(mParticleGroups),
-    mem_fn(&ParticleGroup::isExpired));
-  mParticleGroups.erase(it, end(mParticleGroups));
+  while (
+    mPool.mNumGroups > 0 &&
+    mPool.mFramesElapsed[mPool.mFirstGroup] >= PARTICLE_SYSTEM_LIFE_TIME)
+  {
+    mPool.mFirstGroup = groupIndexAt(mPool, 1);
+    --mPool.mNumGroups;
+  }
 
-  for (auto& group : mParticleGroups)
+  for (auto i = 0; i < mPool.mNumGroups; ++i)
   {
-    group.update();
+    ++mPool.mFramesElapsed[groupIndexAt(mPool, i)];
   }
 }
 
 
-void ParticleSystem::render(const base::Vector& cameraPosition)
+void ParticleSystem::collectVertices(
+  const base::Vector& cameraPosition,
+  std::vector<renderer::PointVertex>& vertices) const
 {
-  for (auto& group : mParticleGroups)
+  vertices.resize(mPool.mNumGroups * PARTICLES_PER_GROUP);
+
+  auto pVertices = vertices.data();
+  for (auto i = 0; i < mPool.mNumGroups; ++i)
   {
-    group.render(*mpRenderer, cameraPosition);
+    const auto index = groupIndexAt(mPool, i);
+    const auto framesElapsed = mPool.mFramesElapsed[index];
+    assert(framesElapsed < NUM_TRAJECTORY_STEPS);
+
+    const auto& velocitiesX = mPool.mVelocitiesX[index];
+    const auto& initialOffsetIndicesY = mPool.mInitialOffsetIndicesY[index];
+    const auto& yOffsets = Y_OFFSET_TABLE[framesElapsed];
+
+    const auto origin =
+      data::tileVectorToPixelVector(mPool.mOrigins[index] - cameraPosition);
+    const auto& color = mPool.mColors[index];
+    const auto r = color.r / 255.0f;
+    const auto g = color.g / 255.0f;
+    const auto b = color.b / 255.0f;
+    const auto a = color.a / 255.0f;
+
+    // Positions are computed in separate passes without any branches, which
+    // allows the compiler to vectorize the loops.
+    std::array<float, PARTICLES_PER_GROUP> positionsX;
+    std::array<float, PARTICLES_PER_GROUP> positionsY;
+
+    for (auto p = 0; p < PARTICLES_PER_GROUP; ++p)
+    {
+      positionsX[p] = float(origin.x + velocitiesX[p] * framesElapsed);
+    }
+
+    for (auto p = 0; p < PARTICLES_PER_GROUP; ++p)
+    {
+      positionsY[p] = float(origin.y + yOffsets[initialOffsetIndicesY[p]]);
+    }
+
+    for (auto p = 0; p < PARTICLES_PER_GROUP; ++p)
+    {
+      pVertices[p] =
+        renderer::PointVertex{positionsX[p], positionsY[p], r, g, b, a};
+    }
+
+    pVertices += PARTICLES_PER_GROUP;
   }
 }
 
@@ -18,29 +18,55 @@
 
 #include "base/color.hpp"
 #include "base/spatial_types.hpp"
+#include "renderer/renderer.hpp"
 
+#include <array>
+#include <cstdint>
 #include <vector>
 
-namespace rigel::renderer
-{
-class Renderer;
-}
-
 
 namespace rigel::engine
 {
 
 class RandomNumberGenerator;
 
-struct ParticleGroup;
+
+constexpr auto PARTICLES_PER_GROUP = 64;
+constexpr auto MAX_PARTICLE_GROUPS = 128;
+
+
+/** Fixed-capacity storage for all particle groups
+ *
+ * Data is stored as structure of arrays, so that computing the positions
+ * of all particles in a group can be done as a single tight loop.
+ *
+ * All groups have the same life time, so they always expire in the order in
+ * which they were spawned. This means we can use the pool as a ring buffer,
+ * with no need for per-group allocation or compaction.
+ */
+struct ParticlePool
+{
+  template <typename T>
+  using PerGroup = std::array<T, MAX_PARTICLE_GROUPS>;
+
+  template <typename T>
+  using PerParticle = std::array<T, PARTICLES_PER_GROUP>;
+
+  PerGroup<PerParticle<std::int16_t>> mVelocitiesX;
+  PerGroup<PerParticle<std::int16_t>> mInitialOffsetIndicesY;
+  PerGroup<base::Vector> mOrigins;
+  PerGroup<base::Color> mColors;
+  PerGroup<int> mFramesElapsed;
+
+  int mFirstGroup = 0;
+  int mNumGroups = 0;
+};
 
 
 class ParticleSystem
 {
 public:
-  ParticleSystem(
-    RandomNumberGenerator* pRandomGenerator,
-    renderer::Renderer* pRenderer);
+  explicit ParticleSystem(RandomNumberGenerator* pRandomGenerator);
   ~ParticleSystem();
 
   void synchronizeTo(const ParticleSystem& other);
@@ -51,12 +77,19 @@ public:
     int velocityScaleX = 0);
 
   void update();
-  void render(const base::Vector& cameraPosition);
+
+  /** Replaces contents of vertices with all particles' current positions
+   *
+   * Positions are relative to the given camera position, ready to be
+   * drawn via renderer::Renderer::drawPoints().
+   */
+  void collectVertices(
+    const base::Vector& cameraPosition,
+    std::vector<renderer::PointVertex>& vertices) const;
 
 private:
-  std::vector<ParticleGroup> mParticleGroups;
+  ParticlePool mPool;
   RandomNumberGenerator* mpRandomGenerator;
-  renderer::Renderer* mpRenderer;
 };
 
 } // namespace rigel::engine
@@ -17,6 +17,7 @@
 #pragma once
 
 #include "base/array_view.hpp"
+#include "base/event_queue.hpp"
 #include "base/spatial_types.hpp"
 #include "base/warnings.hpp"
 #include "engine/base_components.hpp"
@@ -124,6 +125,13 @@ struct CollidedWithWorld
 } // namespace events
 
 
+/** Holds the collisions of one physics update until they are handled
+ *
+ * The capacity covers all collisions happening during a typical frame.
+ */
+using CollisionEventQueue = base::EventQueue<events::CollidedWithWorld, 128>;
+
+
 components::BoundingBox toWorldSpace(
   const components::BoundingBox& bbox,
   const base::Vector& entityPosition);
@@ -104,9 +104,8 @@ void PhysicsSystem::update(ex::EntityManager& es)
 }
 
 
-void PhysicsSystem::updatePhase1(ex::EntityManager& es)
+void PhysicsSystem::startCollectingForPhase2()
 {
-  update(es);
   mShouldCollectForPhase2 = true;
 }
 
@@ -191,7 +190,8 @@ void PhysicsSystem::applyPhysics(
     const auto top = targetPosition.y != position.y && movementY < 0;
     const auto bottom = targetPosition.y != position.y && movementY > 0;
 
-    mpEvents->emit(events::CollidedWithWorld{entity, left, right, top, bottom});
+    mCollisionEvents.push(
+      events::CollidedWithWorld{entity, left, right, top, bottom});
   }
 
   if (body.mIgnoreCollisions)
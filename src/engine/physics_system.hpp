@@ -27,6 +27,7 @@ RIGEL_RESTORE_WARNINGS
 
 #include <cstdint>
 #include <tuple>
+#include <vector>
 
 
 namespace rigel::data::map
@@ -48,7 +49,14 @@ class CollisionChecker;
  * entities will also fall down until they hit solid ground.
  *
  * Entities that collided with the world on the last update() will be tagged
- * with the CollidedWithWorld component.
+ * with the CollidedWithWorld component. In addition, a CollidedWithWorld
+ * event is added to the queue returned by collisionEvents() for each of them,
+ * in the order in which the collisions happened. The system doesn't dispatch
+ * these events itself. Instead, the owner hands the queue to all interested
+ * parties after each update() and updatePhase2(), and then calls
+ * clearCollisionEvents(). Consumers are thus free to create or destroy
+ * entities without affecting the ongoing update, but must check that each
+ * event's entity is still valid.
  *
  * The collision detection is very simple and relies on knowing each entity's
  * previous position. Therefore, entities which are to collide against the
@@ -74,22 +82,29 @@ public:
    */
   void update(entityx::EntityManager& es);
 
-  /** Process currently existing entities
+  /** Start collecting entities for the 2nd phase
    *
-   * Processes physics for all entities with the required components which
-   * exist at the time of the call. Starts collecting entities
-   * for the 2nd phase.
+   * All entities which are assigned a MovingBody from now on will be
+   * processed by the next call to updatePhase2().
    */
-  void updatePhase1(entityx::EntityManager& es);
+  void startCollectingForPhase2();
 
   /** Process entities spawned after phase 1
    *
    * Processes physics for all entities that have been created or assigned
-   * the right components after the call to updatePhase1().
+   * the right components after the call to startCollectingForPhase2().
    * Stops collecting.
    */
   void updatePhase2(entityx::EntityManager& es);
 
+  /** Collisions of all updates since the last clearCollisionEvents() */
+  const CollisionEventQueue& collisionEvents() const
+  {
+    return mCollisionEvents;
+  }
+
+  void clearCollisionEvents() { mCollisionEvents.clear(); }
+
   void
     receive(const entityx::ComponentAddedEvent<components::MovingBody>& event);
   void receive(
@@ -105,6 +120,7 @@ private:
     applyGravity(const components::BoundingBox& bbox, float currentVelocity);
 
 private:
+  CollisionEventQueue mCollisionEvents;
   std::vector<entityx::Entity> mPhysicsObjectsForPhase2;
   const CollisionChecker* mpCollisionChecker;
   const data::map::Map* mpMap;
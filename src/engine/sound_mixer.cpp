@@ -0,0 +1,317 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "sound_mixer.hpp"
+
+#include "base/clock.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+  #include <emmintrin.h>
+  #define RIGEL_MIXER_USE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  #include <arm_neon.h>
+  #define RIGEL_MIXER_USE_NEON
+#endif
+
+
+namespace rigel::engine
+{
+
+namespace
+{
+
+// Volume is a fixed-point factor with 7 fractional bits, same as
+// SDL_mixer's MIX_MAX_VOLUME
+constexpr auto VOLUME_SHIFT = 7;
+constexpr auto MAX_VOLUME = std::int16_t{1 << VOLUME_SHIFT};
+
+
+std::int16_t scaleAndAdd(
+  const std::int16_t existing,
+  const std::int16_t sample,
+  const std::int16_t volume)
+{
+  const auto scaled = (sample * volume) >> VOLUME_SHIFT;
+  return static_cast<std::int16_t>(
+    std::clamp(existing + scaled, -32768, 32767));
+}
+
+
+/** Scale source by volume, and add it to destination with saturation
+ *
+ * The vectorized versions give exactly the same results as the scalar
+ * fallback.
+ */
+void mixScaled(
+  std::int16_t* pDestination,
+  const std::int16_t* pSource,
+  const std::size_t count,
+  const std::int16_t volume)
+{
+  auto i = std::size_t{0};
+
+#if defined(RIGEL_MIXER_USE_SSE2)
+  const auto volumes = _mm_set1_epi16(volume);
+  for (; i + 8 <= count; i += 8)
+  {
+    const auto source =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + i));
+    const auto destination =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(pDestination + i));
+
+    // Full 32-bit products, assembled from their low and high halves
+    const auto productsLow = _mm_mullo_epi16(source, volumes);
+    const auto productsHigh = _mm_mulhi_epi16(source, volumes);
+    const auto products0 = _mm_srai_epi32(
+      _mm_unpacklo_epi16(productsLow, productsHigh), VOLUME_SHIFT);
+    const auto products1 = _mm_srai_epi32(
+      _mm_unpackhi_epi16(productsLow, productsHigh), VOLUME_SHIFT);
+
+    const auto scaled = _mm_packs_epi32(products0, products1);
+    _mm_storeu_si128(
+      reinterpret_cast<__m128i*>(pDestination + i),
+      _mm_adds_epi16(destination, scaled));
+  }
+#elif defined(RIGEL_MIXER_USE_NEON)
+  const auto volumes = vdup_n_s16(volume);
+  for (; i + 8 <= count; i += 8)
+  {
+    const auto source = vld1q_s16(pSource + i);
+    const auto destination = vld1q_s16(pDestination + i);
+
+    const auto products0 =
+      vshrq_n_s32(vmull_s16(vget_low_s16(source), volumes), VOLUME_SHIFT);
+    const auto products1 =
+      vshrq_n_s32(vmull_s16(vget_high_s16(source), volumes), VOLUME_SHIFT);
+
+    const auto scaled =
+      vcombine_s16(vqmovn_s32(products0), vqmovn_s32(products1));
+    vst1q_s16(pDestination + i, vqaddq_s16(destination, scaled));
+  }
+#endif
+
+  for (; i < count; ++i)
+  {
+    pDestination[i] = scaleAndAdd(pDestination[i], pSource[i], volume);
+  }
+}
+
+
+std::int16_t toFixedPointVolume(const float volume)
+{
+  return static_cast<std::int16_t>(
+    std::lround(std::clamp(volume, 0.0f, 1.0f) * MAX_VOLUME));
+}
+
+} // namespace
+
+
+SoundMixer::SoundMixer(const std::size_t maxVoices)
+  : mVoices(maxVoices)
+  , mVolume(MAX_VOLUME)
+{
+  assert(maxVoices > 0);
+}
+
+
+void SoundMixer::setSoundData(
+  const data::SoundId id,
+  const std::int16_t* pSamples,
+  const std::size_t numSamples)
+{
+  mSounds[static_cast<int>(id)] = SoundData{pSamples, numSamples};
+}
+
+
+void SoundMixer::reset()
+{
+  while (const auto command = mCommands.pop())
+  {
+    if (command->mType == CommandType::SetVolume)
+    {
+      applyCommand(*command);
+    }
+  }
+
+  std::fill(mVoices.begin(), mVoices.end(), Voice{});
+  mActiveVoices = 0;
+}
+
+
+void SoundMixer::play(const data::SoundId id)
+{
+  postCommand(
+    Command{CommandType::Play, static_cast<std::uint8_t>(id), 0});
+}
+
+
+void SoundMixer::stop(const data::SoundId id)
+{
+  postCommand(
+    Command{CommandType::Stop, static_cast<std::uint8_t>(id), 0});
+}
+
+
+void SoundMixer::stopAll()
+{
+  postCommand(Command{CommandType::StopAll, 0, 0});
+}
+
+
+void SoundMixer::setVolume(const float volume)
+{
+  postCommand(
+    Command{CommandType::SetVolume, 0, toFixedPointVolume(volume)});
+}
+
+
+void SoundMixer::mix(std::int16_t* pBuffer, const std::size_t numSamples)
+{
+  const auto startTime = base::Clock::now();
+
+  while (const auto command = mCommands.pop())
+  {
+    applyCommand(*command);
+  }
+
+  auto activeVoices = 0;
+  for (auto& voice : mVoices)
+  {
+    if (voice.mSoundIndex < 0)
+    {
+      continue;
+    }
+
+    const auto& sound = mSounds[voice.mSoundIndex];
+    const auto count =
+      std::min(numSamples, sound.mNumSamples - voice.mPosition);
+    mixScaled(pBuffer, sound.mpSamples + voice.mPosition, count, mVolume);
+
+    voice.mPosition += count;
+    if (voice.mPosition >= sound.mNumSamples)
+    {
+      voice = Voice{};
+    }
+    else
+    {
+      ++activeVoices;
+    }
+  }
+
+  const auto elapsed = static_cast<std::uint32_t>(
+    std::chrono::duration_cast<std::chrono::microseconds>(
+      base::Clock::now() - startTime)
+      .count());
+
+  mLastCallbackMicroseconds.store(elapsed, std::memory_order_relaxed);
+  if (elapsed > mPeakCallbackMicroseconds.load(std::memory_order_relaxed))
+  {
+    mPeakCallbackMicroseconds.store(elapsed, std::memory_order_relaxed);
+  }
+  mActiveVoices.store(activeVoices, std::memory_order_relaxed);
+}
+
+
+SoundMixerStats SoundMixer::stats() const
+{
+  return SoundMixerStats{
+    mLastCallbackMicroseconds.load(std::memory_order_relaxed),
+    mPeakCallbackMicroseconds.load(std::memory_order_relaxed),
+    mActiveVoices.load(std::memory_order_relaxed),
+    mDroppedCommands};
+}
+
+
+void SoundMixer::postCommand(const Command& command)
+{
+  if (!mCommands.push(command))
+  {
+    // Can only happen if the audio callback stalls for a long time.
+    // Losing a few sound triggers is preferable to blocking the game.
+    ++mDroppedCommands;
+  }
+}
+
+
+void SoundMixer::applyCommand(const Command& command)
+{
+  switch (command.mType)
+  {
+    case CommandType::Play:
+      startVoice(command.mSoundIndex);
+      break;
+
+    case CommandType::Stop:
+      for (auto& voice : mVoices)
+      {
+        if (voice.mSoundIndex == command.mSoundIndex)
+        {
+          voice = Voice{};
+        }
+      }
+      break;
+
+    case CommandType::StopAll:
+      std::fill(mVoices.begin(), mVoices.end(), Voice{});
+      break;
+
+    case CommandType::SetVolume:
+      mVolume = command.mVolume;
+      break;
+  }
+}
+
+
+void SoundMixer::startVoice(const int soundIndex)
+{
+  if (mSounds[soundIndex].mNumSamples == 0)
+  {
+    return;
+  }
+
+  // Restart if already playing
+  auto iVoice = std::find_if(
+    mVoices.begin(), mVoices.end(), [soundIndex](const Voice& voice) {
+      return voice.mSoundIndex == soundIndex;
+    });
+
+  if (iVoice == mVoices.end())
+  {
+    iVoice = std::find_if(
+      mVoices.begin(), mVoices.end(), [](const Voice& voice) {
+        return voice.mSoundIndex < 0;
+      });
+  }
+
+  if (iVoice == mVoices.end())
+  {
+    // All voices busy, take over the one that's been playing the longest
+    iVoice = std::max_element(
+      mVoices.begin(), mVoices.end(), [](const Voice& lhs, const Voice& rhs) {
+        return lhs.mPosition < rhs.mPosition;
+      });
+  }
+
+  *iVoice = Voice{soundIndex, 0};
+}
+
+} // namespace rigel::engine
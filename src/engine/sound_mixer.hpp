@@ -0,0 +1,143 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "base/spsc_queue.hpp"
+#include "data/sound_ids.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace rigel::engine
+{
+
+struct SoundMixerStats
+{
+  /** Time spent mixing during the most recent audio callback */
+  std::uint32_t mLastCallbackMicroseconds = 0;
+
+  /** Longest time spent in a single callback so far */
+  std::uint32_t mPeakCallbackMicroseconds = 0;
+
+  int mActiveVoices = 0;
+  std::size_t mDroppedCommands = 0;
+};
+
+
+/** Mixes sound effects into an audio stream
+ *
+ * Sound data is in the output device's format, which must be signed 16-bit
+ * native endian. Multi-channel data is interleaved, exactly like the output
+ * buffer.
+ *
+ * play(), stop(), stopAll() and setVolume() are meant to be called from
+ * the game thread, and mix() from the audio callback. The former only post
+ * commands to a lock-free queue, which mix() then applies before producing
+ * its output. Neither side ever waits for the other.
+ *
+ * Like with the original game, each sound ID plays at most once at a time.
+ * Playing a sound that's already playing restarts it. When all voices are
+ * in use, the voice which has been playing the longest is taken over.
+ */
+class SoundMixer
+{
+public:
+  explicit SoundMixer(std::size_t maxVoices);
+
+  /** Set the data to play for given sound ID
+   *
+   * The data must remain valid until replaced, or until the mixer is
+   * destroyed. Must only be called while mix() can't run concurrently, i.e.
+   * the audio callback is not installed.
+   */
+  void setSoundData(
+    data::SoundId id,
+    const std::int16_t* pSamples,
+    std::size_t numSamples);
+
+  /** Immediately silence all voices, and discard pending commands
+   *
+   * Same restrictions as for setSoundData() apply.
+   */
+  void reset();
+
+  void play(data::SoundId id);
+  void stop(data::SoundId id);
+  void stopAll();
+  void setVolume(float volume);
+
+  /** Add all active voices to the given buffer
+   *
+   * numSamples counts individual 16-bit samples, not frames.
+   */
+  void mix(std::int16_t* pBuffer, std::size_t numSamples);
+
+  SoundMixerStats stats() const;
+
+private:
+  enum class CommandType : std::uint8_t
+  {
+    Play,
+    Stop,
+    StopAll,
+    SetVolume
+  };
+
+  struct Command
+  {
+    CommandType mType = CommandType::StopAll;
+    std::uint8_t mSoundIndex = 0;
+    std::int16_t mVolume = 0;
+  };
+
+  struct SoundData
+  {
+    const std::int16_t* mpSamples = nullptr;
+    std::size_t mNumSamples = 0;
+  };
+
+  struct Voice
+  {
+    int mSoundIndex = -1;
+    std::size_t mPosition = 0;
+  };
+
+  static constexpr auto COMMAND_QUEUE_SIZE = std::size_t{256};
+
+  void postCommand(const Command& command);
+  void applyCommand(const Command& command);
+  void startVoice(int soundIndex);
+
+  base::SpscQueue<Command, COMMAND_QUEUE_SIZE> mCommands;
+  std::size_t mDroppedCommands = 0;
+
+  // Only accessed from mix(), apart from setSoundData() and reset()
+  std::array<SoundData, data::NUM_SOUND_IDS> mSounds;
+  std::vector<Voice> mVoices;
+  std::int16_t mVolume;
+
+  std::atomic<std::uint32_t> mLastCallbackMicroseconds{0};
+  std::atomic<std::uint32_t> mPeakCallbackMicroseconds{0};
+  std::atomic<int> mActiveVoices{0};
+};
+
+} // namespace rigel::engine
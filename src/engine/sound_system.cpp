@@ -18,6 +18,7 @@
 
 #include "base/math_tools.hpp"
 #include "base/string_utils.hpp"
+#include "common/memory_accounting.hpp"
 #include "engine/imf_player.hpp"
 #include "loader/resource_loader.hpp"
 #include "sdl_utils/error.hpp"
@@ -28,6 +29,7 @@
 #include <cassert>
 #include <cstring>
 #include <iostream>
+#include <optional>
 #include <utility>
 
 
@@ -234,8 +236,6 @@ struct SoundSystem::MusicConversionWrapper
 
 SoundSystem::LoadedSound::LoadedSound(RawBuffer buffer)
   : mData(std::move(buffer))
-  , mpMixChunk(sdl_utils::wrap(
-      Mix_QuickLoad_RAW(mData.data(), static_cast<Uint32>(mData.size()))))
 {
 }
 
@@ -246,9 +246,29 @@ SoundSystem::LoadedSound::LoadedSound(sdl_utils::Ptr<Mix_Chunk> pMixChunk)
 }
 
 
+const std::int16_t* SoundSystem::LoadedSound::samples() const
+{
+  const auto pBytes = mpMixChunk ? mpMixChunk->abuf : mData.data();
+  return reinterpret_cast<const std::int16_t*>(pBytes);
+}
+
+
+std::size_t SoundSystem::LoadedSound::numSamples() const
+{
+  return sizeInBytes() / sizeof(std::int16_t);
+}
+
+
+std::size_t SoundSystem::LoadedSound::sizeInBytes() const
+{
+  return mpMixChunk ? mpMixChunk->alen : mData.size();
+}
+
+
 SoundSystem::SoundSystem(
   const loader::ResourceLoader* pResources,
-  data::SoundStyle soundStyle)
+  data::SoundStyle soundStyle,
+  const std::size_t maxSoundVoices)
   : mCloseMixerGuard(std::invoke([]() {
     sdl_mixer::check(Mix_OpenAudio(
       DESIRED_SAMPLE_RATE,
@@ -258,6 +278,7 @@ SoundSystem::SoundSystem(
 
     return &Mix_Quit;
   }))
+  , mSoundMixer(maxSoundVoices)
   , mpResources(pResources)
   , mCurrentSoundStyle(soundStyle)
 {
@@ -268,6 +289,11 @@ SoundSystem::SoundSystem(
   int numChannels = 0;
   Mix_QuerySpec(&sampleRate, &audioFormat, &numChannels);
 
+  if (audioFormat != AUDIO_S16SYS)
+  {
+    throw std::runtime_error{"Audio device doesn't support 16-bit output"};
+  }
+
   // Our music is in a format which SDL_mixer does not understand (IMF format
   // aka raw AdLib commands). Therefore, we cannot use any of the high-level
   // music playback functionality offered by the library. Instead, we register
@@ -282,20 +308,17 @@ SoundSystem::SoundSystem(
   mpMusicConversionWrapper = std::make_unique<MusicConversionWrapper>(
     mpMusicPlayer.get(), audioFormat, sampleRate, numChannels);
 
-  // For sound playback, we want to be able to play as many sound effects in
-  // parallel as possible. In the original game, the number of available sound
-  // effects is hardcoded into the executable, with sounds being identified by
-  // a numerical index (sound ID). This allows us to implement a very simple
-  // scheme: We allocate as many mixer channels as there are sound effects. We
-  // then create one playable audio buffer (aka Mix_Chunk) for each sound
-  // effect, and use its sound ID to determine which mixer channel it should be
-  // played on. This way, all possible sound effects can play simultaneously,
-  // but when the same sound effect is triggered multiple times in a row, it
-  // results in the sound being cut off and played again from the beginning as
-  // in the original game.
-  Mix_AllocateChannels(data::NUM_SOUND_IDS);
+  // Sound effects don't use SDL_mixer's channels. Going through those would
+  // mean taking the audio device lock from the game thread for every sound
+  // that's triggered. Instead, our own SoundMixer adds sound effects to the
+  // output in SDL_mixer's post-mix step. In the original game, sounds are
+  // identified by a numerical index (sound ID), and triggering a sound that's
+  // already playing cuts it off and restarts it from the beginning. The
+  // SoundMixer replicates this behavior.
+  Mix_AllocateChannels(0);
 
   loadAllSounds(sampleRate, audioFormat, numChannels, soundStyle);
+  updateSoundMixerData();
 
   setMusicVolume(data::MUSIC_VOLUME_DEFAULT);
   setSoundVolume(data::SOUND_VOLUME_DEFAULT);
@@ -304,11 +327,14 @@ SoundSystem::SoundSystem(
   // We would otherwise end up with a hook that points to a destroyed
   // SoundSystem instance, and crash.
   hookMusic();
+  hookSoundMixer();
 }
 
 
 SoundSystem::~SoundSystem()
 {
+  unhookSoundMixer();
+
   if (mpCurrentReplacementSong)
   {
     mpCurrentReplacementSong.reset();
@@ -327,13 +353,15 @@ void SoundSystem::reloadAllSounds(const data::SoundStyle soundStyle)
     return;
   }
 
-  stopAllSounds();
-
   int sampleRate = 0;
   std::uint16_t audioFormat = 0;
   int numChannels = 0;
   Mix_QuerySpec(&sampleRate, &audioFormat, &numChannels);
 
+  // The mixer might still be playing the current sounds, so we can only
+  // replace them while it's not running. Prepare the new data up front to
+  // keep that time short.
+  std::array<std::optional<LoadedSound>, data::NUM_SOUND_IDS> newSounds;
   data::forEachSoundId([&](const auto id) {
     const auto index = idToIndex(id);
     if (
@@ -344,11 +372,23 @@ void SoundSystem::reloadAllSounds(const data::SoundStyle soundStyle)
     }
 
     const auto soundData = loadSoundForStyle(id, soundStyle, sampleRate);
-    mSounds[index] =
+    newSounds[index] =
       LoadedSound{convertBuffer(soundData, audioFormat, numChannels)};
   });
 
-  applySoundVolume(mCurrentSoundVolume);
+  unhookSoundMixer();
+  mSoundMixer.reset();
+
+  for (auto i = 0u; i < newSounds.size(); ++i)
+  {
+    if (newSounds[i])
+    {
+      mSounds[i] = std::move(*newSounds[i]);
+    }
+  }
+
+  updateSoundMixerData();
+  hookSoundMixer();
 
   mCurrentSoundStyle = soundStyle;
 }
@@ -389,21 +429,19 @@ void SoundSystem::stopMusic() const
 
 void SoundSystem::playSound(const data::SoundId id) const
 {
-  const auto index = idToIndex(id);
-  Mix_PlayChannel(index, mSounds[index].mpMixChunk.get(), 0);
+  mSoundMixer.play(id);
 }
 
 
 void SoundSystem::stopSound(const data::SoundId id) const
 {
-  const auto index = idToIndex(id);
-  Mix_HaltChannel(index);
+  mSoundMixer.stop(id);
 }
 
 
 void SoundSystem::stopAllSounds() const
 {
-  data::forEachSoundId([&](const auto id) { stopSound(id); });
+  mSoundMixer.stopAll();
 }
 
 
@@ -419,8 +457,30 @@ void SoundSystem::setMusicVolume(const float volume)
 
 void SoundSystem::setSoundVolume(const float volume)
 {
-  applySoundVolume(volume);
-  mCurrentSoundVolume = volume;
+  mSoundMixer.setVolume(volume);
+}
+
+
+SoundMixerStats SoundSystem::soundMixerStats() const
+{
+  return mSoundMixer.stats();
+}
+
+
+void SoundSystem::reportMemoryUsage(MemoryReport& report) const
+{
+  std::size_t totalBytes = 0;
+  std::size_t numLoaded = 0;
+  for (const auto& sound : mSounds)
+  {
+    if (const auto size = sound.sizeInBytes())
+    {
+      totalBytes += size;
+      ++numLoaded;
+    }
+  }
+
+  report.add("Audio", "Sound effect PCM buffers", totalBytes, numLoaded);
 }
 
 
@@ -489,21 +549,6 @@ data::AudioBuffer SoundSystem::loadSoundForStyle(
 }
 
 
-void SoundSystem::applySoundVolume(const float volume)
-{
-  const auto sdlVolume =
-    static_cast<int>(std::clamp(volume, 0.0f, 1.0f) * MIX_MAX_VOLUME);
-
-  for (auto& sound : mSounds)
-  {
-    if (sound.mpMixChunk)
-    {
-      Mix_VolumeChunk(sound.mpMixChunk.get(), sdlVolume);
-    }
-  }
-}
-
-
 void SoundSystem::hookMusic() const
 {
   Mix_HookMusic(
@@ -521,6 +566,37 @@ void SoundSystem::unhookMusic() const
 }
 
 
+void SoundSystem::hookSoundMixer()
+{
+  Mix_SetPostMix(
+    [](void* pUserData, Uint8* pStream, int numBytes) {
+      auto pMixer = static_cast<SoundMixer*>(pUserData);
+      pMixer->mix(
+        reinterpret_cast<std::int16_t*>(pStream),
+        static_cast<std::size_t>(numBytes) / sizeof(std::int16_t));
+    },
+    &mSoundMixer);
+}
+
+
+void SoundSystem::unhookSoundMixer()
+{
+  // SDL_mixer holds the audio device lock while changing the post-mix
+  // callback. Once this returns, the mixer is guaranteed to not be running
+  // anymore.
+  Mix_SetPostMix(nullptr, nullptr);
+}
+
+
+void SoundSystem::updateSoundMixerData()
+{
+  data::forEachSoundId([&](const auto id) {
+    const auto& sound = mSounds[idToIndex(id)];
+    mSoundMixer.setSoundData(id, sound.samples(), sound.numSamples());
+  });
+}
+
+
 sdl_utils::Ptr<Mix_Music>
   SoundSystem::loadReplacementSong(const std::string& name)
 {
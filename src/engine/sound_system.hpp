@@ -21,14 +21,22 @@
 #include "data/game_options.hpp"
 #include "data/song.hpp"
 #include "data/sound_ids.hpp"
+#include "engine/sound_mixer.hpp"
 #include "sdl_utils/ptr.hpp"
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <unordered_map>
 
 
+namespace rigel
+{
+class MemoryReport;
+}
+
 namespace rigel::loader
 {
 class ResourceLoader;
@@ -44,19 +52,31 @@ class ImfPlayer;
 using RawBuffer = std::vector<std::uint8_t>;
 
 
+/** Default for the maximum number of simultaneously playing sound effects
+ *
+ * This is enough to play all sound effects at once.
+ */
+constexpr auto DEFAULT_MAX_SOUND_VOICES = std::size_t{data::NUM_SOUND_IDS};
+
+
 /** Provides sound and music playback functionality
  *
  * This class implements sound and music playback. When constructed, it opens
  * an audio device and loads all sound effects from the game's data files. From
  * that point on, sound effects and music playback can be triggered at any time
  * using the class' interface. Sound and music volume can also be adjusted.
+ *
+ * Sound effects are mixed by our own SoundMixer, which runs as SDL_mixer's
+ * post-mix effect. Triggering or stopping sounds thus never has to wait
+ * for the audio thread.
  */
 class SoundSystem
 {
 public:
   explicit SoundSystem(
     const loader::ResourceLoader* pResources,
-    data::SoundStyle soundStyle);
+    data::SoundStyle soundStyle,
+    std::size_t maxSoundVoices = DEFAULT_MAX_SOUND_VOICES);
   ~SoundSystem();
 
   void reloadAllSounds(data::SoundStyle soundStyle);
@@ -88,6 +108,10 @@ public:
   void setMusicVolume(float volume);
   void setSoundVolume(float volume);
 
+  SoundMixerStats soundMixerStats() const;
+
+  void reportMemoryUsage(MemoryReport& report) const;
+
 private:
   void loadAllSounds(
     int sampleRate,
@@ -98,9 +122,11 @@ private:
     data::SoundId id,
     data::SoundStyle soundStyle,
     int sampleRate) const;
-  void applySoundVolume(float volume);
   void hookMusic() const;
   void unhookMusic() const;
+  void hookSoundMixer();
+  void unhookSoundMixer();
+  void updateSoundMixerData();
   sdl_utils::Ptr<Mix_Music> loadReplacementSong(const std::string& name);
 
   struct MusicConversionWrapper;
@@ -111,19 +137,23 @@ private:
     explicit LoadedSound(RawBuffer buffer);
     explicit LoadedSound(sdl_utils::Ptr<Mix_Chunk> pMixChunk);
 
+    const std::int16_t* samples() const;
+    std::size_t numSamples() const;
+    std::size_t sizeInBytes() const;
+
     RawBuffer mData;
     sdl_utils::Ptr<Mix_Chunk> mpMixChunk;
   };
 
   base::ScopeGuard mCloseMixerGuard;
   std::array<LoadedSound, data::NUM_SOUND_IDS> mSounds;
+  mutable SoundMixer mSoundMixer;
   std::unique_ptr<ImfPlayer> mpMusicPlayer;
   std::unique_ptr<MusicConversionWrapper> mpMusicConversionWrapper;
   mutable sdl_utils::Ptr<Mix_Music> mpCurrentReplacementSong;
   mutable std::unordered_map<std::string, std::string>
     mReplacementSongFileCache;
   const loader::ResourceLoader* mpResources;
-  float mCurrentSoundVolume;
   data::SoundStyle mCurrentSoundStyle;
 };
 
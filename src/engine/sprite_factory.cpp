@@ -16,11 +16,15 @@
 
 #include "sprite_factory.hpp"
 
-#include "base/container_utils.hpp"
+#include "common/memory_accounting.hpp"
 #include "data/unit_conversions.hpp"
 #include "loader/actor_image_package.hpp"
+#include "loader/palette.hpp"
 
+#include <algorithm>
 #include <array>
+#include <cassert>
+#include <variant>
 
 
 namespace rigel::engine
@@ -825,96 +829,209 @@ bool hasAssociatedSprite(const ActorID actorID)
 SpriteFactory::SpriteFactory(
   renderer::Renderer* pRenderer,
   const loader::ActorImagePackage* pSpritePackage)
-  : SpriteFactory(construct(pRenderer, pSpritePackage))
+  : mpSpritePackage(pSpritePackage)
+  , mPalette(pRenderer, loader::INGAME_PALETTE)
+  , mSpritesTextureAtlas(pRenderer)
+  , mIsHeadless(pRenderer->isHeadless())
 {
+  auto nextImageId = 0;
+
+  for (const auto mainId : INGAME_SPRITE_ACTOR_IDS)
+  {
+    engine::SpriteDrawData drawData;
+
+    const auto firstImageId = nextImageId;
+    int lastDrawOrder = 0;
+    int lastFrameCount = 0;
+    std::vector<int> framesToRender;
+
+    for (const auto partId : actorIDListForActor(mainId))
+    {
+      const auto actorInfo = pSpritePackage->loadActorInfo(partId);
+      lastDrawOrder = actorInfo.mDrawIndex;
+
+      for (const auto& frameInfo : actorInfo.mFrames)
+      {
+        drawData.mFrames.emplace_back(engine::SpriteFrame{
+          nextImageId, frameInfo.mDrawOffset, frameInfo.mLogicalSize});
+        ++nextImageId;
+      }
+
+      framesToRender.push_back(lastFrameCount);
+      lastFrameCount = int(actorInfo.mFrames.size());
+    }
+
+    drawData.mOrientationOffset = orientationOffsetForActor(mainId);
+    drawData.mVirtualToRealFrameMap = frameMapForActor(mainId);
+    drawData.mDrawOrder = adjustedDrawOrder(mainId, lastDrawOrder);
+
+    applyTweaks(drawData.mFrames, mainId);
+
+    mSpriteDataMap.emplace(
+      mainId,
+      SpriteData{
+        std::move(drawData),
+        std::move(framesToRender),
+        firstImageId,
+        nextImageId - firstImageId});
+  }
 }
 
 
-SpriteFactory::SpriteFactory(CtorArgs args)
-  : mSpriteDataMap(std::move(std::get<0>(args)))
-  , mSpritesTextureAtlas(std::move(std::get<1>(args)))
-  , mHasHighResReplacements(std::get<2>(args))
+void SpriteFactory::prepareForLevel(const std::vector<ActorID>& actorIds)
 {
+  if (mIsHeadless)
+  {
+    return;
+  }
+
+  auto levelActorIds = actorIds;
+  std::sort(levelActorIds.begin(), levelActorIds.end());
+  levelActorIds.erase(
+    std::unique(levelActorIds.begin(), levelActorIds.end()),
+    levelActorIds.end());
+
+  if (levelActorIds != mLevelActorIds)
+  {
+    {
+      const auto lock = std::lock_guard{mResidencyMutex};
+      mResidentActors.clear();
+    }
+
+    mSpritesTextureAtlas.clear();
+    mHasHighResReplacements = false;
+    mLevelActorIds = std::move(levelActorIds);
+
+    for (const auto id : mLevelActorIds)
+    {
+      if (mSpriteDataMap.count(id))
+      {
+        requestImages(id);
+      }
+    }
+  }
+
+  loadRequestedSprites();
 }
 
 
-auto SpriteFactory::construct(
-  renderer::Renderer* pRenderer,
-  const loader::ActorImagePackage* pSpritePackage) -> CtorArgs
+void SpriteFactory::loadRequestedSprites()
 {
-  bool highResReplacementsFound = false;
+  if (mIsHeadless)
+  {
+    return;
+  }
 
-  std::unordered_map<data::ActorID, SpriteData> spriteDataMap;
+  std::vector<ActorID> requestedIds;
 
-  std::vector<data::Image> spriteImages;
-  spriteImages.reserve(INGAME_SPRITE_ACTOR_IDS.size());
+  {
+    // Marking the actors as resident right away makes sure that they aren't
+    // requested again while loading.
+    const auto lock = std::lock_guard{mResidencyMutex};
+    std::swap(requestedIds, mRequestedActors);
+    mResidentActors.insert(requestedIds.begin(), requestedIds.end());
+  }
 
-  for (const auto mainId : INGAME_SPRITE_ACTOR_IDS)
+  if (!requestedIds.empty())
   {
-    engine::SpriteDrawData drawData;
+    loadImages(requestedIds);
+  }
+}
 
-    int lastDrawOrder = 0;
-    int lastFrameCount = 0;
-    std::vector<int> framesToRender;
 
-    const auto actorPartIds = actorIDListForActor(mainId);
+void SpriteFactory::reportMemoryUsage(MemoryReport& report) const
+{
+  const auto numResidentActors = [this]() {
+    const auto lock = std::lock_guard{mResidencyMutex};
+    return mResidentActors.size();
+  }();
+
+  report.add(
+    "Sprites",
+    "Atlas textures",
+    mSpritesTextureAtlas.textureMemorySize(),
+    mSpritesTextureAtlas.numTextures());
+  report.add("Sprites", "Resident actors", 0, numResidentActors);
+  report.add("Sprites", "Known actors", 0, mSpriteDataMap.size());
+}
+
+
+void SpriteFactory::requestImages(const ActorID id)
+{
+  const auto lock = std::lock_guard{mResidencyMutex};
+
+  if (
+    !mResidentActors.count(id) &&
+    std::find(mRequestedActors.begin(), mRequestedActors.end(), id) ==
+      mRequestedActors.end())
+  {
+    mRequestedActors.push_back(id);
+  }
+}
 
-    // non-const so we can move the Image objects into the vector
-    auto actorParts =
-      utils::transformed(actorPartIds, [&](const ActorID partId) {
-        return pSpritePackage->loadActor(partId);
-      });
 
-    // Similarly, non-const for move semantics
-    for (auto& actorData : actorParts)
+void SpriteFactory::loadImages(const std::vector<ActorID>& ids)
+{
+  // Frames replaced by PNG files are true color, all others are indexed.
+  // Each kind gets packed into atlas textures of its own.
+  std::vector<int> imageIds;
+  std::vector<data::Image> images;
+  std::vector<int> indexedImageIds;
+  std::vector<data::IndexedImage> indexedImages;
+
+  for (const auto id : ids)
+  {
+    const auto& data = mSpriteDataMap.at(id);
+    auto imageId = data.mFirstImageId;
+
+    for (const auto partId : actorIDListForActor(id))
     {
-      lastDrawOrder = actorData.mDrawIndex;
+      // non-const so we can move the Image objects into the vector
+      auto actorData = mpSpritePackage->loadActor(partId);
 
-      // Similarly, non-const for move semantics
       for (auto& frameData : actorData.mFrames)
       {
         auto& image = frameData.mFrameImage;
-        drawData.mFrames.emplace_back(engine::SpriteFrame{
-          int(spriteImages.size()),
-          frameData.mDrawOffset,
-          frameData.mLogicalSize});
-
         if (
           data::tilesToPixels(frameData.mLogicalSize.width) <
-            int(image.width()) ||
+            int(data::imageWidth(image)) ||
           data::tilesToPixels(frameData.mLogicalSize.height) <
-            int(image.height()))
+            int(data::imageHeight(image)))
         {
-          highResReplacementsFound = true;
+          mHasHighResReplacements = true;
         }
 
-        spriteImages.emplace_back(std::move(image));
-      }
+        if (auto pIndexed = std::get_if<data::IndexedImage>(&image))
+        {
+          indexedImageIds.push_back(imageId);
+          indexedImages.emplace_back(std::move(*pIndexed));
+        }
+        else
+        {
+          imageIds.push_back(imageId);
+          images.emplace_back(std::move(std::get<data::Image>(image)));
+        }
 
-      framesToRender.push_back(lastFrameCount);
-      lastFrameCount = int(actorData.mFrames.size());
+        ++imageId;
+      }
     }
 
-    drawData.mOrientationOffset = orientationOffsetForActor(mainId);
-    drawData.mVirtualToRealFrameMap = frameMapForActor(mainId);
-    drawData.mDrawOrder = adjustedDrawOrder(mainId, lastDrawOrder);
-
-    applyTweaks(drawData.mFrames, mainId);
-
-    spriteDataMap.emplace(
-      mainId, SpriteData{std::move(drawData), std::move(framesToRender)});
+    assert(imageId == data.mFirstImageId + data.mNumImages);
   }
 
-  return {
-    std::move(spriteDataMap),
-    renderer::TextureAtlas{pRenderer, spriteImages},
-    highResReplacementsFound};
+  mSpritesTextureAtlas.addImages(imageIds, images);
+  mSpritesTextureAtlas.addImages(indexedImageIds, indexedImages, mPalette);
 }
 
 
 Sprite SpriteFactory::createSprite(const ActorID id)
 {
   const auto& data = mSpriteDataMap.at(id);
+  if (!mIsHeadless)
+  {
+    requestImages(id);
+  }
+
   auto sprite = Sprite{&data.mDrawData, data.mInitialFramesToRender};
   configureSprite(sprite, id);
   return sprite;
@@ -20,10 +20,17 @@
 #include "engine/isprite_factory.hpp"
 #include "renderer/texture_atlas.hpp"
 
+#include <cstddef>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 
+namespace rigel
+{
+class MemoryReport;
+}
 namespace rigel::loader
 {
 class ActorImagePackage;
@@ -49,6 +56,23 @@ constexpr auto EFFECT_DRAW_ORDER = MUZZLE_FLASH_DRAW_ORDER + 1;
 
 bool hasAssociatedSprite(data::ActorID actorID);
 
+/** Creates sprites for actors, and owns the texture atlas holding them
+ *
+ * Frame layouts for all actors are known right from construction, but
+ * images are only loaded into the atlas on demand. prepareForLevel() loads
+ * everything a level is expected to need, and evicts everything else.
+ * Creating a sprite for an actor which isn't in the atlas yet requests it
+ * to be loaded by the next call to loadRequestedSprites(). This is the
+ * fallback for actors that are spawned unexpectedly, which comes at the cost
+ * of a small hitch.
+ *
+ * createSprite() and actorFrameRect() can be used from any thread, all other
+ * functions must be called on the thread owning the renderer.
+ *
+ * With a headless renderer, no images are loaded at all. The factory is then
+ * read-only after construction, and can be shared by game worlds running on
+ * different threads.
+ */
 class SpriteFactory : public ISpriteFactory
 {
 public:
@@ -59,6 +83,23 @@ public:
   engine::components::Sprite createSprite(data::ActorID id) override;
   base::Rect<int> actorFrameRect(data::ActorID id, int frame) const override;
 
+  /** Make the texture atlas hold exactly the given actors' sprites
+   *
+   * Does nothing if the atlas was already prepared for the same set of
+   * actors before, as is the case when restarting a level. Otherwise,
+   * sprites created before this call are still valid, but their images
+   * won't be drawn unless they are part of the new set.
+   */
+  void prepareForLevel(const std::vector<data::ActorID>& actorIds);
+
+  /** Load sprites requested via createSprite() which aren't in the atlas */
+  void loadRequestedSprites();
+
+  /** True if any sprite in the atlas has a high-res replacement image
+   *
+   * Reflects the current atlas contents, so it's recomputed for each level by
+   * prepareForLevel(), and updated when loading sprites on demand.
+   */
   bool hasHighResReplacements() const { return mHasHighResReplacements; }
 
   const renderer::TextureAtlas& textureAtlas() const
@@ -66,26 +107,40 @@ public:
     return mSpritesTextureAtlas;
   }
 
+  /** Size of all textures currently used by the sprite atlas, in bytes */
+  std::size_t residentTextureMemory() const
+  {
+    return mSpritesTextureAtlas.textureMemorySize();
+  }
+
+  void reportMemoryUsage(MemoryReport& report) const;
+
 private:
   struct SpriteData
   {
     engine::SpriteDrawData mDrawData;
     std::vector<int> mInitialFramesToRender;
+    int mFirstImageId;
+    int mNumImages;
   };
 
-  using CtorArgs = std::tuple<
-    std::unordered_map<data::ActorID, SpriteData>,
-    renderer::TextureAtlas,
-    bool>;
-
-  SpriteFactory(CtorArgs args);
-  static CtorArgs construct(
-    renderer::Renderer* pRenderer,
-    const loader::ActorImagePackage* pSpritePackage);
+  void requestImages(data::ActorID id);
+  void loadImages(const std::vector<data::ActorID>& ids);
 
+  const loader::ActorImagePackage* mpSpritePackage;
   std::unordered_map<data::ActorID, SpriteData> mSpriteDataMap;
+  // Must be declared before the atlas, since the atlas' indexed textures
+  // refer to it
+  renderer::PaletteTexture mPalette;
   renderer::TextureAtlas mSpritesTextureAtlas;
-  bool mHasHighResReplacements;
+  std::vector<data::ActorID> mLevelActorIds;
+
+  mutable std::mutex mResidencyMutex;
+  std::unordered_set<data::ActorID> mResidentActors;
+  std::vector<data::ActorID> mRequestedActors;
+
+  bool mHasHighResReplacements = false;
+  bool mIsHeadless;
 };
 
 } // namespace rigel::engine
@@ -289,25 +289,17 @@ void SpriteRenderingSystem::update(
     end(mSortBuffer),
     std::mem_fn(&SortableDrawSpec::mDrawTopMost));
 
-  miForegroundSprites = std::next(
-    begin(mSprites), std::distance(begin(mSortBuffer), iFirstTopMostSprite));
+  mNumRegularSprites = static_cast<std::size_t>(
+    std::distance(begin(mSortBuffer), iFirstTopMostSprite));
 }
 
 
-void SpriteRenderingSystem::renderRegularSprites() const
+void SpriteRenderingSystem::renderSprites(
+  const base::ArrayView<SpriteDrawSpec> sprites) const
 {
-  for (auto it = mSprites.begin(); it != miForegroundSprites; ++it)
+  for (const auto& spec : sprites)
   {
-    renderSprite(*it);
-  }
-}
-
-
-void SpriteRenderingSystem::renderForegroundSprites() const
-{
-  for (auto it = miForegroundSprites; it != mSprites.end(); ++it)
-  {
-    renderSprite(*it);
+    renderSprite(spec);
   }
 }
 
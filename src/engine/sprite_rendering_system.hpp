@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "base/array_view.hpp"
 #include "base/spatial_types.hpp"
 #include "base/warnings.hpp"
 #include "engine/base_components.hpp"
@@ -26,6 +27,7 @@ RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
 RIGEL_RESTORE_WARNINGS
 
+#include <cstddef>
 #include <utility>
 #include <vector>
 
@@ -84,8 +86,19 @@ public:
     const base::Extents& viewPortSize,
     const base::Vector& cameraPosition);
 
-  void renderRegularSprites() const;
-  void renderForegroundSprites() const;
+  /** Visible sprites in draw order, as collected by the last update()
+   *
+   * The first numRegularSprites() sprites are drawn behind the map's
+   * foreground layer, the remaining ones on top of it.
+   */
+  const std::vector<SpriteDrawSpec>& visibleSprites() const
+  {
+    return mSprites;
+  }
+
+  std::size_t numRegularSprites() const { return mNumRegularSprites; }
+
+  void renderSprites(base::ArrayView<SpriteDrawSpec> sprites) const;
 
 private:
   void renderSprite(const SpriteDrawSpec& spec) const;
@@ -99,7 +112,7 @@ private:
   // Data needed to draw sprites that are currently visible. This is updated
   // by each call to update().
   std::vector<SpriteDrawSpec> mSprites;
-  std::vector<SpriteDrawSpec>::iterator miForegroundSprites;
+  std::size_t mNumRegularSprites = 0;
 
   // Dependencies needed for drawing
   renderer::Renderer* mpRenderer;
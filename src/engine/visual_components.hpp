@@ -17,6 +17,7 @@
 #pragma once
 
 #include "base/array_view.hpp"
+#include "base/memory_arena.hpp"
 #include "base/spatial_types.hpp"
 #include "base/warnings.hpp"
 #include "engine/base_components.hpp"
@@ -212,7 +213,7 @@ struct ExtendedFrameList
     base::Vector mOffset;
   };
 
-  std::vector<RenderSpec> mFrames;
+  base::ArenaVector<RenderSpec> mFrames;
 };
 
 
@@ -0,0 +1,309 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "world_bounds_mirror.hpp"
+
+#include "engine/physical_components.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+  #include <emmintrin.h>
+  #define RIGEL_CULLING_USE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  #include <arm_neon.h>
+  #define RIGEL_CULLING_USE_NEON
+#endif
+
+
+namespace rigel::engine
+{
+
+using components::BoundingBox;
+using components::WorldPosition;
+
+
+namespace
+{
+
+bool hasLowerIndex(const entityx::Entity& lhs, const entityx::Entity& rhs)
+{
+  return lhs.id().index() < rhs.id().index();
+}
+
+} // namespace
+
+
+WorldBoundsMirror::WorldBoundsMirror(entityx::EventManager& events)
+{
+  events.subscribe<entityx::ComponentAddedEvent<WorldPosition>>(*this);
+  events.subscribe<entityx::ComponentAddedEvent<BoundingBox>>(*this);
+  events.subscribe<entityx::ComponentRemovedEvent<WorldPosition>>(*this);
+  events.subscribe<entityx::ComponentRemovedEvent<BoundingBox>>(*this);
+}
+
+
+void WorldBoundsMirror::cull(const BoundingBox& region)
+{
+  applyMembershipChanges();
+  readBounds();
+
+  const auto numEntities = mEntities.size();
+  mInRegionBits.assign((numEntities + 31) / 32, 0);
+
+  if (region.size.width <= 0 || region.size.height <= 0)
+  {
+    return;
+  }
+
+  // Same semantics as Rect::intersects(): The boxes must overlap by at
+  // least one unit on both axes.
+  const auto regionLeft = region.topLeft.x;
+  const auto regionTop = region.topLeft.y;
+  const auto regionRight = regionLeft + region.size.width;
+  const auto regionBottom = regionTop + region.size.height;
+
+  auto slot = std::size_t{0};
+
+  // Since 32 is a multiple of 4, the 4 result bits of each step always end
+  // up in the same word.
+#if defined(RIGEL_CULLING_USE_SSE2)
+  const auto regionLeft4 = _mm_set1_epi32(regionLeft);
+  const auto regionTop4 = _mm_set1_epi32(regionTop);
+  const auto regionRight4 = _mm_set1_epi32(regionRight);
+  const auto regionBottom4 = _mm_set1_epi32(regionBottom);
+
+  auto load = [](const std::vector<std::int32_t>& values, std::size_t i) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(&values[i]));
+  };
+
+  for (; slot + 4 <= numEntities; slot += 4)
+  {
+    const auto left = load(mLeft, slot);
+    const auto top = load(mTop, slot);
+    const auto right = load(mRight, slot);
+    const auto bottom = load(mBottom, slot);
+
+    auto overlaps = _mm_and_si128(
+      _mm_cmplt_epi32(left, regionRight4),
+      _mm_cmplt_epi32(regionLeft4, right));
+    overlaps = _mm_and_si128(overlaps, _mm_cmplt_epi32(left, right));
+    overlaps = _mm_and_si128(overlaps, _mm_cmplt_epi32(top, regionBottom4));
+    overlaps = _mm_and_si128(overlaps, _mm_cmplt_epi32(regionTop4, bottom));
+    overlaps = _mm_and_si128(overlaps, _mm_cmplt_epi32(top, bottom));
+
+    const auto bits = _mm_movemask_ps(_mm_castsi128_ps(overlaps));
+    mInRegionBits[slot / 32] |= static_cast<std::uint32_t>(bits)
+      << (slot % 32);
+  }
+#elif defined(RIGEL_CULLING_USE_NEON)
+  const auto regionLeft4 = vdupq_n_s32(regionLeft);
+  const auto regionTop4 = vdupq_n_s32(regionTop);
+  const auto regionRight4 = vdupq_n_s32(regionRight);
+  const auto regionBottom4 = vdupq_n_s32(regionBottom);
+  const std::uint32_t bitValues[] = {1, 2, 4, 8};
+  const auto bitValues4 = vld1q_u32(bitValues);
+
+  for (; slot + 4 <= numEntities; slot += 4)
+  {
+    const auto left = vld1q_s32(&mLeft[slot]);
+    const auto top = vld1q_s32(&mTop[slot]);
+    const auto right = vld1q_s32(&mRight[slot]);
+    const auto bottom = vld1q_s32(&mBottom[slot]);
+
+    auto overlaps =
+      vandq_u32(vcltq_s32(left, regionRight4), vcltq_s32(regionLeft4, right));
+    overlaps = vandq_u32(overlaps, vcltq_s32(left, right));
+    overlaps = vandq_u32(overlaps, vcltq_s32(top, regionBottom4));
+    overlaps = vandq_u32(overlaps, vcltq_s32(regionTop4, bottom));
+    overlaps = vandq_u32(overlaps, vcltq_s32(top, bottom));
+
+    // Turn the lane masks into 4 bits by summing up each lane's bit value
+    const auto laneBits = vandq_u32(overlaps, bitValues4);
+    const auto pairSums =
+      vpadd_u32(vget_low_u32(laneBits), vget_high_u32(laneBits));
+    const auto bits = vget_lane_u32(vpadd_u32(pairSums, pairSums), 0);
+    mInRegionBits[slot / 32] |= bits << (slot % 32);
+  }
+#endif
+
+  for (; slot < numEntities; ++slot)
+  {
+    // clang-format off
+    const auto overlaps =
+      mLeft[slot] < regionRight && regionLeft < mRight[slot] &&
+      mLeft[slot] < mRight[slot] &&
+      mTop[slot] < regionBottom && regionTop < mBottom[slot] &&
+      mTop[slot] < mBottom[slot];
+    // clang-format on
+
+    if (overlaps)
+    {
+      mInRegionBits[slot / 32] |= 1u << (slot % 32);
+    }
+  }
+}
+
+
+bool WorldBoundsMirror::isTracked(entityx::Entity entity) const
+{
+  const auto index = entity.id().index();
+  if (index >= mSlotByEntityIndex.size())
+  {
+    return false;
+  }
+
+  const auto slot = mSlotByEntityIndex[index];
+  return slot >= 0 && mEntities[slot] == entity;
+}
+
+
+bool WorldBoundsMirror::isInRegion(entityx::Entity entity) const
+{
+  assert(isTracked(entity));
+  return isInRegion(
+    static_cast<std::size_t>(mSlotByEntityIndex[entity.id().index()]));
+}
+
+
+void WorldBoundsMirror::receive(
+  const entityx::ComponentAddedEvent<WorldPosition>& event)
+{
+  auto entity = event.entity;
+  if (entity.has_component<BoundingBox>())
+  {
+    track(entity);
+  }
+}
+
+
+void WorldBoundsMirror::receive(
+  const entityx::ComponentAddedEvent<BoundingBox>& event)
+{
+  auto entity = event.entity;
+  if (entity.has_component<WorldPosition>())
+  {
+    track(entity);
+  }
+}
+
+
+void WorldBoundsMirror::receive(
+  const entityx::ComponentRemovedEvent<WorldPosition>& event)
+{
+  untrack(event.entity);
+}
+
+
+void WorldBoundsMirror::receive(
+  const entityx::ComponentRemovedEvent<BoundingBox>& event)
+{
+  untrack(event.entity);
+}
+
+
+void WorldBoundsMirror::track(entityx::Entity entity)
+{
+  mPendingEntities.push_back(entity);
+}
+
+
+void WorldBoundsMirror::untrack(entityx::Entity entity)
+{
+  if (isTracked(entity))
+  {
+    const auto index = entity.id().index();
+    mEntities[mSlotByEntityIndex[index]] = entityx::Entity{};
+    mSlotByEntityIndex[index] = -1;
+    mHasRemovedEntities = true;
+    return;
+  }
+
+  const auto iPending =
+    std::find(mPendingEntities.begin(), mPendingEntities.end(), entity);
+  if (iPending != mPendingEntities.end())
+  {
+    mPendingEntities.erase(iPending);
+  }
+}
+
+
+void WorldBoundsMirror::applyMembershipChanges()
+{
+  if (!mHasRemovedEntities && mPendingEntities.empty())
+  {
+    return;
+  }
+
+  if (mHasRemovedEntities)
+  {
+    mEntities.erase(
+      std::remove(mEntities.begin(), mEntities.end(), entityx::Entity{}),
+      mEntities.end());
+    mHasRemovedEntities = false;
+  }
+
+  if (!mPendingEntities.empty())
+  {
+    std::sort(mPendingEntities.begin(), mPendingEntities.end(), hasLowerIndex);
+
+    mMergeBuffer.clear();
+    std::merge(
+      mEntities.begin(),
+      mEntities.end(),
+      mPendingEntities.begin(),
+      mPendingEntities.end(),
+      std::back_inserter(mMergeBuffer),
+      hasLowerIndex);
+    std::swap(mEntities, mMergeBuffer);
+    mPendingEntities.clear();
+  }
+
+  const auto maxIndex =
+    mEntities.empty() ? 0 : mEntities.back().id().index() + 1;
+  mSlotByEntityIndex.assign(maxIndex, -1);
+  for (auto slot = std::size_t{0}; slot < mEntities.size(); ++slot)
+  {
+    mSlotByEntityIndex[mEntities[slot].id().index()] =
+      static_cast<std::int32_t>(slot);
+  }
+
+  mLeft.resize(mEntities.size());
+  mTop.resize(mEntities.size());
+  mRight.resize(mEntities.size());
+  mBottom.resize(mEntities.size());
+}
+
+
+void WorldBoundsMirror::readBounds()
+{
+  for (auto slot = std::size_t{0}; slot < mEntities.size(); ++slot)
+  {
+    auto entity = mEntities[slot];
+    const auto worldSpaceBbox = toWorldSpace(
+      *entity.component<const BoundingBox>(),
+      *entity.component<const WorldPosition>());
+
+    mLeft[slot] = worldSpaceBbox.topLeft.x;
+    mTop[slot] = worldSpaceBbox.topLeft.y;
+    mRight[slot] = worldSpaceBbox.topLeft.x + worldSpaceBbox.size.width;
+    mBottom[slot] = worldSpaceBbox.topLeft.y + worldSpaceBbox.size.height;
+  }
+}
+
+} // namespace rigel::engine
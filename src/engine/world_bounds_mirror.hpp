@@ -0,0 +1,109 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/warnings.hpp"
+#include "engine/base_components.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <entityx/entityx.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace rigel::engine
+{
+
+/** Structure-of-arrays copy of all entities' world-space bounding boxes
+ *
+ * Tracks all entities that have both a WorldPosition and a BoundingBox,
+ * ordered by entity index, i.e. in the same order that iterating the
+ * EntityManager would produce. Membership is kept up to date by listening
+ * to component addition/removal events.
+ *
+ * Positions and bounding boxes are plain data which is modified in place
+ * all over the code, so changes to them can't be observed. Instead, cull()
+ * reads the current values of all tracked entities into a set of
+ * contiguous arrays, and then tests them against a region in one batch
+ * (using SSE2 or NEON where available). The result is a bit per tracked
+ * entity.
+ *
+ * Membership changes are only applied by the next call to cull(), so that
+ * slots stay stable while working with the results. This makes it safe to
+ * add or remove components, or to destroy entities, while iterating.
+ */
+class WorldBoundsMirror : public entityx::Receiver<WorldBoundsMirror>
+{
+public:
+  explicit WorldBoundsMirror(entityx::EventManager& events);
+
+  void cull(const components::BoundingBox& region);
+
+  /** Number of entities tracked as of the last call to cull() */
+  std::size_t size() const { return mEntities.size(); }
+
+  /** Entity in the given slot, invalid if it has been removed since */
+  entityx::Entity entity(const std::size_t slot) const
+  {
+    return mEntities[slot];
+  }
+
+  bool isInRegion(const std::size_t slot) const
+  {
+    return (mInRegionBits[slot / 32] >> (slot % 32)) & 1u;
+  }
+
+  /** True if the entity was tracked as of the last call to cull() */
+  bool isTracked(entityx::Entity entity) const;
+
+  /** Result of the last cull for the given entity, which must be tracked */
+  bool isInRegion(entityx::Entity entity) const;
+
+  void receive(
+    const entityx::ComponentAddedEvent<components::WorldPosition>& event);
+  void receive(
+    const entityx::ComponentAddedEvent<components::BoundingBox>& event);
+  void receive(
+    const entityx::ComponentRemovedEvent<components::WorldPosition>& event);
+  void receive(
+    const entityx::ComponentRemovedEvent<components::BoundingBox>& event);
+
+private:
+  void track(entityx::Entity entity);
+  void untrack(entityx::Entity entity);
+  void applyMembershipChanges();
+  void readBounds();
+
+  std::vector<entityx::Entity> mEntities;
+  std::vector<entityx::Entity> mPendingEntities;
+  std::vector<entityx::Entity> mMergeBuffer;
+  std::vector<std::int32_t> mSlotByEntityIndex;
+  bool mHasRemovedEntities = false;
+
+  // Exclusive right and bottom edges. Empty boxes have right <= left or
+  // bottom <= top, and thus never intersect anything.
+  std::vector<std::int32_t> mLeft;
+  std::vector<std::int32_t> mTop;
+  std::vector<std::int32_t> mRight;
+  std::vector<std::int32_t> mBottom;
+  std::vector<std::uint32_t> mInRegionBits;
+};
+
+} // namespace rigel::engine
@@ -18,13 +18,17 @@
 
 #include "base/defer.hpp"
 #include "base/math_tools.hpp"
+#include "base/thread_pool.hpp"
 #include "data/duke_script.hpp"
 #include "data/game_traits.hpp"
 #include "engine/timing.hpp"
 #include "game_logic/demo_player.hpp"
+#include "game_logic/replay_player.hpp"
 #include "loader/duke_script_loader.hpp"
+#include "loader/file_utils.hpp"
 #include "renderer/upscaling_utils.hpp"
 #include "ui/imgui_integration.hpp"
+#include "ui/utils.hpp"
 
 #include "anti_piracy_screen_mode.hpp"
 #include "game_session_mode.hpp"
@@ -36,6 +40,10 @@ RIGEL_DISABLE_WARNINGS
 #include <imgui.h>
 RIGEL_RESTORE_WARNINGS
 
+#include <fstream>
+#include <future>
+#include <iostream>
+
 namespace rigel
 {
 
@@ -44,6 +52,18 @@ using namespace engine;
 namespace
 {
 
+#ifdef __EMSCRIPTEN__
+constexpr auto STARTUP_LOADING_THREADS = std::size_t{0};
+#else
+constexpr auto STARTUP_LOADING_THREADS = std::size_t{4};
+#endif
+
+constexpr const char* SCRIPT_BUNDLE_FILES[] = {
+  "TEXT.MNI",
+  "OPTIONS.MNI",
+  "ORDERTXT.MNI"};
+
+
 /** Returns game path to be used for loading resources
  *
  * A game path specified on the command line takes priority over the path
@@ -90,16 +110,50 @@ auto wrapWithInitialFadeIn(std::unique_ptr<GameMode> mode)
 }
 
 
-auto loadScripts(const loader::ResourceLoader& resources)
+std::unique_ptr<engine::SoundSystem> createSoundSystem(
+  const loader::ResourceLoader* pResources,
+  const data::SoundStyle soundStyle)
 {
-  auto allScripts = resources.loadScriptBundle("TEXT.MNI");
-  const auto optionsScripts = resources.loadScriptBundle("OPTIONS.MNI");
-  const auto orderInfoScripts = resources.loadScriptBundle("ORDERTXT.MNI");
+  try
+  {
+    return std::make_unique<engine::SoundSystem>(pResources, soundStyle);
+  }
+  catch (const std::exception& ex)
+  {
+    std::cerr << "WARNING: Failed to initialize audio: " << ex.what() << '\n';
+  }
+
+  return nullptr;
+}
 
-  allScripts.insert(std::begin(optionsScripts), std::end(optionsScripts));
-  allScripts.insert(std::begin(orderInfoScripts), std::end(orderInfoScripts));
 
-  return allScripts;
+void writeStartupTimeline(
+  const base::StartupTimeline& timeline,
+  const std::string& fileName)
+{
+  std::ofstream file(std::filesystem::u8path(fileName));
+  if (!file)
+  {
+    std::cerr << "WARNING: Failed to write startup timeline to " << fileName
+              << '\n';
+    return;
+  }
+
+  timeline.writeReport(file);
+}
+
+
+void appendMemoryReport(const MemoryReport& report, const std::string& fileName)
+{
+  std::ofstream file(std::filesystem::u8path(fileName), std::ios::app);
+  if (!file)
+  {
+    std::cerr << "WARNING: Failed to write memory report to " << fileName
+              << '\n';
+    return;
+  }
+
+  file << toJson(report).dump() << '\n';
 }
 
 
@@ -173,7 +227,45 @@ std::unique_ptr<GameMode> createInitialGameMode(
     game_logic::DemoPlayer mDemoPlayer;
   };
 
-  if (commandLineOptions.mLevelToJumpTo)
+  class ReplayMode : public GameMode
+  {
+  public:
+    ReplayMode(Context context, const std::string& replayFile)
+      : mReplayPlayer(
+          context,
+          game_logic::deserializeInputRecording(
+            loader::loadFile(std::filesystem::u8path(replayFile))))
+      , mpServiceProvider(context.mpServiceProvider)
+    {
+    }
+
+    std::unique_ptr<GameMode> updateAndRender(
+      engine::TimeDelta,
+      const std::vector<SDL_Event>& events) override
+    {
+      for (const auto& event : events)
+      {
+        if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE)
+        {
+          mpServiceProvider->scheduleGameQuit();
+        }
+      }
+
+      mReplayPlayer.updateAndRender();
+      return nullptr;
+    }
+
+  private:
+    game_logic::ReplayPlayer mReplayPlayer;
+    IGameServiceProvider* mpServiceProvider;
+  };
+
+  if (!commandLineOptions.mReplayFile.empty())
+  {
+    return std::make_unique<ReplayMode>(
+      context, commandLineOptions.mReplayFile);
+  }
+  else if (commandLineOptions.mLevelToJumpTo)
   {
     return std::make_unique<GameSessionMode>(
       *commandLineOptions.mLevelToJumpTo,
@@ -201,12 +293,12 @@ std::unique_ptr<GameMode> createInitialGameMode(
 }
 
 
-std::optional<renderer::FpsLimiter>
-  createLimiter(const data::GameOptions& options)
+std::optional<renderer::FramePacer>
+  createFramePacer(const data::GameOptions& options)
 {
   if (options.mEnableFpsLimit && !options.mEnableVsync)
   {
-    return renderer::FpsLimiter{options.mMaxFps};
+    return renderer::FramePacer{options.mMaxFps, options.mPredictRenderCost};
   }
   else
   {
@@ -217,28 +309,87 @@ std::optional<renderer::FpsLimiter>
 } // namespace
 
 
-Game::Game(
-  const CommandLineOptions& commandLineOptions,
-  UserProfile* pUserProfile,
-  SDL_Window* pWindow,
-  const bool isFirstLaunch)
-  : mpWindow(pWindow)
-  , mRenderer(pWindow)
-  , mResources(effectiveGamePath(commandLineOptions, *pUserProfile))
-  , mpSoundSystem([&]() {
-    std::unique_ptr<engine::SoundSystem> pResult;
-    try
+/** Loading work which runs concurrently while Game is being constructed
+ *
+ * This only does CPU-side work, since OpenGL can only be used from the main
+ * thread. Game's constructor turns the results into textures.
+ */
+struct Game::StartupTasks
+{
+  StartupTasks(
+    const loader::ResourceLoader* pResources,
+    const data::SoundStyle soundStyle,
+    base::StartupTimeline* pTimeline)
+    : mPool(STARTUP_LOADING_THREADS)
+  {
+    // Rendering and resampling all sounds takes the longest, so we start
+    // with that. SDL allows opening the audio device from any thread.
+    mSoundSystem = mPool.submit([=]() {
+      return pTimeline->measure("Create sound system", [&]() {
+        return createSoundSystem(pResources, soundStyle);
+      });
+    });
+
+    mUiSpriteSheetImage = mPool.submit([=]() {
+      return pTimeline->measure("Load UI sprite sheet", [&]() {
+        return ui::loadUiSpriteSheetImage(*pResources);
+      });
+    });
+
+    mMenuFont = mPool.submit([=]() {
+      return pTimeline->measure("Load menu font", [&]() {
+        return pResources->mActorImagePackage.loadFont();
+      });
+    });
+
+    for (const auto fileName : SCRIPT_BUNDLE_FILES)
     {
-      pResult = std::make_unique<engine::SoundSystem>(
-        &mResources, pUserProfile->mOptions.mSoundStyle);
+      mScriptBundles.push_back(mPool.submit([=]() {
+        return pTimeline->measure(std::string{"Load "} + fileName, [&]() {
+          return pResources->loadScriptBundle(fileName);
+        });
+      }));
     }
-    catch (const std::exception& ex)
+  }
+
+  loader::ScriptBundle takeAllScripts()
+  {
+    // When a script name appears in multiple files, the first one wins
+    loader::ScriptBundle allScripts;
+    for (auto& bundle : mScriptBundles)
     {
-      std::cerr << "WARNING: Failed to initialize audio: " << ex.what() << '\n';
+      allScripts.merge(bundle.get());
     }
 
-    return pResult;
-  }())
+    return allScripts;
+  }
+
+  base::ThreadPool mPool;
+  std::future<std::unique_ptr<engine::SoundSystem>> mSoundSystem;
+  std::future<data::IndexedImage> mUiSpriteSheetImage;
+  std::future<loader::FontData> mMenuFont;
+  std::vector<std::future<loader::ScriptBundle>> mScriptBundles;
+};
+
+
+Game::Game(
+  const CommandLineOptions& commandLineOptions,
+  UserProfile* pUserProfile,
+  SDL_Window* pWindow,
+  const bool isFirstLaunch,
+  base::StartupTimeline* pStartupTimeline)
+  : mpWindow(pWindow)
+  , mpStartupTimeline(pStartupTimeline)
+  , mResources(pStartupTimeline->measure("Load game data", [&]() {
+    return loader::ResourceLoader{
+      effectiveGamePath(commandLineOptions, *pUserProfile)};
+  }))
+  , mpStartupTasks(std::make_unique<StartupTasks>(
+      &mResources,
+      pUserProfile->mOptions.mSoundStyle,
+      pStartupTimeline))
+  , mRenderer(pStartupTimeline->measure(
+      "Create renderer", [&]() { return renderer::Renderer{pWindow}; }))
   , mIsShareWareVersion([this]() {
     // The registered version has 24 additional level files, and a
     // "anti-piracy" image (LCR.MNI). But we don't check for the presence of
@@ -250,10 +401,15 @@ Game::Game(
       mResources.hasFile("LCR.MNI") && mResources.hasFile("O1.MNI");
     return !hasRegisteredVersionFiles;
   }())
-  , mFpsLimiter(createLimiter(pUserProfile->mOptions))
+  , mFramePacer(createFramePacer(pUserProfile->mOptions))
   , mRenderTarget(renderer::createFullscreenRenderTarget(
       &mRenderer,
       pUserProfile->mOptions))
+  , mpInputRecorder(
+      commandLineOptions.mInputRecordingFile.empty()
+        ? nullptr
+        : std::make_unique<game_logic::InputRecorder>(
+            std::filesystem::u8path(commandLineOptions.mInputRecordingFile)))
   , mIsRunning(true)
   , mIsMinimized(false)
   , mCommandLineOptions(commandLineOptions)
@@ -262,16 +418,36 @@ Game::Game(
   , mWidescreenModeWasActive(
       pUserProfile->mOptions.mWidescreenModeOn &&
       renderer::canUseWidescreenMode(&mRenderer))
-  , mScriptRunner(&mResources, &mRenderer, &mpUserProfile->mSaveSlots, this)
-  , mAllScripts(loadScripts(mResources))
+  , mScriptRunner(pStartupTimeline->measure(
+      "Create script runner",
+      [&]() {
+        return ui::DukeScriptRunner{
+          &mResources, &mRenderer, &mpUserProfile->mSaveSlots, this};
+      }))
+  , mAllScripts(mpStartupTasks->takeAllScripts())
+  , mUiSpriteSheetPalette(&mRenderer, loader::INGAME_PALETTE)
   , mUiSpriteSheet(
-      renderer::Texture{
-        &mRenderer,
-        mResources.loadTiledFullscreenImage("STATUS.MNI")},
-      &mRenderer)
-  , mSpriteFactory(&mRenderer, &mResources.mActorImagePackage)
-  , mTextRenderer(&mUiSpriteSheet, &mRenderer, mResources)
+      pStartupTimeline->measure("Create UI sprite sheet texture", [&]() {
+        return ui::makeUiSpriteSheet(
+          &mRenderer,
+          mpStartupTasks->mUiSpriteSheetImage.get(),
+          mUiSpriteSheetPalette);
+      }))
+  , mSpriteFactory(pStartupTimeline->measure("Create sprite factory", [&]() {
+    return engine::SpriteFactory{&mRenderer, &mResources.mActorImagePackage};
+  }))
+  , mTextRenderer(pStartupTimeline->measure("Create menu font texture", [&]() {
+    return ui::MenuElementRenderer{
+      &mUiSpriteSheet, &mRenderer, mpStartupTasks->mMenuFont.get()};
+  }))
+  , mMemoryUsageDisplay(&mMemoryRegistry)
 {
+  mpSoundSystem = mpStartupTasks->mSoundSystem.get();
+  mpStartupTasks.reset();
+
+  mMemoryRegistration = mMemoryRegistry.add(
+    [this](MemoryReport& report) { reportMemoryUsage(report); });
+
   applyChangedOptions();
 
   mpCurrentGameMode = wrapWithInitialFadeIn(createInitialGameMode(
@@ -284,6 +460,9 @@ Game::Game(
 }
 
 
+Game::~Game() = default;
+
+
 auto Game::runOneFrame() -> std::optional<StopReason>
 {
   using namespace std::chrono;
@@ -312,6 +491,20 @@ auto Game::runOneFrame() -> std::optional<StopReason>
 
   swapBuffers();
 
+  if (mpStartupTimeline)
+  {
+    mpStartupTimeline->addStage(
+      "First frame", startOfFrame, base::Clock::now());
+
+    if (!mCommandLineOptions.mStartupTimelineFile.empty())
+    {
+      writeStartupTimeline(
+        *mpStartupTimeline, mCommandLineOptions.mStartupTimelineFile);
+    }
+
+    mpStartupTimeline = nullptr;
+  }
+
   applyChangedOptions();
 
   if (!mGamePathToSwitchTo.empty())
@@ -385,7 +578,15 @@ void Game::updateAndRender(const entityx::TimeDelta elapsed)
 
     if (mpUserProfile->mOptions.mShowFpsCounter)
     {
-      mFpsDisplay.updateAndRender(elapsed);
+      mFpsDisplay.updateAndRender(
+        elapsed,
+        mpSoundSystem ? std::optional{mpSoundSystem->soundMixerStats()}
+                      : std::nullopt);
+    }
+
+    if (mShowMemoryUsage)
+    {
+      mMemoryUsageDisplay.updateAndRender(elapsed);
     }
   }
 
@@ -405,7 +606,9 @@ GameMode::Context Game::makeModeContext()
     &mTextRenderer,
     &mUiSpriteSheet,
     &mSpriteFactory,
-    mpUserProfile};
+    mpUserProfile,
+    mpInputRecorder.get(),
+    &mMemoryRegistry};
 }
 
 
@@ -424,6 +627,18 @@ bool Game::handleEvent(const SDL_Event& event)
       {
         options.mShowFpsCounter = !options.mShowFpsCounter;
       }
+      else if (mCommandLineOptions.mDebugModeEnabled)
+      {
+        if (event.key.keysym.sym == SDLK_F8)
+        {
+          mShowMemoryUsage = !mShowMemoryUsage;
+        }
+        else if (event.key.keysym.sym == SDLK_F9)
+        {
+          appendMemoryReport(
+            mMemoryRegistry.collect(), mCommandLineOptions.mMemoryReportFile);
+        }
+      }
       return false;
 
     case SDL_QUIT:
@@ -528,11 +743,16 @@ void Game::performScreenFadeBlocking(const FadeType type)
 
 void Game::swapBuffers()
 {
+  if (mFramePacer)
+  {
+    mFramePacer->waitForPresentation();
+  }
+
   mRenderer.swapBuffers();
 
-  if (mFpsLimiter)
+  if (mFramePacer)
   {
-    mFpsLimiter->updateAndWait();
+    mFramePacer->waitForNextFrame();
   }
 }
 
@@ -597,9 +817,10 @@ void Game::applyChangedOptions()
   if (
     currentOptions.mEnableVsync != mPreviousOptions.mEnableVsync ||
     currentOptions.mEnableFpsLimit != mPreviousOptions.mEnableFpsLimit ||
-    currentOptions.mMaxFps != mPreviousOptions.mMaxFps)
+    currentOptions.mMaxFps != mPreviousOptions.mMaxFps ||
+    currentOptions.mPredictRenderCost != mPreviousOptions.mPredictRenderCost)
   {
-    mFpsLimiter = createLimiter(currentOptions);
+    mFramePacer = createFramePacer(currentOptions);
   }
 
   if (currentOptions.mUpscalingFilter != mPreviousOptions.mUpscalingFilter)
@@ -652,6 +873,19 @@ void Game::applyChangedOptions()
 }
 
 
+void Game::reportMemoryUsage(MemoryReport& report) const
+{
+  mRenderer.reportMemoryUsage(report);
+  mResources.reportMemoryUsage(report);
+  mSpriteFactory.reportMemoryUsage(report);
+
+  if (mpSoundSystem)
+  {
+    mpSoundSystem->reportMemoryUsage(report);
+  }
+}
+
+
 void Game::enumerateGameControllers()
 {
   mGameControllers.clear();
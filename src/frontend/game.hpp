@@ -18,21 +18,25 @@
 
 #include "base/clock.hpp"
 #include "base/spatial_types.hpp"
+#include "base/startup_timeline.hpp"
 #include "base/warnings.hpp"
 #include "common/game_mode.hpp"
 #include "common/game_service_provider.hpp"
+#include "common/memory_accounting.hpp"
 #include "common/user_profile.hpp"
 #include "engine/sound_system.hpp"
 #include "engine/sprite_factory.hpp"
 #include "engine/tiled_texture.hpp"
+#include "game_logic/input_recording.hpp"
 #include "loader/duke_script_loader.hpp"
 #include "loader/resource_loader.hpp"
-#include "renderer/fps_limiter.hpp"
+#include "renderer/frame_pacer.hpp"
 #include "renderer/renderer.hpp"
 #include "renderer/texture.hpp"
 #include "sdl_utils/ptr.hpp"
 #include "ui/duke_script_runner.hpp"
 #include "ui/fps_display.hpp"
+#include "ui/memory_usage_display.hpp"
 #include "ui/menu_element_renderer.hpp"
 
 #include <SDL_gamecontroller.h>
@@ -54,11 +58,21 @@ public:
     RestartNeeded
   };
 
+  /** Create game, loading all resources
+   *
+   * Loading work that doesn't need OpenGL runs concurrently on a thread pool,
+   * while textures are created on the calling thread. Each stage is recorded
+   * in the given timeline, which must stay alive until the first frame has
+   * been run. The timeline is written to a file after the first frame if
+   * requested via command line.
+   */
   Game(
     const CommandLineOptions& commandLineOptions,
     UserProfile* pUserProfile,
     SDL_Window* pWindow,
-    bool isFirstLaunch);
+    bool isFirstLaunch,
+    base::StartupTimeline* pStartupTimeline);
+  ~Game();
   Game(const Game&) = delete;
   Game& operator=(const Game&) = delete;
 
@@ -95,6 +109,7 @@ private:
   void swapBuffers();
   void applyChangedOptions();
   void enumerateGameControllers();
+  void reportMemoryUsage(MemoryReport& report) const;
 
   // IGameServiceProvider implementation
   void fadeOutScreen() override;
@@ -122,17 +137,23 @@ private:
   }
 
 private:
+  struct StartupTasks;
+
   SDL_Window* mpWindow;
-  renderer::Renderer mRenderer;
+  base::StartupTimeline* mpStartupTimeline;
+  MemoryRegistry mMemoryRegistry;
   loader::ResourceLoader mResources;
+  std::unique_ptr<StartupTasks> mpStartupTasks;
+  renderer::Renderer mRenderer;
   std::unique_ptr<engine::SoundSystem> mpSoundSystem;
   bool mIsShareWareVersion;
 
-  std::optional<renderer::FpsLimiter> mFpsLimiter;
+  std::optional<renderer::FramePacer> mFramePacer;
   renderer::RenderTargetTexture mRenderTarget;
   std::uint8_t mAlphaMod = 0;
   bool mCurrentFrameIsWidescreen = false;
 
+  std::unique_ptr<game_logic::InputRecorder> mpInputRecorder;
   std::unique_ptr<GameMode> mpCurrentGameMode;
 
   bool mIsRunning;
@@ -148,12 +169,17 @@ private:
 
   ui::DukeScriptRunner mScriptRunner;
   loader::ScriptBundle mAllScripts;
+  renderer::PaletteTexture mUiSpriteSheetPalette;
   engine::TiledTexture mUiSpriteSheet;
   engine::SpriteFactory mSpriteFactory;
   ui::MenuElementRenderer mTextRenderer;
   ui::FpsDisplay mFpsDisplay;
+  ui::MemoryUsageDisplay mMemoryUsageDisplay;
+  bool mShowMemoryUsage = false;
   std::vector<SDL_Event> mEventQueue;
   std::vector<sdl_utils::Ptr<SDL_GameController>> mGameControllers;
+
+  MemoryRegistry::Registration mMemoryRegistration;
 };
 
 } // namespace rigel
@@ -19,6 +19,7 @@
 #include "base/math_tools.hpp"
 #include "common/game_service_provider.hpp"
 #include "common/user_profile.hpp"
+#include "game_logic/input_recording.hpp"
 #include "game_logic/world_state.hpp"
 #include "ui/utils.hpp"
 
@@ -44,6 +45,32 @@ GameRunner::GameRunner(
   , mInputHandler(&context.mpUserProfile->mOptions)
   , mMenu(context, pPlayerModel, &mWorld, sessionId)
 {
+  if (mContext.mpServiceProvider->commandLineOptions().mPipelinedGameLogic)
+  {
+    mpLogicThread = std::make_unique<base::WorkerThread>();
+  }
+
+  // Reports are collected on the main thread, like debug text rendering
+  mMemoryRegistration =
+    mContext.mpMemoryRegistry->add([this](MemoryReport& report) {
+      finishLogicUpdate();
+      mWorld.reportMemoryUsage(report);
+    });
+
+  if (mContext.mpInputRecorder)
+  {
+    mContext.mpInputRecorder->beginSegment(
+      sessionId, mWorld.mPlayerModelAtLevelStart, playerPositionOverride);
+  }
+}
+
+
+GameRunner::~GameRunner()
+{
+  if (mContext.mpInputRecorder)
+  {
+    mContext.mpInputRecorder->endSegment();
+  }
 }
 
 
@@ -62,17 +89,32 @@ void GameRunner::handleEvent(const SDL_Event& event)
     return;
   }
 
-  const auto menuCommand = mInputHandler.handleEvent(
-    event, mWorld.mpState->mPlayer.stateIs<game_logic::InShip>());
+  const auto menuCommand =
+    mInputHandler.handleEvent(event, mWorld.isPlayerInShip());
+
+  if (menuCommand != InputHandler::MenuCommand::None)
+  {
+    finishLogicUpdate();
+  }
 
   switch (menuCommand)
   {
     case InputHandler::MenuCommand::QuickSave:
       mWorld.quickSave();
+
+      if (mContext.mpInputRecorder)
+      {
+        mContext.mpInputRecorder->recordQuickSave();
+      }
       break;
 
     case InputHandler::MenuCommand::QuickLoad:
       mWorld.quickLoad();
+
+      if (mContext.mpInputRecorder)
+      {
+        mContext.mpInputRecorder->recordQuickLoad();
+      }
       break;
 
     default:
@@ -103,10 +145,38 @@ void GameRunner::updateAndRender(engine::TimeDelta dt)
     return;
   }
 
+  if (mpLogicThread)
+  {
+    updateWorldPipelined(dt);
+
+    // Debug overlays are drawn from the live world state, not from the
+    // render snapshot
+    if (mWorld.mpState->mDebuggingSystem.isActive() || mShowDebugText)
+    {
+      finishLogicUpdate();
+    }
+
+    mWorld.render();
+    renderDebugText();
+    return;
+  }
+
   updateWorld(dt);
   mWorld.render();
   renderDebugText();
   mWorld.processEndOfFrameActions();
+
+  if (mContext.mpInputRecorder)
+  {
+    mContext.mpInputRecorder->recordEndOfFrameActions();
+  }
+}
+
+
+std::uint32_t GameRunner::stateHash()
+{
+  finishLogicUpdate();
+  return mWorld.stateHash();
 }
 
 
@@ -119,7 +189,17 @@ bool GameRunner::needsPerElementUpscaling() const
 void GameRunner::updateWorld(const engine::TimeDelta dt)
 {
   auto update = [this]() {
-    mWorld.updateGameLogic(mInputHandler.fetchInput());
+    const auto input = mInputHandler.fetchInput();
+    mWorld.updateGameLogic(input);
+
+    if (auto pRecorder = mContext.mpInputRecorder)
+    {
+      pRecorder->recordFrame(input);
+      if (pRecorder->isStateHashDue())
+      {
+        pRecorder->recordStateHash(mWorld.stateHash());
+      }
+    }
   };
 
 
@@ -145,10 +225,120 @@ void GameRunner::updateWorld(const engine::TimeDelta dt)
 }
 
 
+/** Runs game logic on mpLogicThread, one update ahead of rendering
+ *
+ * Logic updates that are due are started at the beginning of a frame, and
+ * run concurrently with rendering the previous update's render snapshot.
+ * Once the worker is done, the next frame publishes the results and runs
+ * end-of-frame actions. If an update takes longer than a frame, rendering
+ * continues with the previous snapshot, and the time spent is made up for
+ * by running multiple updates at once afterwards - just like updateWorld()
+ * does when rendering is slow.
+ *
+ * Anything that needs access to the world outside of logic updates must
+ * call finishLogicUpdate() first.
+ */
+void GameRunner::updateWorldPipelined(const engine::TimeDelta dt)
+{
+  if (mPendingLogicUpdate && mpLogicThread->isIdle())
+  {
+    finishLogicUpdate();
+  }
+
+  std::vector<game_logic::PlayerInput> inputs;
+
+  if (mSingleStepping)
+  {
+    if (mDoNextSingleStep && !mPendingLogicUpdate)
+    {
+      inputs.push_back(mInputHandler.fetchInput());
+      mDoNextSingleStep = false;
+    }
+  }
+  else
+  {
+    mAccumulatedTime += dt;
+
+    if (!mPendingLogicUpdate)
+    {
+      for (; mAccumulatedTime >= game_logic::GAME_LOGIC_UPDATE_DELAY;
+           mAccumulatedTime -= game_logic::GAME_LOGIC_UPDATE_DELAY)
+      {
+        inputs.push_back(mInputHandler.fetchInput());
+      }
+    }
+
+    // Only used for rendering, and not touched by game logic
+    mWorld.mpState->mMapRenderer.updateBackdropAutoScrolling(dt);
+  }
+
+  if (!inputs.empty())
+  {
+    startLogicUpdate(std::move(inputs));
+  }
+}
+
+
+void GameRunner::startLogicUpdate(std::vector<game_logic::PlayerInput> inputs)
+{
+  mWorld.prepareLogicUpdates();
+  mPendingLogicUpdate = PendingLogicUpdate{std::move(inputs), {}};
+
+  const auto needsStateHashes = mContext.mpInputRecorder != nullptr;
+  mpLogicThread->post([this, needsStateHashes]() {
+    auto& update = *mPendingLogicUpdate;
+    for (const auto& input : update.mInputs)
+    {
+      mWorld.runLogicUpdate(input);
+
+      if (needsStateHashes)
+      {
+        update.mStateHashes.push_back(mWorld.stateHash());
+      }
+    }
+  });
+}
+
+
+void GameRunner::finishLogicUpdate()
+{
+  if (!mPendingLogicUpdate)
+  {
+    return;
+  }
+
+  mpLogicThread->waitUntilIdle();
+  mWorld.publishLogicUpdates();
+
+  if (auto pRecorder = mContext.mpInputRecorder)
+  {
+    const auto& update = *mPendingLogicUpdate;
+    for (auto i = std::size_t{0}; i < update.mInputs.size(); ++i)
+    {
+      pRecorder->recordFrame(update.mInputs[i]);
+      if (pRecorder->isStateHashDue())
+      {
+        pRecorder->recordStateHash(update.mStateHashes[i]);
+      }
+    }
+  }
+
+  mPendingLogicUpdate.reset();
+
+  mWorld.processEndOfFrameActions();
+
+  if (mContext.mpInputRecorder)
+  {
+    mContext.mpInputRecorder->recordEndOfFrameActions();
+  }
+}
+
+
 bool GameRunner::updateMenu(const engine::TimeDelta dt)
 {
   if (mMenu.isActive())
   {
+    finishLogicUpdate();
     mInputHandler.reset();
 
     if (mMenu.isTransparent())
@@ -158,6 +348,12 @@ bool GameRunner::updateMenu(const engine::TimeDelta dt)
 
     const auto result = mMenu.updateAndRender(dt);
 
+    if (result != ui::IngameMenu::UpdateResult::StillActive)
+    {
+      // Options might have changed while the menu was active
+      mWorld.refreshRenderSnapshot();
+    }
+
     if (result == ui::IngameMenu::UpdateResult::FinishedNeedsFadeout)
     {
       mContext.mpServiceProvider->fadeOutScreen();
@@ -179,15 +375,19 @@ void GameRunner::handleDebugKeys(const SDL_Event& event)
     return;
   }
 
+  finishLogicUpdate();
+
   auto& debuggingSystem = mWorld.mpState->mDebuggingSystem;
   switch (event.key.keysym.sym)
   {
     case SDLK_b:
       debuggingSystem.toggleBoundingBoxDisplay();
+      mWorld.invalidateFrameCache();
       break;
 
     case SDLK_c:
       debuggingSystem.toggleWorldCollisionDataDisplay();
+      mWorld.invalidateFrameCache();
       break;
 
     case SDLK_d:
@@ -196,6 +396,7 @@ void GameRunner::handleDebugKeys(const SDL_Event& event)
 
     case SDLK_g:
       debuggingSystem.toggleGridDisplay();
+      mWorld.invalidateFrameCache();
       break;
 
     case SDLK_s:
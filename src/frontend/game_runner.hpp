@@ -18,7 +18,9 @@
 
 #include "base/spatial_types.hpp"
 #include "base/warnings.hpp"
+#include "base/worker_thread.hpp"
 #include "common/game_mode.hpp"
+#include "common/memory_accounting.hpp"
 #include "data/bonus.hpp"
 #include "data/saved_game.hpp"
 #include "frontend/input_handler.hpp"
@@ -30,6 +32,11 @@ RIGEL_DISABLE_WARNINGS
 #include <SDL.h>
 RIGEL_RESTORE_WARNINGS
 
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
 
 namespace rigel
 {
@@ -43,6 +50,9 @@ public:
     GameMode::Context context,
     std::optional<base::Vector> playerPositionOverride = std::nullopt,
     bool showWelcomeMessage = false);
+  ~GameRunner();
+  GameRunner(const GameRunner&) = delete;
+  GameRunner& operator=(const GameRunner&) = delete;
 
   void handleEvent(const SDL_Event& event);
   void updateAndRender(engine::TimeDelta dt);
@@ -54,8 +64,25 @@ public:
 
   std::set<data::Bonus> achievedBonuses() const;
 
+  /** See GameWorld::stateHash()
+   *
+   * In pipelined mode, this waits for the logic update in progress, if any,
+   * and publishes its results.
+   */
+  std::uint32_t stateHash();
+
 private:
+  /** Logic updates running on mpLogicThread, see updateWorldPipelined() */
+  struct PendingLogicUpdate
+  {
+    std::vector<game_logic::PlayerInput> mInputs;
+    std::vector<std::uint32_t> mStateHashes;
+  };
+
   void updateWorld(engine::TimeDelta dt);
+  void updateWorldPipelined(engine::TimeDelta dt);
+  void startLogicUpdate(std::vector<game_logic::PlayerInput> inputs);
+  void finishLogicUpdate();
   bool updateMenu(engine::TimeDelta dt);
   void handleDebugKeys(const SDL_Event& event);
   void renderDebugText();
@@ -70,12 +97,20 @@ private:
   bool mSingleStepping = false;
   bool mDoNextSingleStep = false;
   bool mLevelFinishedByDebugKey = false;
+
+  // Only set in pipelined mode. Declared last, so that any logic update
+  // still in progress is finished before the world is destroyed.
+  std::optional<PendingLogicUpdate> mPendingLogicUpdate;
+  std::unique_ptr<base::WorkerThread> mpLogicThread;
+
+  MemoryRegistry::Registration mMemoryRegistration;
 };
 
 
 inline bool GameRunner::levelFinished() const
 {
-  return mWorld.levelFinished() || mLevelFinishedByDebugKey;
+  return (!mPendingLogicUpdate && mWorld.levelFinished()) ||
+    mLevelFinishedByDebugKey;
 }
 
 
@@ -0,0 +1,236 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "actor_dependencies.hpp"
+
+#include <algorithm>
+
+
+namespace rigel::game_logic
+{
+
+using data::ActorID;
+
+
+namespace
+{
+
+// Actors which can appear in any level, independently of what the level
+// contains
+constexpr ActorID ALWAYS_NEEDED_ACTORS[] = {
+  // Player, and what the player can spawn. The player's weapon carries over
+  // from previous levels, so we need all types of projectiles.
+  ActorID::Duke_LEFT,
+  ActorID::Duke_RIGHT,
+  ActorID::Duke_death_particles,
+  ActorID::Duke_regular_shot_horizontal,
+  ActorID::Duke_regular_shot_vertical,
+  ActorID::Duke_laser_shot_horizontal,
+  ActorID::Duke_laser_shot_vertical,
+  ActorID::Duke_rocket_up,
+  ActorID::Duke_rocket_down,
+  ActorID::Duke_rocket_left,
+  ActorID::Duke_rocket_right,
+  ActorID::Duke_flame_shot_up,
+  ActorID::Duke_flame_shot_down,
+  ActorID::Duke_flame_shot_left,
+  ActorID::Duke_flame_shot_right,
+  ActorID::Muzzle_flash_up,
+  ActorID::Muzzle_flash_down,
+  ActorID::Muzzle_flash_left,
+  ActorID::Muzzle_flash_right,
+
+  ActorID::Score_number_FX_100,
+  ActorID::Score_number_FX_500,
+  ActorID::Score_number_FX_2000,
+  ActorID::Score_number_FX_5000,
+  ActorID::Score_number_FX_10000,
+
+  // Effects used by many different actors' destruction effects
+  ActorID::Explosion_FX_1,
+  ActorID::Explosion_FX_2,
+  ActorID::Shot_impact_FX,
+  ActorID::Smoke_puff_FX,
+  ActorID::Smoke_cloud_FX,
+  ActorID::Biological_enemy_debris,
+
+  // Item boxes. Almost every level has some, and the box sprites are
+  // determined by the box' contents in configureItemBox().
+  ActorID::White_box_empty,
+  ActorID::Green_box_empty,
+  ActorID::Red_box_empty,
+  ActorID::Blue_box_empty,
+  ActorID::Yellow_fireball_FX,
+  ActorID::Green_fireball_FX,
+  ActorID::Blue_fireball_FX,
+};
+
+
+struct ActorDependency
+{
+  ActorID mActor;
+  ActorID mSpawnedActor;
+};
+
+// clang-format off
+constexpr ActorDependency ACTOR_DEPENDENCIES[] = {
+  {ActorID::Hoverbot, ActorID::Hoverbot_debris_1},
+  {ActorID::Hoverbot, ActorID::Hoverbot_debris_2},
+  {ActorID::Sentry_robot_generator, ActorID::Hoverbot},
+
+  {ActorID::Wall_mounted_flamethrower_LEFT, ActorID::Flame_thrower_fire_LEFT},
+  {ActorID::Wall_mounted_flamethrower_RIGHT,
+   ActorID::Flame_thrower_fire_RIGHT},
+
+  {ActorID::Rocket_launcher_turret, ActorID::Enemy_rocket_left},
+  {ActorID::Rocket_launcher_turret, ActorID::Enemy_rocket_up},
+  {ActorID::Rocket_launcher_turret, ActorID::Enemy_rocket_right},
+
+  {ActorID::Watchbot_container_carrier, ActorID::Watchbot_container},
+  {ActorID::Watchbot_container, ActorID::Watchbot},
+  {ActorID::Watchbot_container, ActorID::Watchbot_container_debris_1},
+  {ActorID::Watchbot_container, ActorID::Watchbot_container_debris_2},
+
+  {ActorID::Bomb_dropping_spaceship, ActorID::Napalm_bomb},
+  {ActorID::Napalm_bomb, ActorID::Nuclear_explosion},
+  {ActorID::Napalm_bomb_small, ActorID::Nuclear_explosion},
+  {ActorID::Red_box_bomb, ActorID::Fire_bomb_fire},
+
+  {ActorID::Green_slime_container, ActorID::Green_slime_blob},
+  {ActorID::Eyeball_thrower_LEFT, ActorID::Eyeball_projectile},
+  {ActorID::Spider, ActorID::Spider_shaken_off},
+  {ActorID::Windblown_spider_generator, ActorID::Spider_debris_2},
+  {ActorID::Windblown_spider_generator, ActorID::Spider_blowing_in_wind},
+  {ActorID::Metal_grabber_claw, ActorID::Metal_grabber_claw_debris_1},
+  {ActorID::Metal_grabber_claw, ActorID::Metal_grabber_claw_debris_2},
+  {ActorID::Rigelatin_soldier, ActorID::Rigelatin_soldier_projectile},
+  {ActorID::Aggressive_prisoner, ActorID::Prisoner_hand_debris},
+  {ActorID::Passive_prisoner, ActorID::Prisoner_hand_debris},
+
+  {ActorID::Spiked_green_creature_LEFT,
+   ActorID::Spiked_green_creature_eye_FX_LEFT},
+  {ActorID::Spiked_green_creature_LEFT,
+   ActorID::Spiked_green_creature_stone_debris_1_LEFT},
+  {ActorID::Spiked_green_creature_LEFT,
+   ActorID::Spiked_green_creature_stone_debris_2_LEFT},
+  {ActorID::Spiked_green_creature_LEFT,
+   ActorID::Spiked_green_creature_stone_debris_3_LEFT},
+  {ActorID::Spiked_green_creature_LEFT,
+   ActorID::Spiked_green_creature_stone_debris_4_LEFT},
+  {ActorID::Spiked_green_creature_RIGHT,
+   ActorID::Spiked_green_creature_eye_FX_RIGHT},
+  {ActorID::Spiked_green_creature_RIGHT,
+   ActorID::Spiked_green_creature_stone_debris_1_RIGHT},
+  {ActorID::Spiked_green_creature_RIGHT,
+   ActorID::Spiked_green_creature_stone_debris_2_RIGHT},
+  {ActorID::Spiked_green_creature_RIGHT,
+   ActorID::Spiked_green_creature_stone_debris_3_RIGHT},
+  {ActorID::Spiked_green_creature_RIGHT,
+   ActorID::Spiked_green_creature_stone_debris_4_RIGHT},
+
+  // Enemies shooting lasers, see spawnEnemyLaserShot()
+  {ActorID::Blue_guard_LEFT, ActorID::Enemy_laser_shot_LEFT},
+  {ActorID::Blue_guard_RIGHT, ActorID::Enemy_laser_shot_LEFT},
+  {ActorID::Blue_guard_using_a_terminal, ActorID::Enemy_laser_shot_LEFT},
+  {ActorID::Hovering_laser_turret, ActorID::Enemy_laser_shot_LEFT},
+  {ActorID::Laser_turret, ActorID::Enemy_laser_shot_LEFT},
+  {ActorID::Enemy_laser_shot_LEFT, ActorID::Enemy_laser_shot_RIGHT},
+  {ActorID::Enemy_laser_shot_LEFT, ActorID::Enemy_laser_muzzle_flash_1},
+  {ActorID::Enemy_laser_shot_LEFT, ActorID::Enemy_laser_muzzle_flash_2},
+
+  {ActorID::Red_box_cola, ActorID::Coke_can_debris_1},
+  {ActorID::Red_box_cola, ActorID::Coke_can_debris_2},
+  {ActorID::Red_box_6_pack_cola, ActorID::Coke_can_debris_1},
+  {ActorID::Red_box_6_pack_cola, ActorID::Coke_can_debris_2},
+  {ActorID::Blue_bonus_globe_1, ActorID::Bonus_globe_debris_1},
+  {ActorID::Blue_bonus_globe_2, ActorID::Bonus_globe_debris_1},
+  {ActorID::Blue_bonus_globe_3, ActorID::Bonus_globe_debris_1},
+  {ActorID::Blue_bonus_globe_4, ActorID::Bonus_globe_debris_1},
+  {ActorID::Bonus_globe_debris_1, ActorID::Bonus_globe_debris_2},
+
+  {ActorID::Nuclear_waste_can_green_slime_inside,
+   ActorID::Nuclear_waste_can_empty},
+  {ActorID::Nuclear_waste_can_empty, ActorID::Nuclear_waste_can_debris_1},
+  {ActorID::Nuclear_waste_can_empty, ActorID::Nuclear_waste_can_debris_2},
+  {ActorID::Nuclear_waste_can_empty, ActorID::Nuclear_waste_can_debris_3},
+  {ActorID::Nuclear_waste_can_empty, ActorID::Nuclear_waste_can_debris_4},
+
+  {ActorID::Electric_reactor, ActorID::Reactor_fire_LEFT},
+  {ActorID::Electric_reactor, ActorID::Reactor_fire_RIGHT},
+  {ActorID::Electric_reactor, ActorID::White_circle_flash_FX},
+  {ActorID::Missile_intact, ActorID::Missile_broken},
+  {ActorID::Missile_broken, ActorID::Missile_debris},
+  {ActorID::Missile_broken, ActorID::Nuclear_explosion},
+  {ActorID::Missile_broken, ActorID::White_circle_flash_FX},
+
+  {ActorID::Slime_pipe, ActorID::Slime_drop},
+  {ActorID::Water_drop_spawner, ActorID::Water_drop},
+  {ActorID::Special_hint_machine, ActorID::Special_hint_globe_icon},
+
+  {ActorID::Dukes_ship_LEFT, ActorID::Dukes_ship_RIGHT},
+  {ActorID::Dukes_ship_RIGHT, ActorID::Dukes_ship_after_exiting_LEFT},
+  {ActorID::Dukes_ship_RIGHT, ActorID::Dukes_ship_after_exiting_RIGHT},
+  {ActorID::Dukes_ship_RIGHT, ActorID::Dukes_ship_laser_shot},
+
+  {ActorID::BOSS_Episode_1, ActorID::Napalm_bomb_small},
+  {ActorID::BOSS_Episode_3, ActorID::Enemy_rocket_left},
+  {ActorID::BOSS_Episode_3, ActorID::Enemy_rocket_right},
+  {ActorID::BOSS_Episode_3, ActorID::Enemy_rocket_2_up},
+  {ActorID::BOSS_Episode_3, ActorID::Enemy_rocket_2_down},
+  {ActorID::BOSS_Episode_4, ActorID::BOSS_Episode_4_projectile},
+};
+// clang-format on
+
+} // namespace
+
+
+std::vector<ActorID>
+  actorsNeededForLevel(const std::vector<data::map::LevelData::Actor>& actors)
+{
+  std::vector<ActorID> result(
+    std::begin(ALWAYS_NEEDED_ACTORS), std::end(ALWAYS_NEEDED_ACTORS));
+  for (const auto& actor : actors)
+  {
+    result.push_back(actor.mID);
+  }
+
+  // Expand to the transitive closure. Each newly added actor is visited
+  // once, so the loop terminates even if the table contains cycles.
+  std::vector<ActorID> pending = result;
+  while (!pending.empty())
+  {
+    const auto id = pending.back();
+    pending.pop_back();
+
+    for (const auto& dependency : ACTOR_DEPENDENCIES)
+    {
+      if (
+        dependency.mActor == id &&
+        std::find(result.begin(), result.end(), dependency.mSpawnedActor) ==
+          result.end())
+      {
+        result.push_back(dependency.mSpawnedActor);
+        pending.push_back(dependency.mSpawnedActor);
+      }
+    }
+  }
+
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+} // namespace rigel::game_logic
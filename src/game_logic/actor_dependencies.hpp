@@ -0,0 +1,44 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "data/actor_ids.hpp"
+#include "data/map.hpp"
+
+#include <vector>
+
+
+namespace rigel::game_logic
+{
+
+/** Actors that can appear while playing a level with the given actors
+ *
+ * The result contains the given actors, everything they can spawn
+ * (directly or indirectly) according to a table of dependencies, and the
+ * actors that can appear in any level, like the player, projectiles,
+ * and common effects. It is sorted and free of duplicates.
+ *
+ * The table doesn't need to be exhaustive, since the SpriteFactory loads
+ * missing sprites on first use. But each missing entry causes a hitch
+ * during gameplay, so it should be kept in sync with the spawning code in
+ * entity_configuration.ipp, destruction_effect_specs.ipp, and the
+ * behavior controllers.
+ */
+std::vector<data::ActorID>
+  actorsNeededForLevel(const std::vector<data::map::LevelData::Actor>& actors);
+
+} // namespace rigel::game_logic
@@ -0,0 +1,91 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "actor_tag_index.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+
+namespace rigel::game_logic
+{
+
+using components::ActorTag;
+
+
+namespace
+{
+
+bool hasLowerIndex(const entityx::Entity& lhs, const entityx::Entity& rhs)
+{
+  return lhs.id().index() < rhs.id().index();
+}
+
+} // namespace
+
+
+ActorTagIndex::ActorTagIndex(entityx::EventManager& events)
+{
+  events.subscribe<entityx::ComponentAddedEvent<ActorTag>>(*this);
+  events.subscribe<entityx::ComponentRemovedEvent<ActorTag>>(*this);
+}
+
+
+base::ArrayView<entityx::Entity>
+  ActorTagIndex::entitiesOfType(const ActorTag::Type type) const
+{
+  return mEntitiesByType[static_cast<std::size_t>(type)];
+}
+
+
+std::size_t ActorTagIndex::count(const ActorTag::Type type) const
+{
+  return mEntitiesByType[static_cast<std::size_t>(type)].size();
+}
+
+
+void ActorTagIndex::receive(
+  const entityx::ComponentAddedEvent<ActorTag>& event)
+{
+  auto& entities = bucketFor(event.component->mType);
+  const auto iPosition = std::lower_bound(
+    entities.begin(), entities.end(), event.entity, hasLowerIndex);
+  entities.insert(iPosition, event.entity);
+}
+
+
+void ActorTagIndex::receive(
+  const entityx::ComponentRemovedEvent<ActorTag>& event)
+{
+  auto& entities = bucketFor(event.component->mType);
+  const auto iPosition = std::lower_bound(
+    entities.begin(), entities.end(), event.entity, hasLowerIndex);
+
+  assert(iPosition != entities.end() && *iPosition == event.entity);
+  entities.erase(iPosition);
+}
+
+
+std::vector<entityx::Entity>& ActorTagIndex::bucketFor(
+  const ActorTag::Type type)
+{
+  const auto index = static_cast<std::size_t>(type);
+  assert(index < NUM_TYPES);
+  return mEntitiesByType[index];
+}
+
+} // namespace rigel::game_logic
@@ -0,0 +1,70 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "base/array_view.hpp"
+#include "base/warnings.hpp"
+#include "game_logic/actor_tag.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <entityx/entityx.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+
+namespace rigel::game_logic
+{
+
+/** Keeps track of all entities with an ActorTag, grouped by tag type
+ *
+ * The index is kept up to date by listening to ActorTag component
+ * addition/removal events, so that finding all entities of a certain type
+ * doesn't require iterating over all entities in the world. Within each
+ * type, entities are ordered by entity index, i.e. in the same order that
+ * iterating the EntityManager would produce.
+ *
+ * Changing the type of an existing ActorTag in place is not supported.
+ * Remove and re-assign the component instead.
+ */
+class ActorTagIndex : public entityx::Receiver<ActorTagIndex>
+{
+public:
+  explicit ActorTagIndex(entityx::EventManager& events);
+
+  base::ArrayView<entityx::Entity>
+    entitiesOfType(components::ActorTag::Type type) const;
+  std::size_t count(components::ActorTag::Type type) const;
+
+  void receive(
+    const entityx::ComponentAddedEvent<components::ActorTag>& event);
+  void receive(
+    const entityx::ComponentRemovedEvent<components::ActorTag>& event);
+
+private:
+  static constexpr auto NUM_TYPES =
+    static_cast<std::size_t>(components::ActorTag::Type::FireBomb) + 1;
+
+  std::vector<entityx::Entity>& bucketFor(components::ActorTag::Type type);
+
+  std::array<std::vector<entityx::Entity>, NUM_TYPES> mEntitiesByType;
+};
+
+} // namespace rigel::game_logic
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "base/memory_arena.hpp"
 #include "base/warnings.hpp"
 #include "game_logic/global_dependencies.hpp"
 
@@ -23,7 +24,6 @@ RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
 RIGEL_RESTORE_WARNINGS
 
-#include <memory>
 #include <type_traits>
 
 namespace rigel::engine::events
@@ -163,7 +163,7 @@ class BehaviorController
 public:
   template <typename T>
   explicit BehaviorController(T controller)
-    : mpSelf(std::make_unique<Model<T>>(std::move(controller)))
+    : mpSelf(base::makeArenaUnique<Model<T>>(std::move(controller)))
   {
   }
 
@@ -230,7 +230,7 @@ private:
   {
     virtual ~Concept() = default;
 
-    virtual std::unique_ptr<Concept> clone() const = 0;
+    virtual base::ArenaUniquePtr<Concept> clone() const = 0;
 
     virtual void update(
       GlobalDependencies& dependencies,
@@ -265,9 +265,9 @@ private:
     {
     }
 
-    std::unique_ptr<Concept> clone() const override
+    base::ArenaUniquePtr<Concept> clone() const override
     {
-      return std::make_unique<Model>(mData);
+      return base::makeArenaUnique<Model>(mData);
     }
 
     void update(
@@ -311,7 +311,7 @@ private:
     T mData;
   };
 
-  std::unique_ptr<Concept> mpSelf;
+  base::ArenaUniquePtr<Concept> mpSelf;
 };
 
 } // namespace rigel::game_logic::components
@@ -35,7 +35,6 @@ BehaviorControllerSystem::BehaviorControllerSystem(
 {
   mDependencies.mpEvents->subscribe<events::ShootableDamaged>(*this);
   mDependencies.mpEvents->subscribe<events::ShootableKilled>(*this);
-  mDependencies.mpEvents->subscribe<engine::events::CollidedWithWorld>(*this);
 }
 
 
@@ -89,19 +88,25 @@ void BehaviorControllerSystem::receive(const events::ShootableKilled& event)
 }
 
 
-void BehaviorControllerSystem::receive(
-  const engine::events::CollidedWithWorld& event)
+void BehaviorControllerSystem::handleCollisions(
+  const engine::CollisionEventQueue& events)
 {
   using engine::components::Active;
   using game_logic::components::BehaviorController;
 
-  auto entity = event.mEntity;
-  if (
-    entity.has_component<BehaviorController>() &&
-    entity.has_component<Active>())
+  for (auto i = std::size_t{0}; i < events.size(); ++i)
   {
-    entity.component<BehaviorController>()->onCollision(
-      mDependencies, mGlobalState, event, entity);
+    const auto& event = events[i];
+
+    // A controller handling an earlier event might have destroyed the entity
+    auto entity = event.mEntity;
+    if (
+      entity.valid() && entity.has_component<BehaviorController>() &&
+      entity.has_component<Active>())
+    {
+      entity.component<BehaviorController>()->onCollision(
+        mDependencies, mGlobalState, event, entity);
+    }
   }
 }
 
@@ -16,16 +16,11 @@
 
 #pragma once
 
+#include "engine/physical_components.hpp"
 #include "game_logic/damage_components.hpp"
 #include "game_logic/global_dependencies.hpp"
 #include "game_logic/input.hpp"
 
-namespace rigel::engine::events
-{
-struct CollidedWithWorld;
-}
-
-
 namespace rigel::game_logic
 {
 
@@ -43,7 +38,9 @@ public:
 
   void receive(const events::ShootableDamaged& event);
   void receive(const events::ShootableKilled& event);
-  void receive(const engine::events::CollidedWithWorld& event);
+
+  /** Invokes onCollision() for all queued collisions, in queue order */
+  void handleCollisions(const engine::CollisionEventQueue& events);
 
 private:
   GlobalDependencies mDependencies;
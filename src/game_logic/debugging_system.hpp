@@ -41,6 +41,11 @@ public:
   void toggleWorldCollisionDataDisplay();
   void toggleGridDisplay();
 
+  bool isActive() const
+  {
+    return mShowBoundingBoxes || mShowWorldCollisionData || mShowGrid;
+  }
+
   void update(entityx::EntityManager& es, const base::Extents& viewPortSize);
 
 private:
@@ -0,0 +1,129 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "deferring_service_provider.hpp"
+
+#include <utility>
+
+
+namespace rigel::game_logic
+{
+
+DeferringServiceProvider::DeferringServiceProvider(
+  IGameServiceProvider* pServiceProvider)
+  : mpServiceProvider(pServiceProvider)
+{
+}
+
+
+void DeferringServiceProvider::flush()
+{
+  for (const auto& request : mPendingRequests)
+  {
+    request(*mpServiceProvider);
+  }
+
+  mPendingRequests.clear();
+}
+
+
+void DeferringServiceProvider::submit(Request request)
+{
+  if (mDeferring)
+  {
+    mPendingRequests.push_back(std::move(request));
+  }
+  else
+  {
+    request(*mpServiceProvider);
+  }
+}
+
+
+void DeferringServiceProvider::fadeOutScreen()
+{
+  mpServiceProvider->fadeOutScreen();
+}
+
+
+void DeferringServiceProvider::fadeInScreen()
+{
+  mpServiceProvider->fadeInScreen();
+}
+
+
+void DeferringServiceProvider::playSound(const data::SoundId id)
+{
+  submit([id](IGameServiceProvider& provider) { provider.playSound(id); });
+}
+
+
+void DeferringServiceProvider::stopSound(const data::SoundId id)
+{
+  submit([id](IGameServiceProvider& provider) { provider.stopSound(id); });
+}
+
+
+void DeferringServiceProvider::stopAllSounds()
+{
+  submit([](IGameServiceProvider& provider) { provider.stopAllSounds(); });
+}
+
+
+void DeferringServiceProvider::playMusic(const std::string& name)
+{
+  submit(
+    [name](IGameServiceProvider& provider) { provider.playMusic(name); });
+}
+
+
+void DeferringServiceProvider::stopMusic()
+{
+  submit([](IGameServiceProvider& provider) { provider.stopMusic(); });
+}
+
+
+void DeferringServiceProvider::scheduleGameQuit()
+{
+  mpServiceProvider->scheduleGameQuit();
+}
+
+
+void DeferringServiceProvider::switchGamePath(
+  const std::filesystem::path& newGamePath)
+{
+  mpServiceProvider->switchGamePath(newGamePath);
+}
+
+
+void DeferringServiceProvider::markCurrentFrameAsWidescreen()
+{
+  mpServiceProvider->markCurrentFrameAsWidescreen();
+}
+
+
+bool DeferringServiceProvider::isSharewareVersion() const
+{
+  return mpServiceProvider->isSharewareVersion();
+}
+
+
+const CommandLineOptions& DeferringServiceProvider::commandLineOptions() const
+{
+  return mpServiceProvider->commandLineOptions();
+}
+
+} // namespace rigel::game_logic
@@ -0,0 +1,67 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/game_service_provider.hpp"
+
+#include <functional>
+#include <vector>
+
+
+namespace rigel::game_logic
+{
+
+/** Service provider proxy for game logic running on a worker thread
+ *
+ * While deferring is enabled, sound and music requests are recorded instead
+ * of being forwarded, and later replayed in their original order by
+ * flush() on the main thread. Everything else is always forwarded directly,
+ * since game logic doesn't make use of it while running on the worker.
+ */
+class DeferringServiceProvider : public IGameServiceProvider
+{
+public:
+  explicit DeferringServiceProvider(IGameServiceProvider* pServiceProvider);
+
+  void setDeferring(bool deferring) { mDeferring = deferring; }
+  void flush();
+
+  void fadeOutScreen() override;
+  void fadeInScreen() override;
+
+  void playSound(data::SoundId id) override;
+  void stopSound(data::SoundId id) override;
+  void stopAllSounds() override;
+  void playMusic(const std::string& name) override;
+  void stopMusic() override;
+  void scheduleGameQuit() override;
+  void switchGamePath(const std::filesystem::path& newGamePath) override;
+  void markCurrentFrameAsWidescreen() override;
+  bool isSharewareVersion() const override;
+  const CommandLineOptions& commandLineOptions() const override;
+
+private:
+  using Request = std::function<void(IGameServiceProvider&)>;
+
+  void submit(Request request);
+
+  IGameServiceProvider* mpServiceProvider;
+  std::vector<Request> mPendingRequests;
+  bool mDeferring = false;
+};
+
+} // namespace rigel::game_logic
@@ -99,6 +99,10 @@ DemoPlayer::DemoPlayer(GameMode::Context context)
       std::nullopt,
       true,
       mFrames[0].mInput))
+  , mMemoryRegistration(
+      context.mpMemoryRegistry->add([this](MemoryReport& report) {
+        mpWorld->reportMemoryUsage(report);
+      }))
 {
 }
 
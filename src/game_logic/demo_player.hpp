@@ -17,6 +17,7 @@
 #pragma once
 
 #include "common/game_mode.hpp"
+#include "common/memory_accounting.hpp"
 #include "data/player_model.hpp"
 #include "engine/timing.hpp"
 #include "game_logic/input.hpp"
@@ -42,6 +43,8 @@ class DemoPlayer
 {
 public:
   explicit DemoPlayer(GameMode::Context context);
+  DemoPlayer(const DemoPlayer&) = delete;
+  DemoPlayer& operator=(const DemoPlayer&) = delete;
 
   void updateAndRender(engine::TimeDelta dt);
 
@@ -57,6 +60,8 @@ private:
   engine::TimeDelta mElapsedTime = 0;
 
   std::unique_ptr<GameWorld> mpWorld;
+
+  MemoryRegistry::Registration mMemoryRegistration;
 };
 
 } // namespace rigel::game_logic
@@ -141,27 +141,7 @@ void explodeMapSection(
 
 void moveTileRows(const base::Rect<int>& mapSection, data::map::Map& map)
 {
-  const auto startX = mapSection.left();
-  const auto startY = mapSection.top();
-  const auto width = mapSection.size.width;
-  const auto height = mapSection.size.height;
-
-  for (int layer = 0; layer < 2; ++layer)
-  {
-    for (int row = 0; row < height; ++row)
-    {
-      for (int col = 0; col < width; ++col)
-      {
-        const auto x = startX + col;
-        const auto sourceY = startY + (height - row - 1);
-        const auto targetY = sourceY + 1;
-
-        map.setTileAt(layer, x, targetY, map.tileAt(layer, x, sourceY));
-      }
-    }
-  }
-
-  map.clearSection(startX, startY, width, 1);
+  map.moveSection(mapSection, mapSection.topLeft + base::Vector{0, 1});
 }
 
 
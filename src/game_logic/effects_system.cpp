@@ -92,7 +92,6 @@ EffectsSystem::EffectsSystem(
   , mpParticles(pParticles)
 {
   events.subscribe<events::ShootableKilled>(*this);
-  events.subscribe<engine::events::CollidedWithWorld>(*this);
 }
 
 
@@ -137,10 +136,17 @@ void EffectsSystem::receive(const events::ShootableKilled& event)
 }
 
 
-void EffectsSystem::receive(const engine::events::CollidedWithWorld& event)
+void EffectsSystem::handleCollisions(const engine::CollisionEventQueue& events)
 {
-  triggerEffectsIfConditionMatches(
-    event.mEntity, DestructionEffects::TriggerCondition::OnCollision);
+  for (auto i = std::size_t{0}; i < events.size(); ++i)
+  {
+    const auto entity = events[i].mEntity;
+    if (entity.valid())
+    {
+      triggerEffectsIfConditionMatches(
+        entity, DestructionEffects::TriggerCondition::OnCollision);
+    }
+  }
 }
 
 
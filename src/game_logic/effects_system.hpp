@@ -18,6 +18,7 @@
 
 #include "base/spatial_types.hpp"
 #include "base/warnings.hpp"
+#include "engine/physical_components.hpp"
 #include "game_logic/effect_components.hpp"
 
 RIGEL_DISABLE_WARNINGS
@@ -30,11 +31,6 @@ struct IGameServiceProvider;
 }
 namespace rigel::engine
 {
-namespace events
-{
-struct CollidedWithWorld;
-}
-
 class RandomNumberGenerator;
 class ParticleSystem;
 } // namespace rigel::engine
@@ -73,7 +69,9 @@ public:
   void update(entityx::EntityManager& es);
 
   void receive(const events::ShootableKilled& event);
-  void receive(const engine::events::CollidedWithWorld& event);
+
+  /** Triggers OnCollision effects for all queued collisions */
+  void handleCollisions(const engine::CollisionEventQueue& events);
 
 private:
   void triggerEffectsIfConditionMatches(
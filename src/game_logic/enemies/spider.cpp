@@ -38,31 +38,21 @@ namespace
 constexpr auto SHAKE_OFF_THRESHOLD = 2;
 
 
-auto floorWalkerConfig()
-{
-  static auto config = []() {
-    behaviors::SimpleWalker::Configuration c;
-    c.mAnimStart = 3;
-    c.mAnimEnd = 5;
-    return c;
-  }();
-
-  return &config;
-}
+constexpr auto FLOOR_WALKER_CONFIG = []() {
+  behaviors::SimpleWalker::Configuration c;
+  c.mAnimStart = 3;
+  c.mAnimEnd = 5;
+  return c;
+}();
 
 
-auto ceilingWalkerConfig()
-{
-  static auto config = []() {
-    behaviors::SimpleWalker::Configuration c;
-    c.mAnimStart = 0;
-    c.mAnimEnd = 2;
-    c.mWalkOnCeiling = true;
-    return c;
-  }();
-
-  return &config;
-}
+constexpr auto CEILING_WALKER_CONFIG = []() {
+  behaviors::SimpleWalker::Configuration c;
+  c.mAnimStart = 0;
+  c.mAnimEnd = 2;
+  c.mWalkOnCeiling = true;
+  return c;
+}();
 
 
 int baseFrameForClinging(const SpiderClingPosition where)
@@ -154,7 +144,7 @@ void Spider::update(
     // If the spider is floating in the air upon spawning, do not animate.
     if (d.mpCollisionChecker->isTouchingCeiling(worldSpaceBox))
     {
-      mWalkerBehavior.mpConfig = ceilingWalkerConfig();
+      mWalkerBehavior.mpConfig = &CEILING_WALKER_CONFIG;
     }
   };
 
@@ -304,7 +294,7 @@ void Spider::walkOnFloor(entityx::Entity entity)
   auto& sprite = *entity.component<Sprite>();
   sprite.mFramesToRender[0] = 3;
 
-  mWalkerBehavior.mpConfig = floorWalkerConfig();
+  mWalkerBehavior.mpConfig = &FLOOR_WALKER_CONFIG;
 }
 
 } // namespace rigel::game_logic::behaviors
@@ -284,30 +284,20 @@ auto createBlueGuardBehavior(const ActorID id)
 }
 
 
-auto skeletonWalkerConfig()
-{
-  static auto config = []() {
-    behaviors::SimpleWalker::Configuration c;
-    c.mAnimEnd = 3;
-    c.mWalkAtFullSpeed = false;
-    return c;
-  }();
-
-  return &config;
-}
+constexpr auto SKELETON_WALKER_CONFIG = []() {
+  behaviors::SimpleWalker::Configuration c;
+  c.mAnimEnd = 3;
+  c.mWalkAtFullSpeed = false;
+  return c;
+}();
 
 
-auto turkeyWalkerConfig()
-{
-  static auto config = []() {
-    behaviors::SimpleWalker::Configuration c;
-    c.mAnimEnd = 1;
-    c.mWalkAtFullSpeed = true;
-    return c;
-  }();
-
-  return &config;
-}
+constexpr auto TURKEY_WALKER_CONFIG = []() {
+  behaviors::SimpleWalker::Configuration c;
+  c.mAnimEnd = 1;
+  c.mWalkAtFullSpeed = true;
+  return c;
+}();
 
 
 void configureBonusGlobe(
@@ -435,6 +425,29 @@ void addItemBoxDestroyEffect(ex::Entity entity)
   entity.assign<ItemContainer>(std::move(container));
 }
 
+
+/** Tells if configureEntity() produces different results for different
+ * instances of the same actor, e.g. because it depends on the position or
+ * consumes random numbers. These actors can't be spawned from a prototype.
+ *
+ * Needs to be kept in sync with configureEntity().
+ */
+bool configurationDependsOnInstance(const ActorID actorID)
+{
+  switch (actorID)
+  {
+    case ActorID::Force_field:
+    case ActorID::Wall_walker:
+    case ActorID::Metal_grabber_claw:
+    case ActorID::Ugly_green_bird:
+    case ActorID::Dynamic_geometry_3:
+      return true;
+
+    default:
+      return false;
+  }
+}
+
 } // namespace
 
 
@@ -745,7 +758,7 @@ void EntityFactory::configureEntity(
           Shootable{1, 0},
           DestructionEffects{LIVING_TURKEY_KILL_EFFECT_SPEC},
           cookedTurkeyContainer,
-          BehaviorController{behaviors::SimpleWalker{turkeyWalkerConfig()}},
+          BehaviorController{behaviors::SimpleWalker{&TURKEY_WALKER_CONFIG}},
           Active{},
           AppearsOnRadar{});
         addDefaultMovingBody(livingTurkeyContainer, boundingBox);
@@ -1408,7 +1421,7 @@ void EntityFactory::configureEntity(
         mpSpriteFactory->actorFrameRect(actorID, 0));
       entity.assign<PlayerDamaging>(Damage{1});
       entity.assign<BehaviorController>(
-        behaviors::SimpleWalker{skeletonWalkerConfig()});
+        behaviors::SimpleWalker{&SKELETON_WALKER_CONFIG});
       addDefaultMovingBody(entity, boundingBox);
       entity.assign<AppearsOnRadar>();
       break;
@@ -330,15 +330,7 @@ entityx::Entity EntityFactory::spawnSprite(
     entity.assign<BoundingBox>(mpSpriteFactory->actorFrameRect(actorID, 0));
   }
 
-  if (actorID == data::ActorID::Explosion_FX_1)
-  {
-    // TODO: Eliminate duplication with code in effects_system.cpp
-    const auto randomChoice = mpRandomGenerator->gen();
-    const auto soundId = randomChoice % 2 == 0
-      ? data::SoundId::AlternateExplosion
-      : data::SoundId::Explosion;
-    mpServiceProvider->playSound(soundId);
-  }
+  playSoundForSpawnedSprite(actorID);
 
   return entity;
 }
@@ -395,6 +387,23 @@ entityx::Entity EntityFactory::spawnProjectile(
 entityx::Entity EntityFactory::spawnActor(
   const data::ActorID id,
   const base::Vector& position)
+{
+  if (engine::hasAssociatedSprite(id) && !configurationDependsOnInstance(id))
+  {
+    auto entity = mpEntityManager->create();
+    entity.assign<WorldPosition>(position);
+    instantiatePrototype(entity, id);
+    playSoundForSpawnedSprite(id);
+    return entity;
+  }
+
+  return spawnActorWithoutPrototype(id, position);
+}
+
+
+entityx::Entity EntityFactory::spawnActorWithoutPrototype(
+  const data::ActorID id,
+  const base::Vector& position)
 {
   auto entity = spawnSprite(id, position);
   const auto boundingBox = mpSpriteFactory->actorFrameRect(id, 0);
@@ -431,6 +440,12 @@ void EntityFactory::createEntitiesForLevel(
     }
     entity.assign<WorldPosition>(position);
 
+    if (!actor.mAssignedArea && !configurationDependsOnInstance(actor.mID))
+    {
+      instantiatePrototype(entity, actor.mID);
+      continue;
+    }
+
     BoundingBox boundingBox;
     if (actor.mAssignedArea)
     {
@@ -452,6 +467,73 @@ void EntityFactory::createEntitiesForLevel(
 }
 
 
+void EntityFactory::instantiatePrototype(
+  entityx::Entity entity,
+  const data::ActorID actorID)
+{
+  auto iPrototype = mPrototypes.find(actorID);
+  if (iPrototype == mPrototypes.end())
+  {
+    iPrototype = mPrototypes.emplace(actorID, createPrototype(actorID)).first;
+  }
+
+  iPrototype->second.instantiate(entity);
+
+  // Keep spawn indices the same as when configuring the entity directly
+  ++mSpawnIndex;
+}
+
+
+EntityPrototype EntityFactory::createPrototype(const data::ActorID actorID)
+{
+  // The prototype is configured in a separate entity manager, so that it's
+  // not visible to any systems. This matches what createEntitiesForLevel()
+  // and spawnActor() do for actors without an assigned area, except for the
+  // position, which is assigned separately for each instance.
+  entityx::EventManager events;
+  entityx::EntityManager entities{events};
+
+  auto entity = entities.create();
+  entity.assign<WorldPosition>(0, 0);
+
+  BoundingBox boundingBox;
+  if (engine::hasAssociatedSprite(actorID))
+  {
+    entity.assign<Sprite>(createSpriteForId(actorID));
+    boundingBox = mpSpriteFactory->actorFrameRect(actorID, 0);
+  }
+
+  const auto spawnIndex = mSpawnIndex;
+  [[maybe_unused]] const auto numRandomNumbersUsed =
+    mpRandomGenerator->nextNumberIndex();
+  [[maybe_unused]] const auto numEntities = mpEntityManager->size();
+
+  configureEntity(entity, actorID, boundingBox);
+
+  // Building a prototype must not have any effect on the world
+  assert(mpRandomGenerator->nextNumberIndex() == numRandomNumbersUsed);
+  assert(mpEntityManager->size() == numEntities);
+  mSpawnIndex = spawnIndex;
+
+  entity.remove<WorldPosition>();
+  return EntityPrototype::capture(entity);
+}
+
+
+void EntityFactory::playSoundForSpawnedSprite(const data::ActorID actorID)
+{
+  if (actorID == data::ActorID::Explosion_FX_1)
+  {
+    // TODO: Eliminate duplication with code in effects_system.cpp
+    const auto randomChoice = mpRandomGenerator->gen();
+    const auto soundId = randomChoice % 2 == 0
+      ? data::SoundId::AlternateExplosion
+      : data::SoundId::Explosion;
+    mpServiceProvider->playSound(soundId);
+  }
+}
+
+
 entityx::Entity spawnOneShotSprite(
   IEntityFactory& factory,
   const ActorID id,
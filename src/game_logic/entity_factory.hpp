@@ -21,6 +21,7 @@
 #include "engine/base_components.hpp"
 #include "engine/isprite_factory.hpp"
 #include "engine/visual_components.hpp"
+#include "game_logic/entity_prototype.hpp"
 #include "game_logic/ientity_factory.hpp"
 #include "loader/level_loader.hpp"
 #include "renderer/renderer.hpp"
@@ -108,6 +109,14 @@ public:
   entityx::Entity
     spawnActor(data::ActorID actorID, const base::Vector& position) override;
 
+  /** Like spawnActor(), but always configures the entity from scratch
+   * instead of using a prototype. Entities created this way must be
+   * equivalent to those created from a prototype.
+   */
+  entityx::Entity spawnActorWithoutPrototype(
+    data::ActorID actorID,
+    const base::Vector& position);
+
   entityx::EntityManager& entityManager() override { return *mpEntityManager; }
 
 private:
@@ -125,6 +134,10 @@ private:
 
   engine::components::Sprite createSpriteComponent(data::ActorID mainId);
 
+  void instantiatePrototype(entityx::Entity entity, data::ActorID actorID);
+  EntityPrototype createPrototype(data::ActorID actorID);
+  void playSoundForSpawnedSprite(data::ActorID actorID);
+
   engine::ISpriteFactory* mpSpriteFactory;
   entityx::EntityManager* mpEntityManager;
   IGameServiceProvider* mpServiceProvider;
@@ -132,6 +145,10 @@ private:
   const data::GameOptions* mpOptions;
   int mSpawnIndex = 0;
   data::Difficulty mDifficulty;
+
+  // Fully configured components for each actor that has been spawned
+  // so far, for the current difficulty
+  std::unordered_map<data::ActorID, EntityPrototype> mPrototypes;
 };
 
 } // namespace rigel::game_logic
@@ -0,0 +1,231 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "entity_prototype.hpp"
+
+#include "common/global.hpp"
+#include "common/memory_accounting.hpp"
+#include "engine/base_components.hpp"
+#include "engine/life_time_components.hpp"
+#include "engine/physical_components.hpp"
+#include "engine/visual_components.hpp"
+#include "game_logic/actor_tag.hpp"
+#include "game_logic/behavior_controller.hpp"
+#include "game_logic/collectable_components.hpp"
+#include "game_logic/damage_components.hpp"
+#include "game_logic/dynamic_geometry_components.hpp"
+#include "game_logic/effect_components.hpp"
+#include "game_logic/interactive/enemy_radar.hpp"
+#include "game_logic/player/components.hpp"
+
+#include <cassert>
+#include <tuple>
+#include <type_traits>
+
+
+namespace rigel::game_logic
+{
+
+namespace
+{
+
+using namespace engine::components;
+using namespace game_logic::components;
+
+
+/** Pairs a component type with its name, for use in memory reports */
+template <typename T>
+struct ComponentEntry
+{
+  using Type = T;
+
+  const char* mName;
+};
+
+
+// clang-format off
+constexpr auto ALL_COMPONENTS = std::make_tuple(
+  ComponentEntry<AppearsOnRadar>{"AppearsOnRadar"},
+  ComponentEntry<ActivationSettings>{"ActivationSettings"},
+  ComponentEntry<Active>{"Active"},
+  ComponentEntry<ActorTag>{"ActorTag"},
+  ComponentEntry<AnimationLoop>{"AnimationLoop"},
+  ComponentEntry<AnimationSequence>{"AnimationSequence"},
+  ComponentEntry<AutoDestroy>{"AutoDestroy"},
+  ComponentEntry<BehaviorController>{"BehaviorController"},
+  ComponentEntry<BoundingBox>{"BoundingBox"},
+  ComponentEntry<CollectableItem>{"CollectableItem"},
+  ComponentEntry<CollectableItemForCheat>{"CollectableItemForCheat"},
+  ComponentEntry<CollidedWithWorld>{"CollidedWithWorld"},
+  ComponentEntry<CustomDamageApplication>{"CustomDamageApplication"},
+  ComponentEntry<DamageInflicting>{"DamageInflicting"},
+  ComponentEntry<DestructionEffects>{"DestructionEffects"},
+  ComponentEntry<DrawTopMost>{"DrawTopMost"},
+  ComponentEntry<ExtendedFrameList>{"ExtendedFrameList"},
+  ComponentEntry<Interactable>{"Interactable"},
+  ComponentEntry<ItemBounceEffect>{"ItemBounceEffect"},
+  ComponentEntry<ItemContainer>{"ItemContainer"},
+  ComponentEntry<MapGeometryLink>{"MapGeometryLink"},
+  ComponentEntry<MovementSequence>{"MovementSequence"},
+  ComponentEntry<MovingBody>{"MovingBody"},
+  ComponentEntry<Orientation>{"Orientation"},
+  ComponentEntry<OverrideDrawOrder>{"OverrideDrawOrder"},
+  ComponentEntry<PlayerDamaging>{"PlayerDamaging"},
+  ComponentEntry<PlayerProjectile>{"PlayerProjectile"},
+  ComponentEntry<RadarDish>{"RadarDish"},
+  ComponentEntry<Shootable>{"Shootable"},
+  ComponentEntry<SolidBody>{"SolidBody"},
+  ComponentEntry<Sprite>{"Sprite"},
+  ComponentEntry<SpriteCascadeSpawner>{"SpriteCascadeSpawner"},
+  ComponentEntry<TileDebris>{"TileDebris"},
+  ComponentEntry<WorldPosition>{"WorldPosition"});
+// clang-format on
+
+
+template <typename Func>
+void forEachComponent(Func&& func)
+{
+  std::apply(
+    [&func](const auto&... entries) { (func(entries), ...); }, ALL_COMPONENTS);
+}
+
+
+template <typename... Events>
+void registerEventFamilies()
+{
+  (entityx::Event<Events>::family(), ...);
+}
+
+
+
+
+template <typename Entry>
+using ComponentTypeOf = typename std::decay_t<Entry>::Type;
+
+} // namespace
+
+
+void copyAllComponents(entityx::Entity from, entityx::Entity to)
+{
+  forEachComponent([&](const auto& entry) {
+    using T = ComponentTypeOf<decltype(entry)>;
+
+    if (from.has_component<T>())
+    {
+      to.assign<T>(*from.component<const T>());
+    }
+  });
+
+  assert(from.component_mask() == to.component_mask());
+}
+
+
+EntityPrototype EntityPrototype::capture(entityx::Entity entity)
+{
+  EntityPrototype prototype;
+
+  forEachComponent([&](const auto& entry) {
+    using T = ComponentTypeOf<decltype(entry)>;
+
+    if (entity.has_component<T>())
+    {
+      prototype.mComponents.emplace_back(*entity.component<const T>());
+    }
+  });
+
+  return prototype;
+}
+
+
+void reportComponentCounts(
+  entityx::EntityManager& entities,
+  MemoryReport& report,
+  const std::string& category)
+{
+  forEachComponent([&](const auto& entry) {
+    using T = ComponentTypeOf<decltype(entry)>;
+
+    auto count = std::size_t{0};
+    entities.each<T>([&count](entityx::Entity, T&) { ++count; });
+
+    if (count > 0)
+    {
+      report.add(
+        category,
+        std::string{"Component: "} + entry.mName,
+        count * sizeof(T),
+        count);
+    }
+  });
+}
+
+
+void registerComponentTypes()
+{
+  forEachComponent([](const auto& entry) {
+    using T = ComponentTypeOf<decltype(entry)>;
+
+    entityx::EntityManager::component_family<T>();
+    registerEventFamilies<
+      entityx::ComponentAddedEvent<T>,
+      entityx::ComponentRemovedEvent<T>>();
+  });
+
+  registerEventFamilies<
+    entityx::EntityCreatedEvent,
+    entityx::EntityDestroyedEvent>();
+}
+
+
+void registerEventTypes()
+{
+  // clang-format off
+  registerEventFamilies<
+    events::AirLockOpened,
+    events::ElevatorAttachmentChanged,
+    events::ShootableDamaged,
+    events::ShootableKilled,
+    rigel::events::BossActivated,
+    rigel::events::BossDestroyed,
+    rigel::events::CheckPointActivated,
+    rigel::events::CloakExpired,
+    rigel::events::CloakPickedUp,
+    rigel::events::DoorOpened,
+    rigel::events::ExitReached,
+    rigel::events::MissileDetonated,
+    rigel::events::PlayerDied,
+    rigel::events::PlayerFiredShot,
+    rigel::events::PlayerMessage,
+    rigel::events::PlayerTeleported,
+    rigel::events::PlayerTookDamage,
+    rigel::events::RapidFirePickedUp,
+    rigel::events::ScreenFlash,
+    rigel::events::ScreenShake,
+    rigel::events::TutorialMessage>();
+  // clang-format on
+}
+
+
+void EntityPrototype::instantiate(entityx::Entity entity) const
+{
+  for (const auto& component : mComponents)
+  {
+    component.assignToEntity(entity);
+  }
+}
+
+} // namespace rigel::game_logic
@@ -0,0 +1,96 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "base/warnings.hpp"
+#include "game_logic/interactive/item_container.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <entityx/entityx.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <string>
+#include <vector>
+
+
+namespace rigel
+{
+class MemoryReport;
+}
+
+
+namespace rigel::game_logic
+{
+
+/** Copy all components of one entity to another one
+ *
+ * The target must not have any components yet. The two entities don't need
+ * to belong to the same entity manager.
+ */
+void copyAllComponents(entityx::Entity from, entityx::Entity to);
+
+
+/** Add the number of live instances of each component type to a report
+ *
+ * Only types with at least one instance are reported. The reported size
+ * doesn't include heap memory owned by components, nor entityx's pool
+ * overhead.
+ */
+void reportComponentCounts(
+  entityx::EntityManager& entities,
+  MemoryReport& report,
+  const std::string& category);
+
+
+/** Make entityx assign ids to all component types
+ *
+ * entityx assigns a type's id when the type is first used, which isn't
+ * thread-safe. Calling this once before using entity managers from multiple
+ * threads concurrently avoids racing on that. This also covers the events
+ * which entity managers emit on their own, i.e. creation/destruction of
+ * entities and adding/removing each type of component.
+ */
+void registerComponentTypes();
+
+
+/** Make entityx assign ids to all event types used by game logic
+ *
+ * Same as registerComponentTypes(), but for the events that game logic emits
+ * and subscribes to. Needs to be extended when adding a new event type.
+ */
+void registerEventTypes();
+
+
+/** Snapshot of an entity's components, for stamping out copies of it
+ *
+ * Capturing an entity determines its set of components once, so that
+ * instantiating the prototype only needs to assign the components which are
+ * actually present. The captured entity can be destroyed afterwards.
+ */
+class EntityPrototype
+{
+public:
+  static EntityPrototype capture(entityx::Entity entity);
+
+  void instantiate(entityx::Entity entity) const;
+
+private:
+  std::vector<ComponentHolder> mComponents;
+};
+
+} // namespace rigel::game_logic
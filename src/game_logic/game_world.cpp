@@ -16,8 +16,11 @@
 
 #include "game_world.hpp"
 
+#include "base/defer.hpp"
+#include "base/heap_allocation_counter.hpp"
 #include "base/match.hpp"
 #include "common/game_service_provider.hpp"
+#include "common/memory_accounting.hpp"
 #include "common/user_profile.hpp"
 #include "data/game_options.hpp"
 #include "data/game_traits.hpp"
@@ -38,6 +41,7 @@
 #include "ui/menu_element_renderer.hpp"
 #include "ui/utils.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <iomanip>
@@ -60,6 +64,29 @@ namespace
 
 constexpr auto BOSS_LEVEL_INTRO_MUSIC = "CALM.IMF";
 
+// Only a few logic update stages can run in parallel at a time, see
+// setUpLogicStages()
+constexpr auto NUM_PARALLEL_SYSTEM_THREADS = 2;
+
+// Data accessed by logic update stages, for declaring their dependencies
+using ResourceMask = base::StageScheduler::ResourceMask;
+
+// Entity manager and all components, plus the world state's arena
+constexpr auto ENTITIES = ResourceMask{1} << 0;
+// Event manager, and everything modified by event receivers. This includes
+// the message display.
+constexpr auto EVENTS = ResourceMask{1} << 1;
+// Order of (deferred) sound and music requests
+constexpr auto SERVICE_CALLS = ResourceMask{1} << 2;
+constexpr auto RANDOM_NUMBERS = ResourceMask{1} << 3;
+constexpr auto CAMERA = ResourceMask{1} << 4;
+// Animation counters, pending HUD animation steps and the odd frame flag
+constexpr auto FRAME_COUNTERS = ResourceMask{1} << 5;
+constexpr auto PARTICLES = ResourceMask{1} << 6;
+constexpr auto VISIBLE_SPRITES = ResourceMask{1} << 7;
+constexpr auto RENDER_SNAPSHOT = ResourceMask{1} << 8;
+constexpr auto EVERYTHING = ~ResourceMask{0};
+
 constexpr auto HEALTH_BAR_LABEL_START_X = 0;
 constexpr auto HEALTH_BAR_LABEL_START_Y = 0;
 constexpr auto HEALTH_BAR_TILE_INDEX = 4 * 40 + 1;
@@ -92,6 +119,29 @@ int healthOrZero(entityx::Entity entity)
 }
 
 
+/** Hands the physics system's queued collisions to their consumers
+ *
+ * This is one of the sync points of the logic update. Each consumer gets all
+ * collisions at once, in the order in which they happened: First, the
+ * effects system triggers OnCollision effects for all of them, then behavior
+ * controllers' onCollision() is invoked. Consumers skip collisions of
+ * entities which have been destroyed since then, including those destroyed
+ * by a consumer handling an earlier collision.
+ *
+ * ShootableDamaged and ShootableKilled remain regular events, emitted
+ * immediately. Their receivers adjust the shootable's health, or read its
+ * components right before it's destroyed, so the emitting code depends on
+ * them running synchronously.
+ */
+void dispatchCollisionEvents(WorldState& state)
+{
+  const auto& collisions = state.mPhysicsSystem.collisionEvents();
+  state.mEffectsSystem.handleCollisions(collisions);
+  state.mBehaviorControllerSystem.handleCollisions(collisions);
+  state.mPhysicsSystem.clearCollisionEvents();
+}
+
+
 auto localToGlobalTranslation(
   const renderer::Renderer* pRenderer,
   const base::Vector& translation)
@@ -177,15 +227,16 @@ void setupWidescreenHudOffset(
 }
 
 
-std::vector<base::Vector> collectRadarDots(
+void collectRadarDots(
   entityx::EntityManager& entities,
-  const base::Vector& playerPosition)
+  const base::Vector& playerPosition,
+  std::vector<base::Vector>& radarDots)
 {
   using engine::components::Active;
   using engine::components::WorldPosition;
   using game_logic::components::AppearsOnRadar;
 
-  std::vector<base::Vector> radarDots;
+  radarDots.clear();
 
   entities.each<WorldPosition, AppearsOnRadar, Active>(
     [&](
@@ -199,8 +250,6 @@ std::vector<base::Vector> collectRadarDots(
         radarDots.push_back(positionRelativeToPlayer);
       }
     });
-
-  return radarDots;
 }
 
 
@@ -217,53 +266,84 @@ std::string vec2String(const base::Point<ValueT>& vec, const int width)
 }
 
 
-struct WaterEffectArea
-{
-  base::Rect<int> mArea;
-  bool mIsAnimated;
-};
-
-
-std::vector<WaterEffectArea> collectWaterEffectAreas(
-  entityx::EntityManager& es,
+void collectWaterEffectAreas(
+  const ActorTagIndex& actorTagIndex,
   const base::Vector& cameraPosition,
-  const base::Extents& viewPortSize)
+  const base::Extents& viewPortSize,
+  std::vector<WaterEffectArea>& result)
 {
   using engine::components::BoundingBox;
   using game_logic::components::ActorTag;
 
-  std::vector<WaterEffectArea> result;
+  result.clear();
 
   const auto screenBox = BoundingBox{cameraPosition, viewPortSize};
 
-  es.each<ActorTag, WorldPosition, BoundingBox>([&](
-                                                  entityx::Entity,
-                                                  const ActorTag& tag,
-                                                  const WorldPosition& position,
-                                                  const BoundingBox& bbox) {
-    using T = ActorTag::Type;
+  auto addIfVisible = [&](entityx::Entity entity, const bool isAnimated) {
+    if (!entity.has_component<BoundingBox>())
+    {
+      return;
+    }
+
+    const auto worldSpaceBbox = engine::toWorldSpace(
+      *entity.component<const BoundingBox>(),
+      *entity.component<const WorldPosition>());
 
-    const auto isWaterArea =
-      tag.mType == T::AnimatedWaterArea || tag.mType == T::WaterArea;
-    if (isWaterArea)
+    if (screenBox.intersects(worldSpaceBbox))
     {
-      const auto worldSpaceBbox = engine::toWorldSpace(bbox, position);
+      const auto topLeftPx = data::tileVectorToPixelVector(
+        worldSpaceBbox.topLeft - cameraPosition);
+      const auto sizePx = data::tileExtentsToPixelExtents(worldSpaceBbox.size);
 
-      if (screenBox.intersects(worldSpaceBbox))
-      {
-        const auto topLeftPx = data::tileVectorToPixelVector(
-          worldSpaceBbox.topLeft - cameraPosition);
-        const auto sizePx =
-          data::tileExtentsToPixelExtents(worldSpaceBbox.size);
-        const auto hasAnimatedSurface = tag.mType == T::AnimatedWaterArea;
-
-        result.push_back(
-          WaterEffectArea{{topLeftPx, sizePx}, hasAnimatedSurface});
-      }
+      result.push_back(WaterEffectArea{{topLeftPx, sizePx}, isAnimated});
     }
-  });
+  };
+
+  // Merge both types of water area into entity order, so that overlapping
+  // areas are drawn in the same order as before the index existed.
+  const auto waterAreas =
+    actorTagIndex.entitiesOfType(ActorTag::Type::WaterArea);
+  const auto animatedWaterAreas =
+    actorTagIndex.entitiesOfType(ActorTag::Type::AnimatedWaterArea);
+
+  auto i = std::size_t{0};
+  auto j = std::size_t{0};
+  while (i < waterAreas.size() || j < animatedWaterAreas.size())
+  {
+    const auto takeAnimated = i == waterAreas.size() ||
+      (j < animatedWaterAreas.size() &&
+       animatedWaterAreas[j].id().index() < waterAreas[i].id().index());
+
+    if (takeAnimated)
+    {
+      addIfVisible(animatedWaterAreas[j++], true);
+    }
+    else
+    {
+      addIfVisible(waterAreas[i++], false);
+    }
+  }
+}
+
+
+base::Rect<int> boundingBox(const std::vector<WaterEffectArea>& areas)
+{
+  assert(!areas.empty());
+
+  auto left = areas.front().mArea.left();
+  auto top = areas.front().mArea.top();
+  auto right = areas.front().mArea.right();
+  auto bottom = areas.front().mArea.bottom();
 
-  return result;
+  for (const auto& area : areas)
+  {
+    left = std::min(left, area.mArea.left());
+    top = std::min(top, area.mArea.top());
+    right = std::max(right, area.mArea.right());
+    bottom = std::max(bottom, area.mArea.bottom());
+  }
+
+  return base::Rect<int>{{left, top}, {right - left + 1, bottom - top + 1}};
 }
 
 } // namespace
@@ -275,9 +355,11 @@ GameWorld::GameWorld(
   GameMode::Context context,
   std::optional<base::Vector> playerPositionOverride,
   bool showWelcomeMessage,
-  const PlayerInput& initialInput)
+  const PlayerInput& initialInput,
+  const data::map::LevelData* pPreloadedLevel)
   : mpRenderer(context.mpRenderer)
-  , mpServiceProvider(context.mpServiceProvider)
+  , mDeferringServiceProvider(context.mpServiceProvider)
+  , mpServiceProvider(&mDeferringServiceProvider)
   , mpUiSpriteSheet(context.mpUiSpriteSheet)
   , mpTextRenderer(context.mpUiRenderer)
   , mpPlayerModel(pPlayerModel)
@@ -285,6 +367,7 @@ GameWorld::GameWorld(
   , mpResources(context.mpResources)
   , mpSpriteFactory(context.mpSpriteFactory)
   , mSessionId(sessionId)
+  , mpPreloadedLevel(pPreloadedLevel)
   , mPlayerModelAtLevelStart(*mpPlayerModel)
   , mHudRenderer(
       sessionId.mLevel + 1,
@@ -293,19 +376,28 @@ GameWorld::GameWorld(
       *context.mpResources,
       context.mpUiSpriteSheet)
   , mMessageDisplay(mpServiceProvider, context.mpUiRenderer)
-  , mWaterEffectBuffer(
-      renderer::createFullscreenRenderTarget(mpRenderer, *mpOptions))
+  , mRenderSnapshot(mMessageDisplay)
+  , mPendingRenderSnapshot(mMessageDisplay)
   , mLowResLayer(
       mpRenderer,
       renderer::determineWidescreenViewPort(mpRenderer).mWidthPx,
       data::GameTraits::viewPortHeightPx)
+  , mFrameCache(
+      renderer::createFullscreenRenderTarget(mpRenderer, *mpOptions))
   , mPreviousWindowSize(mpRenderer->windowSize())
   , mWidescreenModeWasOn(widescreenModeOn())
   , mPerElementUpscalingWasEnabled(mpOptions->mPerElementUpscalingEnabled)
+  , mSystemThreadPool(
+      context.mpServiceProvider->commandLineOptions().mParallelSystems
+        ? NUM_PARALLEL_SYSTEM_THREADS
+        : 0)
+  , mLogicStages(&mSystemThreadPool)
 {
   using namespace std::chrono;
   auto before = high_resolution_clock::now();
 
+  setUpLogicStages();
+
   loadLevel(initialInput);
 
   if (playerPositionOverride)
@@ -356,8 +448,7 @@ std::set<data::Bonus> GameWorld::achievedBonuses() const
     bonuses.insert(data::Bonus::NoDamageTaken);
   }
 
-  const auto counts = countBonusRelatedItems(
-    const_cast<entityx::EntityManager&>(mpState->mEntities));
+  const auto counts = countBonusRelatedItems(mpState->mActorTagIndex);
 
   if (mpState->mBonusInfo.mInitialCameraCount > 0 && counts.mCameraCount == 0)
   {
@@ -550,7 +641,28 @@ void GameWorld::createNewState()
     unsubscribe(mpState->mEventManager);
   }
 
-  mpState = std::make_unique<WorldState>(
+  mpState = makeWorldState();
+
+  subscribe(mpState->mEventManager);
+}
+
+
+std::unique_ptr<WorldState> GameWorld::makeWorldState()
+{
+  if (mpPreloadedLevel)
+  {
+    return std::make_unique<WorldState>(
+      mpServiceProvider,
+      mpRenderer,
+      mpResources,
+      mpPlayerModel,
+      mpOptions,
+      mpSpriteFactory,
+      mSessionId,
+      data::map::LevelData{*mpPreloadedLevel});
+  }
+
+  return std::make_unique<WorldState>(
     mpServiceProvider,
     mpRenderer,
     mpResources,
@@ -558,8 +670,6 @@ void GameWorld::createNewState()
     mpOptions,
     mpSpriteFactory,
     mSessionId);
-
-  subscribe(mpState->mEventManager);
 }
 
 
@@ -610,93 +720,310 @@ bool GameWorld::needsPerElementUpscaling() const
 
 void GameWorld::updateGameLogic(const PlayerInput& input)
 {
+  prepareLogicUpdates();
+  runLogicUpdate(input);
+  publishLogicUpdates();
+}
+
+
+void GameWorld::prepareLogicUpdates()
+{
+  updateViewPortSizes();
+}
+
+
+void GameWorld::runLogicUpdate(const PlayerInput& input)
+{
+  const auto arenaScope = base::ArenaScope{&mpState->mArena};
+  const auto allocationCountAtStart = base::heapAllocationCount();
+
+  mDeferringServiceProvider.setDeferring(true);
+  const auto stopDeferring = base::defer(
+    [this]() { mDeferringServiceProvider.setDeferring(false); });
+
   mpState->mBackdropFlashColor = std::nullopt;
   mpState->mScreenFlashColor = std::nullopt;
 
-  if (mpState->mReactorDestructionFramesElapsed)
-  {
-    updateReactorDestructionEvent();
-  }
+  mpCurrentInput = &input;
+  mLogicStages.run();
+  mpCurrentInput = nullptr;
 
-  if (mpState->mEarthQuakeEffect)
+  if (allocationCountAtStart)
   {
-    mpState->mEarthQuakeEffect->update();
+    mPendingHeapAllocationCount =
+      *base::heapAllocationCount() - *allocationCountAtStart;
   }
+}
 
-  mHudRenderer.updateAnimation();
-  mMessageDisplay.update();
 
-  if (mpState->mActiveBossEntity && mpState->mBossDeathAnimationStartPending)
-  {
-    engine::removeSafely<game_logic::components::PlayerDamaging>(
-      mpState->mActiveBossEntity);
-    mpState->mActiveBossEntity
-      .replace<game_logic::components::BehaviorController>(
-        behaviors::DyingBoss{mSessionId.mEpisode});
-    mpState->mBossDeathAnimationStartPending = false;
-  }
+void GameWorld::setUpLogicStages()
+{
+  mLogicStages.addStage(0, EVENTS | SERVICE_CALLS, [this]() {
+    if (mpState->mReactorDestructionFramesElapsed)
+    {
+      updateReactorDestructionEvent();
+    }
+  });
 
-  const auto& viewPortSize = widescreenModeOn()
-    ? viewPortSizeWideScreen(mpRenderer)
-    : data::GameTraits::mapViewPortSize;
+  mLogicStages.addStage(0, EVENTS | RANDOM_NUMBERS | SERVICE_CALLS, [this]() {
+    if (mpState->mEarthQuakeEffect)
+    {
+      mpState->mEarthQuakeEffect->update();
+    }
+  });
+
+  mLogicStages.addStage(0, EVENTS | SERVICE_CALLS, [this]() {
+    mMessageDisplay.update();
+  });
+
+  mLogicStages.addStage(0, ENTITIES | EVENTS, [this]() {
+    auto& state = *mpState;
+    if (state.mActiveBossEntity && state.mBossDeathAnimationStartPending)
+    {
+      engine::removeSafely<game_logic::components::PlayerDamaging>(
+        state.mActiveBossEntity);
+      state.mActiveBossEntity
+        .replace<game_logic::components::BehaviorController>(
+          behaviors::DyingBoss{mSessionId.mEpisode});
+      state.mBossDeathAnimationStartPending = false;
+    }
+  });
+
+  mLogicStages.addStage(0, FRAME_COUNTERS, [this]() {
+    auto& state = *mpState;
+    ++mNumPendingHudAnimationSteps;
+    ++state.mMapAnimationFrame;
+    ++state.mWaterAnimStep;
+    if (state.mWaterAnimStep >= 4)
+    {
+      state.mWaterAnimStep = 0;
+    }
+  });
 
-  mpState->mMapRenderer.updateAnimatedMapTiles();
-  engine::updateAnimatedSprites(mpState->mEntities);
-  ++mpState->mWaterAnimStep;
-  if (mpState->mWaterAnimStep >= 4)
+  // Removes finished animation sequences, which emits events
+  mLogicStages.addStage(0, ENTITIES | EVENTS, [this]() {
+    engine::updateAnimatedSprites(mpState->mEntities);
+  });
+
+  // These systems work on arbitrary entities, share the random number
+  // generator, and emit events. There would be nothing to gain from
+  // declaring their accesses individually, so they make up a single stage.
+  mLogicStages.addStage(EVERYTHING, EVERYTHING, [this]() {
+    auto& state = *mpState;
+    const auto& input = *mpCurrentInput;
+    const auto& viewPortSize = mViewPortSize;
+
+    state.mPlayerInteractionSystem.updatePlayerInteraction(
+      input, state.mEntities);
+    state.mPlayer.update(input);
+    state.mCamera.update(input, viewPortSize);
+
+    engine::markActiveEntities(
+      state.mWorldBounds, state.mCamera.position(), viewPortSize);
+    state.mBehaviorControllerSystem.update(
+      state.mEntities,
+      PerFrameState{
+        input,
+        viewPortSize,
+        state.mRadarDishCounter.numRadarDishes(),
+        state.mIsOddFrame,
+        state.mEarthQuakeEffect && state.mEarthQuakeEffect->isQuaking()});
+
+    // Collisions are handled at two sync points, after each physics phase.
+    // Entities spawned while handling the first batch are collected for
+    // phase 2 only afterwards, so like those spawned by the second batch,
+    // they start moving in the next frame.
+    state.mPhysicsSystem.update(state.mEntities);
+    dispatchCollisionEvents(state);
+    state.mPhysicsSystem.startCollectingForPhase2();
+
+    // Collect items after physics, so that any collectible
+    // items are in their final positions for this frame.
+    state.mItemContainerSystem.updateItemBounce(state.mEntities);
+    state.mPlayerInteractionSystem.updateItemCollection(state.mEntities);
+    state.mPlayerDamageSystem.update(state.mEntities);
+    state.mDamageInflictionSystem.update(state.mEntities);
+    state.mItemContainerSystem.update(state.mEntities);
+    state.mPlayerProjectileSystem.update(state.mEntities);
+
+    state.mEffectsSystem.update(state.mEntities);
+    state.mLifeTimeSystem.update(
+      state.mEntities, state.mCamera.position(), viewPortSize);
+
+    // Now process any MovingBody objects that have been spawned after phase 1
+    state.mPhysicsSystem.updatePhase2(state.mEntities);
+    dispatchCollisionEvents(state);
+  });
+
+  mLogicStages.addStage(0, PARTICLES, [this]() {
+    mpState->mParticles.update();
+  });
+
+  mLogicStages.addStage(ENTITIES | CAMERA, VISIBLE_SPRITES, [this]() {
+    auto& state = *mpState;
+    state.mSpriteRenderingSystem.update(
+      state.mEntities, mSpriteViewPortSize, state.mCamera.position());
+  });
+
+  mLogicStages.addStage(0, FRAME_COUNTERS, [this]() {
+    mpState->mIsOddFrame = !mpState->mIsOddFrame;
+  });
+
+  mLogicStages.addStage(EVERYTHING, RENDER_SNAPSHOT, [this]() {
+    captureRenderSnapshot(mPendingRenderSnapshot);
+  });
+}
+
+
+void GameWorld::publishLogicUpdates()
+{
+  std::swap(mRenderSnapshot, mPendingRenderSnapshot);
+  mHeapAllocationCount = mPendingHeapAllocationCount;
+
+  for (; mNumPendingHudAnimationSteps > 0; --mNumPendingHudAnimationSteps)
   {
-    mpState->mWaterAnimStep = 0;
+    mHudRenderer.updateAnimation();
   }
 
-  mpState->mPlayerInteractionSystem.updatePlayerInteraction(
-    input, mpState->mEntities);
-  mpState->mPlayer.update(input);
-  mpState->mCamera.update(input, viewPortSize);
-
-  engine::markActiveEntities(
-    mpState->mEntities, mpState->mCamera.position(), viewPortSize);
-  mpState->mBehaviorControllerSystem.update(
-    mpState->mEntities,
-    PerFrameState{
-      input,
-      viewPortSize,
-      mpState->mRadarDishCounter.numRadarDishes(),
-      mpState->mIsOddFrame,
-      mpState->mEarthQuakeEffect && mpState->mEarthQuakeEffect->isQuaking()});
-
-  mpState->mPhysicsSystem.updatePhase1(mpState->mEntities);
-
-  // Collect items after physics, so that any collectible
-  // items are in their final positions for this frame.
-  mpState->mItemContainerSystem.updateItemBounce(mpState->mEntities);
-  mpState->mPlayerInteractionSystem.updateItemCollection(mpState->mEntities);
-  mpState->mPlayerDamageSystem.update(mpState->mEntities);
-  mpState->mDamageInflictionSystem.update(mpState->mEntities);
-  mpState->mItemContainerSystem.update(mpState->mEntities);
-  mpState->mPlayerProjectileSystem.update(mpState->mEntities);
-
-  mpState->mEffectsSystem.update(mpState->mEntities);
-  mpState->mLifeTimeSystem.update(
-    mpState->mEntities, mpState->mCamera.position(), viewPortSize);
-
-  // Now process any MovingBody objects that have been spawned after phase 1
-  mpState->mPhysicsSystem.updatePhase2(mpState->mEntities);
-
-  mpState->mParticles.update();
+  mDeferringServiceProvider.flush();
+
+  // Entities spawned during the update might use sprites which weren't part
+  // of the level's atlas. Their images can only be uploaded here, on the
+  // render thread.
+  mpSpriteFactory->loadRequestedSprites();
+  invalidateFrameCache();
+}
+
+
+void GameWorld::refreshRenderSnapshot()
+{
+  mpSpriteFactory->loadRequestedSprites();
+  updateViewPortSizes();
+  mpState->mSpriteRenderingSystem.update(
+    mpState->mEntities, mSpriteViewPortSize, mpState->mCamera.position());
+  captureRenderSnapshot(mRenderSnapshot);
+  invalidateFrameCache();
+}
+
+
+bool GameWorld::isPlayerInShip() const
+{
+  return mRenderSnapshot.mPlayerInShip;
+}
+
+
+void GameWorld::updateViewPortSizes()
+{
+  mViewPortSize = widescreenModeOn() ? viewPortSizeWideScreen(mpRenderer)
+                                     : data::GameTraits::mapViewPortSize;
 
   // As far as game logic is concerned, the viewport is always the same height
   // regardless of widescreen mode being on or off. But since the HUD doesn't
   // cover the entire width of the screen in widescreen mode, we need a larger
   // viewport height for rendering to ensure that sprites in the lower left of
   // the screen are rendered.
-  const auto renderingViewPortSize = widescreenModeOn()
-    ? base::
-        Extents{viewPortSize.width, data::GameTraits::viewPortHeightTiles - 1}
-    : viewPortSize;
-  mpState->mSpriteRenderingSystem.update(
-    mpState->mEntities, renderingViewPortSize, mpState->mCamera.position());
+  mSpriteViewPortSize = widescreenModeOn()
+    ? base::Extents{
+        mViewPortSize.width, data::GameTraits::viewPortHeightTiles - 1}
+    : mViewPortSize;
+
+  mRenderingViewPortSize = renderingViewPortSize();
+}
+
 
-  mpState->mIsOddFrame = !mpState->mIsOddFrame;
+/** Bring the map copy used by render snapshots up to date
+ *
+ * Render snapshots can't reference the live map, since it keeps changing while
+ * a snapshot is being rendered. Copying the whole map on every change is
+ * expensive though, and most changes only touch a small area (e.g. a
+ * destroyed tile). We therefore keep two copies: the current one, which might
+ * still be in use by the renderer, and a spare one, which is one revision
+ * behind the current copy. When the live map is only one modification ahead
+ * of the current copy and nobody else holds on to the spare one, we bring the
+ * spare copy up to date by copying just the sections which differ, and then
+ * swap the two.
+ */
+void GameWorld::updateMapForRendering()
+{
+  const auto& map = mpState->mMap;
+
+  if (mpMapForRendering && mpMapForRendering->revision() == map.revision())
+  {
+    return;
+  }
+
+  const auto canPatchSpare = mpMapForRendering && mpSpareMapForRendering &&
+    mpSpareMapForRendering.use_count() == 1 && mSpareMapOutdatedSection &&
+    mpMapForRendering->revision() == map.previousRevision();
+
+  if (canPatchSpare)
+  {
+    mpSpareMapForRendering->updateFrom(
+      map, {*mSpareMapOutdatedSection, map.lastModifiedSection()});
+    std::swap(mpMapForRendering, mpSpareMapForRendering);
+    mSpareMapOutdatedSection = map.lastModifiedSection();
+    return;
+  }
+
+  const auto previousCopyIsOneBehind = mpMapForRendering &&
+    mpMapForRendering->revision() == map.previousRevision();
+  mSpareMapOutdatedSection = previousCopyIsOneBehind
+    ? std::optional<base::Rect<int>>{map.lastModifiedSection()}
+    : std::nullopt;
+  mpSpareMapForRendering = std::move(mpMapForRendering);
+  mpMapForRendering = std::make_shared<data::map::Map>(map);
+}
+
+
+void GameWorld::captureRenderSnapshot(RenderSnapshot& snapshot)
+{
+  using game_logic::components::TileDebris;
+
+  auto& state = *mpState;
+  const auto& cameraPosition = state.mCamera.position();
+
+  // Drop the snapshot's reference first, so that the map it was using can be
+  // recycled by updateMapForRendering()
+  snapshot.mpMap.reset();
+  updateMapForRendering();
+
+  snapshot.mCameraPosition = cameraPosition;
+  snapshot.mpMap = mpMapForRendering;
+  snapshot.mMapAnimationFrame = state.mMapAnimationFrame;
+  snapshot.mBackdropSwitched = state.mBackdropSwitched;
+
+  const auto& sprites = state.mSpriteRenderingSystem.visibleSprites();
+  snapshot.mSprites.assign(sprites.begin(), sprites.end());
+  snapshot.mNumRegularSprites =
+    state.mSpriteRenderingSystem.numRegularSprites();
+
+  snapshot.mTileDebris.clear();
+  state.mEntities.each<TileDebris, WorldPosition>(
+    [&](entityx::Entity, const TileDebris& debris, const WorldPosition& pos) {
+      snapshot.mTileDebris.push_back({debris.mTileIndex, pos});
+    });
+
+  state.mParticles.collectVertices(cameraPosition, snapshot.mParticleVertices);
+  collectWaterEffectAreas(
+    state.mActorTagIndex,
+    cameraPosition,
+    mRenderingViewPortSize,
+    snapshot.mWaterEffectAreas);
+  snapshot.mWaterAnimStep = state.mWaterAnimStep;
+
+  snapshot.mScreenFlashColor = state.mScreenFlashColor;
+  snapshot.mBackdropFlashColor = state.mBackdropFlashColor;
+  snapshot.mScreenShakeOffsetX = state.mScreenShakeOffsetX;
+
+  snapshot.mPlayerModel = *mpPlayerModel;
+  collectRadarDots(
+    state.mEntities, state.mPlayer.orientedPosition(), snapshot.mRadarDots);
+  snapshot.mBossHealth = state.mActiveBossEntity
+    ? std::optional<BossHealthInfo>{BossHealthInfo{
+        healthOrZero(state.mActiveBossEntity), state.mBossStartingHealth}}
+    : std::nullopt;
+  snapshot.mMessageDisplay = mMessageDisplay;
+  snapshot.mPlayerInShip = state.mPlayer.stateIs<InShip>();
 }
 
 
@@ -707,11 +1034,104 @@ void GameWorld::render()
     mpOptions->mPerElementUpscalingEnabled != mPerElementUpscalingWasEnabled ||
     mPreviousWindowSize != mpRenderer->windowSize())
   {
-    mWaterEffectBuffer =
+    mFrameCache =
       renderer::createFullscreenRenderTarget(mpRenderer, *mpOptions);
+    invalidateFrameCache();
   }
 
-  auto drawWorld = [this](const base::Extents& viewPortSize) {
+  if (widescreenModeOn())
+  {
+    mpServiceProvider->markCurrentFrameAsWidescreen();
+  }
+
+  if (!mFrameCacheValid)
+  {
+    mFrameCachePass = determineFrameCachePass();
+  }
+
+  if (!mFrameCachePass)
+  {
+    renderLayers(RenderPass::All);
+  }
+  else
+  {
+    if (!mFrameCacheValid)
+    {
+      const auto saved = mFrameCache.bind();
+
+      {
+        const auto clipRectGuard = renderer::saveState(mpRenderer);
+        mpRenderer->setClipRect({});
+        mpRenderer->clear(
+          *mFrameCachePass == RenderPass::All ? base::Color{0, 0, 0, 255}
+                                              : base::Color{0, 0, 0, 0});
+      }
+
+      renderLayers(*mFrameCachePass);
+      mFrameCacheValid = true;
+    }
+
+    if (*mFrameCachePass == RenderPass::AllButBackdrop)
+    {
+      renderLayers(RenderPass::BackdropOnly);
+    }
+
+    // The cache is drawn into after clearing it to transparent, so for the
+    // AllButBackdrop pass, it holds premultiplied colors. For the opaque All
+    // pass, both blend modes give the same result.
+    auto saved = renderer::saveState(mpRenderer);
+    mpRenderer->setGlobalScale({1.0f, 1.0f});
+    mpRenderer->setGlobalTranslation({});
+    mpRenderer->setClipRect({});
+    mpRenderer->setBlendMode(renderer::BlendMode::PremultipliedAlpha);
+    mFrameCache.render(0, 0);
+  }
+
+  mWidescreenModeWasOn = widescreenModeOn();
+  mPerElementUpscalingWasEnabled = mpOptions->mPerElementUpscalingEnabled;
+  mPreviousWindowSize = mpRenderer->windowSize();
+
+  // Screen shake only applies to a single display frame
+  if (mRenderSnapshot.mScreenShakeOffsetX != 0)
+  {
+    mRenderSnapshot.mScreenShakeOffsetX = 0;
+    invalidateFrameCache();
+  }
+}
+
+
+auto GameWorld::determineFrameCachePass() const -> std::optional<RenderPass>
+{
+  const auto& snapshot = mRenderSnapshot;
+  if (
+    !mpState->mMapRenderer.hasAutoScrollingBackdrop() ||
+    snapshot.mBackdropFlashColor || snapshot.mScreenFlashColor)
+  {
+    return RenderPass::All;
+  }
+
+  // Water effects need to be applied on top of the backdrop, so we can't
+  // keep the backdrop separate from the rest of the world in that case.
+  if (!snapshot.mWaterEffectAreas.empty())
+  {
+    return std::nullopt;
+  }
+
+  return RenderPass::AllButBackdrop;
+}
+
+
+void GameWorld::invalidateFrameCache()
+{
+  mFrameCacheValid = false;
+}
+
+
+void GameWorld::renderLayers(const RenderPass pass)
+{
+  const auto& snapshot = mRenderSnapshot;
+
+  auto drawWorld = [&, this](const base::Extents& viewPortSize) {
     const auto clipRectGuard = renderer::saveState(mpRenderer);
     mpRenderer->setClipRect(base::Rect<int>{
       mpRenderer->globalTranslation(),
@@ -719,21 +1139,29 @@ void GameWorld::render()
         data::tileExtentsToPixelExtents(viewPortSize),
         mpRenderer->globalScale())});
 
-    if (mpState->mScreenFlashColor)
+    if (pass == RenderPass::BackdropOnly)
+    {
+      mpState->mMapRenderer.renderBackdrop(
+        snapshot.mapRenderState(), snapshot.mCameraPosition, viewPortSize);
+      return;
+    }
+
+    if (snapshot.mScreenFlashColor)
     {
-      mpRenderer->clear(*mpState->mScreenFlashColor);
+      mpRenderer->clear(*snapshot.mScreenFlashColor);
       return;
     }
 
+    const auto drawBackdrop = pass == RenderPass::All;
     if (mpOptions->mPerElementUpscalingEnabled)
     {
-      drawMapAndSprites(viewPortSize);
+      drawMapAndSprites(viewPortSize, drawBackdrop);
 
       {
         const auto saved = mLowResLayer.bindAndReset();
 
         mpRenderer->clear({0, 0, 0, 0});
-        mpState->mParticles.render(mpState->mCamera.position());
+        drawParticles();
         mpState->mDebuggingSystem.update(mpState->mEntities, viewPortSize);
       }
 
@@ -741,26 +1169,31 @@ void GameWorld::render()
     }
     else
     {
-      drawMapAndSprites(viewPortSize);
-      mpState->mParticles.render(mpState->mCamera.position());
+      drawMapAndSprites(viewPortSize, drawBackdrop);
+      drawParticles();
       mpState->mDebuggingSystem.update(mpState->mEntities, viewPortSize);
     }
   };
 
   auto drawTopRow = [&, this](int maxWidthPx) {
-    if (mpState->mActiveBossEntity)
+    if (pass == RenderPass::BackdropOnly)
+    {
+      return;
+    }
+
+    if (snapshot.mBossHealth)
     {
-      const auto health = healthOrZero(mpState->mActiveBossEntity);
+      const auto health = snapshot.mBossHealth->mHealth;
+      const auto startingHealth = snapshot.mBossHealth->mStartingHealth;
 
       const auto maxHealthBarSize = maxWidthPx - HEALTH_BAR_START_PX.x;
-      if (mpState->mBossStartingHealth <= maxHealthBarSize)
+      if (startingHealth <= maxHealthBarSize)
       {
         drawBossHealthBar(health, *mpTextRenderer, *mpUiSpriteSheet);
       }
       else
       {
-        const auto healthPercentage =
-          float(health) / mpState->mBossStartingHealth;
+        const auto healthPercentage = float(health) / startingHealth;
         const auto healthPercentagePx =
           base::round(healthPercentage * maxHealthBarSize);
         drawBossHealthBar(
@@ -769,36 +1202,31 @@ void GameWorld::render()
     }
     else
     {
-      mMessageDisplay.render();
+      mRenderSnapshot.mMessageDisplay.render();
     }
   };
 
   auto drawHud = [&, this]() {
-    const auto radarDots =
-      collectRadarDots(mpState->mEntities, mpState->mPlayer.orientedPosition());
-    mHudRenderer.render(*mpPlayerModel, radarDots);
+    if (pass == RenderPass::BackdropOnly)
+    {
+      return;
+    }
+
+    mHudRenderer.render(snapshot.mPlayerModel, snapshot.mRadarDots);
   };
 
 
   if (widescreenModeOn())
   {
-    mpServiceProvider->markCurrentFrameAsWidescreen();
-
     const auto info = renderer::determineWidescreenViewPort(mpRenderer);
     const auto viewPortSize = base::Extents{
       info.mWidthTiles, data::GameTraits::viewPortHeightTiles - 1};
 
-    if (!mWidescreenModeWasOn)
-    {
-      mpState->mSpriteRenderingSystem.update(
-        mpState->mEntities, viewPortSize, mpState->mCamera.position());
-    }
-
     if (mpOptions->mPerElementUpscalingEnabled)
     {
       {
         const auto saved = setupIngameViewportWidescreen(
-          mpRenderer, info, mpState->mScreenShakeOffsetX);
+          mpRenderer, info, snapshot.mScreenShakeOffsetX);
 
         drawWorld(viewPortSize);
 
@@ -817,7 +1245,7 @@ void GameWorld::render()
       drawTopRow(data::tilesToPixels(viewPortSize.width));
 
       mpRenderer->setGlobalTranslation(base::Vector{
-        mpState->mScreenShakeOffsetX,
+        snapshot.mScreenShakeOffsetX,
         data::GameTraits::inGameViewPortOffset.y});
       drawWorld(viewPortSize);
 
@@ -829,7 +1257,7 @@ void GameWorld::render()
   {
     {
       const auto saved =
-        setupIngameViewport(mpRenderer, mpState->mScreenShakeOffsetX);
+        setupIngameViewport(mpRenderer, snapshot.mScreenShakeOffsetX);
 
       drawWorld(data::GameTraits::mapViewPortSize);
       drawHud();
@@ -838,80 +1266,94 @@ void GameWorld::render()
     auto saved = renderer::saveState(mpRenderer);
     mpRenderer->setGlobalTranslation(localToGlobalTranslation(
       mpRenderer,
-      {mpState->mScreenShakeOffsetX + data::GameTraits::inGameViewPortOffset.x,
+      {snapshot.mScreenShakeOffsetX + data::GameTraits::inGameViewPortOffset.x,
        0}));
     drawTopRow(data::GameTraits::inGameViewPortSize.width);
   }
-
-  mWidescreenModeWasOn = widescreenModeOn();
-  mPerElementUpscalingWasEnabled = mpOptions->mPerElementUpscalingEnabled;
-  mPreviousWindowSize = mpRenderer->windowSize();
 }
 
 
-void GameWorld::drawMapAndSprites(const base::Extents& viewPortSize)
+void GameWorld::drawMapAndSprites(
+  const base::Extents& viewPortSize,
+  const bool drawBackdrop)
 {
-  using game_logic::components::TileDebris;
-
-  auto& state = *mpState;
-  const auto& cameraPosition = mpState->mCamera.position();
+  const auto& snapshot = mRenderSnapshot;
+  const auto& mapRenderer = mpState->mMapRenderer;
+  const auto mapRenderState = snapshot.mapRenderState();
+  const auto& cameraPosition = snapshot.mCameraPosition;
+  const auto& spriteRenderer = mpState->mSpriteRenderingSystem;
+  const auto numRegularSprites =
+    static_cast<base::ArrayView<SpriteDrawSpec>::size_type>(
+      snapshot.mNumRegularSprites);
+  const auto numForegroundSprites =
+    static_cast<base::ArrayView<SpriteDrawSpec>::size_type>(
+      snapshot.mSprites.size() - snapshot.mNumRegularSprites);
 
   auto renderBackgroundLayers = [&]() {
-    if (state.mBackdropFlashColor)
+    if (snapshot.mBackdropFlashColor)
     {
       mpRenderer->drawFilledRectangle(
         {{}, data::tileExtentsToPixelExtents(viewPortSize)},
-        *state.mBackdropFlashColor);
+        *snapshot.mBackdropFlashColor);
     }
-    else
+    else if (drawBackdrop)
     {
-      state.mMapRenderer.renderBackdrop(cameraPosition, viewPortSize);
+      mapRenderer.renderBackdrop(mapRenderState, cameraPosition, viewPortSize);
     }
 
-    state.mMapRenderer.renderBackground(cameraPosition, viewPortSize);
-    state.mSpriteRenderingSystem.renderRegularSprites();
+    mapRenderer.renderBackground(mapRenderState, cameraPosition, viewPortSize);
+    spriteRenderer.renderSprites(
+      {snapshot.mSprites.data(), numRegularSprites});
   };
 
 
-  const auto waterEffectAreas =
-    collectWaterEffectAreas(state.mEntities, cameraPosition, viewPortSize);
-  if (waterEffectAreas.empty())
-  {
-    renderBackgroundLayers();
-  }
-  else
-  {
-    {
-      auto saved = mWaterEffectBuffer.bind();
-      renderBackgroundLayers();
-    }
+  renderBackgroundLayers();
 
-    {
-      auto saved = renderer::saveState(mpRenderer);
-      mpRenderer->setGlobalScale({1.0f, 1.0f});
-      mpRenderer->setGlobalTranslation({});
-      mWaterEffectBuffer.render(0, 0);
-    }
+  if (!snapshot.mWaterEffectAreas.empty())
+  {
+    // The water effect needs the background layers as input. Only the
+    // region actually covered by water is copied from the current render
+    // target, instead of rendering everything into a separate buffer.
+    mpRenderer->captureWaterEffectSource(
+      boundingBox(snapshot.mWaterEffectAreas));
 
-    for (const auto& area : waterEffectAreas)
+    for (const auto& area : snapshot.mWaterEffectAreas)
     {
       mpRenderer->drawWaterEffect(
         area.mArea,
-        mWaterEffectBuffer.data(),
-        area.mIsAnimated ? std::optional<int>(state.mWaterAnimStep)
+        area.mIsAnimated ? std::optional<int>(snapshot.mWaterAnimStep)
                          : std::nullopt);
     }
   }
 
-  state.mMapRenderer.renderForeground(cameraPosition, viewPortSize);
-  state.mSpriteRenderingSystem.renderForegroundSprites();
+  mapRenderer.renderForeground(mapRenderState, cameraPosition, viewPortSize);
+  spriteRenderer.renderSprites(
+    {snapshot.mSprites.data() + numRegularSprites, numForegroundSprites});
 
-  // tile debris
-  state.mEntities.each<TileDebris, WorldPosition>(
-    [&](entityx::Entity, const TileDebris& debris, const WorldPosition& pos) {
-      state.mMapRenderer.renderSingleTile(
-        debris.mTileIndex, pos, cameraPosition);
-    });
+  for (const auto& debris : snapshot.mTileDebris)
+  {
+    mapRenderer.renderSingleTile(
+      mapRenderState, debris.mTileIndex, debris.mPosition, cameraPosition);
+  }
+}
+
+
+void GameWorld::drawParticles()
+{
+  if (!mRenderSnapshot.mParticleVertices.empty())
+  {
+    mpRenderer->drawPoints(mRenderSnapshot.mParticleVertices);
+  }
+}
+
+
+base::Extents GameWorld::renderingViewPortSize() const
+{
+  return widescreenModeOn()
+    ? base::Extents{
+        renderer::determineWidescreenViewPort(mpRenderer).mWidthTiles,
+        data::GameTraits::viewPortHeightTiles - 1}
+    : data::GameTraits::mapViewPortSize;
 }
 
 
@@ -927,6 +1369,8 @@ void GameWorld::processEndOfFrameActions()
   handlePlayerDeath();
   handleTeleporter();
 
+  // The render snapshot keeps the screen shake offset until it has been
+  // rendered, see render().
   mpState->mScreenShakeOffsetX = 0;
 }
 
@@ -934,6 +1378,7 @@ void GameWorld::processEndOfFrameActions()
 void GameWorld::activateFullHealthCheat()
 {
   mpPlayerModel->resetHealthAndScore();
+  refreshRenderSnapshot();
 }
 
 
@@ -989,6 +1434,14 @@ void GameWorld::activateGiveItemsCheat()
   {
     mpPlayerModel->switchToWeapon(*weaponToGive);
   }
+
+  refreshRenderSnapshot();
+}
+
+
+std::uint32_t GameWorld::stateHash() const
+{
+  return computeStateHash(*mpState, *mpPlayerModel);
 }
 
 
@@ -999,14 +1452,7 @@ void GameWorld::quickSave()
     return;
   }
 
-  auto pStateCopy = std::make_unique<WorldState>(
-    mpServiceProvider,
-    mpRenderer,
-    mpResources,
-    mpPlayerModel,
-    mpOptions,
-    mpSpriteFactory,
-    mSessionId);
+  auto pStateCopy = makeWorldState();
   pStateCopy->synchronizeTo(
     *mpState, mpServiceProvider, mpPlayerModel, mSessionId);
 
@@ -1014,6 +1460,7 @@ void GameWorld::quickSave()
     QuickSaveData{*mpPlayerModel, std::move(pStateCopy)});
 
   mMessageDisplay.setMessage("Quick saved.");
+  refreshRenderSnapshot();
 }
 
 
@@ -1028,12 +1475,7 @@ void GameWorld::quickLoad()
   mpState->synchronizeTo(
     *mpQuickSave->mpState, mpServiceProvider, mpPlayerModel, mSessionId);
   mMessageDisplay.setMessage("Quick save restored.");
-
-  const auto& viewPortSize = widescreenModeOn()
-    ? viewPortSizeWideScreen(mpRenderer)
-    : data::GameTraits::mapViewPortSize;
-  mpState->mSpriteRenderingSystem.update(
-    mpState->mEntities, viewPortSize, mpState->mCamera.position());
+  refreshRenderSnapshot();
 }
 
 
@@ -1043,6 +1485,17 @@ bool GameWorld::canQuickLoad() const
 }
 
 
+void GameWorld::reportMemoryUsage(MemoryReport& report)
+{
+  mpState->reportMemoryUsage(report, "World");
+
+  if (mpQuickSave)
+  {
+    mpQuickSave->mpState->reportMemoryUsage(report, "Quick save");
+  }
+}
+
+
 void GameWorld::onReactorDestroyed(const base::Vector& position)
 {
   flashScreen(loader::INGAME_PALETTE[7]);
@@ -1060,7 +1513,6 @@ void GameWorld::onReactorDestroyed(const base::Vector& position)
     data::map::BackdropSwitchCondition::OnReactorDestruction;
   if (!mpState->mReactorDestructionFramesElapsed && shouldDoSpecialEvent)
   {
-    mpState->mMapRenderer.switchBackdrops();
     mpState->mBackdropSwitched = true;
     mpState->mReactorDestructionFramesElapsed = 0;
   }
@@ -1138,7 +1590,6 @@ void GameWorld::restartFromCheckpoint()
     data::map::BackdropSwitchCondition::OnTeleportation;
   if (mpState->mBackdropSwitched && shouldSwitchBackAfterRespawn)
   {
-    mpState->mMapRenderer.switchBackdrops();
     mpState->mBackdropSwitched = false;
   }
 
@@ -1169,7 +1620,6 @@ void GameWorld::handleTeleporter()
     data::map::BackdropSwitchCondition::OnTeleportation;
   if (switchBackdrop)
   {
-    mpState->mMapRenderer.switchBackdrops();
     mpState->mBackdropSwitched = !mpState->mBackdropSwitched;
   }
 
@@ -1202,7 +1652,16 @@ void GameWorld::printDebugText(std::ostream& stream) const
 {
   stream << "Scroll: " << vec2String(mpState->mCamera.position(), 4) << '\n'
          << "Player: " << vec2String(mpState->mPlayer.position(), 4) << '\n'
-         << "Entities: " << mpState->mEntities.size() << '\n';
+         << "Entities: " << mpState->mEntities.size() << '\n'
+         << "Arena: " << mpState->mArena.reservedBytes() / 1024 << " KiB, "
+         << mpState->mArena.numLiveAllocations() << " allocs\n"
+         << "Sprite atlas: " << mpSpriteFactory->residentTextureMemory() / 1024
+         << " KiB\n";
+
+  if (mHeapAllocationCount)
+  {
+    stream << "Heap allocs/update: " << *mHeapAllocationCount << '\n';
+  }
 }
 
 } // namespace rigel::game_logic
@@ -18,6 +18,8 @@
 
 #include "base/color.hpp"
 #include "base/spatial_types.hpp"
+#include "base/stage_scheduler.hpp"
+#include "base/thread_pool.hpp"
 #include "base/warnings.hpp"
 #include "common/game_mode.hpp"
 #include "common/global.hpp"
@@ -27,7 +29,9 @@
 #include "data/tutorial_messages.hpp"
 #include "engine/sprite_factory.hpp"
 #include "game_logic/damage_components.hpp"
+#include "game_logic/deferring_service_provider.hpp"
 #include "game_logic/input.hpp"
+#include "game_logic/render_snapshot.hpp"
 #include "ui/hud_renderer.hpp"
 #include "ui/ingame_message_display.hpp"
 
@@ -35,13 +39,16 @@ RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
 RIGEL_RESTORE_WARNINGS
 
+#include <cstdint>
 #include <iosfwd>
+#include <memory>
 #include <optional>
 #include <vector>
 
 namespace rigel
 {
 class GameRunner;
+class MemoryReport;
 }
 namespace rigel::data
 {
@@ -72,13 +79,20 @@ struct WorldState;
 class GameWorld : public entityx::Receiver<GameWorld>
 {
 public:
+  /** Start playing the given session's level
+   *
+   * If a preloaded level is given, the world makes copies of it whenever it
+   * needs to (re-)create the level, instead of loading it from the game
+   * files. The level data must outlive the GameWorld.
+   */
   GameWorld(
     data::PlayerModel* pPlayerModel,
     const data::GameSessionId& sessionId,
     GameMode::Context context,
     std::optional<base::Vector> playerPositionOverride = std::nullopt,
     bool showWelcomeMessage = false,
-    const PlayerInput& initialInput = PlayerInput{});
+    const PlayerInput& initialInput = PlayerInput{},
+    const data::map::LevelData* pPreloadedLevel = nullptr);
   ~GameWorld(); // NOLINT
 
   bool levelFinished() const;
@@ -104,18 +118,48 @@ public:
   void render();
   void processEndOfFrameActions();
 
+  /** Split-up version of updateGameLogic(), for pipelined execution
+   *
+   * prepareLogicUpdates() and publishLogicUpdates() must be called on the
+   * main thread, before and after running one or more logic updates via
+   * runLogicUpdate(). The latter can run on a worker thread, while the main
+   * thread keeps rendering the previous update's render snapshot. Sound and
+   * music requests made by game logic are held back until published.
+   *
+   * No other member functions may be called while a runLogicUpdate() is in
+   * progress, except for render() and isPlayerInShip().
+   */
+  void prepareLogicUpdates();
+  void runLogicUpdate(const PlayerInput& input);
+  void publishLogicUpdates();
+
+  /** Make rendering reflect changes made outside of logic updates */
+  void refreshRenderSnapshot();
+
+  bool isPlayerInShip() const;
+
   void activateFullHealthCheat();
   void activateGiveItemsCheat();
 
+  /** Hash of current simulation state, see computeStateHash() */
+  std::uint32_t stateHash() const;
+
   void quickSave();
   void quickLoad();
   bool canQuickLoad() const;
 
+  /** Report the current level's state, and the quick save if there is one
+   *
+   * Must not be called while a runLogicUpdate() is in progress.
+   */
+  void reportMemoryUsage(MemoryReport& report);
+
   friend class rigel::GameRunner;
 
 private:
   void loadLevel(const PlayerInput& initialInput);
   void createNewState();
+  std::unique_ptr<WorldState> makeWorldState();
   void subscribe(entityx::EventManager& eventManager);
   void unsubscribe(entityx::EventManager& eventManager);
 
@@ -133,7 +177,37 @@ private:
 
   void printDebugText(std::ostream& stream) const;
 
-  void drawMapAndSprites(const base::Extents& viewPortSize);
+  /** Split a logic update into stages for mLogicStages
+   *
+   * With --parallel-systems, independent stages run concurrently. Stages
+   * accessing the same data run in their original order, so results stay
+   * identical to serial updates.
+   */
+  void setUpLogicStages();
+
+  void captureRenderSnapshot(RenderSnapshot& snapshot);
+  void updateMapForRendering();
+  void updateViewPortSizes();
+
+  /** Selects which layers renderLayers() draws
+   *
+   * The only part of the world that can change between two logic updates
+   * is an auto-scrolling backdrop. Everything else is drawn once per logic
+   * update into mFrameCache, and re-used for intermediate display frames.
+   */
+  enum class RenderPass
+  {
+    All,
+    AllButBackdrop,
+    BackdropOnly
+  };
+
+  std::optional<RenderPass> determineFrameCachePass() const;
+  void invalidateFrameCache();
+  void renderLayers(RenderPass pass);
+  void drawMapAndSprites(const base::Extents& viewPortSize, bool drawBackdrop);
+  void drawParticles();
+  base::Extents renderingViewPortSize() const;
   bool widescreenModeOn() const;
 
   struct QuickSaveData
@@ -143,6 +217,7 @@ private:
   };
 
   renderer::Renderer* mpRenderer;
+  DeferringServiceProvider mDeferringServiceProvider;
   IGameServiceProvider* mpServiceProvider;
   engine::TiledTexture* mpUiSpriteSheet;
   ui::MenuElementRenderer* mpTextRenderer;
@@ -151,15 +226,32 @@ private:
   const loader::ResourceLoader* mpResources;
   engine::SpriteFactory* mpSpriteFactory;
   data::GameSessionId mSessionId;
+  const data::map::LevelData* mpPreloadedLevel;
 
   data::PlayerModel mPlayerModelAtLevelStart;
   ui::HudRenderer mHudRenderer;
   ui::IngameMessageDisplay mMessageDisplay;
-  renderer::RenderTargetTexture mWaterEffectBuffer;
+  RenderSnapshot mRenderSnapshot;
+  RenderSnapshot mPendingRenderSnapshot;
+  std::shared_ptr<data::map::Map> mpMapForRendering;
+  std::shared_ptr<data::map::Map> mpSpareMapForRendering;
+  std::optional<base::Rect<int>> mSpareMapOutdatedSection;
+  base::Extents mViewPortSize;
+  base::Extents mSpriteViewPortSize;
+  base::Extents mRenderingViewPortSize;
+  int mNumPendingHudAnimationSteps = 0;
+  std::optional<std::uint64_t> mPendingHeapAllocationCount;
+  std::optional<std::uint64_t> mHeapAllocationCount;
   renderer::RenderTargetTexture mLowResLayer;
+  renderer::RenderTargetTexture mFrameCache;
+  std::optional<RenderPass> mFrameCachePass;
+  bool mFrameCacheValid = false;
   base::Size<int> mPreviousWindowSize;
   bool mWidescreenModeWasOn;
   bool mPerElementUpscalingWasEnabled;
+  base::ThreadPool mSystemThreadPool;
+  base::StageScheduler mLogicStages;
+  const PlayerInput* mpCurrentInput = nullptr;
 
   std::unique_ptr<WorldState> mpState;
   std::unique_ptr<QuickSaveData> mpQuickSave;
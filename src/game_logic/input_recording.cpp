@@ -0,0 +1,477 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "input_recording.hpp"
+
+#include "data/saved_game.hpp"
+#include "loader/file_utils.hpp"
+
+#include <stdexcept>
+
+
+namespace rigel::game_logic
+{
+
+namespace
+{
+
+constexpr char MAGIC[] = {'R', 'G', 'L', 'R'};
+constexpr std::uint16_t FORMAT_VERSION = 2;
+
+constexpr std::uint16_t NO_POSITION_OVERRIDE = 0xFFFF;
+
+
+enum FrameBits : std::uint16_t
+{
+  Left = 1 << 0,
+  Right = 1 << 1,
+  Up = 1 << 2,
+  Down = 1 << 3,
+  InteractPressed = 1 << 4,
+  InteractTriggered = 1 << 5,
+  JumpPressed = 1 << 6,
+  JumpTriggered = 1 << 7,
+  FirePressed = 1 << 8,
+  FireTriggered = 1 << 9,
+  QuickSave = 1 << 10,
+  QuickLoad = 1 << 11,
+  EndOfFrameActions = 1 << 12
+};
+
+
+struct FrameRun
+{
+  std::uint16_t mBits;
+  std::uint16_t mLength;
+};
+
+
+std::uint16_t packFrame(const RecordedFrame& frame)
+{
+  const auto& input = frame.mInput;
+
+  auto bit = [](const bool value, const FrameBits mask) {
+    return value ? static_cast<std::uint16_t>(mask) : std::uint16_t{0};
+  };
+
+  // clang-format off
+  return static_cast<std::uint16_t>(
+    bit(input.mLeft, Left) |
+    bit(input.mRight, Right) |
+    bit(input.mUp, Up) |
+    bit(input.mDown, Down) |
+    bit(input.mInteract.mIsPressed, InteractPressed) |
+    bit(input.mInteract.mWasTriggered, InteractTriggered) |
+    bit(input.mJump.mIsPressed, JumpPressed) |
+    bit(input.mJump.mWasTriggered, JumpTriggered) |
+    bit(input.mFire.mIsPressed, FirePressed) |
+    bit(input.mFire.mWasTriggered, FireTriggered) |
+    bit(frame.mQuickSave, QuickSave) |
+    bit(frame.mQuickLoad, QuickLoad) |
+    bit(frame.mEndOfFrameActions, EndOfFrameActions));
+  // clang-format on
+}
+
+
+RecordedFrame unpackFrame(const std::uint16_t bits)
+{
+  auto isSet = [bits](const FrameBits mask) { return (bits & mask) != 0; };
+
+  RecordedFrame frame;
+  auto& input = frame.mInput;
+
+  input.mLeft = isSet(Left);
+  input.mRight = isSet(Right);
+  input.mUp = isSet(Up);
+  input.mDown = isSet(Down);
+  input.mInteract = Button{isSet(InteractPressed), isSet(InteractTriggered)};
+  input.mJump = Button{isSet(JumpPressed), isSet(JumpTriggered)};
+  input.mFire = Button{isSet(FirePressed), isSet(FireTriggered)};
+  frame.mQuickSave = isSet(QuickSave);
+  frame.mQuickLoad = isSet(QuickLoad);
+  frame.mEndOfFrameActions = isSet(EndOfFrameActions);
+
+  return frame;
+}
+
+
+void writeU8(loader::ByteBuffer& buffer, const std::uint8_t value)
+{
+  buffer.push_back(value);
+}
+
+
+void writeU16(loader::ByteBuffer& buffer, const std::uint16_t value)
+{
+  buffer.push_back(static_cast<std::uint8_t>(value & 0xFF));
+  buffer.push_back(static_cast<std::uint8_t>(value >> 8));
+}
+
+
+void writeU32(loader::ByteBuffer& buffer, const std::uint32_t value)
+{
+  writeU16(buffer, static_cast<std::uint16_t>(value & 0xFFFF));
+  writeU16(buffer, static_cast<std::uint16_t>(value >> 16));
+}
+
+
+void writeSegment(loader::ByteBuffer& buffer, const RecordingSegment& segment)
+{
+  writeU8(buffer, static_cast<std::uint8_t>(segment.mSessionId.mEpisode));
+  writeU8(buffer, static_cast<std::uint8_t>(segment.mSessionId.mLevel));
+  writeU8(buffer, static_cast<std::uint8_t>(segment.mSessionId.mDifficulty));
+  writeU8(buffer, static_cast<std::uint8_t>(segment.mWeapon));
+  writeU8(buffer, static_cast<std::uint8_t>(segment.mAmmo));
+  writeU8(buffer, static_cast<std::uint8_t>(segment.mHealth));
+  writeU32(buffer, static_cast<std::uint32_t>(segment.mScore));
+
+  writeU8(buffer, static_cast<std::uint8_t>(segment.mInventory.size()));
+  for (const auto item : segment.mInventory)
+  {
+    writeU8(buffer, static_cast<std::uint8_t>(item));
+  }
+
+  writeU8(buffer, static_cast<std::uint8_t>(segment.mCollectedLetters.size()));
+  for (const auto letter : segment.mCollectedLetters)
+  {
+    writeU8(buffer, static_cast<std::uint8_t>(letter));
+  }
+
+  auto tutorialMessageBits = std::uint32_t{0};
+  for (auto i = 0; i < data::NUM_TUTORIAL_MESSAGES; ++i)
+  {
+    const auto id = static_cast<data::TutorialMessageId>(i);
+    if (segment.mTutorialMessages.hasBeenShown(id))
+    {
+      tutorialMessageBits |= 1u << i;
+    }
+  }
+  writeU32(buffer, tutorialMessageBits);
+
+  if (segment.mPlayerPositionOverride)
+  {
+    writeU16(
+      buffer, static_cast<std::uint16_t>(segment.mPlayerPositionOverride->x));
+    writeU16(
+      buffer, static_cast<std::uint16_t>(segment.mPlayerPositionOverride->y));
+  }
+  else
+  {
+    writeU16(buffer, NO_POSITION_OVERRIDE);
+    writeU16(buffer, NO_POSITION_OVERRIDE);
+  }
+
+  // Frames are stored as runs of identical packed values
+  std::vector<FrameRun> runs;
+  for (const auto& frame : segment.mFrames)
+  {
+    const auto bits = packFrame(frame);
+    if (
+      runs.empty() || runs.back().mBits != bits ||
+      runs.back().mLength == 0xFFFF)
+    {
+      runs.push_back({bits, 0});
+    }
+
+    ++runs.back().mLength;
+  }
+
+  writeU32(buffer, static_cast<std::uint32_t>(runs.size()));
+  for (const auto& run : runs)
+  {
+    writeU16(buffer, run.mBits);
+    writeU16(buffer, run.mLength);
+  }
+
+  writeU32(buffer, static_cast<std::uint32_t>(segment.mStateHashes.size()));
+  for (const auto& stateHash : segment.mStateHashes)
+  {
+    writeU32(buffer, stateHash.mFrame);
+    writeU32(buffer, stateHash.mHash);
+  }
+}
+
+
+RecordingSegment readSegment(loader::LeStreamReader& reader)
+{
+  RecordingSegment segment;
+
+  segment.mSessionId.mEpisode = reader.readU8();
+  segment.mSessionId.mLevel = reader.readU8();
+  segment.mSessionId.mDifficulty =
+    static_cast<data::Difficulty>(reader.readU8());
+  segment.mWeapon = static_cast<data::WeaponType>(reader.readU8());
+  segment.mAmmo = reader.readU8();
+  segment.mHealth = reader.readU8();
+  segment.mScore = static_cast<int>(reader.readU32());
+
+  if (
+    segment.mSessionId.mEpisode >= data::NUM_EPISODES ||
+    segment.mSessionId.mLevel >= data::NUM_LEVELS_PER_EPISODE ||
+    segment.mSessionId.mDifficulty > data::Difficulty::Hard ||
+    segment.mWeapon > data::WeaponType::FlameThrower)
+  {
+    throw std::runtime_error("Invalid segment header in input recording");
+  }
+
+  const auto numItems = reader.readU8();
+  for (auto i = 0; i < numItems; ++i)
+  {
+    const auto item = static_cast<data::InventoryItemType>(reader.readU8());
+    if (item > data::InventoryItemType::CloakingDevice)
+    {
+      throw std::runtime_error("Invalid inventory item in input recording");
+    }
+
+    segment.mInventory.push_back(item);
+  }
+
+  const auto numLetters = reader.readU8();
+  for (auto i = 0; i < numLetters; ++i)
+  {
+    const auto letter =
+      static_cast<data::CollectableLetterType>(reader.readU8());
+    if (letter > data::CollectableLetterType::M)
+    {
+      throw std::runtime_error("Invalid letter in input recording");
+    }
+
+    segment.mCollectedLetters.push_back(letter);
+  }
+
+  const auto tutorialMessageBits = reader.readU32();
+  for (auto i = 0; i < data::NUM_TUTORIAL_MESSAGES; ++i)
+  {
+    if (tutorialMessageBits & (1u << i))
+    {
+      segment.mTutorialMessages.markAsShown(
+        static_cast<data::TutorialMessageId>(i));
+    }
+  }
+
+  const auto positionX = reader.readU16();
+  const auto positionY = reader.readU16();
+  if (positionX != NO_POSITION_OVERRIDE)
+  {
+    segment.mPlayerPositionOverride = base::Vector{positionX, positionY};
+  }
+
+  const auto numRuns = reader.readU32();
+  for (auto run = 0u; run < numRuns; ++run)
+  {
+    const auto frame = unpackFrame(reader.readU16());
+    const auto runLength = reader.readU16();
+    segment.mFrames.insert(segment.mFrames.end(), runLength, frame);
+  }
+
+  const auto numHashes = reader.readU32();
+  for (auto i = 0u; i < numHashes; ++i)
+  {
+    const auto frame = reader.readU32();
+    const auto hash = reader.readU32();
+    segment.mStateHashes.push_back({frame, hash});
+  }
+
+  return segment;
+}
+
+} // namespace
+
+
+loader::ByteBuffer serialize(const InputRecording& recording)
+{
+  loader::ByteBuffer buffer;
+
+  for (const auto c : MAGIC)
+  {
+    writeU8(buffer, static_cast<std::uint8_t>(c));
+  }
+
+  writeU16(buffer, FORMAT_VERSION);
+  writeU16(buffer, static_cast<std::uint16_t>(recording.mSegments.size()));
+
+  for (const auto& segment : recording.mSegments)
+  {
+    writeSegment(buffer, segment);
+  }
+
+  return buffer;
+}
+
+
+InputRecording deserializeInputRecording(const loader::ByteBuffer& data)
+{
+  loader::LeStreamReader reader(data);
+
+  for (const auto c : MAGIC)
+  {
+    if (reader.readU8() != static_cast<std::uint8_t>(c))
+    {
+      throw std::runtime_error("Not an input recording file");
+    }
+  }
+
+  if (reader.readU16() != FORMAT_VERSION)
+  {
+    throw std::runtime_error("Unsupported input recording version");
+  }
+
+  InputRecording recording;
+
+  const auto numSegments = reader.readU16();
+  for (auto i = 0; i < numSegments; ++i)
+  {
+    recording.mSegments.push_back(readSegment(reader));
+  }
+
+  return recording;
+}
+
+
+data::PlayerModel initialPlayerModel(const RecordingSegment& segment)
+{
+  auto save = data::SavedGame{};
+  save.mSessionId = segment.mSessionId;
+  save.mWeapon = segment.mWeapon;
+  save.mAmmo = segment.mAmmo;
+  save.mScore = segment.mScore;
+  save.mTutorialMessagesAlreadySeen = segment.mTutorialMessages;
+
+  auto model = data::PlayerModel{save};
+  model.takeDamage(data::MAX_HEALTH - segment.mHealth);
+
+  for (const auto item : segment.mInventory)
+  {
+    model.giveItem(item);
+  }
+
+  for (const auto letter : segment.mCollectedLetters)
+  {
+    model.addLetter(letter);
+  }
+
+  return model;
+}
+
+
+InputRecorder::InputRecorder(std::filesystem::path outputFile)
+  : mOutputFile(std::move(outputFile))
+{
+}
+
+
+void InputRecorder::beginSegment(
+  const data::GameSessionId& sessionId,
+  const data::PlayerModel& playerModel,
+  const std::optional<base::Vector>& playerPositionOverride)
+{
+  auto segment = RecordingSegment{};
+  segment.mSessionId = sessionId;
+  segment.mWeapon = playerModel.weapon();
+  segment.mAmmo = playerModel.ammo();
+  segment.mHealth = playerModel.health();
+  segment.mScore = playerModel.score();
+  segment.mInventory = playerModel.inventory();
+  segment.mCollectedLetters = playerModel.collectedLetters();
+  segment.mTutorialMessages = playerModel.tutorialMessages();
+  segment.mPlayerPositionOverride = playerPositionOverride;
+
+  mRecording.mSegments.push_back(std::move(segment));
+  mPendingFrame = {};
+  mSegmentActive = true;
+}
+
+
+void InputRecorder::endSegment()
+{
+  if (!mSegmentActive)
+  {
+    return;
+  }
+
+  mSegmentActive = false;
+  flush();
+}
+
+
+void InputRecorder::flush()
+{
+  auto tempFile = mOutputFile;
+  tempFile += ".tmp";
+
+  loader::saveToFile(serialize(mRecording), tempFile);
+  std::filesystem::rename(tempFile, mOutputFile);
+}
+
+
+void InputRecorder::recordQuickSave()
+{
+  mPendingFrame.mQuickSave = true;
+}
+
+
+void InputRecorder::recordQuickLoad()
+{
+  mPendingFrame.mQuickLoad = true;
+}
+
+
+void InputRecorder::recordEndOfFrameActions()
+{
+  mPendingFrame.mEndOfFrameActions = true;
+}
+
+
+void InputRecorder::recordFrame(const PlayerInput& input)
+{
+  if (!mSegmentActive)
+  {
+    return;
+  }
+
+  mPendingFrame.mInput = input;
+
+  auto& frames = mRecording.mSegments.back().mFrames;
+  frames.push_back(mPendingFrame);
+  mPendingFrame = {};
+
+  if (frames.size() % RECORDING_FLUSH_INTERVAL == 0)
+  {
+    flush();
+  }
+}
+
+
+bool InputRecorder::isStateHashDue() const
+{
+  if (!mSegmentActive)
+  {
+    return false;
+  }
+
+  const auto numFrames = mRecording.mSegments.back().mFrames.size();
+  return numFrames > 0 && numFrames % STATE_HASH_INTERVAL == 0;
+}
+
+
+void InputRecorder::recordStateHash(const std::uint32_t hash)
+{
+  auto& segment = mRecording.mSegments.back();
+  segment.mStateHashes.push_back(
+    {static_cast<std::uint32_t>(segment.mFrames.size()), hash});
+}
+
+} // namespace rigel::game_logic
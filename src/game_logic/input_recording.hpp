@@ -0,0 +1,150 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/spatial_types.hpp"
+#include "data/game_session_data.hpp"
+#include "data/player_model.hpp"
+#include "game_logic/input.hpp"
+#include "loader/byte_buffer.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+
+namespace rigel::game_logic
+{
+
+/** Number of logic frames between two state hashes in a recording */
+constexpr auto STATE_HASH_INTERVAL = 15;
+
+/** Number of logic frames between writing the recording file
+ *
+ * This is 10 seconds of game time.
+ */
+constexpr auto RECORDING_FLUSH_INTERVAL = 150;
+
+
+/** Input and frame-level events for one logic update
+ *
+ * Besides the player input, this stores actions which happen outside of
+ * GameWorld::updateGameLogic() but still affect the simulation. All flags
+ * refer to things that happened _before_ the frame's logic update.
+ */
+struct RecordedFrame
+{
+  PlayerInput mInput;
+  bool mQuickSave = false;
+  bool mQuickLoad = false;
+  bool mEndOfFrameActions = false;
+};
+
+
+struct RecordedStateHash
+{
+  /** Number of logic updates that had been run when the hash was taken */
+  std::uint32_t mFrame;
+  std::uint32_t mHash;
+};
+
+
+/** Recording of a single level, from level start until leaving the level
+ *
+ * Stores the complete player model at the start of the level, since all of
+ * it can affect the simulation or the messages shown during the level.
+ */
+struct RecordingSegment
+{
+  data::GameSessionId mSessionId;
+  data::WeaponType mWeapon = data::WeaponType::Normal;
+  int mAmmo = data::MAX_AMMO;
+  int mHealth = data::MAX_HEALTH;
+  int mScore = 0;
+  std::vector<data::InventoryItemType> mInventory;
+  std::vector<data::CollectableLetterType> mCollectedLetters;
+  data::TutorialMessageState mTutorialMessages;
+  std::optional<base::Vector> mPlayerPositionOverride;
+
+  std::vector<RecordedFrame> mFrames;
+  std::vector<RecordedStateHash> mStateHashes;
+};
+
+
+struct InputRecording
+{
+  std::vector<RecordingSegment> mSegments;
+};
+
+
+/** Serialize recording into a compact binary format
+ *
+ * Inputs are stored run-length encoded, since they rarely change from one
+ * logic frame to the next.
+ */
+loader::ByteBuffer serialize(const InputRecording& recording);
+
+/** Parse recording created by serialize()
+ *
+ * Throws an exception if the data is not a valid recording.
+ */
+InputRecording deserializeInputRecording(const loader::ByteBuffer& data);
+
+/** Create player model matching the state at the start of the segment */
+data::PlayerModel initialPlayerModel(const RecordingSegment& segment);
+
+
+/** Records player input during gameplay
+ *
+ * Each level played results in one segment. The entire recording is written
+ * to the output file whenever a segment is finished, and additionally every
+ * RECORDING_FLUSH_INTERVAL frames while a segment is active. This way, a
+ * recording of everything up to shortly before a crash is available. The
+ * file is replaced atomically, so a crash while writing doesn't corrupt the
+ * previous version.
+ */
+class InputRecorder
+{
+public:
+  explicit InputRecorder(std::filesystem::path outputFile);
+
+  void beginSegment(
+    const data::GameSessionId& sessionId,
+    const data::PlayerModel& playerModel,
+    const std::optional<base::Vector>& playerPositionOverride);
+  void endSegment();
+
+  void recordQuickSave();
+  void recordQuickLoad();
+  void recordEndOfFrameActions();
+  void recordFrame(const PlayerInput& input);
+
+  /** True if a state hash should be recorded for the last recorded frame */
+  bool isStateHashDue() const;
+  void recordStateHash(std::uint32_t hash);
+
+private:
+  void flush();
+
+  InputRecording mRecording;
+  RecordedFrame mPendingFrame;
+  std::filesystem::path mOutputFile;
+  bool mSegmentActive = false;
+};
+
+} // namespace rigel::game_logic
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "base/memory_arena.hpp"
 #include "base/spatial_types.hpp"
 #include "base/warnings.hpp"
 
@@ -23,7 +24,6 @@ RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
 RIGEL_RESTORE_WARNINGS
 
-#include <memory>
 #include <vector>
 
 namespace rigel
@@ -56,7 +56,7 @@ class ComponentHolder
 public:
   template <typename T>
   explicit ComponentHolder(T component_)
-    : mpSelf(std::make_unique<Model<T>>(std::move(component_)))
+    : mpSelf(base::makeArenaUnique<Model<T>>(std::move(component_)))
   {
   }
 
@@ -84,7 +84,7 @@ private:
   struct Concept
   {
     virtual ~Concept() = default;
-    virtual std::unique_ptr<Concept> clone() const = 0;
+    virtual base::ArenaUniquePtr<Concept> clone() const = 0;
     virtual void assignToEntity(entityx::Entity entity) const = 0;
   };
 
@@ -96,9 +96,9 @@ private:
     {
     }
 
-    std::unique_ptr<Concept> clone() const override
+    base::ArenaUniquePtr<Concept> clone() const override
     {
-      return std::make_unique<Model>(mData);
+      return base::makeArenaUnique<Model>(mData);
     }
 
     void assignToEntity(entityx::Entity entity) const override
@@ -109,7 +109,7 @@ private:
     T mData;
   };
 
-  std::unique_ptr<Concept> mpSelf;
+  base::ArenaUniquePtr<Concept> mpSelf;
 };
 
 
@@ -0,0 +1,109 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/color.hpp"
+#include "base/spatial_types.hpp"
+#include "data/map.hpp"
+#include "data/player_model.hpp"
+#include "engine/map_renderer.hpp"
+#include "engine/sprite_rendering_system.hpp"
+#include "renderer/renderer.hpp"
+#include "ui/ingame_message_display.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+
+namespace rigel::game_logic
+{
+
+struct WaterEffectArea
+{
+  base::Rect<int> mArea;
+  bool mIsAnimated;
+};
+
+
+struct TileDebrisDrawSpec
+{
+  data::map::TileIndex mTileIndex;
+  base::Vector mPosition;
+};
+
+
+struct BossHealthInfo
+{
+  int mHealth;
+  int mStartingHealth;
+};
+
+
+/** Everything needed to draw the game world and HUD for one logic update
+ *
+ * Captured at the end of each logic update. Rendering only reads from the
+ * snapshot, never from the WorldState. This makes it possible to run the
+ * next logic update on a worker thread while the main thread keeps
+ * rendering the previous one.
+ *
+ * The map is shared between snapshots, and only copied again when its
+ * revision changes, which is rare (e.g. when dynamic geometry collapses).
+ */
+struct RenderSnapshot
+{
+  explicit RenderSnapshot(ui::IngameMessageDisplay messageDisplay)
+    : mMessageDisplay(std::move(messageDisplay))
+  {
+  }
+
+  engine::MapRenderState mapRenderState() const
+  {
+    return {mpMap.get(), mMapAnimationFrame, mBackdropSwitched};
+  }
+
+  base::Vector mCameraPosition;
+
+  std::shared_ptr<const data::map::Map> mpMap;
+  std::uint32_t mMapAnimationFrame = 0;
+  bool mBackdropSwitched = false;
+
+  std::vector<engine::SpriteDrawSpec> mSprites;
+  std::size_t mNumRegularSprites = 0;
+  std::vector<TileDebrisDrawSpec> mTileDebris;
+  std::vector<renderer::PointVertex> mParticleVertices;
+  std::vector<WaterEffectArea> mWaterEffectAreas;
+  int mWaterAnimStep = 0;
+
+  std::optional<base::Color> mScreenFlashColor;
+  std::optional<base::Color> mBackdropFlashColor;
+  int mScreenShakeOffsetX = 0;
+
+  data::PlayerModel mPlayerModel;
+  std::vector<base::Vector> mRadarDots;
+  std::optional<BossHealthInfo> mBossHealth;
+  ui::IngameMessageDisplay mMessageDisplay;
+
+  // Not needed for rendering, but for input handling, which also happens on
+  // the main thread.
+  bool mPlayerInShip = false;
+};
+
+} // namespace rigel::game_logic
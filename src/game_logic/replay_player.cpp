@@ -0,0 +1,205 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "replay_player.hpp"
+
+#include "base/clock.hpp"
+#include "game_logic/game_world.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+
+namespace rigel::game_logic
+{
+
+namespace
+{
+
+// Upper bound for the time spent simulating before a frame is rendered.
+// This keeps the window responsive while fast-forwarding.
+constexpr auto MAX_SIMULATION_TIME_PER_UPDATE = std::chrono::milliseconds{100};
+
+} // namespace
+
+
+SegmentPlayback::SegmentPlayback(const RecordingSegment* pSegment)
+  : mpSegment(pSegment)
+{
+}
+
+
+bool SegmentPlayback::runNextFrame(GameWorld& world)
+{
+  const auto& frame = mpSegment->mFrames[mFrameIndex];
+
+  if (frame.mEndOfFrameActions)
+  {
+    world.processEndOfFrameActions();
+  }
+
+  if (frame.mQuickSave)
+  {
+    world.quickSave();
+  }
+
+  if (frame.mQuickLoad)
+  {
+    world.quickLoad();
+  }
+
+  world.updateGameLogic(frame.mInput);
+  ++mFrameIndex;
+
+  const auto& hashes = mpSegment->mStateHashes;
+  if (
+    mNextHashIndex >= hashes.size() ||
+    hashes[mNextHashIndex].mFrame != mFrameIndex)
+  {
+    return true;
+  }
+
+  const auto expectedHash = hashes[mNextHashIndex].mHash;
+  ++mNextHashIndex;
+
+  return expectedHash == world.stateHash();
+}
+
+
+bool SegmentPlayback::isFinished() const
+{
+  return mFrameIndex >= mpSegment->mFrames.size();
+}
+
+
+ReplayPlayer::ReplayPlayer(GameMode::Context context, InputRecording recording)
+  : mContext(context)
+  , mRecording(std::move(recording))
+{
+  if (mRecording.mSegments.empty())
+  {
+    throw std::runtime_error("Input recording doesn't contain any data");
+  }
+
+  startSegment();
+}
+
+
+ReplayPlayer::~ReplayPlayer() = default;
+
+
+void ReplayPlayer::updateAndRender()
+{
+  if (isFinished())
+  {
+    mpWorld->render();
+    return;
+  }
+
+  const auto startTime = base::Clock::now();
+  const auto deadline = startTime + MAX_SIMULATION_TIME_PER_UPDATE;
+
+  do
+  {
+    runOneFrame();
+  } while (!isFinished() && base::Clock::now() < deadline);
+
+  mElapsedWallTime +=
+    std::chrono::duration<double>(base::Clock::now() - startTime).count();
+
+  mpWorld->render();
+
+  if (isFinished())
+  {
+    printSummary();
+  }
+}
+
+
+bool ReplayPlayer::isFinished() const
+{
+  return mSegmentIndex >= mRecording.mSegments.size();
+}
+
+
+void ReplayPlayer::startSegment()
+{
+  const auto& segment = mRecording.mSegments[mSegmentIndex];
+
+  mPlayback.emplace(&segment);
+  mDesyncReportedForSegment = false;
+  mPlayerModel = initialPlayerModel(segment);
+  mpWorld.reset();
+  mpWorld = std::make_unique<GameWorld>(
+    &mPlayerModel,
+    segment.mSessionId,
+    mContext,
+    segment.mPlayerPositionOverride);
+}
+
+
+void ReplayPlayer::runOneFrame()
+{
+  if (!mPlayback->isFinished())
+  {
+    const auto stateMatches = mPlayback->runNextFrame(*mpWorld);
+    ++mNumFramesSimulated;
+
+    if (!stateMatches)
+    {
+      reportDesync();
+    }
+  }
+
+  if (mPlayback->isFinished())
+  {
+    ++mSegmentIndex;
+    if (!isFinished())
+    {
+      startSegment();
+    }
+  }
+}
+
+
+void ReplayPlayer::reportDesync()
+{
+  ++mNumDesyncs;
+
+  // Once a segment has desynced, all subsequent hashes will most likely
+  // mismatch as well, so we only report the first one.
+  if (!mDesyncReportedForSegment)
+  {
+    std::cerr << "Replay desync in segment " << mSegmentIndex << " at frame "
+              << mPlayback->numFramesRun() << '\n';
+    mDesyncReportedForSegment = true;
+  }
+}
+
+
+void ReplayPlayer::printSummary() const
+{
+  const auto simulatedTime = mNumFramesSimulated * GAME_LOGIC_UPDATE_DELAY;
+
+  std::cout << "Replay finished: " << mNumFramesSimulated << " frames in "
+            << mElapsedWallTime * 1000.0 << " ms ("
+            << simulatedTime / std::max(mElapsedWallTime, 0.001)
+            << "x real time), " << mNumDesyncs << " state hash mismatches\n";
+}
+
+} // namespace rigel::game_logic
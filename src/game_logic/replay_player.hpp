@@ -0,0 +1,102 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/game_mode.hpp"
+#include "data/player_model.hpp"
+#include "engine/timing.hpp"
+#include "game_logic/input_recording.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+
+namespace rigel::game_logic
+{
+
+class GameWorld;
+
+
+/** Steps a GameWorld through the frames of one recording segment
+ *
+ * Applies each recorded frame the same way as it happened while recording,
+ * and verifies the recorded state hashes. Shared by ReplayPlayer and
+ * SimulationHost, so that both play back recordings in exactly the same way.
+ */
+class SegmentPlayback
+{
+public:
+  explicit SegmentPlayback(const RecordingSegment* pSegment);
+
+  /** Run the next frame, and verify its state hash if there is one
+   *
+   * Returns false if the recording has a state hash for the frame and it
+   * doesn't match the world's state, true otherwise.
+   */
+  bool runNextFrame(GameWorld& world);
+
+  bool isFinished() const;
+
+  /** Number of frames run so far */
+  std::size_t numFramesRun() const { return mFrameIndex; }
+
+private:
+  const RecordingSegment* mpSegment;
+  std::size_t mFrameIndex = 0;
+  std::size_t mNextHashIndex = 0;
+};
+
+
+/** Plays back an input recording as fast as possible
+ *
+ * Each call to updateAndRender() runs as many logic updates as fit into a
+ * fixed time budget, and then renders the world once. State hashes stored in
+ * the recording are compared against the replayed state, any mismatch is
+ * reported on stderr.
+ */
+class ReplayPlayer
+{
+public:
+  ReplayPlayer(GameMode::Context context, InputRecording recording);
+  ~ReplayPlayer();
+
+  void updateAndRender();
+
+  bool isFinished() const;
+
+private:
+  void startSegment();
+  void runOneFrame();
+  void reportDesync();
+  void printSummary() const;
+
+  GameMode::Context mContext;
+  InputRecording mRecording;
+  data::PlayerModel mPlayerModel;
+
+  std::size_t mSegmentIndex = 0;
+  std::optional<SegmentPlayback> mPlayback;
+  std::size_t mNumFramesSimulated = 0;
+  int mNumDesyncs = 0;
+  bool mDesyncReportedForSegment = false;
+  engine::TimeDelta mElapsedWallTime = 0.0;
+
+  std::unique_ptr<GameWorld> mpWorld;
+};
+
+} // namespace rigel::game_logic
@@ -0,0 +1,214 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "simulation_host.hpp"
+
+#include "common/game_mode.hpp"
+#include "common/game_service_provider.hpp"
+#include "common/user_profile.hpp"
+#include "data/game_traits.hpp"
+#include "data/image.hpp"
+#include "game_logic/entity_prototype.hpp"
+#include "game_logic/game_world.hpp"
+#include "game_logic/replay_player.hpp"
+#include "game_logic/world_state.hpp"
+#include "loader/resource_loader.hpp"
+
+#include <future>
+#include <memory>
+
+
+namespace rigel::game_logic
+{
+
+namespace
+{
+
+/** Service provider for worlds that don't have any audio or screen */
+class NullServiceProvider : public IGameServiceProvider
+{
+public:
+  explicit NullServiceProvider(const CommandLineOptions* pCommandLineOptions)
+    : mpCommandLineOptions(pCommandLineOptions)
+  {
+  }
+
+  void fadeOutScreen() override { }
+  void fadeInScreen() override { }
+  void playSound(data::SoundId) override { }
+  void stopSound(data::SoundId) override { }
+  void stopAllSounds() override { }
+  void playMusic(const std::string&) override { }
+  void stopMusic() override { }
+  void scheduleGameQuit() override { }
+  void switchGamePath(const std::filesystem::path&) override { }
+  void markCurrentFrameAsWidescreen() override { }
+  bool isSharewareVersion() const override { return false; }
+
+  const CommandLineOptions& commandLineOptions() const override
+  {
+    return *mpCommandLineOptions;
+  }
+
+private:
+  const CommandLineOptions* mpCommandLineOptions;
+};
+
+
+engine::TiledTexture makeBlankUiSpriteSheet(renderer::Renderer* pRenderer)
+{
+  // Never drawn, so there's no need to decode the real sprite sheet. Only
+  // the size matters for computing tile positions.
+  const auto image = data::Image{
+    data::GameTraits::viewPortWidthPx, data::GameTraits::viewPortHeightPx};
+  return engine::TiledTexture{renderer::Texture{pRenderer, image}, pRenderer};
+}
+
+} // namespace
+
+
+SimulationHost::SimulationHost(
+  const loader::ResourceLoader* pResources,
+  const data::GameOptions& options,
+  const CommandLineOptions& commandLineOptions,
+  const std::size_t numThreads)
+  : mpResources(pResources)
+  , mOptions(options)
+  , mCommandLineOptions(commandLineOptions)
+  , mRenderer(base::Size<int>{options.mWindowWidth, options.mWindowHeight})
+  , mSpriteFactory(&mRenderer, &pResources->mActorImagePackage)
+  , mUiSpriteSheet(makeBlankUiSpriteSheet(&mRenderer))
+  , mTextRenderer(&mUiSpriteSheet, &mRenderer, *pResources)
+  , mThreadPool(numThreads)
+{
+  registerComponentTypes();
+  registerEventTypes();
+}
+
+
+std::vector<SimulationResult>
+  SimulationHost::run(const std::vector<RecordingSegment>& segments)
+{
+  // Loading a level might write to the level cache, so this is done up
+  // front on the calling thread.
+  std::vector<const data::map::LevelData*> levels;
+  levels.reserve(segments.size());
+  for (const auto& segment : segments)
+  {
+    levels.push_back(&levelData(segment.mSessionId));
+  }
+
+  std::vector<std::future<SimulationResult>> pendingResults;
+  pendingResults.reserve(segments.size());
+  for (auto i = std::size_t{0}; i < segments.size(); ++i)
+  {
+    pendingResults.push_back(mThreadPool.submit(
+      [this, pSegment = &segments[i], pLevel = levels[i]]() {
+        return simulate(*pSegment, *pLevel);
+      }));
+  }
+
+  // Make sure that no job is still running when an exception propagates
+  // out of here, since they reference the segments.
+  for (const auto& pendingResult : pendingResults)
+  {
+    pendingResult.wait();
+  }
+
+  std::vector<SimulationResult> results;
+  results.reserve(pendingResults.size());
+  for (auto& pendingResult : pendingResults)
+  {
+    results.push_back(pendingResult.get());
+  }
+
+  return results;
+}
+
+
+const data::map::LevelData&
+  SimulationHost::levelData(const data::GameSessionId& sessionId)
+{
+  const auto key =
+    LevelKey{sessionId.mEpisode, sessionId.mLevel, sessionId.mDifficulty};
+
+  auto iLevel = mLevels.find(key);
+  if (iLevel == mLevels.end())
+  {
+    iLevel = mLevels.emplace(key, loadLevelData(sessionId, *mpResources)).first;
+  }
+
+  return iLevel->second;
+}
+
+
+SimulationResult SimulationHost::simulate(
+  const RecordingSegment& segment,
+  const data::map::LevelData& level)
+{
+  auto serviceProvider = NullServiceProvider{&mCommandLineOptions};
+  auto userProfile = UserProfile{};
+  userProfile.mOptions = mOptions;
+  auto playerModel = initialPlayerModel(segment);
+
+  auto pWorld = [&]() {
+    const auto lock = std::lock_guard{mWorldCreationMutex};
+
+    return std::make_unique<GameWorld>(
+      &playerModel,
+      segment.mSessionId,
+      GameMode::Context{
+        mpResources,
+        &mRenderer,
+        &serviceProvider,
+        nullptr,
+        nullptr,
+        &mTextRenderer,
+        &mUiSpriteSheet,
+        &mSpriteFactory,
+        &userProfile,
+        nullptr,
+        nullptr},
+      segment.mPlayerPositionOverride,
+      false,
+      PlayerInput{},
+      &level);
+  }();
+
+  auto result = SimulationResult{};
+  auto playback = SegmentPlayback{&segment};
+
+  while (!playback.isFinished())
+  {
+    if (!playback.runNextFrame(*pWorld))
+    {
+      if (!result.mFirstDesyncFrame)
+      {
+        result.mFirstDesyncFrame =
+          static_cast<std::uint32_t>(playback.numFramesRun());
+      }
+
+      ++result.mNumDesyncs;
+    }
+  }
+
+  result.mNumFramesSimulated = playback.numFramesRun();
+  result.mFinalStateHash = pWorld->stateHash();
+  result.mLevelFinished = pWorld->levelFinished();
+  return result;
+}
+
+} // namespace rigel::game_logic
@@ -0,0 +1,136 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/thread_pool.hpp"
+#include "common/command_line_options.hpp"
+#include "data/game_options.hpp"
+#include "data/map.hpp"
+#include "engine/sprite_factory.hpp"
+#include "engine/tiled_texture.hpp"
+#include "game_logic/input_recording.hpp"
+#include "renderer/renderer.hpp"
+#include "ui/menu_element_renderer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+
+namespace rigel::loader
+{
+class ResourceLoader;
+}
+
+
+namespace rigel::game_logic
+{
+
+/** Outcome of simulating one recording segment */
+struct SimulationResult
+{
+  std::size_t mNumFramesSimulated = 0;
+
+  /** Number of state hashes in the segment which didn't match */
+  int mNumDesyncs = 0;
+
+  /** Frame of the first mismatching state hash, if any */
+  std::optional<std::uint32_t> mFirstDesyncFrame;
+
+  std::uint32_t mFinalStateHash = 0;
+  bool mLevelFinished = false;
+};
+
+
+/** Runs many independent game worlds in parallel, without audio or video
+ *
+ * Meant for batch jobs like validating a large number of input recordings,
+ * or automated play-testing. Each job is a recording segment, which is
+ * played back in its own GameWorld as fast as possible. State hashes
+ * contained in a segment are verified the same way as in ReplayPlayer, so
+ * segments without any hashes can be used to just run a sequence of inputs.
+ *
+ * Worlds share the resources, UI assets, and decoded level data - each
+ * distinct level is loaded once, and then copied into every world playing
+ * it. These are immutable while game logic runs. Each world gets its own
+ * player model, user profile, and a service provider which ignores all audio
+ * and screen fade requests. Rendering goes to a headless renderer.
+ *
+ * There is some shared mutable state though:
+ *
+ *  - The sprite factory, which loads sprites on demand. It synchronizes
+ *    access internally.
+ *  - entityx's type ids for components and events, which are assigned from a
+ *    global, unsynchronized counter on first use of a type. The constructor
+ *    assigns ids to all known types up front via registerComponentTypes()
+ *    and registerEventTypes(), so that worlds never need to assign new ids
+ *    while running concurrently. Adding a new component or event type
+ *    without extending these functions reintroduces a data race.
+ *
+ * As an additional safeguard, worlds are created one at a time, since that's
+ * where most types are used for the first time. Afterwards, they run in
+ * parallel. Note that parallel systems (see
+ * CommandLineOptions::mParallelSystems) give each world its own additional
+ * threads, which is usually counter-productive here.
+ */
+class SimulationHost
+{
+public:
+  SimulationHost(
+    const loader::ResourceLoader* pResources,
+    const data::GameOptions& options,
+    const CommandLineOptions& commandLineOptions,
+    std::size_t numThreads);
+
+  SimulationHost(const SimulationHost&) = delete;
+  SimulationHost& operator=(const SimulationHost&) = delete;
+
+  /** Simulate all given segments, and wait for them to finish
+   *
+   * Results are in the same order as the segments. Exceptions thrown while
+   * simulating are propagated after all segments have finished.
+   */
+  std::vector<SimulationResult>
+    run(const std::vector<RecordingSegment>& segments);
+
+  std::size_t numThreads() const { return mThreadPool.numThreads(); }
+
+private:
+  using LevelKey = std::tuple<int, int, data::Difficulty>;
+
+  const data::map::LevelData& levelData(const data::GameSessionId& sessionId);
+  SimulationResult simulate(
+    const RecordingSegment& segment,
+    const data::map::LevelData& level);
+
+  const loader::ResourceLoader* mpResources;
+  data::GameOptions mOptions;
+  CommandLineOptions mCommandLineOptions;
+  renderer::Renderer mRenderer;
+  engine::SpriteFactory mSpriteFactory;
+  engine::TiledTexture mUiSpriteSheet;
+  ui::MenuElementRenderer mTextRenderer;
+  std::map<LevelKey, data::map::LevelData> mLevels;
+  std::mutex mWorldCreationMutex;
+  base::ThreadPool mThreadPool;
+};
+
+} // namespace rigel::game_logic
@@ -17,18 +17,15 @@
 #include "world_state.hpp"
 
 #include "common/game_service_provider.hpp"
+#include "common/memory_accounting.hpp"
+#include "common/user_profile.hpp"
 #include "engine/base_components.hpp"
-#include "engine/life_time_components.hpp"
-#include "engine/physical_components.hpp"
 #include "engine/sprite_factory.hpp"
-#include "engine/visual_components.hpp"
+#include "game_logic/actor_dependencies.hpp"
 #include "game_logic/actor_tag.hpp"
-#include "game_logic/behavior_controller.hpp"
-#include "game_logic/collectable_components.hpp"
-#include "game_logic/damage_components.hpp"
-#include "game_logic/dynamic_geometry_components.hpp"
-#include "game_logic/effect_components.hpp"
-#include "game_logic/interactive/item_container.hpp"
+#include "game_logic/entity_prototype.hpp"
+#include "loader/level_cache.hpp"
+#include "loader/level_loader.hpp"
 #include "loader/resource_loader.hpp"
 #include "renderer/renderer.hpp"
 
@@ -41,6 +38,8 @@ namespace
 
 char EPISODE_PREFIXES[] = {'L', 'M', 'N', 'O'};
 
+const auto LEVEL_CACHE_DIRECTORY = "level_cache";
+
 
 std::string levelFileName(const int episode, const int level)
 {
@@ -54,87 +53,84 @@ std::string levelFileName(const int episode, const int level)
   return fileName;
 }
 
+} // namespace
+
 
-template <typename T>
-void copyComponentIfPresent(entityx::Entity from, entityx::Entity to)
+data::map::LevelData loadLevelData(
+  const data::GameSessionId& sessionId,
+  const loader::ResourceLoader& resources)
 {
-  if (from.has_component<T>())
+  const auto fileName = levelFileName(sessionId.mEpisode, sessionId.mLevel);
+
+  if (const auto preferencesPath = createOrGetPreferencesPath())
   {
-    to.assign<T>(*from.component<const T>());
+    return loader::loadLevelCached(
+      fileName,
+      resources,
+      sessionId.mDifficulty,
+      *preferencesPath / LEVEL_CACHE_DIRECTORY);
   }
+
+  return loader::loadLevel(fileName, resources, sessionId.mDifficulty);
 }
 
 
-void copyAllComponents(entityx::Entity from, entityx::Entity to)
+BonusRelatedItemCounts countBonusRelatedItems(const ActorTagIndex& index)
 {
-  using namespace engine::components;
-  using namespace game_logic::components;
-
-  copyComponentIfPresent<AppearsOnRadar>(from, to);
-  copyComponentIfPresent<ActivationSettings>(from, to);
-  copyComponentIfPresent<Active>(from, to);
-  copyComponentIfPresent<ActorTag>(from, to);
-  copyComponentIfPresent<AnimationLoop>(from, to);
-  copyComponentIfPresent<AnimationSequence>(from, to);
-  copyComponentIfPresent<AutoDestroy>(from, to);
-  copyComponentIfPresent<BehaviorController>(from, to);
-  copyComponentIfPresent<BoundingBox>(from, to);
-  copyComponentIfPresent<CollectableItem>(from, to);
-  copyComponentIfPresent<CollectableItemForCheat>(from, to);
-  copyComponentIfPresent<CollidedWithWorld>(from, to);
-  copyComponentIfPresent<CustomDamageApplication>(from, to);
-  copyComponentIfPresent<DamageInflicting>(from, to);
-  copyComponentIfPresent<DestructionEffects>(from, to);
-  copyComponentIfPresent<DrawTopMost>(from, to);
-  copyComponentIfPresent<ExtendedFrameList>(from, to);
-  copyComponentIfPresent<Interactable>(from, to);
-  copyComponentIfPresent<ItemBounceEffect>(from, to);
-  copyComponentIfPresent<ItemContainer>(from, to);
-  copyComponentIfPresent<MapGeometryLink>(from, to);
-  copyComponentIfPresent<MovementSequence>(from, to);
-  copyComponentIfPresent<MovingBody>(from, to);
-  copyComponentIfPresent<Orientation>(from, to);
-  copyComponentIfPresent<OverrideDrawOrder>(from, to);
-  copyComponentIfPresent<PlayerDamaging>(from, to);
-  copyComponentIfPresent<PlayerProjectile>(from, to);
-  copyComponentIfPresent<RadarDish>(from, to);
-  copyComponentIfPresent<Shootable>(from, to);
-  copyComponentIfPresent<SolidBody>(from, to);
-  copyComponentIfPresent<Sprite>(from, to);
-  copyComponentIfPresent<SpriteCascadeSpawner>(from, to);
-  copyComponentIfPresent<TileDebris>(from, to);
-  copyComponentIfPresent<WorldPosition>(from, to);
-
-  assert(from.component_mask() == to.component_mask());
-}
+  using AT = game_logic::components::ActorTag::Type;
 
-} // namespace
+  auto countOf = [&index](const AT type) {
+    return static_cast<int>(index.count(type));
+  };
+
+  BonusRelatedItemCounts counts;
+  counts.mCameraCount = countOf(AT::ShootableCamera);
+  counts.mFireBombCount = countOf(AT::FireBomb);
+  counts.mWeaponCount = countOf(AT::CollectableWeapon);
+  counts.mMerchandiseCount = countOf(AT::Merchandise);
+  counts.mBonusGlobeCount = countOf(AT::ShootableBonusGlobe);
+  counts.mLaserTurretCount = countOf(AT::MountedLaserTurret);
+  return counts;
+}
 
 
-BonusRelatedItemCounts countBonusRelatedItems(entityx::EntityManager& es)
+std::uint32_t computeStateHash(
+  WorldState& state,
+  const data::PlayerModel& playerModel)
 {
-  using game_logic::components::ActorTag;
-  using AT = ActorTag::Type;
+  using engine::components::WorldPosition;
 
-  BonusRelatedItemCounts counts;
+  // 32-bit FNV-1a
+  auto hash = std::uint32_t{2166136261u};
+  auto addToHash = [&hash](const int value) {
+    const auto bits = static_cast<std::uint32_t>(value);
+    for (auto i = 0u; i < 4u; ++i)
+    {
+      hash ^= (bits >> (i * 8u)) & 0xFF;
+      hash *= 16777619u;
+    }
+  };
 
-  // clang-format off
-  es.each<ActorTag>([&counts](entityx::Entity, const ActorTag& tag) {
-      switch (tag.mType) {
-        case AT::ShootableCamera: ++counts.mCameraCount; break;
-        case AT::FireBomb: ++counts.mFireBombCount; break;
-        case AT::CollectableWeapon: ++counts.mWeaponCount; break;
-        case AT::Merchandise: ++counts.mMerchandiseCount; break;
-        case AT::ShootableBonusGlobe: ++counts.mBonusGlobeCount; break;
-        case AT::MountedLaserTurret: ++counts.mLaserTurretCount; break;
-
-        default:
-          break;
-      }
+  addToHash(state.mRandomGenerator.nextNumberIndex());
+  addToHash(static_cast<int>(state.mEntities.size()));
+
+  state.mEntities.each<WorldPosition>(
+    [&](entityx::Entity entity, const WorldPosition& position) {
+      addToHash(static_cast<int>(entity.id().index()));
+      addToHash(position.x);
+      addToHash(position.y);
     });
-  // clang-format on
 
-  return counts;
+  addToHash(playerModel.score());
+  addToHash(playerModel.health());
+  addToHash(playerModel.ammo());
+  addToHash(static_cast<int>(playerModel.weapon()));
+  for (const auto item : playerModel.inventory())
+  {
+    addToHash(static_cast<int>(item));
+  }
+
+  return hash;
 }
 
 
@@ -154,10 +150,7 @@ WorldState::WorldState(
       pOptions,
       pSpriteFactory,
       sessionId,
-      loader::loadLevel(
-        levelFileName(sessionId.mEpisode, sessionId.mLevel),
-        *pResources,
-        sessionId.mDifficulty))
+      loadLevelData(sessionId, *pResources))
 {
 }
 
@@ -171,7 +164,8 @@ WorldState::WorldState(
   engine::SpriteFactory* pSpriteFactory,
   const data::GameSessionId sessionId,
   data::map::LevelData&& loadedLevel)
-  : mMap(std::move(loadedLevel.mMap))
+  : mConstructionArenaScope(std::in_place, &mArena)
+  , mMap(std::move(loadedLevel.mMap))
   , mEntities(mEventManager)
   , mEntityFactory(
       pSpriteFactory,
@@ -181,6 +175,8 @@ WorldState::WorldState(
       pOptions,
       sessionId.mDifficulty)
   , mRadarDishCounter(mEntities, mEventManager)
+  , mActorTagIndex(mEventManager)
+  , mWorldBounds(mEventManager)
   , mCollisionChecker(&mMap, mEntities, mEventManager)
   , mpOptions(pOptions)
   , mPlayer(
@@ -204,11 +200,10 @@ WorldState::WorldState(
       &mEventManager,
       &mRandomGenerator)
   , mCamera(&mPlayer, mMap, mEventManager)
-  , mParticles(&mRandomGenerator, pRenderer)
+  , mParticles(&mRandomGenerator)
   , mSpriteRenderingSystem(pRenderer, &pSpriteFactory->textureAtlas())
   , mMapRenderer(
       pRenderer,
-      &mMap,
       engine::MapRenderer::MapRenderData{
         std::move(loadedLevel.mTileSetImage),
         std::move(loadedLevel.mBackdropImage),
@@ -260,9 +255,10 @@ WorldState::WorldState(
   , mLevelMusicFile(loadedLevel.mMusicFile)
   , mBackdropSwitchCondition(loadedLevel.mBackdropSwitchCondition)
 {
+  pSpriteFactory->prepareForLevel(actorsNeededForLevel(loadedLevel.mActors));
   mEntityFactory.createEntitiesForLevel(loadedLevel.mActors);
 
-  const auto counts = countBonusRelatedItems(mEntities);
+  const auto counts = countBonusRelatedItems(mActorTagIndex);
   mBonusInfo.mInitialCameraCount = counts.mCameraCount;
   mBonusInfo.mInitialMerchandiseCount = counts.mMerchandiseCount;
   mBonusInfo.mInitialWeaponCount = counts.mWeaponCount;
@@ -274,6 +270,8 @@ WorldState::WorldState(
     mEarthQuakeEffect =
       EarthQuakeEffect{pServiceProvider, &mRandomGenerator, &mEventManager};
   }
+
+  mConstructionArenaScope.reset();
 }
 
 
@@ -283,10 +281,7 @@ void WorldState::synchronizeTo(
   data::PlayerModel* pPlayerModel,
   const data::GameSessionId sessionId)
 {
-  if (mBackdropSwitched != other.mBackdropSwitched)
-  {
-    mMapRenderer.switchBackdrops();
-  }
+  const auto arenaScope = base::ArenaScope{&mArena};
 
   mBonusInfo = other.mBonusInfo;
   mLevelMusicFile = other.mLevelMusicFile;
@@ -362,4 +357,22 @@ void WorldState::synchronizeTo(
   }
 }
 
+
+void WorldState::reportMemoryUsage(
+  MemoryReport& report,
+  const std::string& category)
+{
+  const auto mapBytes = std::size_t(mMap.width()) * std::size_t(mMap.height()) *
+    2 * sizeof(data::map::TileIndex);
+
+  report.add(
+    category,
+    "Memory arena",
+    mArena.reservedBytes(),
+    mArena.numLiveAllocations());
+  report.add(category, "Map tiles", mapBytes);
+  report.add(category, "Entities", 0, mEntities.size());
+  reportComponentCounts(mEntities, report, category);
+}
+
 } // namespace rigel::game_logic
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "base/memory_arena.hpp"
 #include "base/spatial_types.hpp"
 #include "base/warnings.hpp"
 #include "data/bonus.hpp"
@@ -29,6 +30,8 @@
 #include "engine/physics_system.hpp"
 #include "engine/random_number_generator.hpp"
 #include "engine/sprite_rendering_system.hpp"
+#include "engine/world_bounds_mirror.hpp"
+#include "game_logic/actor_tag_index.hpp"
 #include "game_logic/behavior_controller_system.hpp"
 #include "game_logic/camera.hpp"
 #include "game_logic/damage_infliction_system.hpp"
@@ -49,12 +52,15 @@ RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
 RIGEL_RESTORE_WARNINGS
 
+#include <cstdint>
+#include <optional>
 #include <string>
 
 
 namespace rigel
 {
 struct IGameServiceProvider;
+class MemoryReport;
 }
 namespace rigel::data
 {
@@ -87,7 +93,31 @@ struct BonusRelatedItemCounts
   int mLaserTurretCount = 0;
 };
 
-BonusRelatedItemCounts countBonusRelatedItems(entityx::EntityManager& es);
+BonusRelatedItemCounts countBonusRelatedItems(const ActorTagIndex& index);
+
+
+/** Load the level for the given session, as done by WorldState
+ *
+ * Goes through the level cache in the user's preferences directory when
+ * available. Meant for loading a level once, and then creating multiple
+ * WorldStates from copies of the result.
+ */
+data::map::LevelData loadLevelData(
+  const data::GameSessionId& sessionId,
+  const loader::ResourceLoader& resources);
+
+
+struct WorldState;
+
+/** Compute hash over simulation-relevant state
+ *
+ * Covers the positions of all entities, the random number generator's state,
+ * and the player model. Meant for detecting desynchronization when replaying
+ * input recordings, not for exact state comparison.
+ */
+std::uint32_t computeStateHash(
+  WorldState& state,
+  const data::PlayerModel& playerModel);
 
 
 struct LevelBonusInfo
@@ -108,6 +138,14 @@ struct CheckpointData
   base::Vector mPosition;
 };
 
+/** All state belonging to a running level
+ *
+ * Heap storage of components (behavior controllers, item containers etc.)
+ * comes from mArena while it is the active arena. This is the case during
+ * construction and synchronizeTo(), and the owner is expected to activate it
+ * while running logic updates as well. Freeing a level's worth of
+ * entities thus doesn't go through the global allocator for each one.
+ */
 struct WorldState
 {
   WorldState(
@@ -134,6 +172,16 @@ struct WorldState
     data::PlayerModel* pPlayerModel,
     data::GameSessionId sessionId);
 
+  /** Add entity, component and arena usage to the given report
+   *
+   * Must not run concurrently with a logic update on this state.
+   */
+  void reportMemoryUsage(MemoryReport& report, const std::string& category);
+
+  // Must come first, so that it outlives everything allocated from it
+  base::MemoryArena mArena;
+  std::optional<base::ArenaScope> mConstructionArenaScope;
+
   data::map::Map mMap;
 
   entityx::EventManager mEventManager;
@@ -141,6 +189,8 @@ struct WorldState
   engine::RandomNumberGenerator mRandomGenerator;
   EntityFactory mEntityFactory;
   RadarDishCounter mRadarDishCounter;
+  ActorTagIndex mActorTagIndex;
+  engine::WorldBoundsMirror mWorldBounds;
   engine::CollisionChecker mCollisionChecker;
   const data::GameOptions* mpOptions;
 
@@ -175,6 +225,7 @@ struct WorldState
   int mScreenShakeOffsetX = 0;
   data::map::BackdropSwitchCondition mBackdropSwitchCondition;
   int mWaterAnimStep = 0;
+  std::uint32_t mMapAnimationFrame = 0;
   bool mBossDeathAnimationStartPending = false;
   bool mBackdropSwitched = false;
   bool mLevelFinished = false;
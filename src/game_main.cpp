@@ -17,6 +17,7 @@
 #include "game_main.hpp"
 
 #include "base/defer.hpp"
+#include "base/startup_timeline.hpp"
 #include "frontend/game.hpp"
 #include "renderer/opengl.hpp"
 #include "sdl_utils/error.hpp"
@@ -134,11 +135,13 @@ for more info.)");
 void initAndRunGame(
   SDL_Window* pWindow,
   UserProfile& userProfile,
-  const CommandLineOptions& commandLineOptions)
+  const CommandLineOptions& commandLineOptions,
+  base::StartupTimeline& startupTimeline)
 {
   auto run = [&](const CommandLineOptions& options, const bool isFirstLaunch) {
-    showLoadingScreen(pWindow);
-    Game game(options, &userProfile, pWindow, isFirstLaunch);
+    startupTimeline.measure(
+      "Show loading screen", [&]() { showLoadingScreen(pWindow); });
+    Game game(options, &userProfile, pWindow, isFirstLaunch, &startupTimeline);
 
     for (;;)
     {
@@ -192,8 +195,12 @@ void gameMain(const CommandLineOptions& options)
   SetProcessDPIAware();
 #endif
 
-  sdl_utils::check(
-    SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_GAMECONTROLLER));
+  base::StartupTimeline startupTimeline;
+
+  startupTimeline.measure("Initialize SDL", []() {
+    sdl_utils::check(
+      SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_GAMECONTROLLER));
+  });
   auto sdlGuard = defer([]() { SDL_Quit(); });
 
   SDL_version version;
@@ -210,10 +217,15 @@ void gameMain(const CommandLineOptions& options)
   sdl_utils::check(SDL_GL_LoadLibrary(nullptr));
   platform::setGLAttributes();
 
-  auto userProfile = loadOrCreateUserProfile();
-  auto pWindow = platform::createWindow(userProfile.mOptions);
-  SDL_GLContext pGlContext =
-    sdl_utils::check(SDL_GL_CreateContext(pWindow.get()));
+  auto userProfile = startupTimeline.measure(
+    "Load user profile", []() { return loadOrCreateUserProfile(); });
+  auto pWindow = startupTimeline.measure("Create window", [&]() {
+    return platform::createWindow(userProfile.mOptions);
+  });
+  SDL_GLContext pGlContext = startupTimeline.measure(
+    "Create OpenGL context", [&]() {
+      return sdl_utils::check(SDL_GL_CreateContext(pWindow.get()));
+    });
   auto glGuard = defer([pGlContext]() { SDL_GL_DeleteContext(pGlContext); });
 
   renderer::loadGlFunctions();
@@ -226,13 +238,15 @@ void gameMain(const CommandLineOptions& options)
   SDL_DisableScreenSaver();
   SDL_ShowCursor(SDL_DISABLE);
 
-  ui::imgui_integration::init(
-    pWindow.get(), pGlContext, createOrGetPreferencesPath());
+  startupTimeline.measure("Initialize ImGui", [&]() {
+    ui::imgui_integration::init(
+      pWindow.get(), pGlContext, createOrGetPreferencesPath());
+  });
   auto imGuiGuard = defer([]() { ui::imgui_integration::shutdown(); });
 
   try
   {
-    initAndRunGame(pWindow.get(), userProfile, options);
+    initAndRunGame(pWindow.get(), userProfile, options, startupTimeline);
   }
   catch (const std::exception& error)
   {
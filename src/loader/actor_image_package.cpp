@@ -61,10 +61,19 @@ ActorImagePackage::ActorImagePackage(
   LeStreamReader actorInfoReader(actorInfoData);
   const auto numEntries = actorInfoReader.peekU16();
 
+  // The first offset doubles as the number of entries
+  vector<uint16_t> entryOffsets(numEntries);
+  actorInfoReader.readU16Array(entryOffsets.data(), entryOffsets.size());
+
+  // Draw offset x/y, height, width, image data offset (32 bit) and 32 bits
+  // of padding
+  constexpr auto WORDS_PER_FRAME_HEADER = size_t{8};
+  vector<int16_t> frameHeaderWords;
+
   mDrawIndexById.reserve(numEntries);
   for (uint16_t index = 0; index < numEntries; ++index)
   {
-    const auto offset = actorInfoReader.readU16();
+    const auto offset = entryOffsets[index];
 
     LeStreamReader entryReader(actorInfoData);
     entryReader.skipBytes(offset * sizeof(uint16_t));
@@ -74,17 +83,26 @@ ActorImagePackage::ActorImagePackage(
 
     mDrawIndexById.push_back(drawIndex);
 
+    frameHeaderWords.resize(numFrames * WORDS_PER_FRAME_HEADER);
+    entryReader.readS16Array(frameHeaderWords.data(), frameHeaderWords.size());
+
     vector<ActorFrameHeader> frameHeaders;
+    frameHeaders.reserve(numFrames);
     for (size_t frame = 0; frame < numFrames; ++frame)
     {
-      base::Vector drawOffset{entryReader.readS16(), entryReader.readS16()};
+      const auto pWords = &frameHeaderWords[frame * WORDS_PER_FRAME_HEADER];
+      auto unsignedWord = [pWords](const size_t i) {
+        return static_cast<uint16_t>(pWords[i]);
+      };
+
+      base::Vector drawOffset{pWords[0], pWords[1]};
 
-      const auto height = entryReader.readU16();
-      const auto width = entryReader.readU16();
+      const auto height = unsignedWord(2);
+      const auto width = unsignedWord(3);
       base::Extents size{width, height};
 
-      const auto imageDataOffset = entryReader.readU32();
-      entryReader.skipBytes(4); // padding
+      const auto imageDataOffset =
+        unsignedWord(4) | (uint32_t{unsignedWord(5)} << 16);
 
       frameHeaders.emplace_back(
         ActorFrameHeader{drawOffset, size, imageDataOffset});
@@ -99,8 +117,27 @@ ActorImagePackage::ActorImagePackage(
 }
 
 
-ActorData
-  ActorImagePackage::loadActor(const ActorID id, const Palette16& palette) const
+ActorData ActorImagePackage::loadActor(const ActorID id) const
+{
+  const auto& header = headerFor(id);
+  return ActorData{header.mDrawIndex, loadFrameImages(id, header)};
+}
+
+
+ActorInfo ActorImagePackage::loadActorInfo(const ActorID id) const
+{
+  const auto& header = headerFor(id);
+  return ActorInfo{
+    header.mDrawIndex,
+    utils::transformed(header.mFrames, [](const auto& frameHeader) {
+      return ActorInfo::Frame{
+        frameHeader.mDrawOffset, frameHeader.mSizeInTiles};
+    })};
+}
+
+
+auto ActorImagePackage::headerFor(const ActorID id) const
+  -> const ActorHeader&
 {
   // Font has to be loaded using loadFont()
   assert(id != data::ActorID::Menu_font_grayscale);
@@ -113,15 +150,13 @@ ActorData
       std::to_string(static_cast<int>(id)));
   }
 
-  const auto& header = it->second;
-  return ActorData{header.mDrawIndex, loadFrameImages(id, header, palette)};
+  return it->second;
 }
 
 
 std::vector<ActorData::Frame> ActorImagePackage::loadFrameImages(
   const data::ActorID id,
-  const ActorHeader& header,
-  const Palette16& palette) const
+  const ActorHeader& header) const
 {
   return utils::transformed(
     header.mFrames, [&, this, frame = 0](const auto& frameHeader) mutable {
@@ -134,14 +169,14 @@ std::vector<ActorData::Frame> ActorImagePackage::loadFrameImages(
       return ActorData::Frame{
         frameHeader.mDrawOffset,
         frameHeader.mSizeInTiles,
-        maybeReplacement ? *maybeReplacement : loadImage(frameHeader, palette)};
+        maybeReplacement ? data::AnyImage{std::move(*maybeReplacement)}
+                         : data::AnyImage{loadImage(frameHeader)}};
     });
 }
 
 
-data::Image ActorImagePackage::loadImage(
-  const ActorFrameHeader& frameHeader,
-  const Palette16& palette) const
+data::IndexedImage
+  ActorImagePackage::loadImage(const ActorFrameHeader& frameHeader) const
 {
   using T = data::TileImageType;
 
@@ -155,8 +190,8 @@ data::Image ActorImagePackage::loadImage(
   }
 
   const auto dataStart = mImageData.begin() + frameHeader.mFileOffset;
-  return loadTiledImage(
-    dataStart, dataStart + dataSize, width, palette, T::Masked);
+  return loadTiledIndexedImage(
+    dataStart, dataStart + dataSize, width, T::Masked);
 }
 
 
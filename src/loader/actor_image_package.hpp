@@ -37,7 +37,23 @@ struct ActorData
   {
     base::Vector mDrawOffset;
     base::Extents mLogicalSize;
-    data::Image mFrameImage;
+
+    /** Indexed, using INGAME_PALETTE, unless replaced by a PNG file */
+    data::AnyImage mFrameImage;
+  };
+
+  int mDrawIndex;
+  std::vector<Frame> mFrames;
+};
+
+
+/** Like ActorData, but without any image data */
+struct ActorInfo
+{
+  struct Frame
+  {
+    base::Vector mDrawOffset;
+    base::Extents mLogicalSize;
   };
 
   int mDrawIndex;
@@ -59,9 +75,10 @@ public:
     const ByteBuffer& actorInfoData,
     std::optional<std::string> maybeImageReplacementsPath = std::nullopt);
 
-  ActorData loadActor(
-    data::ActorID id,
-    const Palette16& palette = INGAME_PALETTE) const;
+  ActorData loadActor(data::ActorID id) const;
+
+  /** Frame layout of an actor, cheap since it doesn't decode any images */
+  ActorInfo loadActorInfo(data::ActorID id) const;
 
   FontData loadFont() const;
 
@@ -70,6 +87,8 @@ public:
     return mDrawIndexById.at(static_cast<size_t>(id));
   }
 
+  std::size_t imageDataSize() const { return mImageData.size(); }
+
 private:
   struct ActorFrameHeader
   {
@@ -84,14 +103,12 @@ private:
     std::vector<ActorFrameHeader> mFrames;
   };
 
-  std::vector<ActorData::Frame> loadFrameImages(
-    data::ActorID id,
-    const ActorHeader& header,
-    const Palette16& palette) const;
+  const ActorHeader& headerFor(data::ActorID id) const;
+
+  std::vector<ActorData::Frame>
+    loadFrameImages(data::ActorID id, const ActorHeader& header) const;
 
-  data::Image loadImage(
-    const ActorFrameHeader& frameHeader,
-    const Palette16& palette) const;
+  data::IndexedImage loadImage(const ActorFrameHeader& frameHeader) const;
 
 private:
   const ByteBuffer mImageData;
@@ -52,11 +52,14 @@ std::vector<AudioDictEntry> readAudioDict(const ByteBuffer& data)
   vector<AudioDictEntry> dict;
   dict.reserve(numOffsets);
 
+  vector<uint32_t> offsets(numOffsets);
   LeStreamReader reader(data);
-  auto previousOffset = reader.readU32();
+  reader.readU32Array(offsets.data(), offsets.size());
+
+  auto previousOffset = offsets.at(0);
   for (auto i = 1u; i < numOffsets; ++i)
   {
-    const auto nextOffset = reader.readU32();
+    const auto nextOffset = offsets[i];
 
     const auto chunkSize = static_cast<int64_t>(nextOffset) - previousOffset;
 
@@ -81,18 +84,12 @@ std::vector<AudioDictEntry> readAudioDict(const ByteBuffer& data)
 AudioPackage::AdlibSound::AdlibSound(LeStreamReader& reader)
 {
   const auto length = reader.readU32();
-  mSoundData.reserve(length);
   reader.skipBytes(sizeof(uint16_t)); // priority - not interesting for us
-  for (auto& setting : mInstrumentSettings)
-  {
-    setting = reader.readU8();
-  }
+  reader.readU8Array(mInstrumentSettings.data(), mInstrumentSettings.size());
   mOctave = reader.readU8();
 
-  for (auto i = 0u; i < length; ++i)
-  {
-    mSoundData.push_back(reader.readU8());
-  }
+  mSoundData.resize(length);
+  reader.readU8Array(mSoundData.data(), mSoundData.size());
 }
 
 
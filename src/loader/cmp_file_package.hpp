@@ -37,6 +37,8 @@ public:
 
   bool hasFile(const std::string& name) const;
 
+  std::size_t sizeInBytes() const { return mFileData.size(); }
+
 private:
   struct DictEntry
   {
@@ -38,9 +38,6 @@ using data::tilesToPixels;
 namespace
 {
 
-using PalettizedPixelBuffer = std::vector<std::uint8_t>;
-
-
 size_t inferHeight(
   const ByteBufferCIter begin,
   const ByteBufferCIter end,
@@ -149,16 +146,15 @@ void applyEgaMask(
 }
 
 
-template <typename Callable>
-data::PixelBuffer decodeTiledEgaData(
+template <typename Buffer, typename Callable>
+Buffer decodeTiledEgaData(
   const ByteBufferCIter dataIter,
   const std::size_t widthInTiles,
   const std::size_t heightInTiles,
   Callable decodeRow)
 {
   const auto targetBufferStride = tilesToPixels(widthInTiles);
-  PixelBuffer pixels(
-    widthInTiles * heightInTiles * GameTraits::tileSizeSquared);
+  Buffer pixels(widthInTiles * heightInTiles * GameTraits::tileSizeSquared);
 
   BitWiseIterator<ByteBufferCIter> bitsIter(dataIter);
   for (auto row = 0u; row < heightInTiles; ++row)
@@ -182,10 +178,9 @@ data::PixelBuffer decodeTiledEgaData(
 } // namespace
 
 
-data::PixelBuffer decodeSimplePlanarEgaBuffer(
+data::IndexBuffer decodeSimplePlanarEgaIndices(
   const ByteBufferCIter begin,
-  const ByteBufferCIter end,
-  const Palette16& palette)
+  const ByteBufferCIter end)
 {
   const auto numBytes = distance(begin, end);
   assert(numBytes > 0);
@@ -193,12 +188,20 @@ data::PixelBuffer decodeSimplePlanarEgaBuffer(
     GameTraits::pixelsPerEgaByte;
 
   BitWiseIterator<ByteBufferCIter> bitsIter(begin);
-  PalettizedPixelBuffer indexedPixels(numPixels, 0);
+  data::IndexBuffer indexedPixels(numPixels, 0);
   readEgaColorData(bitsIter, indexedPixels.begin(), numPixels);
+  return indexedPixels;
+}
 
-  return utils::transformed(indexedPixels, [&palette](const auto colorIndex) {
-    return palette[colorIndex];
-  });
+
+data::PixelBuffer decodeSimplePlanarEgaBuffer(
+  const ByteBufferCIter begin,
+  const ByteBufferCIter end,
+  const Palette16& palette)
+{
+  return utils::transformed(
+    decodeSimplePlanarEgaIndices(begin, end),
+    [&palette](const auto colorIndex) { return palette[colorIndex]; });
 }
 
 
@@ -212,7 +215,7 @@ data::Image loadTiledImage(
   const auto heightInTiles =
     inferHeight(begin, end, widthInTiles, GameTraits::bytesPerTile(type));
 
-  auto pixels = decodeTiledEgaData(
+  auto pixels = decodeTiledEgaData<PixelBuffer>(
     begin,
     widthInTiles,
     heightInTiles,
@@ -250,6 +253,52 @@ data::Image loadTiledImage(
 }
 
 
+data::IndexedImage loadTiledIndexedImage(
+  const ByteBufferCIter begin,
+  const ByteBufferCIter end,
+  std::size_t widthInTiles,
+  const data::TileImageType type)
+{
+  const auto heightInTiles =
+    inferHeight(begin, end, widthInTiles, GameTraits::bytesPerTile(type));
+
+  auto indices = decodeTiledEgaData<data::IndexBuffer>(
+    begin,
+    widthInTiles,
+    heightInTiles,
+    [type](auto sourceBitsIter, const auto targetIndexIter) {
+      const auto isMasked = type == data::TileImageType::Masked;
+      array<bool, GameTraits::tileSize> pixelMask;
+      if (isMasked)
+      {
+        sourceBitsIter = readEgaMaskPlane(
+          sourceBitsIter, pixelMask.begin(), GameTraits::tileSize);
+      }
+
+      sourceBitsIter =
+        readEgaColorData(sourceBitsIter, targetIndexIter, GameTraits::tileSize);
+
+      if (isMasked)
+      {
+        for (auto i = 0; i < GameTraits::tileSize; ++i)
+        {
+          if (pixelMask[i])
+          {
+            *(targetIndexIter + i) = EGA_TRANSPARENT_INDEX;
+          }
+        }
+      }
+
+      return sourceBitsIter;
+    });
+
+  return data::IndexedImage(
+    std::move(indices),
+    tilesToPixels(widthInTiles),
+    tilesToPixels(heightInTiles));
+}
+
+
 data::Image loadTiledFontBitmap(
   const ByteBufferCIter begin,
   const ByteBufferCIter end,
@@ -258,7 +307,7 @@ data::Image loadTiledFontBitmap(
   const auto heightInTiles =
     inferHeight(begin, end, widthInTiles, GameTraits::bytesPerFontTile());
 
-  auto pixels = decodeTiledEgaData(
+  auto pixels = decodeTiledEgaData<PixelBuffer>(
     begin,
     widthInTiles,
     heightInTiles,
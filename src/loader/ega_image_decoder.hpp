@@ -25,6 +25,19 @@
 namespace rigel::loader
 {
 
+/** Palette index used for masked pixels in indexed EGA images
+ *
+ * EGA images only use 16 colors, so this is the first index outside of a
+ * 16-color palette, which makes it transparent (see data::IndexedImage).
+ */
+constexpr auto EGA_TRANSPARENT_INDEX = std::uint8_t{16};
+
+
+data::IndexBuffer decodeSimplePlanarEgaIndices(
+  ByteBufferCIter begin,
+  ByteBufferCIter end);
+
+
 data::PixelBuffer decodeSimplePlanarEgaBuffer(
   ByteBufferCIter begin,
   ByteBufferCIter end,
@@ -48,6 +61,21 @@ inline data::Image loadTiledImage(
   return loadTiledImage(data.begin(), data.end(), widthInTiles, palette, type);
 }
 
+data::IndexedImage loadTiledIndexedImage(
+  ByteBufferCIter begin,
+  ByteBufferCIter end,
+  std::size_t widthInTiles,
+  data::TileImageType type);
+
+
+inline data::IndexedImage loadTiledIndexedImage(
+  const ByteBuffer& data,
+  std::size_t widthInTiles,
+  const data::TileImageType type = data::TileImageType::Unmasked)
+{
+  return loadTiledIndexedImage(data.begin(), data.end(), widthInTiles, type);
+}
+
 data::Image loadTiledFontBitmap(
   ByteBufferCIter begin,
   ByteBufferCIter end,
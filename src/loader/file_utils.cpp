@@ -17,8 +17,10 @@
 #include "file_utils.hpp"
 
 #include <cassert>
+#include <cstring>
 #include <fstream>
 #include <stdexcept>
+#include <type_traits>
 
 
 namespace rigel::loader
@@ -32,9 +34,59 @@ namespace
 
 const char* OUT_OF_DATA_ERROR_MSG = "No more data in stream";
 
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+constexpr auto IS_LITTLE_ENDIAN_HOST = false;
+#else
+constexpr auto IS_LITTLE_ENDIAN_HOST = true;
+#endif
+
+
+template <typename T>
+T decodeLittleEndian(const uint8_t* pSource)
+{
+  using Unsigned = make_unsigned_t<T>;
+
+  auto value = Unsigned{0};
+  for (auto i = 0u; i < sizeof(T); ++i)
+  {
+    value |= static_cast<Unsigned>(Unsigned{pSource[i]} << (i * 8u));
+  }
+
+  return static_cast<T>(value);
 }
 
 
+template <typename T>
+void decodeLittleEndianArray(
+  const uint8_t* pSource,
+  T* pDestination,
+  const size_t count)
+{
+  static_assert(is_integral_v<T>);
+
+  if (count == 0)
+  {
+    return;
+  }
+
+  if constexpr (IS_LITTLE_ENDIAN_HOST)
+  {
+    // The file layout matches the in-memory layout, no conversion needed
+    memcpy(pDestination, pSource, count * sizeof(T));
+  }
+  else
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      pDestination[i] = decodeLittleEndian<T>(pSource + i * sizeof(T));
+    }
+  }
+}
+
+} // namespace
+
+
 ByteBuffer loadFile(const string& fileName)
 {
   ifstream file(fileName, ios::binary | ios::ate);
@@ -89,37 +141,26 @@ LeStreamReader::LeStreamReader(ByteBufferCIter begin, ByteBufferCIter end)
 
 uint8_t LeStreamReader::readU8()
 {
-  if (mCurrentByteIter == mDataEnd)
-  {
-    throw runtime_error(OUT_OF_DATA_ERROR_MSG);
-  }
-  return *mCurrentByteIter++;
+  return *consumeBytes(1);
 }
 
 
 uint16_t LeStreamReader::readU16()
 {
-  const auto lsb = readU8();
-  const auto msb = readU8();
-  return lsb | uint16_t(msb << 8);
+  return decodeLittleEndian<uint16_t>(consumeBytes(2));
 }
 
 
 uint32_t LeStreamReader::readU24()
 {
-  const auto lsb = readU8();
-  const auto middle = readU8();
-  const auto msb = readU8();
-
-  return lsb | (middle << 8) | (msb << 16);
+  const auto pBytes = consumeBytes(3);
+  return pBytes[0] | (pBytes[1] << 8) | (pBytes[2] << 16);
 }
 
 
 uint32_t LeStreamReader::readU32()
 {
-  const auto lowWord = readU16();
-  const auto highWord = readU16();
-  return lowWord | (highWord << 16);
+  return decodeLittleEndian<uint32_t>(consumeBytes(4));
 }
 
 
@@ -150,6 +191,33 @@ int32_t LeStreamReader::readS32()
 }
 
 
+void LeStreamReader::readU8Array(uint8_t* pDestination, const size_t count)
+{
+  decodeLittleEndianArray(consumeBytes(count), pDestination, count);
+}
+
+
+void LeStreamReader::readU16Array(uint16_t* pDestination, const size_t count)
+{
+  decodeLittleEndianArray(
+    consumeBytes(count * sizeof(uint16_t)), pDestination, count);
+}
+
+
+void LeStreamReader::readU32Array(uint32_t* pDestination, const size_t count)
+{
+  decodeLittleEndianArray(
+    consumeBytes(count * sizeof(uint32_t)), pDestination, count);
+}
+
+
+void LeStreamReader::readS16Array(int16_t* pDestination, const size_t count)
+{
+  decodeLittleEndianArray(
+    consumeBytes(count * sizeof(int16_t)), pDestination, count);
+}
+
+
 template <typename Callable>
 auto LeStreamReader::withPreservingCurrentIter(Callable func)
 {
@@ -210,15 +278,26 @@ int32_t LeStreamReader::peekS32()
 
 void LeStreamReader::skipBytes(const size_t count)
 {
-  assert(distance(mCurrentByteIter, mDataEnd) >= 0);
-  const auto availableBytes =
-    static_cast<size_t>(distance(mCurrentByteIter, mDataEnd));
-  if (availableBytes < count)
+  consumeBytes(count);
+}
+
+
+const uint8_t* LeStreamReader::consumeBytes(const size_t count)
+{
+  if (bytesRemaining() < count)
   {
     throw runtime_error(OUT_OF_DATA_ERROR_MSG);
   }
 
+  if (count == 0)
+  {
+    // mCurrentByteIter might be the end iterator, can't dereference it
+    return nullptr;
+  }
+
+  const auto pBytes = &*mCurrentByteIter;
   advance(mCurrentByteIter, count);
+  return pBytes;
 }
 
 
@@ -228,6 +307,13 @@ bool LeStreamReader::hasData() const
 }
 
 
+size_t LeStreamReader::bytesRemaining() const
+{
+  assert(distance(mCurrentByteIter, mDataEnd) >= 0);
+  return static_cast<size_t>(distance(mCurrentByteIter, mDataEnd));
+}
+
+
 ByteBufferCIter LeStreamReader::currentIter() const
 {
   return mCurrentByteIter;
@@ -236,14 +322,11 @@ ByteBufferCIter LeStreamReader::currentIter() const
 
 string readFixedSizeString(LeStreamReader& reader, const size_t len)
 {
-  vector<char> characters;
-  for (size_t i = 0; i < len; ++i)
-  {
-    characters.push_back(static_cast<char>(reader.readU8()));
-  }
+  static_assert(sizeof(char) == sizeof(uint8_t));
 
-  // Ensure string is zero-terminated
-  characters.push_back(0);
+  // One extra element to ensure the string is zero-terminated
+  vector<char> characters(len + 1, 0);
+  reader.readU8Array(reinterpret_cast<uint8_t*>(characters.data()), len);
 
   // Let std::string's ctor handle the zero-terminator detection
   return string(characters.data());
@@ -47,6 +47,11 @@ std::string asText(const ByteBuffer& buffer);
 /** Offers checked reading of little-endian data from a byte buffer
  *
  * All readX() methods will throw if there is not enough data left.
+ *
+ * For reading many values of the same type, prefer the readXArray()
+ * methods. These check the available data once for the whole range and then
+ * decode it in bulk, instead of checking each byte individually. If there is
+ * not enough data, they throw without consuming anything.
  */
 class LeStreamReader
 {
@@ -66,6 +71,12 @@ public:
   std::int32_t readS24();
   std::int32_t readS32();
 
+  void readU8Array(std::uint8_t* pDestination, std::size_t count);
+  void readU16Array(std::uint16_t* pDestination, std::size_t count);
+  void readU32Array(std::uint32_t* pDestination, std::size_t count);
+
+  void readS16Array(std::int16_t* pDestination, std::size_t count);
+
   std::uint8_t peekU8();
   std::uint16_t peekU16();
   std::uint32_t peekU24();
@@ -78,12 +89,19 @@ public:
 
   void skipBytes(std::size_t count);
   bool hasData() const;
+  std::size_t bytesRemaining() const;
   ByteBufferCIter currentIter() const;
 
 private:
   template <typename Callable>
   auto withPreservingCurrentIter(Callable func);
 
+  /** Returns pointer to the next count bytes and advances past them
+   *
+   * Throws if fewer than count bytes are left.
+   */
+  const std::uint8_t* consumeBytes(std::size_t count);
+
   ByteBufferCIter mCurrentByteIter;
   const ByteBufferCIter mDataEnd;
 };
@@ -0,0 +1,566 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "level_cache.hpp"
+
+#include "data/game_traits.hpp"
+#include "loader/file_utils.hpp"
+#include "loader/level_loader.hpp"
+#include "loader/resource_loader.hpp"
+
+#include "version_info.hpp"
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+
+
+namespace rigel::loader
+{
+
+using data::map::LevelData;
+
+namespace fs = std::filesystem;
+
+
+namespace
+{
+
+constexpr char MAGIC[] = {'R', 'G', 'L', 'C'};
+constexpr std::uint16_t FORMAT_VERSION = 2;
+
+const auto CACHE_FILE_EXTENSION = ".lvlcache";
+
+
+void addToHash(std::uint64_t& hash, const std::uint8_t* pData, std::size_t size)
+{
+  // 64-bit FNV-1a
+  for (auto i = std::size_t{0}; i < size; ++i)
+  {
+    hash ^= pData[i];
+    hash *= 1099511628211ull;
+  }
+}
+
+
+void addToHash(std::uint64_t& hash, const std::uint64_t value)
+{
+  addToHash(hash, reinterpret_cast<const std::uint8_t*>(&value), sizeof(value));
+}
+
+
+void addToHash(std::uint64_t& hash, const ByteBuffer& data)
+{
+  addToHash(hash, static_cast<std::uint64_t>(data.size()));
+  addToHash(hash, data.data(), data.size());
+}
+
+
+void addToHash(std::uint64_t& hash, const std::string& text)
+{
+  addToHash(hash, ByteBuffer(text.begin(), text.end()));
+}
+
+
+std::uint64_t hashString(const std::string& text)
+{
+  auto hash = std::uint64_t{14695981039346656037ull};
+  addToHash(hash, text);
+  return hash;
+}
+
+
+void writeU8(ByteBuffer& buffer, const std::uint8_t value)
+{
+  buffer.push_back(value);
+}
+
+
+void writeU16(ByteBuffer& buffer, const std::uint16_t value)
+{
+  buffer.push_back(static_cast<std::uint8_t>(value & 0xFF));
+  buffer.push_back(static_cast<std::uint8_t>(value >> 8));
+}
+
+
+void writeU32(ByteBuffer& buffer, const std::uint32_t value)
+{
+  writeU16(buffer, static_cast<std::uint16_t>(value & 0xFFFF));
+  writeU16(buffer, static_cast<std::uint16_t>(value >> 16));
+}
+
+
+void writeU64(ByteBuffer& buffer, const std::uint64_t value)
+{
+  writeU32(buffer, static_cast<std::uint32_t>(value & 0xFFFFFFFF));
+  writeU32(buffer, static_cast<std::uint32_t>(value >> 32));
+}
+
+
+std::uint64_t readU64(LeStreamReader& reader)
+{
+  const auto low = std::uint64_t{reader.readU32()};
+  const auto high = std::uint64_t{reader.readU32()};
+  return low | (high << 32);
+}
+
+
+void writeString(ByteBuffer& buffer, const std::string& text)
+{
+  writeU16(buffer, static_cast<std::uint16_t>(text.size()));
+  buffer.insert(buffer.end(), text.begin(), text.end());
+}
+
+
+std::string readString(LeStreamReader& reader)
+{
+  const auto length = reader.readU16();
+  return readFixedSizeString(reader, length);
+}
+
+
+void writeImage(ByteBuffer& buffer, const data::Image& image)
+{
+  static_assert(sizeof(data::Pixel) == 4);
+  static_assert(std::is_trivially_copyable_v<data::Pixel>);
+
+  writeU32(buffer, static_cast<std::uint32_t>(image.width()));
+  writeU32(buffer, static_cast<std::uint32_t>(image.height()));
+
+  const auto& pixels = image.pixelData();
+  const auto pBytes = reinterpret_cast<const std::uint8_t*>(pixels.data());
+  buffer.insert(
+    buffer.end(), pBytes, pBytes + pixels.size() * sizeof(data::Pixel));
+}
+
+
+data::Image readImage(LeStreamReader& reader)
+{
+  const auto width = std::size_t{reader.readU32()};
+  const auto height = std::size_t{reader.readU32()};
+
+  // Raw pixel data is copied in one go. Skipping over it first makes sure
+  // that there is enough data left.
+  const auto numBytes = width * height * sizeof(data::Pixel);
+  const auto pixelDataBegin = reader.currentIter();
+  reader.skipBytes(numBytes);
+
+  data::PixelBuffer pixels(width * height);
+  if (numBytes > 0)
+  {
+    std::memcpy(pixels.data(), &*pixelDataBegin, numBytes);
+  }
+
+  return data::Image{std::move(pixels), width, height};
+}
+
+
+void writeIndexedImage(ByteBuffer& buffer, const data::IndexedImage& image)
+{
+  writeU32(buffer, static_cast<std::uint32_t>(image.width()));
+  writeU32(buffer, static_cast<std::uint32_t>(image.height()));
+
+  const auto& indices = image.indexData();
+  buffer.insert(buffer.end(), indices.begin(), indices.end());
+}
+
+
+data::IndexedImage readIndexedImage(LeStreamReader& reader)
+{
+  const auto width = std::size_t{reader.readU32()};
+  const auto height = std::size_t{reader.readU32()};
+
+  const auto indicesBegin = reader.currentIter();
+  reader.skipBytes(width * height);
+
+  return data::IndexedImage{
+    data::IndexBuffer(indicesBegin, indicesBegin + width * height),
+    width,
+    height};
+}
+
+
+enum class ImageKind : std::uint8_t
+{
+  TrueColor = 0,
+  Indexed = 1
+};
+
+
+void writeAnyImage(ByteBuffer& buffer, const data::AnyImage& image)
+{
+  if (const auto pIndexed = std::get_if<data::IndexedImage>(&image))
+  {
+    writeU8(buffer, static_cast<std::uint8_t>(ImageKind::Indexed));
+    writeIndexedImage(buffer, *pIndexed);
+  }
+  else
+  {
+    writeU8(buffer, static_cast<std::uint8_t>(ImageKind::TrueColor));
+    writeImage(buffer, std::get<data::Image>(image));
+  }
+}
+
+
+data::AnyImage readAnyImage(LeStreamReader& reader)
+{
+  switch (static_cast<ImageKind>(reader.readU8()))
+  {
+    case ImageKind::TrueColor:
+      return readImage(reader);
+
+    case ImageKind::Indexed:
+      return readIndexedImage(reader);
+  }
+
+  throw std::runtime_error("Invalid image kind");
+}
+
+
+void writeActor(ByteBuffer& buffer, const LevelData::Actor& actor)
+{
+  writeU16(buffer, static_cast<std::uint16_t>(actor.mPosition.x));
+  writeU16(buffer, static_cast<std::uint16_t>(actor.mPosition.y));
+  writeU16(buffer, static_cast<std::uint16_t>(actor.mID));
+
+  writeU8(buffer, actor.mAssignedArea ? 1 : 0);
+  if (actor.mAssignedArea)
+  {
+    const auto& area = *actor.mAssignedArea;
+    writeU16(buffer, static_cast<std::uint16_t>(area.topLeft.x));
+    writeU16(buffer, static_cast<std::uint16_t>(area.topLeft.y));
+    writeU16(buffer, static_cast<std::uint16_t>(area.size.width));
+    writeU16(buffer, static_cast<std::uint16_t>(area.size.height));
+  }
+}
+
+
+LevelData::Actor readActor(LeStreamReader& reader)
+{
+  LevelData::Actor actor;
+  actor.mPosition.x = reader.readU16();
+  actor.mPosition.y = reader.readU16();
+  actor.mID = static_cast<data::ActorID>(reader.readU16());
+
+  if (reader.readU8() != 0)
+  {
+    base::Rect<int> area;
+    area.topLeft.x = reader.readU16();
+    area.topLeft.y = reader.readU16();
+    area.size.width = reader.readU16();
+    area.size.height = reader.readU16();
+    actor.mAssignedArea = area;
+  }
+
+  return actor;
+}
+
+
+void writeMap(ByteBuffer& buffer, const data::map::Map& map)
+{
+  writeU16(buffer, static_cast<std::uint16_t>(map.width()));
+  writeU16(buffer, static_cast<std::uint16_t>(map.height()));
+
+  const auto& attributes = map.attributeDict().bitPacks();
+  writeU16(buffer, static_cast<std::uint16_t>(attributes.size()));
+  for (const auto bitPack : attributes)
+  {
+    writeU16(buffer, bitPack);
+  }
+
+  for (auto layer = 0; layer < 2; ++layer)
+  {
+    for (auto y = 0; y < map.height(); ++y)
+    {
+      for (auto x = 0; x < map.width(); ++x)
+      {
+        writeU16(buffer, static_cast<std::uint16_t>(map.tileAt(layer, x, y)));
+      }
+    }
+  }
+}
+
+
+data::map::Map readMap(LeStreamReader& reader)
+{
+  const auto width = static_cast<int>(reader.readU16());
+  const auto height = static_cast<int>(reader.readU16());
+
+  const auto numAttributes = reader.readU16();
+  data::map::TileAttributeDict::AttributeArray attributes;
+  attributes.reserve(numAttributes);
+  for (auto i = 0; i < numAttributes; ++i)
+  {
+    attributes.push_back(reader.readU16());
+  }
+
+  data::map::Map map(
+    width, height, data::map::TileAttributeDict{std::move(attributes)});
+
+  for (auto layer = 0; layer < 2; ++layer)
+  {
+    for (auto y = 0; y < height; ++y)
+    {
+      for (auto x = 0; x < width; ++x)
+      {
+        // Tiles are 0 by default, so only non-empty ones need to be set
+        if (const auto tile = reader.readU16())
+        {
+          map.setTileAt(layer, x, y, tile);
+        }
+      }
+    }
+  }
+
+  return map;
+}
+
+
+fs::path cacheFilePath(
+  const fs::path& cacheDirectory,
+  const fs::path& gamePath,
+  const std::string& mapName,
+  const data::Difficulty chosenDifficulty)
+{
+  // Different game directories might contain different versions of the same
+  // level. A digest of the directory's path keeps their entries from
+  // overwriting each other.
+  const auto gamePathDigest =
+    hashString(fs::absolute(gamePath).lexically_normal().u8string());
+
+  auto fileName = std::stringstream{};
+  fileName << mapName << '_' << static_cast<int>(chosenDifficulty) << '_'
+           << std::hex << std::setw(16) << std::setfill('0') << gamePathDigest
+           << CACHE_FILE_EXTENSION;
+  return cacheDirectory / fs::u8path(fileName.str());
+}
+
+
+std::optional<LevelData> tryLoadFromCache(
+  const fs::path& cacheFile,
+  const std::uint64_t sourceHash)
+{
+  if (!fs::exists(cacheFile))
+  {
+    return {};
+  }
+
+  try
+  {
+    return deserializeLevelData(loadFile(cacheFile), sourceHash);
+  }
+  catch (const std::exception& ex)
+  {
+    std::cerr << "WARNING: Ignoring broken level cache file "
+              << cacheFile.u8string() << ": " << ex.what() << '\n';
+    return {};
+  }
+}
+
+
+void tryWriteToCache(
+  const fs::path& cacheFile,
+  const LevelData& level,
+  const std::uint64_t sourceHash)
+{
+  try
+  {
+    fs::create_directories(cacheFile.parent_path());
+
+    // Write to a temporary file first, so that an interrupted write can't
+    // leave a truncated cache file behind.
+    auto tempFile = cacheFile;
+    tempFile += ".tmp";
+    saveToFile(serializeLevelData(level, sourceHash), tempFile);
+    fs::rename(tempFile, cacheFile);
+  }
+  catch (const std::exception& ex)
+  {
+    std::cerr << "WARNING: Failed to write level cache file "
+              << cacheFile.u8string() << ": " << ex.what() << '\n';
+  }
+}
+
+} // namespace
+
+
+std::uint64_t levelSourceHash(
+  const std::string& mapName,
+  const ResourceLoader& resources,
+  const data::Difficulty chosenDifficulty)
+{
+  auto hash = std::uint64_t{14695981039346656037ull};
+
+  addToHash(hash, std::string{COMMIT_HASH});
+  addToHash(hash, std::uint64_t{VERSION_MAJOR});
+  addToHash(hash, std::uint64_t{VERSION_MINOR});
+  addToHash(hash, std::uint64_t{VERSION_PATCH});
+
+  const auto difficulty = static_cast<std::uint8_t>(chosenDifficulty);
+  addToHash(hash, &difficulty, sizeof(difficulty));
+
+  for (const auto& fileName : levelSourceFiles(mapName, resources))
+  {
+    addToHash(hash, fileName);
+    addToHash(hash, resources.file(fileName));
+
+    if (const auto replacementPath = resources.replacementImagePath(fileName))
+    {
+      const auto size =
+        static_cast<std::uint64_t>(fs::file_size(*replacementPath));
+      const auto modificationTime = static_cast<std::uint64_t>(
+        fs::last_write_time(*replacementPath).time_since_epoch().count());
+      addToHash(hash, size);
+      addToHash(hash, modificationTime);
+    }
+  }
+
+  addToHash(hash, resources.file(ActorImagePackage::ACTOR_INFO_FILE));
+
+  return hash;
+}
+
+
+ByteBuffer serializeLevelData(
+  const LevelData& level,
+  const std::uint64_t sourceHash)
+{
+  ByteBuffer buffer;
+
+  for (const auto c : MAGIC)
+  {
+    writeU8(buffer, static_cast<std::uint8_t>(c));
+  }
+
+  writeU16(buffer, FORMAT_VERSION);
+  writeU64(buffer, sourceHash);
+
+  writeAnyImage(buffer, level.mTileSetImage);
+  writeAnyImage(buffer, level.mBackdropImage);
+  writeU8(buffer, level.mSecondaryBackdropImage ? 1 : 0);
+  if (level.mSecondaryBackdropImage)
+  {
+    writeAnyImage(buffer, *level.mSecondaryBackdropImage);
+  }
+
+  writeMap(buffer, level.mMap);
+
+  writeU32(buffer, static_cast<std::uint32_t>(level.mActors.size()));
+  for (const auto& actor : level.mActors)
+  {
+    writeActor(buffer, actor);
+  }
+
+  writeU16(buffer, static_cast<std::uint16_t>(level.mPlayerSpawnPosition.x));
+  writeU16(buffer, static_cast<std::uint16_t>(level.mPlayerSpawnPosition.y));
+  writeU8(buffer, level.mPlayerFacingLeft ? 1 : 0);
+  writeU8(buffer, static_cast<std::uint8_t>(level.mBackdropScrollMode));
+  writeU8(buffer, static_cast<std::uint8_t>(level.mBackdropSwitchCondition));
+  writeU8(buffer, level.mEarthquake ? 1 : 0);
+  writeString(buffer, level.mMusicFile);
+
+  return buffer;
+}
+
+
+std::optional<LevelData>
+  deserializeLevelData(const ByteBuffer& data, const std::uint64_t sourceHash)
+{
+  LeStreamReader reader(data);
+
+  for (const auto c : MAGIC)
+  {
+    if (reader.readU8() != static_cast<std::uint8_t>(c))
+    {
+      throw std::runtime_error("Not a level cache file");
+    }
+  }
+
+  if (reader.readU16() != FORMAT_VERSION || readU64(reader) != sourceHash)
+  {
+    return {};
+  }
+
+  auto tileSetImage = readAnyImage(reader);
+  auto backdropImage = readAnyImage(reader);
+  std::optional<data::AnyImage> secondaryBackdropImage;
+  if (reader.readU8() != 0)
+  {
+    secondaryBackdropImage = readAnyImage(reader);
+  }
+
+  auto map = readMap(reader);
+
+  const auto numActors = reader.readU32();
+  std::vector<LevelData::Actor> actors;
+  actors.reserve(numActors);
+  for (auto i = 0u; i < numActors; ++i)
+  {
+    actors.push_back(readActor(reader));
+  }
+
+  base::Vector playerSpawnPosition;
+  playerSpawnPosition.x = reader.readU16();
+  playerSpawnPosition.y = reader.readU16();
+  const auto playerFacingLeft = reader.readU8() != 0;
+  const auto scrollMode =
+    static_cast<data::map::BackdropScrollMode>(reader.readU8());
+  const auto switchCondition =
+    static_cast<data::map::BackdropSwitchCondition>(reader.readU8());
+  const auto earthquake = reader.readU8() != 0;
+  auto musicFile = readString(reader);
+
+  return LevelData{
+    std::move(tileSetImage),
+    std::move(backdropImage),
+    std::move(secondaryBackdropImage),
+    std::move(map),
+    std::move(actors),
+    playerSpawnPosition,
+    playerFacingLeft,
+    scrollMode,
+    switchCondition,
+    earthquake,
+    std::move(musicFile)};
+}
+
+
+LevelData loadLevelCached(
+  const std::string& mapName,
+  const ResourceLoader& resources,
+  const data::Difficulty chosenDifficulty,
+  const fs::path& cacheDirectory)
+{
+  const auto sourceHash =
+    levelSourceHash(mapName, resources, chosenDifficulty);
+  const auto cacheFile = cacheFilePath(
+    cacheDirectory, resources.gamePath(), mapName, chosenDifficulty);
+
+  if (auto cachedLevel = tryLoadFromCache(cacheFile, sourceHash))
+  {
+    return std::move(*cachedLevel);
+  }
+
+  auto level = loadLevel(mapName, resources, chosenDifficulty);
+  tryWriteToCache(cacheFile, level, sourceHash);
+  return level;
+}
+
+} // namespace rigel::loader
@@ -0,0 +1,87 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "data/game_session_data.hpp"
+#include "data/map.hpp"
+#include "loader/byte_buffer.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+
+namespace rigel::loader
+{
+
+class ResourceLoader;
+
+
+/** Hash identifying the inputs used to produce a level's LevelData
+ *
+ * Covers the contents of all files the level is built from (see
+ * levelSourceFiles()), the actor info file (which determines draw order),
+ * the difficulty, and the version of the engine, since a different version
+ * might produce different LevelData from the same files. Replacement images
+ * for the tileset and backdrops are only covered by their size and
+ * modification time, to avoid reading them in full for every lookup.
+ */
+std::uint64_t levelSourceHash(
+  const std::string& mapName,
+  const ResourceLoader& resources,
+  data::Difficulty chosenDifficulty);
+
+
+/** Serialize fully loaded level into a binary cache format
+ *
+ * The format is only meant for caching on the local machine. It stores
+ * images as raw palette indices or RGBA data, so that no decoding is needed
+ * when reading it back.
+ */
+ByteBuffer serializeLevelData(
+  const data::map::LevelData& level,
+  std::uint64_t sourceHash);
+
+/** Read level written by serializeLevelData()
+ *
+ * Returns an empty optional if the data was written by a different version
+ * of the format, or from different source data. Throws an exception if the
+ * data is malformed.
+ */
+std::optional<data::map::LevelData>
+  deserializeLevelData(const ByteBuffer& data, std::uint64_t sourceHash);
+
+
+/** Like loadLevel(), but goes through a cache on disk
+ *
+ * When the cache directory contains an up-to-date entry for the level, it
+ * is used instead of parsing the original files and decoding all images.
+ * Entries are kept apart per game directory, so that switching between
+ * different game versions doesn't keep invalidating the cache.
+ * Otherwise, the level is loaded regularly and the result is written to the
+ * cache. Failing to read or write the cache is not an error, the level is
+ * then simply loaded without it.
+ */
+data::map::LevelData loadLevelCached(
+  const std::string& mapName,
+  const ResourceLoader& resources,
+  data::Difficulty chosenDifficulty,
+  const std::filesystem::path& cacheDirectory);
+
+} // namespace rigel::loader
@@ -17,9 +17,11 @@
 #include "level_loader.hpp"
 
 #include "base/container_utils.hpp"
+#include "base/defer.hpp"
 #include "base/grid.hpp"
 #include "base/math_tools.hpp"
 #include "base/string_utils.hpp"
+#include "base/thread_pool.hpp"
 #include "data/game_traits.hpp"
 #include "data/unit_conversions.hpp"
 #include "loader/bitwise_iter.hpp"
@@ -28,6 +30,7 @@
 #include "loader/rle_compression.hpp"
 
 #include <algorithm>
+#include <future>
 #include <string>
 #include <type_traits>
 
@@ -60,6 +63,13 @@ namespace
 
 using ActorList = std::vector<LevelData::Actor>;
 
+#ifdef __EMSCRIPTEN__
+constexpr auto LEVEL_LOADING_THREADS = std::size_t{0};
+#else
+// Tileset, primary and secondary backdrop
+constexpr auto LEVEL_LOADING_THREADS = std::size_t{3};
+#endif
+
 
 data::map::TileIndex convertTileIndex(const uint16_t rawIndex)
 {
@@ -141,9 +151,9 @@ std::string backdropNameFromNumber(const uint8_t backdropNumber)
  * Takes a linear list of actor descriptions, and puts them into a 2d grid.
  * This is useful since some meta actors have spatial relations to others.
  */
-auto makeActorGrid(const data::map::Map& map, const ActorList& actors)
+auto makeActorGrid(const int width, const int height, const ActorList& actors)
 {
-  base::Grid<const LevelData::Actor*> actorGrid(map.width(), map.height());
+  base::Grid<const LevelData::Actor*> actorGrid(width, height);
 
   for (const auto& actor : actors)
   {
@@ -156,8 +166,8 @@ auto makeActorGrid(const data::map::Map& map, const ActorList& actors)
 class ActorGrid
 {
 public:
-  ActorGrid(const data::map::Map& map, const ActorList& actors)
-    : mActorGrid(makeActorGrid(map, actors))
+  ActorGrid(const int width, const int height, const ActorList& actors)
+    : mActorGrid(makeActorGrid(width, height, actors))
   {
   }
 
@@ -416,7 +426,8 @@ bool isValidActorId(const uint16_t id)
  * the list (difficulty markers and section markers, player).
  */
 std::tuple<ActorList, base::Vector, bool> preProcessActorDescriptions(
-  const data::map::Map& map,
+  const int mapWidth,
+  const int mapHeight,
   const ActorList& originalActors,
   const Difficulty chosenDifficulty)
 {
@@ -424,10 +435,10 @@ std::tuple<ActorList, base::Vector, bool> preProcessActorDescriptions(
   base::Vector playerSpawnPosition;
   bool playerFacingLeft = false;
 
-  ActorGrid grid(map, originalActors);
-  for (int row = 0; row < map.height(); ++row)
+  ActorGrid grid(mapWidth, mapHeight, originalActors);
+  for (int row = 0; row < mapHeight; ++row)
   {
-    for (int col = 0; col < map.width(); ++col)
+    for (int col = 0; col < mapWidth; ++col)
     {
       if (!grid.hasActorAt(col, row))
       {
@@ -508,6 +519,40 @@ void sortByDrawIndex(ActorList& actors, const ResourceLoader& resources)
     });
 }
 
+
+ActorList readActorList(LeStreamReader& levelReader, const LevelHeader& header)
+{
+  ActorList actors;
+  for (size_t i = 0; i < header.numActorWords / 3u; ++i)
+  {
+    const auto type = levelReader.readU16();
+    const base::Vector position{levelReader.readU16(), levelReader.readU16()};
+    if (isValidActorId(type))
+    {
+      actors.emplace_back(
+        LevelData::Actor{position, static_cast<ActorID>(type), std::nullopt});
+    }
+  }
+
+  return actors;
+}
+
+
+LevelActors prepareActors(
+  const int mapWidth,
+  const int mapHeight,
+  const ActorList& originalActors,
+  const ResourceLoader& resources,
+  const Difficulty chosenDifficulty)
+{
+  auto [actors, playerSpawnPosition, playerFacingLeft] =
+    preProcessActorDescriptions(
+      mapWidth, mapHeight, originalActors, chosenDifficulty);
+  sortByDrawIndex(actors, resources);
+
+  return LevelActors{std::move(actors), playerSpawnPosition, playerFacingLeft};
+}
+
 } // namespace
 
 
@@ -515,28 +560,65 @@ LevelData loadLevel(
   const std::string& mapName,
   const ResourceLoader& resources,
   const Difficulty chosenDifficulty)
+{
+  base::ThreadPool pool{LEVEL_LOADING_THREADS};
+  return loadLevel(mapName, resources, chosenDifficulty, pool);
+}
+
+
+LevelData loadLevel(
+  const std::string& mapName,
+  const ResourceLoader& resources,
+  const Difficulty chosenDifficulty,
+  base::ThreadPool& pool)
 {
   const auto levelData = resources.file(mapName);
   LeStreamReader levelReader(levelData);
 
   LevelHeader header(levelReader);
-  ActorList actors;
-  for (size_t i = 0; i < header.numActorWords / 3u; ++i)
+
+  // Decoding the tileset and backdrops doesn't depend on anything else in
+  // the level file, and makes up most of the loading time. We kick these off
+  // first, and do the remaining work on this thread in the meantime.
+  auto tileSetFuture =
+    pool.submit([&]() { return resources.loadCZone(header.CZone); });
+  auto backdropFuture =
+    pool.submit([&]() { return resources.loadBackdrop(header.backdrop); });
+
+  std::optional<std::future<data::AnyImage>> alternativeBackdropFuture;
+  if (header.flagBitSet(0x40) || header.flagBitSet(0x80))
   {
-    const auto type = levelReader.readU16();
-    const base::Vector position{levelReader.readU16(), levelReader.readU16()};
-    if (isValidActorId(type))
+    alternativeBackdropFuture = pool.submit([&]() {
+      return resources.loadBackdrop(
+        backdropNameFromNumber(header.alternativeBackdropNumber));
+    });
+  }
+
+  // Make sure we don't leave any jobs running which reference our local
+  // variables in case we exit via exception.
+  auto waitForJobs = base::defer([&]() {
+    auto waitIfPending = [](const auto& future) {
+      if (future.valid())
+      {
+        future.wait();
+      }
+    };
+
+    waitIfPending(tileSetFuture);
+    waitIfPending(backdropFuture);
+    if (alternativeBackdropFuture)
     {
-      actors.emplace_back(
-        LevelData::Actor{position, static_cast<ActorID>(type), std::nullopt});
+      waitIfPending(*alternativeBackdropFuture);
     }
-  }
+  });
 
-  auto tileSet = resources.loadCZone(header.CZone);
+  const auto actors = readActorList(levelReader, header);
 
   const auto width = static_cast<int>(levelReader.readU16());
   const auto height = static_cast<int>(GameTraits::mapHeightForWidth(width));
-  data::map::Map map(width, height, std::move(tileSet.mAttributes));
+
+  auto [actorDescriptions, playerSpawnPosition, playerFacingLeft] =
+    prepareActors(width, height, actors, resources, chosenDifficulty);
 
   const auto maskedTileOffsets = readExtraMaskedTileBits(levelReader);
   auto lookupExtraMaskedTileBits =
@@ -551,14 +633,17 @@ LevelData loadLevel(
       return static_cast<uint8_t>(extraBits << 5);
     };
 
-  LeStreamReader tileDataReader(
-    levelReader.currentIter(),
-    levelReader.currentIter() + width * height * sizeof(uint16_t));
+  auto tileSet = tileSetFuture.get();
+  data::map::Map map(width, height, std::move(tileSet.mAttributes));
+
+  std::vector<uint16_t> tileData(size_t(width) * size_t(height));
+  levelReader.readU16Array(tileData.data(), tileData.size());
+
   for (int y = 0; y < height; ++y)
   {
     for (int x = 0; x < width; ++x)
     {
-      const auto tileSpec = tileDataReader.readU16();
+      const auto tileSpec = tileData[x + y * width];
 
       if (tileSpec & 0x8000)
       {
@@ -614,18 +699,13 @@ LevelData loadLevel(
     }
   }
 
-  auto backdropImage = resources.loadBackdrop(header.backdrop);
-  std::optional<data::Image> alternativeBackdropImage;
-  if (header.flagBitSet(0x40) || header.flagBitSet(0x80))
+  auto backdropImage = backdropFuture.get();
+  std::optional<data::AnyImage> alternativeBackdropImage;
+  if (alternativeBackdropFuture)
   {
-    alternativeBackdropImage = resources.loadBackdrop(
-      backdropNameFromNumber(header.alternativeBackdropNumber));
+    alternativeBackdropImage = alternativeBackdropFuture->get();
   }
 
-  auto [actorDescriptions, playerSpawnPosition, playerFacingLeft] =
-    preProcessActorDescriptions(map, actors, chosenDifficulty);
-  sortByDrawIndex(actorDescriptions, resources);
-
   return LevelData{
     std::move(tileSet.mTiles),
     std::move(backdropImage),
@@ -641,4 +721,39 @@ LevelData loadLevel(
 }
 
 
+LevelActors loadLevelActors(
+  const std::string& mapName,
+  const ResourceLoader& resources,
+  const Difficulty chosenDifficulty)
+{
+  const auto levelData = resources.file(mapName);
+  LeStreamReader levelReader(levelData);
+  LevelHeader header(levelReader);
+
+  const auto actors = readActorList(levelReader, header);
+  const auto width = static_cast<int>(levelReader.readU16());
+  const auto height = static_cast<int>(GameTraits::mapHeightForWidth(width));
+
+  return prepareActors(width, height, actors, resources, chosenDifficulty);
+}
+
+
+std::vector<std::string>
+  levelSourceFiles(const std::string& mapName, const ResourceLoader& resources)
+{
+  const auto levelData = resources.file(mapName);
+  LeStreamReader levelReader(levelData);
+  LevelHeader header(levelReader);
+
+  auto result =
+    std::vector<std::string>{mapName, header.CZone, header.backdrop};
+  if (header.flagBitSet(0x40) || header.flagBitSet(0x80))
+  {
+    result.push_back(backdropNameFromNumber(header.alternativeBackdropNumber));
+  }
+
+  return result;
+}
+
+
 } // namespace rigel::loader
@@ -25,6 +25,12 @@
 #include "loader/actor_image_package.hpp"
 
 
+namespace rigel::base
+{
+class ThreadPool;
+}
+
+
 namespace rigel::loader
 {
 
@@ -36,4 +42,44 @@ data::map::LevelData loadLevel(
   const ResourceLoader& resources,
   data::Difficulty chosenDifficulty);
 
+/** Load a level, decoding the tileset and backdrops on the given pool
+ *
+ * The result is identical to the overload above, which uses a temporary
+ * pool. Meant for callers that load several levels in a row, and for
+ * benchmarking.
+ */
+data::map::LevelData loadLevel(
+  const std::string& mapName,
+  const ResourceLoader& resources,
+  data::Difficulty chosenDifficulty,
+  base::ThreadPool& pool);
+
+/** Actors of a level, as they end up in the LevelData */
+struct LevelActors
+{
+  std::vector<data::map::LevelData::Actor> mActors;
+  base::Vector mPlayerSpawnPosition;
+  bool mPlayerFacingLeft = false;
+};
+
+/** Read and preprocess a level's actor list, like loadLevel() does
+ *
+ * Applies the difficulty, assigns areas to dynamic geometry, extracts the
+ * player spawn position, and sorts the remaining actors by draw index.
+ * Tilesets and backdrops aren't touched. Meant for benchmarking this part of
+ * level loading on its own.
+ */
+LevelActors loadLevelActors(
+  const std::string& mapName,
+  const ResourceLoader& resources,
+  data::Difficulty chosenDifficulty);
+
+/** Names of all game files that loadLevel() reads for the given level
+ *
+ * This is the level file itself, plus the tileset and backdrop(s) it
+ * references.
+ */
+std::vector<std::string>
+  levelSourceFiles(const std::string& mapName, const ResourceLoader& resources);
+
 } // namespace rigel::loader
@@ -41,6 +41,12 @@ namespace
 
 const char* INVALID_MOVIE_FILE = "Invalid/corrupted movie file";
 
+// Animation frames only store the pixels that change compared to the previous
+// frame. While decoding, we mark the remaining ones with this value.
+constexpr auto UNCHANGED_PIXEL = std::int16_t{-1};
+
+using FramePixels = std::vector<std::int16_t>;
+
 enum class SubChunkType
 {
   Palette,
@@ -119,11 +125,10 @@ Palette256 readPalette(LeStreamReader& reader)
 }
 
 
-data::PixelBuffer readMainImagePixels(
+data::IndexBuffer readMainImagePixels(
   LeStreamReader& reader,
   const uint16_t width,
-  const uint16_t height,
-  const Palette256& palette)
+  const uint16_t height)
 {
   SubChunkHeader mainImageSubChunkHeader(reader);
   if (mainImageSubChunkHeader.mType != SubChunkType::MainImage)
@@ -131,17 +136,15 @@ data::PixelBuffer readMainImagePixels(
     throw invalid_argument(INVALID_MOVIE_FILE);
   }
 
-  data::PixelBuffer mainImagePixels;
+  data::IndexBuffer mainImagePixels;
   mainImagePixels.reserve(width * height);
 
   for (auto row = 0u; row < height; ++row)
   {
     const auto numRLEFlagsInRow = reader.readU8();
     decompressRle(
-      reader,
-      numRLEFlagsInRow,
-      [&mainImagePixels, &palette](const auto colorIndex) {
-        mainImagePixels.push_back(palette[colorIndex]);
+      reader, numRLEFlagsInRow, [&mainImagePixels](const auto colorIndex) {
+        mainImagePixels.push_back(colorIndex);
       });
   }
 
@@ -149,13 +152,12 @@ data::PixelBuffer readMainImagePixels(
 }
 
 
-data::PixelBuffer readAnimationFramePixels(
+FramePixels readAnimationFramePixels(
   LeStreamReader& reader,
   const uint16_t width,
-  const uint16_t height,
-  const Palette256& palette)
+  const uint16_t height)
 {
-  data::PixelBuffer framePixels(width * height, data::Pixel{});
+  FramePixels framePixels(width * height, UNCHANGED_PIXEL);
 
   for (auto row = 0u; row < height; ++row)
   {
@@ -174,9 +176,9 @@ data::PixelBuffer readAnimationFramePixels(
       expandSingleRleWord(
         -invertedMarkerByte,
         reader,
-        [&framePixels, &palette, &targetCol, startOffset](
-          const auto colorIndex) {
-          framePixels[targetCol++ + startOffset] = palette[colorIndex];
+        [&framePixels, &targetCol, startOffset](const auto colorIndex) {
+          framePixels[targetCol++ + startOffset] =
+            static_cast<std::int16_t>(colorIndex);
         });
     }
   }
@@ -185,13 +187,20 @@ data::PixelBuffer readAnimationFramePixels(
 }
 
 
-vector<data::MovieFrame> readAnimationFrames(
+struct DecodedFrame
+{
+  FramePixels mPixels;
+  uint16_t mNumRows;
+  uint16_t mStartRow;
+};
+
+
+vector<DecodedFrame> readAnimationFrames(
   LeStreamReader& reader,
   const uint16_t width,
-  const uint16_t numAnimFrames,
-  const Palette256& palette)
+  const uint16_t numAnimFrames)
 {
-  vector<data::MovieFrame> frames;
+  vector<DecodedFrame> frames;
   for (auto frame = 0u; frame < numAnimFrames; ++frame)
   {
     ChunkHeader frameChunkHeader(reader);
@@ -205,17 +214,14 @@ vector<data::MovieFrame> readAnimationFrames(
 
     const auto yOffset = reader.readU16();
     const auto numRows = reader.readU16();
-    frames.emplace_back(
-      data::Image(
-        readAnimationFramePixels(reader, width, numRows, palette),
-        width,
-        numRows),
-      yOffset);
+    frames.push_back(DecodedFrame{
+      readAnimationFramePixels(reader, width, numRows), numRows, yOffset});
   }
 
   return frames;
 }
 
+
 } // namespace
 
 
@@ -241,11 +247,39 @@ data::Movie loadMovie(const ByteBuffer& file)
     throw invalid_argument(INVALID_MOVIE_FILE);
   }
   const auto palette = readPalette(reader);
-  auto mainImagePixels = readMainImagePixels(reader, width, height, palette);
+  auto mainImagePixels = readMainImagePixels(reader, width, height);
+  const auto decodedFrames = readAnimationFrames(reader, width, numAnimFrames);
+
+  vector<data::MovieFrame> frames;
+  frames.reserve(decodedFrames.size());
+  for (const auto& frame : decodedFrames)
+  {
+    if (frame.mStartRow + frame.mNumRows > height)
+    {
+      throw invalid_argument(INVALID_MOVIE_FILE);
+    }
+
+    data::IndexBuffer indices;
+    vector<bool> changedPixels;
+    indices.reserve(frame.mPixels.size());
+    changedPixels.reserve(frame.mPixels.size());
+    for (const auto index : frame.mPixels)
+    {
+      const auto isChanged = index != UNCHANGED_PIXEL;
+      indices.push_back(isChanged ? static_cast<std::uint8_t>(index) : 0);
+      changedPixels.push_back(isChanged);
+    }
+
+    frames.emplace_back(
+      data::IndexedImage(std::move(indices), width, frame.mNumRows),
+      std::move(changedPixels),
+      frame.mStartRow);
+  }
 
-  auto frames = readAnimationFrames(reader, width, numAnimFrames, palette);
   return {
-    data::Image(std::move(mainImagePixels), width, height), std::move(frames)};
+    data::IndexedImage(std::move(mainImagePixels), width, height),
+    std::move(frames),
+    vector<data::Pixel>(palette.begin(), palette.end())};
 }
 
 
@@ -18,6 +18,10 @@
 
 #include "loader/file_utils.hpp"
 
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
 
 namespace rigel::loader
 {
@@ -25,21 +29,34 @@ namespace rigel::loader
 namespace
 {
 
-data::ImfCommand readCommand(LeStreamReader& reader)
-{
-  return {reader.readU8(), reader.readU8(), reader.readU16()};
-}
+// Register, value, and a 16-bit delay
+constexpr auto WORDS_PER_COMMAND = std::size_t{2};
 
 } // namespace
 
 data::Song loadSong(const ByteBuffer& imfData)
 {
-  data::Song song;
+  constexpr auto COMMAND_SIZE = WORDS_PER_COMMAND * sizeof(std::uint16_t);
+
+  if (imfData.size() % COMMAND_SIZE != 0)
+  {
+    throw std::runtime_error("Truncated command in IMF data");
+  }
 
+  const auto numCommands = imfData.size() / COMMAND_SIZE;
+
+  std::vector<std::uint16_t> words(numCommands * WORDS_PER_COMMAND);
   LeStreamReader reader(imfData);
-  while (reader.hasData())
+  reader.readU16Array(words.data(), words.size());
+
+  data::Song song(numCommands);
+  for (std::size_t i = 0; i < numCommands; ++i)
   {
-    song.push_back(readCommand(reader));
+    const auto registerAndValue = words[i * WORDS_PER_COMMAND];
+    song[i] = data::ImfCommand{
+      static_cast<std::uint8_t>(registerAndValue & 0xFF),
+      static_cast<std::uint8_t>(registerAndValue >> 8),
+      words[i * WORDS_PER_COMMAND + 1]};
   }
 
   return song;
@@ -17,6 +17,7 @@
 #include "resource_loader.hpp"
 
 #include "base/container_utils.hpp"
+#include "common/memory_accounting.hpp"
 #include "data/game_traits.hpp"
 #include "data/unit_conversions.hpp"
 #include "loader/ega_image_decoder.hpp"
@@ -76,26 +77,29 @@ const auto FULL_SCREEN_IMAGE_DATA_SIZE =
 const auto ASSET_REPLACEMENTS_PATH = "asset_replacements";
 
 
-std::optional<data::Image> loadReplacementTilesetIfPresent(
-  const fs::path& gamePath,
-  const std::string& name)
+/** File name of the replacement image for a tileset or backdrop file
+ *
+ * Returns an empty optional for files which can't be replaced.
+ */
+std::optional<std::string> replacementImageName(const std::string& name)
 {
   using namespace std::literals;
 
   std::regex tilesetNameRegex{"^CZONE([0-9A-Z])\\.MNI$", std::regex::icase};
+  std::regex backdropNameRegex{"^DROP([0-9]+)\\.MNI$", std::regex::icase};
   std::smatch matches;
 
-  if (!std::regex_match(name, matches, tilesetNameRegex) || matches.size() != 2)
+  if (std::regex_match(name, matches, tilesetNameRegex) && matches.size() == 2)
   {
-    return {};
+    return "tileset"s + matches[1].str() + ".png";
   }
 
-  const auto number = matches[1].str();
-  const auto replacementName = "tileset"s + number + ".png";
-  const auto replacementPath =
-    gamePath / ASSET_REPLACEMENTS_PATH / replacementName;
+  if (std::regex_match(name, matches, backdropNameRegex) && matches.size() == 2)
+  {
+    return "backdrop"s + matches[1].str() + ".png";
+  }
 
-  return loadPng(replacementPath.u8string());
+  return {};
 }
 
 
@@ -160,6 +164,16 @@ data::Image ResourceLoader::loadTiledFullscreenImage(
 }
 
 
+data::IndexedImage
+  ResourceLoader::loadTiledFullscreenIndexedImage(const std::string& name) const
+{
+  return loadTiledIndexedImage(
+    file(name),
+    data::GameTraits::viewPortWidthTiles,
+    data::TileImageType::Unmasked);
+}
+
+
 data::Image
   ResourceLoader::loadStandaloneFullscreenImage(const std::string& name) const
 {
@@ -210,26 +224,17 @@ loader::Palette16 ResourceLoader::loadPaletteFromFullScreenImage(
 }
 
 
-data::Image ResourceLoader::loadBackdrop(const std::string& name) const
+data::AnyImage ResourceLoader::loadBackdrop(const std::string& name) const
 {
-  using namespace std::literals;
-
-  std::regex backdropNameRegex{"^DROP([0-9]+)\\.MNI$", std::regex::icase};
-  std::smatch matches;
-
-  if (std::regex_match(name, matches, backdropNameRegex) && matches.size() == 2)
+  if (const auto replacementPath = replacementImagePath(name))
   {
-    const auto number = matches[1].str();
-    const auto replacementName = "backdrop"s + number + ".png";
-    const auto replacementPath =
-      mGamePath / ASSET_REPLACEMENTS_PATH / replacementName;
-    if (const auto replacementImage = loadPng(replacementPath.u8string()))
+    if (auto replacementImage = loadPng(replacementPath->u8string()))
     {
-      return *replacementImage;
+      return std::move(*replacementImage);
     }
   }
 
-  return loadTiledFullscreenImage(name);
+  return loadTiledFullscreenIndexedImage(name);
 }
 
 
@@ -255,31 +260,35 @@ TileSet ResourceLoader::loadCZone(const std::string& name) const
     }
   }
 
-  if (auto replacementImage = loadReplacementTilesetIfPresent(mGamePath, name))
+  if (const auto replacementPath = replacementImagePath(name))
   {
-    return {
-      std::move(*replacementImage), TileAttributeDict{std::move(attributes)}};
+    if (auto replacementImage = loadPng(replacementPath->u8string()))
+    {
+      return {
+        std::move(*replacementImage),
+        TileAttributeDict{std::move(attributes)}};
+    }
   }
 
-  Image fullImage(
+  // Rows which aren't covered by any tiles stay transparent
+  IndexedImage fullImage(
     tilesToPixels(GameTraits::CZone::tileSetImageWidth),
-    tilesToPixels(GameTraits::CZone::tileSetImageHeight));
+    tilesToPixels(GameTraits::CZone::tileSetImageHeight),
+    EGA_TRANSPARENT_INDEX);
 
   const auto tilesBegin = data.begin() + GameTraits::CZone::attributeBytesTotal;
   const auto maskedTilesBegin = tilesBegin +
     GameTraits::CZone::numSolidTiles * GameTraits::CZone::tileBytes;
 
-  const auto solidTilesImage = loadTiledImage(
+  const auto solidTilesImage = loadTiledIndexedImage(
     tilesBegin,
     maskedTilesBegin,
     GameTraits::CZone::tileSetImageWidth,
-    INGAME_PALETTE,
     T::Unmasked);
-  const auto maskedTilesImage = loadTiledImage(
+  const auto maskedTilesImage = loadTiledIndexedImage(
     maskedTilesBegin,
     data.end(),
     GameTraits::CZone::tileSetImageWidth,
-    INGAME_PALETTE,
     T::Masked);
   fullImage.insertImage(0, 0, solidTilesImage);
   fullImage.insertImage(
@@ -291,6 +300,22 @@ TileSet ResourceLoader::loadCZone(const std::string& name) const
 }
 
 
+std::optional<std::filesystem::path>
+  ResourceLoader::replacementImagePath(const std::string& name) const
+{
+  if (const auto replacementName = replacementImageName(name))
+  {
+    auto path = mGamePath / ASSET_REPLACEMENTS_PATH / *replacementName;
+    if (fs::exists(path))
+    {
+      return path;
+    }
+  }
+
+  return {};
+}
+
+
 data::Movie ResourceLoader::loadMovie(const std::string& name) const
 {
   return loader::loadMovie(loadFile(mGamePath / fs::u8path(name)));
@@ -382,4 +407,12 @@ bool ResourceLoader::hasFile(const std::string& name) const
   return fs::exists(unpackedFilePath) || mFilePackage.hasFile(name);
 }
 
+
+void ResourceLoader::reportMemoryUsage(MemoryReport& report) const
+{
+  report.add("Resources", "Game data file (CMP)", mFilePackage.sizeInBytes());
+  report.add(
+    "Resources", "Actor image data", mActorImagePackage.imageDataSize());
+}
+
 } // namespace rigel::loader
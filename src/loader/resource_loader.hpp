@@ -29,15 +29,22 @@
 #include "loader/palette.hpp"
 
 #include <filesystem>
+#include <optional>
 #include <string>
 
 
+namespace rigel
+{
+class MemoryReport;
+}
+
+
 namespace rigel::loader
 {
 
 struct TileSet
 {
-  data::Image mTiles;
+  data::AnyImage mTiles;
   data::map::TileAttributeDict mAttributes;
 };
 
@@ -51,6 +58,8 @@ public:
   data::Image loadTiledFullscreenImage(
     const std::string& name,
     const Palette16& overridePalette) const;
+  data::IndexedImage
+    loadTiledFullscreenIndexedImage(const std::string& name) const;
 
   data::Image loadStandaloneFullscreenImage(const std::string& name) const;
   loader::Palette16
@@ -58,8 +67,18 @@ public:
 
   data::Image loadAntiPiracyImage() const;
 
-  data::Image loadBackdrop(const std::string& name) const;
+  data::AnyImage loadBackdrop(const std::string& name) const;
   TileSet loadCZone(const std::string& name) const;
+
+  /** Path of the replacement image for a tileset or backdrop, if present
+   *
+   * When there is a replacement, loadCZone() and loadBackdrop() return it
+   * as a true color image. Otherwise, they return an indexed image decoded
+   * from the original game files, which uses the in-game palette.
+   */
+  std::optional<std::filesystem::path>
+    replacementImagePath(const std::string& name) const;
+
   data::Movie loadMovie(const std::string& name) const;
 
   data::Song loadMusic(const std::string& name) const;
@@ -75,6 +94,10 @@ public:
   std::string fileAsText(const std::string& name) const;
   bool hasFile(const std::string& name) const;
 
+  const std::filesystem::path& gamePath() const { return mGamePath; }
+
+  void reportMemoryUsage(MemoryReport& report) const;
+
 private:
   data::AudioBuffer loadSound(const std::string& name) const;
 
@@ -244,6 +244,27 @@ std::variant<CommandLineOptions, int> parseArgs(int argc, char** argv)
     ("play-demo",
      po::bool_switch(&config.mPlayDemo),
      "Play pre-recorded demo")
+    ("pipelined-logic",
+     po::bool_switch(&config.mPipelinedGameLogic),
+     "Run game logic on a separate thread, one update ahead of rendering")
+    ("parallel-systems",
+     po::bool_switch(&config.mParallelSystems),
+     "Run independent parts of each game logic update in parallel")
+    ("record-input",
+     po::value<std::string>(&config.mInputRecordingFile),
+     "Record player input for all levels played into the given file")
+    ("replay",
+     po::value<std::string>(&config.mReplayFile),
+     "Play back input recording created via 'record-input', running the game\n"
+     "logic as fast as possible")
+    ("startup-timeline",
+     po::value<std::string>(&config.mStartupTimelineFile),
+     "Write a report on how long each stage of startup took into the given\n"
+     "file")
+    ("memory-report",
+     po::value<std::string>(&config.mMemoryReportFile),
+     "File to append memory usage reports to when pressing F9 in debug mode.\n"
+     "Each report is written as one line of JSON")
     ("game-path",
      po::value<std::string>(&config.mGamePath)->default_value(""),
      "Path to original game's installation. Can also be given as positional "
@@ -0,0 +1,51 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "blend_mode.hpp"
+
+#include <cmath>
+#include <cstdint>
+
+
+namespace rigel::renderer
+{
+
+base::Color blend(
+  const BlendMode mode,
+  const base::Color& source,
+  const base::Color& destination)
+{
+  const auto sourceAlpha = source.a / 255.0f;
+  const auto sourceFactor =
+    mode == BlendMode::PremultipliedAlpha ? 1.0f : sourceAlpha;
+
+  auto blendChannel = [&](
+                        const std::uint8_t sourceValue,
+                        const std::uint8_t destinationValue,
+                        const float factor) {
+    const auto result =
+      sourceValue * factor + destinationValue * (1.0f - sourceAlpha);
+    return static_cast<std::uint8_t>(std::lround(result));
+  };
+
+  return base::Color{
+    blendChannel(source.r, destination.r, sourceFactor),
+    blendChannel(source.g, destination.g, sourceFactor),
+    blendChannel(source.b, destination.b, sourceFactor),
+    blendChannel(source.a, destination.a, 1.0f)};
+}
+
+} // namespace rigel::renderer
@@ -0,0 +1,62 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/color.hpp"
+
+
+namespace rigel::renderer
+{
+
+/** How drawn pixels are combined with the render target's contents
+ *
+ * In both modes, alpha is accumulated with the "over" operator. This way,
+ * partially transparent drawing into an opaque render target keeps it
+ * opaque, and drawing into a transparent render target leaves color values
+ * in it which are premultiplied by their alpha.
+ */
+enum class BlendMode
+{
+  /** Source colors have straight (not premultiplied) alpha
+   *
+   * This is the default, and matches how all images are stored.
+   */
+  Normal,
+
+  /** Source colors are already multiplied by their alpha
+   *
+   * Must be used when drawing a render target which was cleared to
+   * transparent before drawing into it with BlendMode::Normal. Using Normal
+   * mode in that case applies alpha twice, which darkens partially
+   * transparent pixels.
+   */
+  PremultipliedAlpha
+};
+
+
+/** Blend a single pixel like the GPU does with the given mode
+ *
+ * Both colors as well as the result have 8 bits per channel, like render
+ * targets do. This makes it possible to verify compositing logic without
+ * a GPU.
+ */
+base::Color blend(
+  BlendMode mode,
+  const base::Color& source,
+  const base::Color& destination);
+
+} // namespace rigel::renderer
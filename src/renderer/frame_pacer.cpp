@@ -0,0 +1,227 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "frame_pacer.hpp"
+
+#include <SDL_timer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+
+namespace rigel::renderer
+{
+
+using namespace std::chrono;
+
+namespace
+{
+
+constexpr auto INITIAL_SPIN_MARGIN = base::Clock::duration{milliseconds{2}};
+constexpr auto MIN_SPIN_MARGIN = base::Clock::duration{microseconds{500}};
+constexpr auto MAX_SPIN_MARGIN = base::Clock::duration{milliseconds{4}};
+
+
+constexpr auto RENDER_COST_SAFETY_MARGIN =
+  base::Clock::duration{microseconds{500}};
+
+} // namespace
+
+
+void FrameTimeStatistics::addSample(const double frameTime)
+{
+  auto bucketFor = [](const double time) {
+    const auto index =
+      static_cast<std::size_t>(std::max(time, 0.0) / HISTOGRAM_BUCKET_WIDTH);
+    return std::min(index, NUM_HISTOGRAM_BUCKETS - 1);
+  };
+
+  if (mNumSamples == WINDOW_SIZE)
+  {
+    --mHistogram[bucketFor(mSamples[mNextSample])];
+  }
+  else
+  {
+    ++mNumSamples;
+  }
+
+  mSamples[mNextSample] = frameTime;
+  ++mHistogram[bucketFor(frameTime)];
+  mNextSample = (mNextSample + 1) % WINDOW_SIZE;
+}
+
+
+double FrameTimeStatistics::meanFrameTime() const
+{
+  if (mNumSamples == 0)
+  {
+    return 0.0;
+  }
+
+  auto sum = 0.0;
+  for (auto i = std::size_t{0}; i < mNumSamples; ++i)
+  {
+    sum += mSamples[i];
+  }
+
+  return sum / mNumSamples;
+}
+
+
+double FrameTimeStatistics::minFrameTime() const
+{
+  if (mNumSamples == 0)
+  {
+    return 0.0;
+  }
+
+  return *std::min_element(
+    std::begin(mSamples), std::begin(mSamples) + mNumSamples);
+}
+
+
+double FrameTimeStatistics::maxFrameTime() const
+{
+  if (mNumSamples == 0)
+  {
+    return 0.0;
+  }
+
+  return *std::max_element(
+    std::begin(mSamples), std::begin(mSamples) + mNumSamples);
+}
+
+
+double FrameTimeStatistics::jitter() const
+{
+  if (mNumSamples < 2)
+  {
+    return 0.0;
+  }
+
+  const auto mean = meanFrameTime();
+
+  auto sumOfSquares = 0.0;
+  for (auto i = std::size_t{0}; i < mNumSamples; ++i)
+  {
+    const auto deviation = mSamples[i] - mean;
+    sumOfSquares += deviation * deviation;
+  }
+
+  return std::sqrt(sumOfSquares / mNumSamples);
+}
+
+
+auto FramePacer::systemTimeSource() -> TimeSource
+{
+  return {
+    []() { return base::Clock::now(); },
+    [](const base::Clock::duration duration) {
+      // We use SDL_Delay instead of std::this_thread::sleep_for, because the
+      // former is more accurate on some platforms.
+      SDL_Delay(static_cast<Uint32>(
+        duration_cast<milliseconds>(duration).count()));
+    }};
+}
+
+
+FramePacer::FramePacer(
+  const int targetFps,
+  const bool predictRenderCost,
+  TimeSource timeSource)
+  : mTimeSource(std::move(timeSource))
+  , mTargetFrameTime(
+      duration_cast<base::Clock::duration>(duration<double>(1.0 / targetFps)))
+  , mSpinMargin(INITIAL_SPIN_MARGIN)
+  , mNextDeadline(mTimeSource.mNow())
+  , mFrameStartTime(mNextDeadline)
+  , mPredictRenderCost(predictRenderCost)
+{
+  // Start out conservatively, until we've seen how accurately the
+  // platform sleeps.
+  mRecentSleepOvershoots.fill(INITIAL_SPIN_MARGIN);
+}
+
+
+void FramePacer::waitForPresentation()
+{
+  const auto now = mTimeSource.mNow();
+
+  mRecentRenderCosts[mNextRenderCostIndex] = now - mFrameStartTime;
+  mNextRenderCostIndex = (mNextRenderCostIndex + 1) % NUM_RENDER_COST_SAMPLES;
+
+  mNextDeadline += mTargetFrameTime;
+  if (now > mNextDeadline)
+  {
+    mNextDeadline = now;
+  }
+
+  waitUntil(mNextDeadline);
+}
+
+
+void FramePacer::waitForNextFrame()
+{
+  if (mPredictRenderCost)
+  {
+    waitUntil(mNextDeadline + mTargetFrameTime - predictedRenderCost());
+  }
+
+  mFrameStartTime = mTimeSource.mNow();
+}
+
+
+base::Clock::duration FramePacer::predictedRenderCost() const
+{
+  const auto longestRecentCost = *std::max_element(
+    std::begin(mRecentRenderCosts), std::end(mRecentRenderCosts));
+
+  return longestRecentCost + RENDER_COST_SAFETY_MARGIN;
+}
+
+
+void FramePacer::waitUntil(const base::Clock::time_point wakeUpTime)
+{
+  auto now = mTimeSource.mNow();
+
+  const auto sleepUntil = wakeUpTime - mSpinMargin;
+  if (sleepUntil > now)
+  {
+    mTimeSource.mSleepFor(sleepUntil - now);
+    now = mTimeSource.mNow();
+
+    // Adapt the spin margin to how much sleeping recently overshot on this
+    // platform, with some headroom.
+    mRecentSleepOvershoots[mNextOvershootIndex] =
+      std::max(now - sleepUntil, base::Clock::duration{});
+    mNextOvershootIndex = (mNextOvershootIndex + 1) % NUM_OVERSHOOT_SAMPLES;
+
+    const auto largestRecentOvershoot = *std::max_element(
+      std::begin(mRecentSleepOvershoots), std::end(mRecentSleepOvershoots));
+    mSpinMargin = std::clamp(
+      largestRecentOvershoot + largestRecentOvershoot / 2,
+      MIN_SPIN_MARGIN,
+      MAX_SPIN_MARGIN);
+  }
+
+  while (now < wakeUpTime)
+  {
+    now = mTimeSource.mNow();
+  }
+}
+
+} // namespace rigel::renderer
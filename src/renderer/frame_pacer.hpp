@@ -0,0 +1,125 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/clock.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+
+namespace rigel::renderer
+{
+
+/** Rolling window of frame times, with histogram and jitter statistics
+ *
+ * Keeps the most recent WINDOW_SIZE samples. The histogram has buckets
+ * of HISTOGRAM_BUCKET_WIDTH seconds, the last bucket also counts all
+ * frame times exceeding the histogram's range.
+ */
+class FrameTimeStatistics
+{
+public:
+  static constexpr auto WINDOW_SIZE = std::size_t{256};
+  static constexpr auto NUM_HISTOGRAM_BUCKETS = std::size_t{64};
+  static constexpr auto HISTOGRAM_BUCKET_WIDTH = 0.0005;
+
+  using Histogram = std::array<std::uint32_t, NUM_HISTOGRAM_BUCKETS>;
+
+  void addSample(double frameTime);
+
+  std::size_t numSamples() const { return mNumSamples; }
+  const Histogram& histogram() const { return mHistogram; }
+
+  double meanFrameTime() const;
+  double minFrameTime() const;
+  double maxFrameTime() const;
+
+  /** Standard deviation of frame times in the window */
+  double jitter() const;
+
+private:
+  std::array<double, WINDOW_SIZE> mSamples{};
+  Histogram mHistogram{};
+  std::size_t mNextSample = 0;
+  std::size_t mNumSamples = 0;
+};
+
+
+/** Limits frame rate with sub-millisecond accuracy
+ *
+ * Frames are presented on a fixed grid of deadlines, so that wait
+ * inaccuracies don't accumulate. A frame that misses its deadline is
+ * presented immediately, and the grid is re-aligned to it instead of
+ * rushing through subsequent frames to catch up.
+ *
+ * Waiting combines sleeping for most of the remaining time with spinning
+ * on base::Clock for the last stretch. The spin margin adapts to the
+ * largest recently observed sleep inaccuracy of the platform.
+ *
+ * Usage: Call waitForPresentation() right before presenting a frame
+ * (i.e. swapping buffers), and waitForNextFrame() right after. The latter
+ * only waits when render cost prediction is enabled: It then delays the
+ * start of the next frame by as much as the longest recently observed
+ * render cost allows. This reduces input latency, since input is sampled as
+ * late as possible before the frame is presented.
+ */
+class FramePacer
+{
+public:
+  struct TimeSource
+  {
+    std::function<base::Clock::time_point()> mNow;
+    std::function<void(base::Clock::duration)> mSleepFor;
+  };
+
+  static TimeSource systemTimeSource();
+
+  explicit FramePacer(
+    int targetFps,
+    bool predictRenderCost = false,
+    TimeSource timeSource = systemTimeSource());
+
+  void waitForPresentation();
+  void waitForNextFrame();
+
+  base::Clock::duration predictedRenderCost() const;
+  base::Clock::duration spinMargin() const { return mSpinMargin; }
+
+private:
+  void waitUntil(base::Clock::time_point wakeUpTime);
+
+  static constexpr auto NUM_RENDER_COST_SAMPLES = std::size_t{16};
+  static constexpr auto NUM_OVERSHOOT_SAMPLES = std::size_t{128};
+
+  TimeSource mTimeSource;
+  base::Clock::duration mTargetFrameTime;
+  base::Clock::duration mSpinMargin;
+  base::Clock::time_point mNextDeadline;
+  base::Clock::time_point mFrameStartTime;
+  std::array<base::Clock::duration, NUM_RENDER_COST_SAMPLES>
+    mRecentRenderCosts{};
+  std::size_t mNextRenderCostIndex = 0;
+  std::array<base::Clock::duration, NUM_OVERSHOOT_SAMPLES>
+    mRecentSleepOvershoots{};
+  std::size_t mNextOvershootIndex = 0;
+  bool mPredictRenderCost;
+};
+
+} // namespace rigel::renderer
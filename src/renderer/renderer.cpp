@@ -16,6 +16,7 @@
 
 #include "renderer.hpp"
 
+#include "common/memory_accounting.hpp"
 #include "data/game_options.hpp"
 #include "data/game_traits.hpp"
 #include "loader/palette.hpp"
@@ -31,6 +32,8 @@ RIGEL_RESTORE_WARNINGS
 
 #include <algorithm>
 #include <array>
+#include <cassert>
+#include <cmath>
 #include <iterator>
 
 
@@ -67,6 +70,20 @@ constexpr auto WATER_ANIM_TEX_HEIGHT =
   nextPowerOf2(WATER_MASK_HEIGHT * WATER_NUM_MASKS);
 constexpr auto WATER_MASK_INDEX_FILLED = 4;
 
+constexpr auto PALETTE_SIZE = 256;
+constexpr auto PALETTE_TEXTURE_UNIT = GL_TEXTURE3;
+
+#ifdef RIGEL_USE_GL_ES
+// GL ES 2 doesn't have single-channel red textures, but luminance textures
+// work the same for our purposes: The shader reads the index from the red
+// channel.
+constexpr auto INDEX_TEXTURE_INTERNAL_FORMAT = GL_LUMINANCE;
+constexpr auto INDEX_TEXTURE_FORMAT = GL_LUMINANCE;
+#else
+constexpr auto INDEX_TEXTURE_INTERNAL_FORMAT = GL_R8;
+constexpr auto INDEX_TEXTURE_FORMAT = GL_RED;
+#endif
+
 
 class DummyVao
 {
@@ -99,6 +116,7 @@ struct RenderTarget
 enum class RenderMode : std::uint8_t
 {
   SpriteBatch,
+  IndexedSpriteBatch,
   NonTexturedRender,
   Points,
   WaterEffect
@@ -297,10 +315,29 @@ auto getSize(SDL_Window* pWindow)
 }
 
 
+// OpenGL wants pixel data in bottom-up format, so transform it accordingly
+std::vector<std::uint8_t> bottomUpIndexData(const data::IndexedImage& image)
+{
+  const auto& indices = image.indexData();
+  std::vector<std::uint8_t> indexData;
+  indexData.reserve(indices.size());
+  for (std::size_t y = 0; y < image.height(); ++y)
+  {
+    const auto iSourceRow =
+      indices.begin() + (image.height() - (y + 1)) * image.width();
+    indexData.insert(indexData.end(), iSourceRow, iSourceRow + image.width());
+  }
+
+  return indexData;
+}
+
+
 GLuint createGlTexture(
   const GLsizei width,
   const GLsizei height,
-  const GLvoid* const pData)
+  const GLvoid* const pData,
+  const GLint internalFormat = GL_RGBA,
+  const GLenum format = GL_RGBA)
 {
   GLuint handle = 0;
   glGenTextures(1, &handle);
@@ -314,16 +351,35 @@ GLuint createGlTexture(
   glTexImage2D(
     GL_TEXTURE_2D,
     0,
-    GL_RGBA,
+    internalFormat,
     width,
     height,
     0,
-    GL_RGBA,
+    format,
     GL_UNSIGNED_BYTE,
     pData);
   return handle;
 }
 
+
+std::vector<std::uint8_t>
+  paletteTextureData(const base::ArrayView<base::Color> colors)
+{
+  assert(colors.size() <= PALETTE_SIZE);
+
+  // Entries beyond the given colors stay zero, i.e. fully transparent
+  std::vector<std::uint8_t> data(PALETTE_SIZE * 4, 0);
+  for (auto i = 0u; i < colors.size(); ++i)
+  {
+    data[i * 4] = colors[i].r;
+    data[i * 4 + 1] = colors[i].g;
+    data[i * 4 + 2] = colors[i].b;
+    data[i * 4 + 3] = colors[i].a;
+  }
+
+  return data;
+}
+
 } // namespace
 
 
@@ -337,6 +393,7 @@ struct Renderer::Impl
     glm::vec2 mGlobalTranslation{0.0f, 0.0f};
     glm::vec2 mGlobalScale{1.0f, 1.0f};
     TextureId mRenderTargetTexture = 0;
+    BlendMode mBlendMode = BlendMode::Normal;
     bool mTextureRepeatEnabled = false;
 
     friend bool operator==(const State& lhs, const State& rhs)
@@ -350,6 +407,7 @@ struct Renderer::Impl
           lhs.mGlobalTranslation,
           lhs.mGlobalScale,
           lhs.mRenderTargetTexture,
+          lhs.mBlendMode,
           lhs.mTextureRepeatEnabled) ==
         std::tie(
           rhs.mClipRect,
@@ -358,6 +416,7 @@ struct Renderer::Impl
           rhs.mGlobalTranslation,
           rhs.mGlobalScale,
           rhs.mRenderTargetTexture,
+          rhs.mBlendMode,
           rhs.mTextureRepeatEnabled);
       // clang-format on
     }
@@ -387,12 +446,15 @@ struct Renderer::Impl
   std::uint16_t mBatchSize = 0;
   RenderMode mRenderMode = RenderMode::SpriteBatch;
   bool mStateChanged = true;
+  bool mLastUsedTextureIsIndexed = false;
 
   // warm - needed for committing state changes
   State mLastCommittedState;
   std::unordered_map<TextureId, RenderTarget> mRenderTargetDict;
+  std::unordered_map<TextureId, TextureId> mPaletteByIndexedTexture;
   Shader mTexturedQuadShader;
   Shader mSimpleTexturedQuadShader;
+  Shader mIndexedTexturedQuadShader;
   Shader mSolidColorShader;
   Shader mWaterEffectShader;
   base::Size<int> mWindowSize;
@@ -401,10 +463,14 @@ struct Renderer::Impl
   RenderMode mLastKnownRenderMode = RenderMode::SpriteBatch;
 
   // cold
-  int mNumTextures = 0;
-  int mNumInternalTextures = 0;
+  std::unordered_map<TextureId, std::size_t> mTextureSizeInBytes;
+  std::size_t mNumInternalTextures = 0;
   TextureId mWaterSurfaceAnimTexture = 0;
   TextureId mWaterEffectColorMapTexture = 0;
+  TextureId mWaterEffectSourceTexture = 0;
+  base::Size<int> mWaterEffectSourceTextureSize;
+  glm::vec4 mWaterEffectSourceTransform{1.0f, 1.0f, 0.0f, 0.0f};
+  bool mWaterEffectSourceTransformChanged = true;
   DummyVao mDummyVao;
   GLuint mStreamVbo = 0;
 
@@ -418,6 +484,10 @@ struct Renderer::Impl
         VERTEX_SOURCE,
         FRAGMENT_SOURCE_SIMPLE,
         {"position", "texCoord"})
+    , mIndexedTexturedQuadShader(
+        VERTEX_SOURCE,
+        FRAGMENT_SOURCE_INDEXED,
+        {"position", "texCoord"})
     , mSolidColorShader(
         VERTEX_SOURCE_SOLID,
         FRAGMENT_SOURCE_SOLID,
@@ -433,7 +503,7 @@ struct Renderer::Impl
     glDisable(GL_DEPTH_TEST);
     glEnable(GL_CULL_FACE);
     glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    commitBlendMode(mLastCommittedState);
 
     // Set up a VBO for streaming data to the GPU, stays bound all the time
     glGenBuffers(1, &mStreamVbo);
@@ -478,6 +548,10 @@ struct Renderer::Impl
     glBindTexture(GL_TEXTURE_2D, mWaterEffectColorMapTexture);
     glActiveTexture(GL_TEXTURE0);
 
+    // Storage for the source texture is allocated on first capture, see
+    // captureWaterEffectSource()
+    glGenTextures(1, &mWaterEffectSourceTexture);
+
     mWaterEffectShader.use();
     mWaterEffectShader.setUniform("textureData", 0);
     mWaterEffectShader.setUniform("maskData", 1);
@@ -490,7 +564,12 @@ struct Renderer::Impl
     mSimpleTexturedQuadShader.use();
     mSimpleTexturedQuadShader.setUniform("textureData", 0);
 
-    mNumInternalTextures = mNumTextures;
+    mIndexedTexturedQuadShader.use();
+    mIndexedTexturedQuadShader.setUniform("textureData", 0);
+    mIndexedTexturedQuadShader.setUniform(
+      "paletteData", int(PALETTE_TEXTURE_UNIT - GL_TEXTURE0));
+
+    mNumInternalTextures = mTextureSizeInBytes.size();
 
     glEnableVertexAttribArray(0);
     glEnableVertexAttribArray(1);
@@ -505,12 +584,13 @@ struct Renderer::Impl
     // Make sure all externally used textures and render targets have been
     // destroyed before the renderer is destroyed.
     assert(mRenderTargetDict.empty());
-    assert(mNumTextures == mNumInternalTextures);
+    assert(mTextureSizeInBytes.size() == mNumInternalTextures);
 
     glDeleteBuffers(1, &mStreamVbo);
     glDeleteBuffers(1, &mQuadIndicesEbo);
     glDeleteTextures(1, &mWaterSurfaceAnimTexture);
     glDeleteTextures(1, &mWaterEffectColorMapTexture);
+    glDeleteTextures(1, &mWaterEffectSourceTexture);
   }
 
 
@@ -519,16 +599,17 @@ struct Renderer::Impl
     const TexCoords& sourceRect,
     const base::Rect<int>& destRect)
   {
-    updateState(mRenderMode, RenderMode::SpriteBatch);
-
     if (texture != mLastUsedTexture)
     {
       submitBatch();
-
-      glBindTexture(GL_TEXTURE_2D, texture);
-      mLastUsedTexture = texture;
+      bindTexture(texture);
     }
 
+    updateState(
+      mRenderMode,
+      mLastUsedTextureIsIndexed ? RenderMode::IndexedSpriteBatch
+                                : RenderMode::SpriteBatch);
+
     // x, y, tex_u, tex_v
     GLfloat vertices[4 * (2 + 2)];
     fillVertexPositions(destRect, std::begin(vertices), 0, 4);
@@ -538,6 +619,23 @@ struct Renderer::Impl
   }
 
 
+  void bindTexture(const TextureId texture)
+  {
+    glBindTexture(GL_TEXTURE_2D, texture);
+    mLastUsedTexture = texture;
+
+    // Indexed textures need their palette bound as well
+    const auto iPalette = mPaletteByIndexedTexture.find(texture);
+    mLastUsedTextureIsIndexed = iPalette != mPaletteByIndexedTexture.end();
+    if (mLastUsedTextureIsIndexed)
+    {
+      glActiveTexture(PALETTE_TEXTURE_UNIT);
+      glBindTexture(GL_TEXTURE_2D, iPalette->second);
+      glActiveTexture(GL_TEXTURE0);
+    }
+  }
+
+
   void submitBatch()
   {
     if (mBatchData.empty())
@@ -550,6 +648,7 @@ struct Renderer::Impl
     switch (mRenderMode)
     {
       case RenderMode::SpriteBatch:
+      case RenderMode::IndexedSpriteBatch:
       case RenderMode::WaterEffect:
         glBufferData(
           GL_ARRAY_BUFFER,
@@ -674,9 +773,120 @@ struct Renderer::Impl
   }
 
 
+  void drawPoints(base::ArrayView<PointVertex> vertices)
+  {
+    static_assert(sizeof(PointVertex) == sizeof(GLfloat) * 6);
+
+    if (vertices.empty())
+    {
+      return;
+    }
+
+    updateState(mRenderMode, RenderMode::Points);
+
+    const auto pFirst = reinterpret_cast<const GLfloat*>(vertices.data());
+    mBatchData.insert(
+      std::end(mBatchData), pFirst, pFirst + vertices.size() * 6);
+  }
+
+
+  void captureWaterEffectSource(const base::Rect<int>& area)
+  {
+    submitBatch();
+    commitChangedState();
+
+    const auto& state = mStateStack.back();
+    const auto framebufferSize = this->framebufferSize(state);
+
+    // Determine the area's extent in framebuffer pixels, and clip it to the
+    // framebuffer. The clip rect is applied as well, since nothing outside
+    // of it can be drawn anyway.
+    auto left = int(std::floor(
+      state.mGlobalTranslation.x + area.left() * state.mGlobalScale.x));
+    auto top = int(std::floor(
+      state.mGlobalTranslation.y + area.top() * state.mGlobalScale.y));
+    auto right = int(std::ceil(
+      state.mGlobalTranslation.x +
+      (area.left() + area.size.width) * state.mGlobalScale.x));
+    auto bottom = int(std::ceil(
+      state.mGlobalTranslation.y +
+      (area.top() + area.size.height) * state.mGlobalScale.y));
+
+    left = std::max(left, 0);
+    top = std::max(top, 0);
+    right = std::min(right, framebufferSize.width);
+    bottom = std::min(bottom, framebufferSize.height);
+
+    if (state.mClipRect)
+    {
+      left = std::max(left, state.mClipRect->left());
+      top = std::max(top, state.mClipRect->top());
+      right = std::min(right, state.mClipRect->right() + 1);
+      bottom = std::min(bottom, state.mClipRect->bottom() + 1);
+    }
+
+    if (right <= left || bottom <= top)
+    {
+      return;
+    }
+
+    const auto width = right - left;
+    const auto height = bottom - top;
+
+    glBindTexture(GL_TEXTURE_2D, mWaterEffectSourceTexture);
+
+    if (
+      width > mWaterEffectSourceTextureSize.width ||
+      height > mWaterEffectSourceTextureSize.height)
+    {
+      // Only grow, so that the texture gets reallocated rarely. The contents
+      // don't need to be preserved, they are replaced by the copy below.
+      mWaterEffectSourceTextureSize.width =
+        std::max(width, mWaterEffectSourceTextureSize.width);
+      mWaterEffectSourceTextureSize.height =
+        std::max(height, mWaterEffectSourceTextureSize.height);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+      // The default framebuffer might not have an alpha channel, which
+      // makes copying into an RGBA texture an error on GL ES.
+      glTexImage2D(
+        GL_TEXTURE_2D,
+        0,
+        GL_RGB,
+        mWaterEffectSourceTextureSize.width,
+        mWaterEffectSourceTextureSize.height,
+        0,
+        GL_RGB,
+        GL_UNSIGNED_BYTE,
+        nullptr);
+    }
+
+    // OpenGL's window coordinates have their origin at the bottom left,
+    // whereas ours are at the top left.
+    const auto glBottom = framebufferSize.height - bottom;
+    glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, left, glBottom, width, height);
+
+    glBindTexture(GL_TEXTURE_2D, mLastUsedTexture);
+
+    // Maps the 0..1 range covering the whole framebuffer, which the water
+    // effect vertex shader computes, to the captured region.
+    const auto textureWidth = float(mWaterEffectSourceTextureSize.width);
+    const auto textureHeight = float(mWaterEffectSourceTextureSize.height);
+    mWaterEffectSourceTransform = glm::vec4{
+      framebufferSize.width / textureWidth,
+      framebufferSize.height / textureHeight,
+      -left / textureWidth,
+      -glBottom / textureHeight};
+    mWaterEffectSourceTransformChanged = true;
+    mStateChanged = true;
+  }
+
+
   void drawWaterEffect(
     const base::Rect<int>& area,
-    const TextureId texture,
     std::optional<int> surfaceAnimationStep)
   {
     assert(
@@ -707,11 +917,10 @@ struct Renderer::Impl
 
     updateState(mRenderMode, RenderMode::WaterEffect);
 
-    if (mLastUsedTexture != texture)
+    if (mLastUsedTexture != mWaterEffectSourceTexture)
     {
       submitBatch();
-      glBindTexture(GL_TEXTURE_2D, texture);
-      mLastUsedTexture = texture;
+      bindTexture(mWaterEffectSourceTexture);
     }
 
     if (surfaceAnimationStep)
@@ -780,6 +989,12 @@ struct Renderer::Impl
   }
 
 
+  void setBlendMode(const BlendMode mode)
+  {
+    updateState(mStateStack.back().mBlendMode, mode);
+  }
+
+
   void setGlobalTranslation(const base::Vector& translation)
   {
     const auto glTranslation = glm::vec2{translation.x, translation.y};
@@ -870,17 +1085,7 @@ struct Renderer::Impl
 
     const auto& state = mStateStack.back();
 
-    auto currentFramebufferSize = [&]() {
-      if (state.mRenderTargetTexture != 0)
-      {
-        const auto iData = mRenderTargetDict.find(state.mRenderTargetTexture);
-        assert(iData != mRenderTargetDict.end());
-        return iData->second.mSize;
-      }
-
-      return mWindowSize;
-    };
-
+    auto currentFramebufferSize = [&]() { return framebufferSize(state); };
 
     auto transformNeedsUpdate =
       state.mGlobalTranslation != mLastCommittedState.mGlobalTranslation ||
@@ -920,26 +1125,30 @@ struct Renderer::Impl
       }
     }
 
-    if (mRenderMode == RenderMode::SpriteBatch && state.needsExtendedShader())
+    if (state.mBlendMode != mLastCommittedState.mBlendMode)
     {
+      commitBlendMode(state);
+    }
+
+    if (usesExtendedShader(state))
+    {
+      auto& shader = shaderToUse(state);
+
       if (state.mColorModulation != mLastCommittedState.mColorModulation)
       {
-        mTexturedQuadShader.setUniform(
-          "colorModulation", toGlColor(state.mColorModulation));
+        shader.setUniform("colorModulation", toGlColor(state.mColorModulation));
       }
 
       if (state.mOverlayColor != mLastCommittedState.mOverlayColor)
       {
-        mTexturedQuadShader.setUniform(
-          "overlayColor", toGlColor(state.mOverlayColor));
+        shader.setUniform("overlayColor", toGlColor(state.mOverlayColor));
       }
 
       if (
         state.mTextureRepeatEnabled !=
         mLastCommittedState.mTextureRepeatEnabled)
       {
-        mTexturedQuadShader.setUniform(
-          "enableRepeat", state.mTextureRepeatEnabled);
+        shader.setUniform("enableRepeat", state.mTextureRepeatEnabled);
       }
     }
 
@@ -948,6 +1157,15 @@ struct Renderer::Impl
       commitTransformationMatrix(state, currentFramebufferSize());
     }
 
+    if (
+      mRenderMode == RenderMode::WaterEffect &&
+      mWaterEffectSourceTransformChanged)
+    {
+      mWaterEffectShader.setUniform(
+        "sourceTransform", mWaterEffectSourceTransform);
+      mWaterEffectSourceTransformChanged = false;
+    }
+
     mLastCommittedState = state;
     mLastKnownRenderMode = mRenderMode;
     mLastKnownWindowSize = mWindowSize;
@@ -955,6 +1173,19 @@ struct Renderer::Impl
   }
 
 
+  base::Extents framebufferSize(const State& state) const
+  {
+    if (state.mRenderTargetTexture != 0)
+    {
+      const auto iData = mRenderTargetDict.find(state.mRenderTargetTexture);
+      assert(iData != mRenderTargetDict.end());
+      return iData->second.mSize;
+    }
+
+    return mWindowSize;
+  }
+
+
   void commitRenderTarget(const State& state)
   {
     if (state.mRenderTargetTexture != 0)
@@ -970,6 +1201,24 @@ struct Renderer::Impl
   }
 
 
+  void commitBlendMode(const State& state)
+  {
+    // Alpha is always accumulated using the "over" operator, see BlendMode.
+    // blend() in blend_mode.cpp needs to match what's done here.
+    switch (state.mBlendMode)
+    {
+      case BlendMode::Normal:
+        glBlendFuncSeparate(
+          GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        break;
+
+      case BlendMode::PremultipliedAlpha:
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        break;
+    }
+  }
+
+
   void commitClipRect(const State& state, const base::Extents& framebufferSize)
   {
     if (state.mClipRect)
@@ -984,6 +1233,18 @@ struct Renderer::Impl
   }
 
 
+  bool usesExtendedShader(const State& state) const
+  {
+    // The indexed shader always supports all of the extended shader's
+    // features.
+    // clang-format off
+    return
+      mRenderMode == RenderMode::IndexedSpriteBatch ||
+      (mRenderMode == RenderMode::SpriteBatch && state.needsExtendedShader());
+    // clang-format on
+  }
+
+
   Shader& shaderToUse(const State& state)
   {
     switch (mRenderMode)
@@ -996,6 +1257,9 @@ struct Renderer::Impl
 
         return mSimpleTexturedQuadShader;
 
+      case RenderMode::IndexedSpriteBatch:
+        return mIndexedTexturedQuadShader;
+
       case RenderMode::Points:
       case RenderMode::NonTexturedRender:
         return mSolidColorShader;
@@ -1014,14 +1278,11 @@ struct Renderer::Impl
     auto& shader = shaderToUse(state);
     shader.use();
 
-    if (shader.handle() == mTexturedQuadShader.handle())
+    if (usesExtendedShader(state))
     {
-      mTexturedQuadShader.setUniform(
-        "enableRepeat", state.mTextureRepeatEnabled);
-      mTexturedQuadShader.setUniform(
-        "colorModulation", toGlColor(state.mColorModulation));
-      mTexturedQuadShader.setUniform(
-        "overlayColor", toGlColor(state.mOverlayColor));
+      shader.setUniform("enableRepeat", state.mTextureRepeatEnabled);
+      shader.setUniform("colorModulation", toGlColor(state.mColorModulation));
+      shader.setUniform("overlayColor", toGlColor(state.mOverlayColor));
     }
 
     commitVertexAttributeFormat();
@@ -1033,6 +1294,7 @@ struct Renderer::Impl
     switch (mRenderMode)
     {
       case RenderMode::SpriteBatch:
+      case RenderMode::IndexedSpriteBatch:
       case RenderMode::WaterEffect:
         glVertexAttribPointer(
           0, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 4, toAttribOffset(0));
@@ -1123,11 +1385,99 @@ struct Renderer::Impl
       GLsizei(image.width()), GLsizei(image.height()), pixelData.data());
     glBindTexture(GL_TEXTURE_2D, mLastUsedTexture);
 
-    ++mNumTextures;
+    mTextureSizeInBytes.insert({handle, pixelData.size()});
     return handle;
   }
 
 
+  TextureId createPaletteTexture(const base::ArrayView<base::Color> colors)
+  {
+    submitBatch();
+
+    const auto data = paletteTextureData(colors);
+    const auto handle = createGlTexture(PALETTE_SIZE, 1, data.data());
+    glBindTexture(GL_TEXTURE_2D, mLastUsedTexture);
+
+    mTextureSizeInBytes.insert({handle, data.size()});
+    return handle;
+  }
+
+
+  void updatePaletteTexture(
+    const TextureId palette,
+    const base::ArrayView<base::Color> colors)
+  {
+    // Pending draw calls must still use the previous colors
+    submitBatch();
+
+    const auto data = paletteTextureData(colors);
+    glBindTexture(GL_TEXTURE_2D, palette);
+    glTexSubImage2D(
+      GL_TEXTURE_2D,
+      0,
+      0,
+      0,
+      PALETTE_SIZE,
+      1,
+      GL_RGBA,
+      GL_UNSIGNED_BYTE,
+      data.data());
+    glBindTexture(GL_TEXTURE_2D, mLastUsedTexture);
+  }
+
+
+  TextureId createIndexedTexture(
+    const data::IndexedImage& image,
+    const TextureId palette)
+  {
+    submitBatch();
+
+    const auto indexData = bottomUpIndexData(image);
+
+    // Rows are tightly packed, not padded to 4 bytes
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    const auto handle = createGlTexture(
+      GLsizei(image.width()),
+      GLsizei(image.height()),
+      indexData.data(),
+      INDEX_TEXTURE_INTERNAL_FORMAT,
+      INDEX_TEXTURE_FORMAT);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, mLastUsedTexture);
+
+    mPaletteByIndexedTexture.insert({handle, palette});
+
+    mTextureSizeInBytes.insert({handle, indexData.size()});
+    return handle;
+  }
+
+
+  void updateIndexedTexture(
+    const TextureId texture,
+    const data::IndexedImage& image)
+  {
+    // Pending draw calls must still use the previous contents
+    submitBatch();
+
+    const auto indexData = bottomUpIndexData(image);
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(
+      GL_TEXTURE_2D,
+      0,
+      0,
+      0,
+      GLsizei(image.width()),
+      GLsizei(image.height()),
+      INDEX_TEXTURE_FORMAT,
+      GL_UNSIGNED_BYTE,
+      indexData.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, mLastUsedTexture);
+  }
+
+
   void destroyTexture(TextureId texture)
   {
     submitBatch();
@@ -1140,13 +1490,41 @@ struct Renderer::Impl
     }
     else
     {
-      --mNumTextures;
+      mPaletteByIndexedTexture.erase(texture);
+      mTextureSizeInBytes.erase(texture);
     }
 
     glDeleteTextures(1, &texture);
   }
 
 
+  void reportMemoryUsage(MemoryReport& report) const
+  {
+    std::size_t textureBytes = 0;
+    for (const auto& [id, size] : mTextureSizeInBytes)
+    {
+      textureBytes += size;
+    }
+
+    std::size_t renderTargetBytes = 0;
+    for (const auto& [id, renderTarget] : mRenderTargetDict)
+    {
+      renderTargetBytes +=
+        std::size_t(renderTarget.mSize.width * renderTarget.mSize.height) * 4;
+    }
+
+    // The water effect source is RGB, see captureWaterEffectSource()
+    const auto waterEffectSourceBytes = std::size_t(
+      mWaterEffectSourceTextureSize.width *
+      mWaterEffectSourceTextureSize.height * 3);
+
+    report.add("GPU", "Textures", textureBytes, mTextureSizeInBytes.size());
+    report.add(
+      "GPU", "Render targets", renderTargetBytes, mRenderTargetDict.size());
+    report.add("GPU", "Water effect source", waterEffectSourceBytes);
+  }
+
+
   void setFilteringEnabled(const TextureId texture, const bool enabled)
   {
     submitBatch();
@@ -1175,24 +1553,48 @@ Renderer::Renderer(SDL_Window* pWindow)
 }
 
 
+Renderer::Renderer(const base::Size<int>& headlessWindowSize)
+  : mHeadlessWindowSize(headlessWindowSize)
+{
+}
+
+
 Renderer::~Renderer() = default;
 
 
 void Renderer::setOverlayColor(const base::Color& color)
 {
-  mpImpl->setOverlayColor(color);
+  if (mpImpl)
+  {
+    mpImpl->setOverlayColor(color);
+  }
 }
 
 
 void Renderer::setColorModulation(const base::Color& colorModulation)
 {
-  mpImpl->setColorModulation(colorModulation);
+  if (mpImpl)
+  {
+    mpImpl->setColorModulation(colorModulation);
+  }
 }
 
 
 void Renderer::setTextureRepeatEnabled(const bool enable)
 {
-  mpImpl->setTextureRepeatEnabled(enable);
+  if (mpImpl)
+  {
+    mpImpl->setTextureRepeatEnabled(enable);
+  }
+}
+
+
+void Renderer::setBlendMode(const BlendMode mode)
+{
+  if (mpImpl)
+  {
+    mpImpl->setBlendMode(mode);
+  }
 }
 
 
@@ -1201,13 +1603,19 @@ void Renderer::drawTexture(
   const TexCoords& sourceRect,
   const base::Rect<int>& destRect)
 {
-  mpImpl->drawTexture(texture, sourceRect, destRect);
+  if (mpImpl)
+  {
+    mpImpl->drawTexture(texture, sourceRect, destRect);
+  }
 }
 
 
 void Renderer::submitBatch()
 {
-  mpImpl->submitBatch();
+  if (mpImpl)
+  {
+    mpImpl->submitBatch();
+  }
 }
 
 
@@ -1215,7 +1623,10 @@ void Renderer::drawFilledRectangle(
   const base::Rect<int>& rect,
   const base::Color& color)
 {
-  mpImpl->drawFilledRectangle(rect, color);
+  if (mpImpl)
+  {
+    mpImpl->drawFilledRectangle(rect, color);
+  }
 }
 
 
@@ -1223,7 +1634,10 @@ void Renderer::drawRectangle(
   const base::Rect<int>& rect,
   const base::Color& color)
 {
-  mpImpl->drawRectangle(rect, color);
+  if (mpImpl)
+  {
+    mpImpl->drawRectangle(rect, color);
+  }
 }
 
 
@@ -1234,51 +1648,94 @@ void Renderer::drawLine(
   const int y2,
   const base::Color& color)
 {
-  mpImpl->drawLine(x1, y1, x2, y2, color);
+  if (mpImpl)
+  {
+    mpImpl->drawLine(x1, y1, x2, y2, color);
+  }
 }
 
 
 void Renderer::drawPoint(const base::Vector& position, const base::Color& color)
 {
-  mpImpl->drawPoint(position, color);
+  if (mpImpl)
+  {
+    mpImpl->drawPoint(position, color);
+  }
+}
+
+
+void Renderer::drawPoints(base::ArrayView<PointVertex> vertices)
+{
+  if (mpImpl)
+  {
+    mpImpl->drawPoints(vertices);
+  }
+}
+
+
+void Renderer::captureWaterEffectSource(const base::Rect<int>& area)
+{
+  if (mpImpl)
+  {
+    mpImpl->captureWaterEffectSource(area);
+  }
 }
 
 
 void Renderer::drawWaterEffect(
   const base::Rect<int>& area,
-  const TextureId texture,
   std::optional<int> surfaceAnimationStep)
 {
-  mpImpl->drawWaterEffect(area, texture, surfaceAnimationStep);
+  if (mpImpl)
+  {
+    mpImpl->drawWaterEffect(area, surfaceAnimationStep);
+  }
 }
 
 
 void Renderer::pushState()
 {
-  mpImpl->pushState();
+  if (mpImpl)
+  {
+    mpImpl->pushState();
+  }
 }
 
 
 void Renderer::popState()
 {
-  mpImpl->popState();
+  if (mpImpl)
+  {
+    mpImpl->popState();
+  }
 }
 
 
 void Renderer::resetState()
 {
-  mpImpl->resetState();
+  if (mpImpl)
+  {
+    mpImpl->resetState();
+  }
 }
 
 
 void Renderer::setGlobalTranslation(const base::Vector& translation)
 {
-  mpImpl->setGlobalTranslation(translation);
+  if (mpImpl)
+  {
+    mpImpl->setGlobalTranslation(translation);
+  }
 }
 
 
 base::Vector Renderer::globalTranslation() const
 {
+  if (!mpImpl)
+  {
+    return {};
+  }
+
   return base::Vector{
     static_cast<int>(mpImpl->mStateStack.back().mGlobalTranslation.x),
     static_cast<int>(mpImpl->mStateStack.back().mGlobalTranslation.y)};
@@ -1287,12 +1744,20 @@ base::Vector Renderer::globalTranslation() const
 
 void Renderer::setGlobalScale(const base::Point<float>& scale)
 {
-  mpImpl->setGlobalScale(scale);
+  if (mpImpl)
+  {
+    mpImpl->setGlobalScale(scale);
+  }
 }
 
 
 base::Point<float> Renderer::globalScale() const
 {
+  if (!mpImpl)
+  {
+    return {1.0f, 1.0f};
+  }
+
   return {
     mpImpl->mStateStack.back().mGlobalScale.x,
     mpImpl->mStateStack.back().mGlobalScale.y};
@@ -1301,61 +1766,150 @@ base::Point<float> Renderer::globalScale() const
 
 void Renderer::setClipRect(const std::optional<base::Rect<int>>& clipRect)
 {
-  mpImpl->setClipRect(clipRect);
+  if (mpImpl)
+  {
+    mpImpl->setClipRect(clipRect);
+  }
 }
 
 
 std::optional<base::Rect<int>> Renderer::clipRect() const
 {
+  if (!mpImpl)
+  {
+    return std::nullopt;
+  }
+
   return mpImpl->mStateStack.back().mClipRect;
 }
 
 
+void Renderer::reportMemoryUsage(MemoryReport& report) const
+{
+  if (mpImpl)
+  {
+    mpImpl->reportMemoryUsage(report);
+  }
+}
+
+
 base::Size<int> Renderer::windowSize() const
 {
-  return mpImpl->mWindowSize;
+  return mpImpl ? mpImpl->mWindowSize : mHeadlessWindowSize;
 }
 
 
 void Renderer::setRenderTarget(const TextureId target)
 {
-  mpImpl->setRenderTarget(target);
+  if (mpImpl)
+  {
+    mpImpl->setRenderTarget(target);
+  }
 }
 
 
 void Renderer::swapBuffers()
 {
-  mpImpl->swapBuffers();
+  if (mpImpl)
+  {
+    mpImpl->swapBuffers();
+  }
 }
 
 
 void Renderer::clear(const base::Color& clearColor)
 {
-  mpImpl->clear(clearColor);
+  if (mpImpl)
+  {
+    mpImpl->clear(clearColor);
+  }
 }
 
 
 TextureId Renderer::createRenderTargetTexture(const int width, const int height)
 {
+  if (!mpImpl)
+  {
+    return 0;
+  }
+
   return mpImpl->createRenderTargetTexture(width, height);
 }
 
 
 TextureId Renderer::createTexture(const data::Image& image)
 {
+  if (!mpImpl)
+  {
+    return 0;
+  }
+
   return mpImpl->createTexture(image);
 }
 
 
+TextureId
+  Renderer::createPaletteTexture(const base::ArrayView<base::Color> colors)
+{
+  if (!mpImpl)
+  {
+    return 0;
+  }
+
+  return mpImpl->createPaletteTexture(colors);
+}
+
+
+void Renderer::updatePaletteTexture(
+  const TextureId palette,
+  const base::ArrayView<base::Color> colors)
+{
+  if (mpImpl)
+  {
+    mpImpl->updatePaletteTexture(palette, colors);
+  }
+}
+
+
+TextureId Renderer::createIndexedTexture(
+  const data::IndexedImage& image,
+  const TextureId palette)
+{
+  if (!mpImpl)
+  {
+    return 0;
+  }
+
+  return mpImpl->createIndexedTexture(image, palette);
+}
+
+
+void Renderer::updateIndexedTexture(
+  const TextureId texture,
+  const data::IndexedImage& image)
+{
+  if (mpImpl)
+  {
+    mpImpl->updateIndexedTexture(texture, image);
+  }
+}
+
+
 void Renderer::destroyTexture(TextureId texture)
 {
-  mpImpl->destroyTexture(texture);
+  if (mpImpl)
+  {
+    mpImpl->destroyTexture(texture);
+  }
 }
 
 
 void Renderer::setFilteringEnabled(const TextureId texture, const bool enabled)
 {
-  mpImpl->setFilteringEnabled(texture, enabled);
+  if (mpImpl)
+  {
+    mpImpl->setFilteringEnabled(texture, enabled);
+  }
 }
 
 } // namespace rigel::renderer
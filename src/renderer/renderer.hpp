@@ -16,11 +16,13 @@
 
 #pragma once
 
+#include "base/array_view.hpp"
 #include "base/color.hpp"
 #include "base/defer.hpp"
 #include "base/spatial_types.hpp"
 #include "base/warnings.hpp"
 #include "data/image.hpp"
+#include "renderer/blend_mode.hpp"
 
 RIGEL_DISABLE_WARNINGS
 #include <SDL_video.h>
@@ -31,6 +33,12 @@ RIGEL_RESTORE_WARNINGS
 #include <optional>
 
 
+namespace rigel
+{
+class MemoryReport;
+}
+
+
 namespace rigel::renderer
 {
 
@@ -74,6 +82,21 @@ inline TexCoords toTexCoords(
 }
 
 
+/** Vertex format for Renderer::drawPoints()
+ *
+ * Position is in pixels, color components are in range [0.0, 1.0].
+ */
+struct PointVertex
+{
+  float x;
+  float y;
+  float r;
+  float g;
+  float b;
+  float a;
+};
+
+
 /** OpenGL-based 2D rendering API
  *
  * This class provides hardware-accelerated 2D rendering capabilities
@@ -84,14 +107,28 @@ inline TexCoords toTexCoords(
  * (scaling, translation), and a few color effects are also available.
  *
  * A valid OpenGL context must be created before instantiating this
- * class.
+ * class, unless creating a headless renderer.
  */
 class Renderer
 {
 public:
   explicit Renderer(SDL_Window* pWindow);
+
+  /** Create a headless renderer, which doesn't need OpenGL
+   *
+   * All drawing and state changes are ignored, texture creation returns
+   * texture id 0, and windowSize() always returns the given size. This
+   * makes it possible to run code that owns textures and render targets,
+   * like the GameWorld, without a window - e.g. for batch simulations.
+   * A headless renderer has no mutable state, so it can be shared between
+   * threads.
+   */
+  explicit Renderer(const base::Size<int>& headlessWindowSize);
+
   ~Renderer();
 
+  bool isHeadless() const { return mpImpl == nullptr; }
+
   // Drawing API
   ////////////////////////////////////////////////////////////////////////
 
@@ -134,26 +171,45 @@ public:
    */
   void drawPoint(const base::Vector& position, const base::Color& color);
 
+  /** Draw many pixels at once
+   *
+   * Same as calling drawPoint() for each vertex, but the whole block of
+   * vertices is appended to the current batch in one go. Use this when
+   * drawing large numbers of points, e.g. for particle effects.
+   */
+  void drawPoints(base::ArrayView<PointVertex> vertices);
+
+  /** Capture part of the current render target for the "under water" effect
+   *
+   * Copies the pixels covered by the given area into an internal buffer,
+   * which serves as input for subsequent drawWaterEffect() calls. The area
+   * is modified by the current global scale and translation, and clipped to
+   * the current clip rect and render target. Only this area needs to be
+   * copied, so the area should be the union of all water areas drawn
+   * afterwards.
+   *
+   * Interrupts the current batch.
+   */
+  void captureWaterEffectSource(const base::Rect<int>& area);
+
   /** Draw "under water" effect
    *
    * Contrary to the other functions offered by the renderer, this one
-   * is very specific to Duke Nukem II. It draws the given texture with
-   * a special shader modifying all colors to be shades of blue.
-   * The area rectangle is used as both source and target rectangle, as
-   * the texture typically represents a rendered game scene.
+   * is very specific to Duke Nukem II. It draws the contents previously
+   * captured via captureWaterEffectSource() with a special shader modifying
+   * all colors to be shades of blue. The area rectangle is used as both
+   * source and target rectangle, it must be contained in the captured area.
    * If an animation step is given, the top-most pixels of the given
    * area will appear in one of 4 possible wave patterns. Otherwise,
    * the entire area is drawn uniformly. The animation step must be a
    * number between 0 and 3.
    *
    * Supports batching: Multiple calls to this function will be combined
-   * into a single vertex buffer and OpenGL draw call, as long as the
-   * same texture is used. Changing any state will also interrupt the
-   * current batch.
+   * into a single vertex buffer and OpenGL draw call. Changing any state
+   * will interrupt the current batch.
    */
   void drawWaterEffect(
     const base::Rect<int>& area,
-    TextureId unprocessedScreen,
     std::optional<int> surfaceAnimationStep);
 
   /** Draw rectangle outline, 1 pixel wide
@@ -240,6 +296,46 @@ public:
    */
   TextureId createTexture(const data::Image& image);
 
+  /** Create a palette for use with indexed textures
+   *
+   * This is a low-level API. Using the renderer::PaletteTexture class
+   * instead is recommended for most use cases.
+   *
+   * Holds up to 256 colors. Indices beyond the given colors are fully
+   * transparent, like in data::IndexedImage::toRgba().
+   * Must be destroyed using destroyTexture(), after all indexed textures
+   * using it have been destroyed.
+   */
+  TextureId createPaletteTexture(base::ArrayView<base::Color> colors);
+
+  /** Replace the colors of a palette
+   *
+   * Takes effect for all indexed textures using the palette, without
+   * having to re-upload them. Drawing operations issued before calling
+   * this function still use the previous colors.
+   */
+  void updatePaletteTexture(
+    TextureId palette,
+    base::ArrayView<base::Color> colors);
+
+  /** Create an indexed texture
+   *
+   * Like createTexture, but only uploads the image's 8-bit palette indices.
+   * When drawing, colors are resolved through the given palette.
+   * Filtering (see setFilteringEnabled()) is not supported for indexed
+   * textures.
+   */
+  TextureId
+    createIndexedTexture(const data::IndexedImage& image, TextureId palette);
+
+  /** Replace the contents of an indexed texture
+   *
+   * The image must have the same size as the one used for creating the
+   * texture. Drawing operations issued before calling this function still
+   * use the previous contents.
+   */
+  void updateIndexedTexture(TextureId texture, const data::IndexedImage& image);
+
   /** Create a render target texture
    *
    * This is a low-level API. Using the renderer::RenderTarget class
@@ -264,7 +360,7 @@ public:
 
   /** Snapshot current state for later restoration
    *
-   * Saves all renderer state (color modifiers, texture repeat,
+   * Saves all renderer state (color modifiers, texture repeat, blend mode,
    * translation, scale, clip rect, and render target) into a snapshot.
    * Calling popState() reapplies the last saved state, effectively
    * undoing any state changes that happened between pushState() and
@@ -342,6 +438,13 @@ public:
    */
   void setTextureRepeatEnabled(bool enable);
 
+  /** Set how drawn pixels are combined with the render target
+   *
+   * Part of the renderer state. Applies to all drawing functions.
+   * See BlendMode. Default value is BlendMode::Normal.
+   */
+  void setBlendMode(BlendMode mode);
+
   /** Set offset to be added to all coordinates before rendering
    *
    * Part of the renderer state.
@@ -411,9 +514,17 @@ public:
   base::Point<float> globalScale() const;
   std::optional<base::Rect<int>> clipRect() const;
 
+  /** Add texture and render target memory to the given report
+   *
+   * Sizes are computed from texture dimensions and formats. The actual
+   * amount of memory used by the driver might differ.
+   */
+  void reportMemoryUsage(MemoryReport& report) const;
+
 private:
   struct Impl;
   std::unique_ptr<Impl> mpImpl;
+  base::Size<int> mHeadlessWindowSize;
 };
 
 /** RAII helper for temporarily saving state
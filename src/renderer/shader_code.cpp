@@ -75,6 +75,40 @@ void main() {
 }
 )shd";
 
+
+const char* FRAGMENT_SOURCE_INDEXED = R"shd(
+OUTPUT_COLOR_DECLARATION
+
+IN HIGHP vec2 texCoordFrag;
+
+uniform sampler2D textureData;
+uniform sampler2D paletteData;
+uniform vec4 overlayColor;
+
+uniform vec4 colorModulation;
+uniform bool enableRepeat;
+
+void main() {
+  vec2 texCoords = texCoordFrag;
+  if (enableRepeat) {
+    texCoords.x = fract(texCoords.x);
+    texCoords.y = fract(texCoords.y);
+  }
+
+  // The texture stores palette indices, normalized to the range 0.0 to 1.0.
+  // We scale them back to 0 - 255 and sample the center of the corresponding
+  // texel in the 256x1 palette texture.
+  float index = TEXTURE_LOOKUP(textureData, texCoords).r * 255.0;
+  vec4 baseColor =
+    TEXTURE_LOOKUP(paletteData, vec2((index + 0.5) / 256.0, 0.5));
+  vec4 modulated = baseColor * colorModulation;
+  float targetAlpha = modulated.a;
+
+  OUTPUT_COLOR =
+    vec4(mix(modulated.rgb, overlayColor.rgb, overlayColor.a), targetAlpha);
+}
+)shd";
+
 const char* VERTEX_SOURCE_SOLID = R"shd(
 ATTRIBUTE vec2 position;
 ATTRIBUTE vec4 color;
@@ -110,20 +144,25 @@ OUT vec2 texCoordMaskFrag;
 
 uniform mat4 transform;
 
+// xy: scale, zw: offset
+uniform vec4 sourceTransform;
+
 void main() {
   SET_POINT_SIZE(1.0);
   vec4 transformedPos = transform * vec4(position, 0.0, 1.0);
 
   // Applying the transform gives us a position in normalized device
-  // coordinates (from -1.0 to 1.0). For sampling the render target texture,
+  // coordinates (from -1.0 to 1.0). For sampling the source texture,
   // we need texture coordinates in the range 0.0 to 1.0, however.
   // Therefore, we transform the position from normalized device coordinates
   // into the 0.0 to 1.0 range by adding 1 and dividing by 2.
   //
-  // We assume that the texture is as large as the screen, therefore sampling
-  // with the resulting tex coords should be equivalent to reading the pixel
-  // located at 'position'.
-  texCoordFrag = (transformedPos.xy + vec2(1.0, 1.0)) / 2.0;
+  // The source texture only holds a copy of a part of the framebuffer.
+  // The source transform maps framebuffer-relative coordinates to that
+  // part, therefore sampling with the resulting tex coords is equivalent to
+  // reading the pixel located at 'position'.
+  vec2 screenTexCoord = (transformedPos.xy + vec2(1.0, 1.0)) / 2.0;
+  texCoordFrag = screenTexCoord * sourceTransform.xy + sourceTransform.zw;
   texCoordMaskFrag = vec2(texCoordMask.x, 1.0 - texCoordMask.y);
 
   gl_Position = transformedPos;
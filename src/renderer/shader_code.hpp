@@ -23,6 +23,7 @@ namespace rigel::renderer
 extern const char* VERTEX_SOURCE;
 extern const char* FRAGMENT_SOURCE_SIMPLE;
 extern const char* FRAGMENT_SOURCE;
+extern const char* FRAGMENT_SOURCE_INDEXED;
 
 extern const char* VERTEX_SOURCE_SOLID;
 extern const char* FRAGMENT_SOURCE_SOLID;
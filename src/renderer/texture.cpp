@@ -17,6 +17,7 @@
 #include "texture.hpp"
 
 #include <cassert>
+#include <variant>
 
 
 namespace rigel::renderer
@@ -25,6 +26,30 @@ namespace rigel::renderer
 using data::Image;
 
 
+PaletteTexture::PaletteTexture(
+  Renderer* pRenderer,
+  const base::ArrayView<data::Pixel> colors)
+  : mpRenderer(pRenderer)
+  , mId(pRenderer->createPaletteTexture(colors))
+{
+}
+
+
+PaletteTexture::~PaletteTexture()
+{
+  if (mpRenderer)
+  {
+    mpRenderer->destroyTexture(mId);
+  }
+}
+
+
+void PaletteTexture::update(const base::ArrayView<data::Pixel> colors)
+{
+  mpRenderer->updatePaletteTexture(mId, colors);
+}
+
+
 void Texture::render(const int x, const int y) const
 {
   base::Rect<int> fullImageRect{{0, 0}, {width(), height()}};
@@ -74,6 +99,31 @@ Texture::Texture(renderer::Renderer* pRenderer, const Image& image)
 }
 
 
+Texture::Texture(
+  renderer::Renderer* pRenderer,
+  const data::IndexedImage& image,
+  const PaletteTexture& palette)
+  : Texture(
+      pRenderer,
+      pRenderer->createIndexedTexture(image, palette.data()),
+      static_cast<int>(image.width()),
+      static_cast<int>(image.height()))
+{
+}
+
+
+Texture::Texture(
+  renderer::Renderer* pRenderer,
+  const data::AnyImage& image,
+  const PaletteTexture& palette)
+  : Texture(
+      std::holds_alternative<data::IndexedImage>(image)
+        ? Texture(pRenderer, std::get<data::IndexedImage>(image), palette)
+        : Texture(pRenderer, std::get<Image>(image)))
+{
+}
+
+
 Texture::~Texture()
 {
   if (mpRenderer)
@@ -25,6 +25,52 @@
 namespace rigel::renderer
 {
 
+/** Color palette residing in GPU memory, for use with indexed textures
+ *
+ * Like the Texture class, this is an abstraction over the Renderer API.
+ * Indexed textures only store palette indices, and are drawn by looking up
+ * each index in the palette they were created with. Updating the palette
+ * therefore changes the colors of all textures using it, without having to
+ * re-upload any of them.
+ *
+ * A palette must outlive all textures using it.
+ */
+class PaletteTexture
+{
+public:
+  PaletteTexture() = default;
+  PaletteTexture(Renderer* pRenderer, base::ArrayView<data::Pixel> colors);
+  ~PaletteTexture();
+
+  PaletteTexture(PaletteTexture&& other) noexcept
+    : mpRenderer(std::exchange(other.mpRenderer, nullptr))
+    , mId(std::exchange(other.mId, 0))
+  {
+  }
+
+  PaletteTexture& operator=(PaletteTexture&& other) noexcept
+  {
+    using std::swap;
+
+    swap(mpRenderer, other.mpRenderer);
+    swap(mId, other.mId);
+
+    return *this;
+  }
+
+  PaletteTexture(const PaletteTexture&) = delete;
+  PaletteTexture& operator=(const PaletteTexture&) = delete;
+
+  void update(base::ArrayView<data::Pixel> colors);
+
+  TextureId data() const { return mId; }
+
+private:
+  Renderer* mpRenderer = nullptr;
+  TextureId mId = 0;
+};
+
+
 /** Image (bitmap) residing in GPU memory
  *
  * This is an abstraction over the low-level texture management API
@@ -36,6 +82,21 @@ class Texture
 public:
   Texture() = default;
   Texture(Renderer* renderer, const data::Image& image);
+
+  /** Create an indexed texture, using the given palette for drawing */
+  Texture(
+    Renderer* renderer,
+    const data::IndexedImage& image,
+    const PaletteTexture& palette);
+
+  /** Create a texture for either kind of image
+   *
+   * Indexed images become indexed textures, using the given palette.
+   */
+  Texture(
+    Renderer* renderer,
+    const data::AnyImage& image,
+    const PaletteTexture& palette);
   ~Texture();
 
   Texture(Texture&& other) noexcept
@@ -24,6 +24,8 @@ RIGEL_DISABLE_WARNINGS
 RIGEL_RESTORE_WARNINGS
 
 #include <algorithm>
+#include <cassert>
+#include <numeric>
 #include <stdexcept>
 
 
@@ -39,12 +41,64 @@ constexpr auto ATLAS_HEIGHT = 1024;
 } // namespace
 
 
+TextureAtlas::TextureAtlas(Renderer* pRenderer)
+  : mpRenderer(pRenderer)
+{
+}
+
+
 TextureAtlas::TextureAtlas(
   Renderer* pRenderer,
   const std::vector<data::Image>& images)
   : mpRenderer(pRenderer)
 {
-  mAtlasMap.resize(images.size());
+  std::vector<int> indices(images.size());
+  std::iota(indices.begin(), indices.end(), 0);
+  addImages(indices, images);
+}
+
+
+void TextureAtlas::addImages(
+  const std::vector<int>& indices,
+  const std::vector<data::Image>& images)
+{
+  packImages(indices, images, [this](data::Image&& atlas) {
+    const auto size = atlas.pixelData().size() * sizeof(data::Pixel);
+    return AtlasTexture{Texture{mpRenderer, atlas}, size};
+  });
+}
+
+
+void TextureAtlas::addImages(
+  const std::vector<int>& indices,
+  const std::vector<data::IndexedImage>& images,
+  const PaletteTexture& palette)
+{
+  packImages(indices, images, [&](data::IndexedImage&& atlas) {
+    const auto size = atlas.indexData().size();
+    return AtlasTexture{Texture{mpRenderer, atlas, palette}, size};
+  });
+}
+
+
+template <typename ImageT, typename CreateTexture>
+void TextureAtlas::packImages(
+  const std::vector<int>& indices,
+  const std::vector<ImageT>& images,
+  CreateTexture createTexture)
+{
+  assert(indices.size() == images.size());
+
+  if (images.empty())
+  {
+    return;
+  }
+
+  const auto maxIndex = *std::max_element(indices.begin(), indices.end());
+  if (maxIndex >= static_cast<int>(mAtlasMap.size()))
+  {
+    mAtlasMap.resize(maxIndex + 1);
+  }
 
   std::vector<stbrp_rect> rects;
   rects.reserve(images.size());
@@ -96,32 +150,74 @@ TextureAtlas::TextureAtlas(
       throw std::runtime_error{"Failed to build texture atlas"};
     }
 
-    data::Image atlas{
-      static_cast<size_t>(ATLAS_WIDTH), static_cast<size_t>(ATLAS_HEIGHT)};
+    // Textures are only as large as needed to hold the packed images. This
+    // keeps textures holding just a few images, like the last one, small.
+    auto usedWidth = 0;
+    auto usedHeight = 0;
+    std::for_each(iFirstPacked, rects.end(), [&](const stbrp_rect& rect) {
+      usedWidth = std::max(usedWidth, rect.x + rect.w);
+      usedHeight = std::max(usedHeight, rect.y + rect.h);
+    });
+
+    ImageT atlas{
+      static_cast<size_t>(usedWidth), static_cast<size_t>(usedHeight)};
 
     const auto textureIndex = static_cast<int>(mAtlasTextures.size());
     std::for_each(iFirstPacked, rects.end(), [&](const stbrp_rect& packedRect) {
       atlas.insertImage(packedRect.x, packedRect.y, images[packedRect.id]);
-      mAtlasMap[packedRect.id] = TextureInfo{
+      mAtlasMap[indices[packedRect.id]] = TextureInfo{
         toTexCoords(
           {{packedRect.x, packedRect.y}, {packedRect.w, packedRect.h}},
-          ATLAS_WIDTH,
-          ATLAS_HEIGHT),
+          usedWidth,
+          usedHeight),
         textureIndex};
     });
 
-    mAtlasTextures.emplace_back(mpRenderer, std::move(atlas));
+    mAtlasTextures.push_back(createTexture(std::move(atlas)));
 
     rects.erase(iFirstPacked, rects.end());
   } while (!rects.empty());
 }
 
 
+void TextureAtlas::clear()
+{
+  mAtlasMap.clear();
+  mAtlasTextures.clear();
+}
+
+
+bool TextureAtlas::contains(const int index) const
+{
+  return index >= 0 && index < static_cast<int>(mAtlasMap.size()) &&
+    mAtlasMap[index].mTextureIndex >= 0;
+}
+
+
+std::size_t TextureAtlas::textureMemorySize() const
+{
+  auto size = std::size_t{0};
+  for (const auto& texture : mAtlasTextures)
+  {
+    size += texture.mSizeInBytes;
+  }
+
+  return size;
+}
+
+
 void TextureAtlas::draw(int index, const base::Rect<int>& destRect) const
 {
+  if (!contains(index))
+  {
+    return;
+  }
+
   const auto& info = mAtlasMap[index];
   mpRenderer->drawTexture(
-    mAtlasTextures[info.mTextureIndex].data(), info.mCoordinates, destRect);
+    mAtlasTextures[info.mTextureIndex].mTexture.data(),
+    info.mCoordinates,
+    destRect);
 }
 
 } // namespace rigel::renderer
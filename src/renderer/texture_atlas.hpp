@@ -20,6 +20,9 @@
 #include "renderer/renderer.hpp"
 #include "renderer/texture.hpp"
 
+#include <cstddef>
+#include <vector>
+
 
 namespace rigel::renderer
 {
@@ -35,6 +38,9 @@ namespace rigel::renderer
 class TextureAtlas
 {
 public:
+  /** Create an empty atlas, images can be added via addImages() */
+  explicit TextureAtlas(Renderer* pRenderer);
+
   /** Build a texture atlas
    *
    * Create an atlas using the provided list of images. Might use more than
@@ -46,10 +52,42 @@ public:
    */
   TextureAtlas(Renderer* pRenderer, const std::vector<data::Image>& images);
 
+  /** Add more images to the atlas
+   *
+   * The images are packed into one or more new textures, existing textures
+   * are left as they are. images[i] is referenced by indices[i] afterwards.
+   * Indices don't need to be contiguous, but must not be in use already.
+   */
+  void addImages(
+    const std::vector<int>& indices,
+    const std::vector<data::Image>& images);
+
+  /** Add indexed images to the atlas
+   *
+   * Like the overload above, but the images are packed into indexed
+   * textures, which are drawn using the given palette. The palette must
+   * outlive the atlas' textures.
+   */
+  void addImages(
+    const std::vector<int>& indices,
+    const std::vector<data::IndexedImage>& images,
+    const PaletteTexture& palette);
+
+  /** Remove all images, and release the textures holding them */
+  void clear();
+
+  bool contains(int index) const;
+
+  /** Combined size of all textures owned by the atlas, in bytes */
+  std::size_t textureMemorySize() const;
+
+  std::size_t numTextures() const { return mAtlasTextures.size(); }
+
   /** Draw image from atlas at given location
    *
    * The index parameter corresponds to the index in the list given on
-   * construction.
+   * construction, or to the index given to addImages(). Nothing is drawn
+   * for indices which are not part of the atlas.
    */
   void draw(int index, const base::Rect<int>& destRect) const;
 
@@ -57,11 +95,23 @@ private:
   struct TextureInfo
   {
     TexCoords mCoordinates;
-    int mTextureIndex;
+    int mTextureIndex = -1;
   };
 
+  struct AtlasTexture
+  {
+    Texture mTexture;
+    std::size_t mSizeInBytes;
+  };
+
+  template <typename ImageT, typename CreateTexture>
+  void packImages(
+    const std::vector<int>& indices,
+    const std::vector<ImageT>& images,
+    CreateTexture createTexture);
+
   std::vector<TextureInfo> mAtlasMap;
-  std::vector<Texture> mAtlasTextures;
+  std::vector<AtlasTexture> mAtlasTextures;
   Renderer* mpRenderer;
 };
 
@@ -61,7 +61,7 @@ const auto TOTAL_TIME = TIME_FOR_VIDEO_PLAYBACK + engine::fastTicksToTime(60);
 
 
 ApogeeLogo::ApogeeLogo(GameMode::Context context)
-  : mMoviePlayer(context.mpRenderer)
+  : mMoviePlayer(context.mpRenderer, context.mpMemoryRegistry)
   , mpServiceProvider(context.mpServiceProvider)
   , mLogoMovie(context.mpResources->loadMovie("NUKEM2.F5"))
 {
@@ -62,9 +62,10 @@ constexpr loader::Palette16 DUKE_3D_TEASER_TEXT_PALETTE{
 
 auto loadImage(const loader::ResourceLoader& resources)
 {
-  const auto actorData = resources.mActorImagePackage.loadActor(
-    data::ActorID::Duke_3d_teaser_text, DUKE_3D_TEASER_TEXT_PALETTE);
-  return actorData.mFrames.at(0).mFrameImage;
+  const auto actorData =
+    resources.mActorImagePackage.loadActor(data::ActorID::Duke_3d_teaser_text);
+  return data::toRgba(
+    actorData.mFrames.at(0).mFrameImage, DUKE_3D_TEASER_TEXT_PALETTE);
 }
 
 } // namespace
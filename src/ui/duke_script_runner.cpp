@@ -74,8 +74,9 @@ DukeScriptRunner::DukeScriptRunner(
   , mpRenderer(pRenderer)
   , mpSaveSlots(pSaveSlots)
   , mpServices(pServiceProvider)
+  , mUiSpriteSheetPalette(pRenderer, mCurrentPalette)
   , mUiSpriteSheetRenderer(
-      makeUiSpriteSheet(pRenderer, *pResourceLoader, mCurrentPalette))
+      makeUiSpriteSheet(pRenderer, *pResourceLoader, mUiSpriteSheetPalette))
   , mMenuElementRenderer(&mUiSpriteSheetRenderer, pRenderer, *pResourceLoader)
   , mCanvas(
       pRenderer,
@@ -547,13 +548,12 @@ void DukeScriptRunner::drawSprite(
   const int x,
   const int y)
 {
-  const auto actorData =
-    mpResourceBundle->mActorImagePackage.loadActor(id, mCurrentPalette);
+  const auto actorData = mpResourceBundle->mActorImagePackage.loadActor(id);
   const auto& frameData = actorData.mFrames.at(frame);
   const auto& image = frameData.mFrameImage;
 
   const auto spriteHeightTiles =
-    data::pixelsToTiles(static_cast<int>(image.height()));
+    data::pixelsToTiles(static_cast<int>(data::imageHeight(image)));
   const auto pos = base::Vector{x - 1, y};
   const auto topLeft = pos - base::Vector(0, spriteHeightTiles - 1);
 
@@ -561,7 +561,9 @@ void DukeScriptRunner::drawSprite(
   const auto drawOffsetPx =
     data::tileVectorToPixelVector(frameData.mDrawOffset);
 
-  renderer::Texture spriteTexture(mpRenderer, image);
+  // Indexed frames share the UI sprite sheet's palette, which follows the
+  // current palette
+  renderer::Texture spriteTexture(mpRenderer, image, mUiSpriteSheetPalette);
   spriteTexture.render(topLeftPx + drawOffsetPx);
 }
 
@@ -722,14 +724,10 @@ void DukeScriptRunner::drawCurrentKeyBindings()
 
 void DukeScriptRunner::updatePalette(const loader::Palette16& palette)
 {
-  // TODO think about optimizing this maybe, to only update if actually
-  // changed, e.g. if (palette != mCurrentPalette) or maybe have a
-  // 'paletteSource' string (name of palette file or fullscreen image file),
-  // which can be compared to determine if update needed.
-
+  // The UI sprite sheet is an indexed texture, so we only need to update
+  // its palette.
   mCurrentPalette = palette;
-  mUiSpriteSheetRenderer =
-    makeUiSpriteSheet(mpRenderer, *mpResourceBundle, mCurrentPalette);
+  mUiSpriteSheetPalette.update(mCurrentPalette);
 }
 
 
@@ -202,6 +202,7 @@ private:
   renderer::Renderer* mpRenderer;
   const data::SaveSlotArray* mpSaveSlots;
   IGameServiceProvider* mpServices;
+  renderer::PaletteTexture mUiSpriteSheetPalette;
   engine::TiledTexture mUiSpriteSheetRenderer;
   MenuElementRenderer mMenuElementRenderer;
 
@@ -20,6 +20,7 @@
 
 #include "utils.hpp"
 
+#include <algorithm>
 #include <iomanip>
 #include <sstream>
 #include <string>
@@ -34,11 +35,18 @@ namespace
 const auto PRE_FILTER_WEIGHT = 0.7f;
 const auto FILTER_WEIGHT = 0.9f;
 
+const auto HISTOGRAM_BAR_WIDTH = 3.0f;
+const auto HISTOGRAM_HEIGHT = 40.0f;
+
 } // namespace
 
 
-void FpsDisplay::updateAndRender(const engine::TimeDelta totalElapsed)
+void FpsDisplay::updateAndRender(
+  const engine::TimeDelta totalElapsed,
+  const std::optional<engine::SoundMixerStats>& soundMixerStats)
 {
+  mStatistics.addSample(totalElapsed);
+
   mPreFilteredFrameTime = base::lerp(
     static_cast<float>(totalElapsed), mPreFilteredFrameTime, PRE_FILTER_WEIGHT);
   mFilteredFrameTime =
@@ -51,11 +59,56 @@ void FpsDisplay::updateAndRender(const engine::TimeDelta totalElapsed)
   statsReport
     << smoothedFps << " FPS, "
     << std::setw(4) << std::fixed << std::setprecision(2)
-    << totalElapsed * 1000.0 << " ms";
+    << totalElapsed * 1000.0 << " ms\n"
+    << "jitter " << mStatistics.jitter() * 1000.0 << " ms, "
+    << "min " << mStatistics.minFrameTime() * 1000.0 << " ms, "
+    << "max " << mStatistics.maxFrameTime() * 1000.0 << " ms";
   // clang-format on
 
+  auto numLines = 2;
+  if (soundMixerStats)
+  {
+    // clang-format off
+    statsReport
+      << "\nsound mixing " << soundMixerStats->mLastCallbackMicroseconds
+      << " us, peak " << soundMixerStats->mPeakCallbackMicroseconds << " us, "
+      << soundMixerStats->mActiveVoices << " voices";
+    // clang-format on
+    ++numLines;
+  }
+
   const auto reportString = statsReport.str();
   drawText(reportString, 0, 0, {255, 255, 255, 255});
+
+  drawHistogram(ImGui::GetTextLineHeightWithSpacing() * numLines);
+}
+
+
+void FpsDisplay::drawHistogram(const float y) const
+{
+  const auto& histogram = mStatistics.histogram();
+  const auto largestBucket =
+    *std::max_element(std::begin(histogram), std::end(histogram));
+  if (largestBucket == 0)
+  {
+    return;
+  }
+
+  auto pDrawList = ImGui::GetForegroundDrawList();
+
+  const auto width = HISTOGRAM_BAR_WIDTH * histogram.size();
+  pDrawList->AddRectFilled(
+    {0.0f, y}, {width, y + HISTOGRAM_HEIGHT}, toImgui({0, 0, 0, 160}));
+
+  for (auto i = std::size_t{0}; i < histogram.size(); ++i)
+  {
+    const auto barHeight = HISTOGRAM_HEIGHT * histogram[i] / largestBucket;
+    const auto x = HISTOGRAM_BAR_WIDTH * i;
+    pDrawList->AddRectFilled(
+      {x, y + HISTOGRAM_HEIGHT - barHeight},
+      {x + HISTOGRAM_BAR_WIDTH - 1.0f, y + HISTOGRAM_HEIGHT},
+      toImgui({255, 255, 255, 255}));
+  }
 }
 
 } // namespace rigel::ui
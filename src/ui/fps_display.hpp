@@ -16,7 +16,11 @@
 
 #pragma once
 
+#include "engine/sound_mixer.hpp"
 #include "engine/timing.hpp"
+#include "renderer/frame_pacer.hpp"
+
+#include <optional>
 
 
 namespace rigel::ui
@@ -25,10 +29,15 @@ namespace rigel::ui
 class FpsDisplay
 {
 public:
-  void updateAndRender(engine::TimeDelta elapsed);
+  void updateAndRender(
+    engine::TimeDelta elapsed,
+    const std::optional<engine::SoundMixerStats>& soundMixerStats);
 
 
 private:
+  void drawHistogram(float y) const;
+
+  renderer::FrameTimeStatistics mStatistics;
   float mPreFilteredFrameTime = 0.0f;
   float mFilteredFrameTime = 0.0f;
 };
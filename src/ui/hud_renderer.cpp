@@ -133,53 +133,52 @@ void drawLevelNumber(const int number, const TiledTexture& spriteSheet)
 }
 
 
-Texture
-  actorToTexture(renderer::Renderer* pRenderer, const loader::ActorData& data)
+data::Image frameImage(const loader::ActorData& data, const int frame = 0)
 {
-  return Texture(pRenderer, data.mFrames[0].mFrameImage);
+  return data::toRgba(data.mFrames[frame].mFrameImage, loader::INGAME_PALETTE);
 }
 
-
 } // namespace
 
 
-HudRenderer::InventoryItemTextureMap HudRenderer::makeInventoryItemTextureMap(
-  renderer::Renderer* pRenderer,
-  const loader::ActorImagePackage& imagePack)
+HudRenderer::HudImages
+  HudRenderer::loadHudImages(const loader::ActorImagePackage& imagePack)
 {
-  InventoryItemTextureMap map;
-
-  map.emplace(
-    InventoryItemType::CircuitBoard,
-    actorToTexture(
-      pRenderer, imagePack.loadActor(data::ActorID::White_box_circuit_card)));
-  map.emplace(
-    InventoryItemType::BlueKey,
-    actorToTexture(
-      pRenderer, imagePack.loadActor(data::ActorID::White_box_blue_key)));
-  map.emplace(
-    InventoryItemType::RapidFire,
-    actorToTexture(
-      pRenderer, imagePack.loadActor(data::ActorID::Rapid_fire_icon)));
-  map.emplace(
-    InventoryItemType::SpecialHintGlobe,
-    actorToTexture(
-      pRenderer, imagePack.loadActor(data::ActorID::Special_hint_globe_icon)));
-  map.emplace(
-    InventoryItemType::CloakingDevice,
-    actorToTexture(
-      pRenderer, imagePack.loadActor(data::ActorID::Cloaking_device_icon)));
-  return map;
-}
+  HudImages result;
+
+  auto addImage = [&](const data::Image& image) {
+    const auto index = static_cast<int>(result.mImages.size());
+    result.mImages.push_back(image);
+    return AtlasImage{
+      index,
+      base::Extents{
+        static_cast<int>(image.width()), static_cast<int>(image.height())}};
+  };
 
+  // Hud background
+  const auto frameData = imagePack.loadActor(ActorID::HUD_frame_background);
+  result.mTopRightFrame = addImage(frameImage(frameData, 0));
+  result.mBottomLeftFrame = addImage(frameImage(frameData, 1));
+  result.mBottomRightFrame = addImage(frameImage(frameData, 2));
 
-HudRenderer::CollectedLetterIndicatorMap
-  HudRenderer::makeCollectedLetterTextureMap(
-    renderer::Renderer* pRenderer,
-    const loader::ActorImagePackage& imagePack)
-{
-  CollectedLetterIndicatorMap map;
+  // Inventory
+  auto addInventoryItem = [&](
+                            const InventoryItemType type,
+                            const data::ActorID actorId) {
+    result.mInventoryItems.emplace(
+      type, addImage(frameImage(imagePack.loadActor(actorId))));
+  };
+
+  addInventoryItem(
+    InventoryItemType::CircuitBoard, ActorID::White_box_circuit_card);
+  addInventoryItem(InventoryItemType::BlueKey, ActorID::White_box_blue_key);
+  addInventoryItem(InventoryItemType::RapidFire, ActorID::Rapid_fire_icon);
+  addInventoryItem(
+    InventoryItemType::SpecialHintGlobe, ActorID::Special_hint_globe_icon);
+  addInventoryItem(
+    InventoryItemType::CloakingDevice, ActorID::Cloaking_device_icon);
 
+  // Collected letters
   const auto rightScreenEdge = GameTraits::inGameViewPortSize.width;
   const auto bottomScreenEdge = GameTraits::inGameViewPortSize.height;
   const base::Vector letterDrawStart{
@@ -188,37 +187,39 @@ HudRenderer::CollectedLetterIndicatorMap
   // TODO: Consider using the positions from the loaded actor frames instead
   // of calculating manually?
   const base::Vector letterSize{GameTraits::tileSize, 0};
-  map.emplace(
+
+  auto addLetter = [&](
+                     const CollectableLetterType type,
+                     const data::ActorID actorId,
+                     const base::Vector& position) {
+    result.mCollectedLetters.emplace(
+      type,
+      CollectedLetterIndicator{
+        addImage(frameImage(imagePack.loadActor(actorId))), position});
+  };
+
+  addLetter(
     CollectableLetterType::N,
-    CollectedLetterIndicator{
-      actorToTexture(
-        pRenderer, imagePack.loadActor(ActorID::Letter_collection_indicator_N)),
-      letterDrawStart});
-  map.emplace(
+    ActorID::Letter_collection_indicator_N,
+    letterDrawStart);
+  addLetter(
     CollectableLetterType::U,
-    CollectedLetterIndicator{
-      actorToTexture(
-        pRenderer, imagePack.loadActor(ActorID::Letter_collection_indicator_U)),
-      letterDrawStart});
-  map.emplace(
+    ActorID::Letter_collection_indicator_U,
+    letterDrawStart);
+  addLetter(
     CollectableLetterType::K,
-    CollectedLetterIndicator{
-      actorToTexture(
-        pRenderer, imagePack.loadActor(ActorID::Letter_collection_indicator_K)),
-      letterDrawStart + letterSize * 1});
-  map.emplace(
+    ActorID::Letter_collection_indicator_K,
+    letterDrawStart + letterSize * 1);
+  addLetter(
     CollectableLetterType::E,
-    CollectedLetterIndicator{
-      actorToTexture(
-        pRenderer, imagePack.loadActor(ActorID::Letter_collection_indicator_E)),
-      letterDrawStart + letterSize * 2});
-  map.emplace(
+    ActorID::Letter_collection_indicator_E,
+    letterDrawStart + letterSize * 2);
+  addLetter(
     CollectableLetterType::M,
-    CollectedLetterIndicator{
-      actorToTexture(
-        pRenderer, imagePack.loadActor(ActorID::Letter_collection_indicator_M)),
-      letterDrawStart + letterSize * 3});
-  return map;
+    ActorID::Letter_collection_indicator_M,
+    letterDrawStart + letterSize * 3);
+
+  return result;
 }
 
 
@@ -232,9 +233,7 @@ HudRenderer::HudRenderer(
       levelNumber,
       pOptions,
       pRenderer,
-      bundle.mActorImagePackage.loadActor(ActorID::HUD_frame_background),
-      makeInventoryItemTextureMap(pRenderer, bundle.mActorImagePackage),
-      makeCollectedLetterTextureMap(pRenderer, bundle.mActorImagePackage),
+      loadHudImages(bundle.mActorImagePackage),
       pStatusSpriteSheet)
 {
 }
@@ -244,19 +243,22 @@ HudRenderer::HudRenderer(
   const int levelNumber,
   const data::GameOptions* pOptions,
   renderer::Renderer* pRenderer,
-  const loader::ActorData& actorData,
-  InventoryItemTextureMap&& inventoryItemTextures,
-  CollectedLetterIndicatorMap&& collectedLetterTextures,
+  HudImages&& images,
   engine::TiledTexture* pStatusSpriteSheet)
   : mLevelNumber(levelNumber)
   , mpRenderer(pRenderer)
   , mpOptions(pOptions)
-  , mTopRightTexture(mpRenderer, actorData.mFrames[0].mFrameImage)
-  , mBottomLeftTexture(mpRenderer, actorData.mFrames[1].mFrameImage)
-  , mBottomRightTexture(mpRenderer, actorData.mFrames[2].mFrameImage)
-  , mInventoryTexturesByType(std::move(inventoryItemTextures))
-  , mCollectedLetterIndicatorsByType(std::move(collectedLetterTextures))
+  , mAtlas(pRenderer, images.mImages)
+  , mTopRightFrame(images.mTopRightFrame)
+  , mBottomLeftFrame(images.mBottomLeftFrame)
+  , mBottomRightFrame(images.mBottomRightFrame)
+  , mInventoryImagesByType(std::move(images.mInventoryItems))
+  , mCollectedLetterIndicatorsByType(std::move(images.mCollectedLetters))
   , mpStatusSpriteSheetRenderer(pStatusSpriteSheet)
+  , mCachedLayer(
+      pRenderer,
+      GameTraits::inGameViewPortSize.width,
+      GameTraits::inGameViewPortSize.height)
   , mRadarSurface(pRenderer, RADAR_SIZE_PX, RADAR_SIZE_PX)
 {
 }
@@ -271,24 +273,115 @@ void HudRenderer::updateAnimation()
 void HudRenderer::render(
   const data::PlayerModel& playerModel,
   const base::ArrayView<base::Vector> radarPositions)
+{
+  if (!isCachedLayerUpToDate(playerModel))
+  {
+    updateCachedLayer(playerModel);
+  }
+
+  {
+    // The layer was cleared to transparent before drawing into it
+    const auto saved = renderer::saveState(mpRenderer);
+    mpRenderer->setBlendMode(renderer::BlendMode::PremultipliedAlpha);
+    mCachedLayer.render(0, 0);
+  }
+
+  drawRadar(radarPositions);
+}
+
+
+std::uint32_t
+  HudRenderer::healthAnimationStep(const data::PlayerModel& playerModel) const
+{
+  // The health bar is only animated when showing the lowest health value,
+  // see drawHealthBar()
+  return playerModel.health() <= 1 ? mElapsedFrames % 9 : 0;
+}
+
+
+bool HudRenderer::isCachedLayerUpToDate(
+  const data::PlayerModel& playerModel) const
+{
+  const auto& state = mCachedLayerState;
+
+  // clang-format off
+  return
+    mCachedLayerValid &&
+    state.mScore == playerModel.score() &&
+    state.mAmmo == playerModel.ammo() &&
+    state.mMaxAmmo == playerModel.currentMaxAmmo() &&
+    state.mHealth == playerModel.health() &&
+    state.mWeapon == playerModel.weapon() &&
+    state.mInventory == playerModel.inventory() &&
+    state.mCollectedLetters == playerModel.collectedLetters() &&
+    state.mHealthAnimationStep == healthAnimationStep(playerModel);
+  // clang-format on
+}
+
+
+void HudRenderer::updateCachedLayer(const data::PlayerModel& playerModel)
+{
+  auto& state = mCachedLayerState;
+  state.mScore = playerModel.score();
+  state.mAmmo = playerModel.ammo();
+  state.mMaxAmmo = playerModel.currentMaxAmmo();
+  state.mHealth = playerModel.health();
+  state.mWeapon = playerModel.weapon();
+  state.mInventory.assign(
+    playerModel.inventory().begin(), playerModel.inventory().end());
+  state.mCollectedLetters.assign(
+    playerModel.collectedLetters().begin(),
+    playerModel.collectedLetters().end());
+  state.mHealthAnimationStep = healthAnimationStep(playerModel);
+  mCachedLayerValid = true;
+
+  const auto saved = mCachedLayer.bindAndReset();
+  mpRenderer->clear({0, 0, 0, 0});
+
+  drawFramesAndInventory(playerModel);
+  drawScore(playerModel.score(), *mpStatusSpriteSheetRenderer);
+  drawWeaponIcon(playerModel.weapon(), *mpStatusSpriteSheetRenderer);
+  drawAmmoBar(
+    playerModel.ammo(),
+    playerModel.currentMaxAmmo(),
+    *mpStatusSpriteSheetRenderer);
+  drawHealthBar(playerModel);
+  drawLevelNumber(mLevelNumber, *mpStatusSpriteSheetRenderer);
+  drawCollectedLetters(playerModel);
+}
+
+
+void HudRenderer::drawImage(
+  const AtlasImage& image,
+  const base::Vector& position) const
+{
+  mAtlas.draw(image.mIndex, base::Rect<int>{position, image.mSize});
+}
+
+
+void HudRenderer::drawFramesAndInventory(
+  const data::PlayerModel& playerModel) const
 {
   // Hud background
   // --------------------------------------------------------------------------
   const auto maxX = GameTraits::inGameViewPortSize.width;
-  mBottomLeftTexture.render(
-    0, GameTraits::inGameViewPortSize.height - mBottomLeftTexture.height());
+  const auto maxY = GameTraits::inGameViewPortSize.height;
+  drawImage(
+    mBottomLeftFrame,
+    base::Vector{0, maxY - mBottomLeftFrame.mSize.height});
 
-  mBottomRightTexture.render(
-    mBottomLeftTexture.width(),
-    GameTraits::inGameViewPortSize.height - mBottomRightTexture.height());
+  drawImage(
+    mBottomRightFrame,
+    base::Vector{
+      mBottomLeftFrame.mSize.width, maxY - mBottomRightFrame.mSize.height});
 
-  const auto topRightTexturePosX = maxX - mTopRightTexture.width();
-  mTopRightTexture.render(topRightTexturePosX, 0);
+  const auto topRightFramePosX = maxX - mTopRightFrame.mSize.width;
+  drawImage(mTopRightFrame, base::Vector{topRightFramePosX, 0});
 
   // Inventory
   // --------------------------------------------------------------------------
   const auto inventoryStartPos = base::Vector{
-    topRightTexturePosX + GameTraits::tileSize, 2 * GameTraits::tileSize};
+    topRightFramePosX + GameTraits::tileSize, 2 * GameTraits::tileSize};
   auto inventoryIter = playerModel.inventory().begin();
   for (int row = 0; row < 3; ++row)
   {
@@ -300,25 +393,12 @@ void HudRenderer::render(
         const auto drawPos =
           inventoryStartPos + base::Vector{col, row} * GameTraits::tileSize * 2;
 
-        const auto textureIt = mInventoryTexturesByType.find(itemType);
-        assert(textureIt != mInventoryTexturesByType.end());
-        textureIt->second.render(drawPos);
+        const auto imageIt = mInventoryImagesByType.find(itemType);
+        assert(imageIt != mInventoryImagesByType.end());
+        drawImage(imageIt->second, drawPos);
       }
     }
   }
-
-  // Player state and remaining HUD elements
-  // --------------------------------------------------------------------------
-  drawScore(playerModel.score(), *mpStatusSpriteSheetRenderer);
-  drawWeaponIcon(playerModel.weapon(), *mpStatusSpriteSheetRenderer);
-  drawAmmoBar(
-    playerModel.ammo(),
-    playerModel.currentMaxAmmo(),
-    *mpStatusSpriteSheetRenderer);
-  drawHealthBar(playerModel);
-  drawLevelNumber(mLevelNumber, *mpStatusSpriteSheetRenderer);
-  drawCollectedLetters(playerModel);
-  drawRadar(radarPositions);
 }
 
 
@@ -368,7 +448,7 @@ void HudRenderer::drawCollectedLetters(
   {
     const auto it = mCollectedLetterIndicatorsByType.find(letter);
     assert(it != mCollectedLetterIndicatorsByType.end());
-    it->second.mTexture.render(it->second.mPxPosition);
+    drawImage(it->second.mImage, it->second.mPxPosition);
   }
 }
 
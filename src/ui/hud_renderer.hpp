@@ -20,9 +20,11 @@
 #include "data/player_model.hpp"
 #include "engine/tiled_texture.hpp"
 #include "renderer/texture.hpp"
+#include "renderer/texture_atlas.hpp"
 
 #include <cstdint>
 #include <unordered_map>
+#include <vector>
 
 
 namespace rigel
@@ -56,6 +58,15 @@ inline bool isVisibleOnRadar(const base::Vector& position)
 }
 
 
+/** Draws the in-game HUD
+ *
+ * All HUD imagery except for the status sprite sheet (which is shared with
+ * other UI code) is packed into a single texture atlas. Since most of the
+ * HUD only changes when the player's score, inventory etc. change, all parts
+ * except the radar are rendered into a cached layer, which is only redrawn
+ * when the displayed player model values change, or when the health bar's
+ * low-health animation advances. The radar is redrawn every frame.
+ */
 class HudRenderer
 {
 public:
@@ -72,34 +83,62 @@ public:
     base::ArrayView<base::Vector> radarPositions);
 
 private:
+  struct AtlasImage
+  {
+    int mIndex;
+    base::Extents mSize;
+  };
+
   struct CollectedLetterIndicator
   {
-    renderer::Texture mTexture;
+    AtlasImage mImage;
     base::Vector mPxPosition;
   };
 
-  using InventoryItemTextureMap =
-    std::unordered_map<data::InventoryItemType, renderer::Texture>;
+  using InventoryItemImageMap =
+    std::unordered_map<data::InventoryItemType, AtlasImage>;
   using CollectedLetterIndicatorMap =
     std::unordered_map<data::CollectableLetterType, CollectedLetterIndicator>;
 
+  struct HudImages
+  {
+    std::vector<data::Image> mImages;
+    AtlasImage mTopRightFrame;
+    AtlasImage mBottomLeftFrame;
+    AtlasImage mBottomRightFrame;
+    InventoryItemImageMap mInventoryItems;
+    CollectedLetterIndicatorMap mCollectedLetters;
+  };
+
+  /** Player model values shown in the cached layer */
+  struct CachedLayerState
+  {
+    int mScore = 0;
+    int mAmmo = 0;
+    int mMaxAmmo = 0;
+    int mHealth = 0;
+    data::WeaponType mWeapon = data::WeaponType::Normal;
+    std::vector<data::InventoryItemType> mInventory;
+    std::vector<data::CollectableLetterType> mCollectedLetters;
+    std::uint32_t mHealthAnimationStep = 0;
+  };
+
   HudRenderer(
     int levelNumber,
     const data::GameOptions* pOptions,
     renderer::Renderer* pRenderer,
-    const loader::ActorData& actorData,
-    InventoryItemTextureMap&& inventoryItemTextures,
-    CollectedLetterIndicatorMap&& collectedLetterTextures,
+    HudImages&& images,
     engine::TiledTexture* pStatusSpriteSheetRenderer);
 
-  static InventoryItemTextureMap makeInventoryItemTextureMap(
-    renderer::Renderer* pRenderer,
-    const loader::ActorImagePackage& imagePack);
+  static HudImages loadHudImages(const loader::ActorImagePackage& imagePack);
 
-  static CollectedLetterIndicatorMap makeCollectedLetterTextureMap(
-    renderer::Renderer* pRenderer,
-    const loader::ActorImagePackage& imagePack);
+  std::uint32_t healthAnimationStep(
+    const data::PlayerModel& playerModel) const;
+  bool isCachedLayerUpToDate(const data::PlayerModel& playerModel) const;
+  void updateCachedLayer(const data::PlayerModel& playerModel);
 
+  void drawImage(const AtlasImage& image, const base::Vector& position) const;
+  void drawFramesAndInventory(const data::PlayerModel& playerModel) const;
   void drawHealthBar(const data::PlayerModel& playerModel) const;
   void drawCollectedLetters(const data::PlayerModel& playerModel) const;
   void drawRadar(base::ArrayView<base::Vector> positions) const;
@@ -110,12 +149,16 @@ private:
 
   std::uint32_t mElapsedFrames = 0;
 
-  renderer::Texture mTopRightTexture;
-  renderer::Texture mBottomLeftTexture;
-  renderer::Texture mBottomRightTexture;
-  InventoryItemTextureMap mInventoryTexturesByType;
+  renderer::TextureAtlas mAtlas;
+  AtlasImage mTopRightFrame;
+  AtlasImage mBottomLeftFrame;
+  AtlasImage mBottomRightFrame;
+  InventoryItemImageMap mInventoryImagesByType;
   CollectedLetterIndicatorMap mCollectedLetterIndicatorsByType;
   engine::TiledTexture* mpStatusSpriteSheetRenderer;
+  renderer::RenderTargetTexture mCachedLayer;
+  CachedLayerState mCachedLayerState;
+  bool mCachedLayerValid = false;
   mutable renderer::RenderTargetTexture mRadarSurface;
 };
 
@@ -114,8 +114,11 @@ IngameMenu::TopLevelMenu::TopLevelMenu(
   const bool canQuickLoad)
   : mContext(context)
   , mPalette(context.mpResources->loadPaletteFromFullScreenImage("MESSAGE.MNI"))
-  , mUiSpriteSheet(
-      makeUiSpriteSheet(context.mpRenderer, *context.mpResources, mPalette))
+  , mUiSpriteSheetPalette(context.mpRenderer, mPalette)
+  , mUiSpriteSheet(makeUiSpriteSheet(
+      context.mpRenderer,
+      *context.mpResources,
+      mUiSpriteSheetPalette))
   , mMenuElementRenderer(
       &mUiSpriteSheet,
       context.mpRenderer,
@@ -502,7 +505,9 @@ void IngameMenu::handleCheatCodes()
     // for g, o, d being pressed here, only in the shareware version.
     if (keysPressed(SDLK_e, SDLK_a, SDLK_t))
     {
-      mpGameWorld->activateFullHealthCheat();
+      // Like the item cheat below, this is activated when entering the menu.
+      // Event handling must not modify the game world, since game logic
+      // might be running concurrently at that point (see GameRunner).
       mMenuToEnter = MenuType::CheatMessageHealthRestored;
     }
     else if (keysPressed(SDLK_n, SDLK_u, SDLK_k))
@@ -625,6 +630,7 @@ void IngameMenu::enterMenu(const MenuType type)
 
     case MenuType::CheatMessageHealthRestored:
       enterScriptedMenu("Full_Health", leaveMenuHook, noopEventHook, true);
+      mpGameWorld->activateFullHealthCheat();
       // The original game incorrectly does a fadeout after the message is
       // closed, but we don't replicate it here.
       break;
@@ -100,6 +100,7 @@ private:
 
     GameMode::Context mContext;
     loader::Palette16 mPalette;
+    renderer::PaletteTexture mUiSpriteSheetPalette;
     engine::TiledTexture mUiSpriteSheet;
     MenuElementRenderer mMenuElementRenderer;
     renderer::Texture mMenuBackground;
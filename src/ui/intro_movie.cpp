@@ -188,7 +188,7 @@ IntroMovie::PlaybackConfigList
 
 IntroMovie::IntroMovie(GameMode::Context context)
   : mpServiceProvider(context.mpServiceProvider)
-  , mMoviePlayer(context.mpRenderer)
+  , mMoviePlayer(context.mpRenderer, context.mpMemoryRegistry)
   , mCurrentConfiguration(0u)
 {
   mMovieConfigurations = createConfigurations(*context.mpResources);
@@ -0,0 +1,102 @@
+/* Copyright (C) 2016, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "memory_usage_display.hpp"
+
+#include "utils.hpp"
+
+#include <string>
+
+
+namespace rigel::ui
+{
+
+namespace
+{
+
+const auto REFRESH_INTERVAL = 0.5;
+
+
+std::string formatBytes(const std::size_t bytes)
+{
+  if (bytes >= 1024 * 1024)
+  {
+    return std::to_string(bytes / (1024 * 1024)) + "." +
+      std::to_string(bytes % (1024 * 1024) * 10 / (1024 * 1024)) + " MiB";
+  }
+
+  if (bytes >= 1024)
+  {
+    return std::to_string(bytes / 1024) + " KiB";
+  }
+
+  return std::to_string(bytes) + " B";
+}
+
+} // namespace
+
+
+MemoryUsageDisplay::MemoryUsageDisplay(const MemoryRegistry* pRegistry)
+  : mpRegistry(pRegistry)
+{
+}
+
+
+void MemoryUsageDisplay::updateAndRender(const engine::TimeDelta elapsed)
+{
+  mTimeSinceRefresh += elapsed;
+  if (mNeedsRefresh || mTimeSinceRefresh >= REFRESH_INTERVAL)
+  {
+    mReport = mpRegistry->collect();
+    mTimeSinceRefresh = 0.0;
+    mNeedsRefresh = false;
+  }
+
+  ImGui::SetNextWindowPos({0.0f, 0.0f}, ImGuiCond_FirstUseEver);
+  ImGui::Begin(
+    "Memory usage",
+    nullptr,
+    ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoFocusOnAppearing);
+
+  for (const auto& category : mReport.categories())
+  {
+    const auto header =
+      category + " (" + formatBytes(mReport.totalBytes(category)) + ")";
+    if (!ImGui::CollapsingHeader(
+          header.c_str(), ImGuiTreeNodeFlags_DefaultOpen))
+    {
+      continue;
+    }
+
+    for (const auto& entry : mReport.entries())
+    {
+      if (entry.mCategory != category)
+      {
+        continue;
+      }
+
+      const auto size = entry.mBytes > 0 ? formatBytes(entry.mBytes) : "";
+      const auto count =
+        entry.mCount > 0 ? std::to_string(entry.mCount) : std::string{};
+      ImGui::Text(
+        "%-36s %10s %8s", entry.mName.c_str(), size.c_str(), count.c_str());
+    }
+  }
+
+  ImGui::End();
+}
+
+} // namespace rigel::ui
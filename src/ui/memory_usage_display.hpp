@@ -0,0 +1,45 @@
+/* Copyright (C) 2016, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/memory_accounting.hpp"
+#include "engine/timing.hpp"
+
+
+namespace rigel::ui
+{
+
+/** Debug overlay listing the contents of a MemoryRegistry
+ *
+ * Collecting a report can be expensive, so it's only refreshed a couple of
+ * times per second.
+ */
+class MemoryUsageDisplay
+{
+public:
+  explicit MemoryUsageDisplay(const MemoryRegistry* pRegistry);
+
+  void updateAndRender(engine::TimeDelta elapsed);
+
+private:
+  const MemoryRegistry* mpRegistry;
+  MemoryReport mReport;
+  engine::TimeDelta mTimeSinceRefresh = 0.0;
+  bool mNeedsRefresh = true;
+};
+
+} // namespace rigel::ui
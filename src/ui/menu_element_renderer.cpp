@@ -172,11 +172,21 @@ MenuElementRenderer::MenuElementRenderer(
   engine::TiledTexture* pSpriteSheet,
   renderer::Renderer* pRenderer,
   const loader::ResourceLoader& resources)
+  : MenuElementRenderer(
+      pSpriteSheet,
+      pRenderer,
+      resources.mActorImagePackage.loadFont())
+{
+}
+
+
+MenuElementRenderer::MenuElementRenderer(
+  engine::TiledTexture* pSpriteSheet,
+  renderer::Renderer* pRenderer,
+  const loader::FontData& menuFont)
   : mpRenderer(pRenderer)
   , mpSpriteSheet(pSpriteSheet)
-  , mBigTextTexture(
-      createFontTexture(resources.mActorImagePackage.loadFont(), pRenderer),
-      pRenderer)
+  , mBigTextTexture(createFontTexture(menuFont, pRenderer), pRenderer)
 {
 }
 
@@ -20,6 +20,7 @@
 #include "base/warnings.hpp"
 #include "engine/tiled_texture.hpp"
 #include "engine/timing.hpp"
+#include "loader/actor_image_package.hpp"
 #include "loader/palette.hpp"
 #include "renderer/texture.hpp"
 
@@ -48,6 +49,10 @@ public:
     engine::TiledTexture* pSpriteSheet,
     renderer::Renderer* pRenderer,
     const loader::ResourceLoader& resources);
+  MenuElementRenderer(
+    engine::TiledTexture* pSpriteSheet,
+    renderer::Renderer* pRenderer,
+    const loader::FontData& menuFont);
 
   // Stateless API
   // --------------------------------------------------------------------------
@@ -16,8 +16,6 @@
 
 #include "movie_player.hpp"
 
-#include "base/container_utils.hpp"
-#include "data/game_traits.hpp"
 #include "engine/timing.hpp"
 #include "utility"
 
@@ -30,12 +28,13 @@ namespace rigel::ui
 using engine::fastTicksToTime;
 
 
-MoviePlayer::MoviePlayer(renderer::Renderer* pRenderer)
+MoviePlayer::MoviePlayer(
+  renderer::Renderer* pRenderer,
+  MemoryRegistry* pMemoryRegistry)
   : mpRenderer(pRenderer)
-  , mCanvas(
-      pRenderer,
-      data::GameTraits::viewPortWidthPx,
-      data::GameTraits::viewPortHeightPx)
+  , mCurrentImage(0, 0)
+  , mMemoryRegistration(pMemoryRegistry->add(
+      [this](MemoryReport& report) { reportMemoryUsage(report); }))
 {
 }
 
@@ -48,18 +47,19 @@ void MoviePlayer::playMovie(
 {
   assert(frameDelayInFastTicks >= 1);
 
-  {
-    const auto saved = mCanvas.bindAndReset();
-
-    auto baseImage = renderer::Texture(mpRenderer, movie.mBaseImage);
-    baseImage.render(0, 0);
-  }
+  // The previous movie's texture must be gone before replacing the palette
+  // it uses
+  mCurrentImageTexture = renderer::Texture{};
+  mPalette = renderer::PaletteTexture(mpRenderer, movie.mPalette);
 
-  mAnimationFrames =
-    utils::transformed(movie.mFrames, [this](const auto& frame) {
-      auto texture = renderer::Texture(mpRenderer, frame.mReplacementImage);
-      return FrameData{std::move(texture), frame.mStartRow};
-    });
+  // Frames only contain the pixels that change compared to the previous
+  // frame, so we apply them to a copy of the base image and upload the
+  // result. This keeps all 256 palette entries available for colors.
+  mCurrentImage = movie.mBaseImage;
+  mCurrentImageTexture =
+    renderer::Texture(mpRenderer, mCurrentImage, mPalette);
+  mAnimationFrames = movie.mFrames;
+  mAppliedFrame = -1;
 
   mFrameCallback = std::move(frameCallback);
   mCurrentFrame = 0;
@@ -120,13 +120,37 @@ void MoviePlayer::updateAndRender(const engine::TimeDelta timeDelta)
     invokeFrameCallbackIfPresent(frameNrIncludingFirstImage);
   }
 
+  if (mCurrentFrame != mAppliedFrame)
   {
-    const auto saved = mCanvas.bindAndReset();
-    const auto& frameData = mAnimationFrames[mCurrentFrame];
-    frameData.mImage.render(0, frameData.mStartRow);
+    const auto& frame = mAnimationFrames[mCurrentFrame];
+    mCurrentImage.insertImage(
+      0, frame.mStartRow, frame.mReplacementImage, frame.mChangedPixels);
+    mpRenderer->updateIndexedTexture(
+      mCurrentImageTexture.data(), mCurrentImage);
+    mAppliedFrame = mCurrentFrame;
   }
 
-  mCanvas.render(0, 0);
+  mCurrentImageTexture.render(0, 0);
+}
+
+
+void MoviePlayer::reportMemoryUsage(MemoryReport& report) const
+{
+  std::size_t frameBytes = 0;
+  for (const auto& frame : mAnimationFrames)
+  {
+    frameBytes += frame.mReplacementImage.indexData().size() +
+      frame.mChangedPixels.size() / 8;
+  }
+
+  report.add("Movie", "Frames", frameBytes, mAnimationFrames.size());
+
+  // The current image is an indexed texture, using one byte per pixel
+  report.add(
+    "Movie",
+    "Frame texture",
+    mCurrentImage.indexData().size(),
+    mCurrentImageTexture.data() != 0 ? 1 : 0);
 }
 
 
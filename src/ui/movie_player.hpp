@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "common/memory_accounting.hpp"
 #include "data/movie.hpp"
 #include "engine/timing.hpp"
 #include "renderer/texture.hpp"
@@ -37,7 +38,11 @@ public:
    */
   using FrameCallbackFunc = std::function<std::optional<int>(int)>;
 
-  explicit MoviePlayer(renderer::Renderer* pRenderer);
+  MoviePlayer(
+    renderer::Renderer* pRenderer,
+    MemoryRegistry* pMemoryRegistry);
+  MoviePlayer(const MoviePlayer&) = delete;
+  MoviePlayer& operator=(const MoviePlayer&) = delete;
 
   void playMovie(
     const data::Movie& movie,
@@ -49,25 +54,25 @@ public:
   bool hasCompletedPlayback() const;
 
 private:
-  struct FrameData
-  {
-    renderer::Texture mImage;
-    int mStartRow;
-  };
-
   void invokeFrameCallbackIfPresent(int whichFrame);
+  void reportMemoryUsage(MemoryReport& report) const;
 
 private:
   renderer::Renderer* mpRenderer;
-  renderer::RenderTargetTexture mCanvas;
-  std::vector<FrameData> mAnimationFrames;
+  renderer::PaletteTexture mPalette;
+  data::IndexedImage mCurrentImage;
+  renderer::Texture mCurrentImageTexture;
+  std::vector<data::MovieFrame> mAnimationFrames;
   FrameCallbackFunc mFrameCallback = nullptr;
 
   bool mHasShownFirstFrame = false;
   int mCurrentFrame = 0;
+  int mAppliedFrame = -1;
   std::optional<int> mRemainingRepetitions = 0;
   engine::TimeDelta mFrameDelay = 0.0;
   engine::TimeDelta mElapsedTime = 0.0;
+
+  MemoryRegistry::Registration mMemoryRegistration;
 };
 
 } // namespace rigel::ui
@@ -121,6 +121,12 @@ void fpsLimitUi(data::GameOptions* pOptions)
       ImGui::EndCombo();
     }
   });
+
+  const auto fpsLimitActive =
+    !pOptions->mEnableVsync && pOptions->mEnableFpsLimit;
+  withEnabledState(fpsLimitActive, [=]() {
+    ImGui::Checkbox("Reduce input lag", &pOptions->mPredictRenderCost);
+  });
 }
 
 
@@ -43,13 +43,27 @@ renderer::Texture fullScreenImageAsTexture(
 engine::TiledTexture makeUiSpriteSheet(
   renderer::Renderer* pRenderer,
   const loader::ResourceLoader& resourceLoader,
-  const loader::Palette16& palette)
+  const renderer::PaletteTexture& palette)
+{
+  return makeUiSpriteSheet(
+    pRenderer, loadUiSpriteSheetImage(resourceLoader), palette);
+}
+
+
+data::IndexedImage
+  loadUiSpriteSheetImage(const loader::ResourceLoader& resourceLoader)
+{
+  return resourceLoader.loadTiledFullscreenIndexedImage("STATUS.MNI");
+}
+
+
+engine::TiledTexture makeUiSpriteSheet(
+  renderer::Renderer* pRenderer,
+  const data::IndexedImage& image,
+  const renderer::PaletteTexture& palette)
 {
   return engine::TiledTexture{
-    renderer::Texture{
-      pRenderer,
-      resourceLoader.loadTiledFullscreenImage("STATUS.MNI", palette)},
-    pRenderer};
+    renderer::Texture{pRenderer, image, palette}, pRenderer};
 }
 
 
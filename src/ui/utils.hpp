@@ -44,10 +44,29 @@ renderer::Texture fullScreenImageAsTexture(
   const loader::ResourceLoader& resources,
   const std::string& imageName);
 
+/** Create a tiled texture for STATUS.MNI
+ *
+ * The texture is indexed, so changing the given palette's colors changes the
+ * sprite sheet's colors as well.
+ */
 engine::TiledTexture makeUiSpriteSheet(
   renderer::Renderer* pRenderer,
   const loader::ResourceLoader& resourceLoader,
-  const loader::Palette16& palette);
+  const renderer::PaletteTexture& palette);
+
+/** Load the image for the UI sprite sheet
+ *
+ * Together with the overload of makeUiSpriteSheet() below, this allows
+ * loading the image on a different thread than the one doing the texture
+ * upload.
+ */
+data::IndexedImage
+  loadUiSpriteSheetImage(const loader::ResourceLoader& resourceLoader);
+
+engine::TiledTexture makeUiSpriteSheet(
+  renderer::Renderer* pRenderer,
+  const data::IndexedImage& image,
+  const renderer::PaletteTexture& palette);
 
 void drawText(std::string_view text, int x, int y, const base::Color& color);
 
@@ -0,0 +1,699 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synthetic_game_data.hpp"
+
+#include "data/actor_ids.hpp"
+#include "data/game_traits.hpp"
+#include "loader/file_utils.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iterator>
+#include <random>
+
+
+namespace rigel::synthetic_data
+{
+
+namespace
+{
+
+using data::ActorID;
+using data::GameTraits;
+using loader::ByteBuffer;
+
+
+constexpr auto CMP_FILE_NAME_LENGTH = std::size_t{12};
+constexpr auto LEVEL_HEADER_NAME_LENGTH = std::size_t{13};
+constexpr auto NUM_ACTOR_IDS =
+  static_cast<int>(ActorID::Rigelatin_soldier_projectile) + 1;
+constexpr auto NUM_AUDIO_CHUNKS = 68;
+constexpr auto FIRST_ADLIB_SOUND_CHUNK = 34;
+constexpr auto ADLIB_SOUND_DATA_SIZE = 64;
+constexpr auto MAX_RLE_RUN_LENGTH = 127;
+
+// Roughly 11 kHz, like the game's digitized sound effects
+constexpr auto VOC_FREQUENCY_DIVISOR = std::uint8_t{0xA5};
+
+// A selection of regular enemies and items, avoiding meta actors which
+// expect other actors or specific tiles around them.
+constexpr ActorID LEVEL_ACTOR_IDS[] = {
+  ActorID::Hoverbot,
+  ActorID::Red_box_bomb,
+  ActorID::Red_box_cola,
+  ActorID::Blue_box_N,
+  ActorID::Green_box_empty,
+  ActorID::Watchbot,
+  ActorID::Rocket_launcher_turret,
+  ActorID::Green_slime_blob,
+  ActorID::Snake,
+  ActorID::Camera_on_ceiling,
+  ActorID::Wall_walker,
+  ActorID::Skeleton,
+  ActorID::Spider,
+  ActorID::Blue_guard_RIGHT,
+  ActorID::Laser_turret,
+};
+
+
+using RandomGenerator = std::minstd_rand;
+
+
+int randomInt(RandomGenerator& rng, const int min, const int max)
+{
+  return std::uniform_int_distribution<int>{min, max}(rng);
+}
+
+
+std::uint8_t randomByte(RandomGenerator& rng)
+{
+  return static_cast<std::uint8_t>(randomInt(rng, 0, 255));
+}
+
+
+void writeU8(ByteBuffer& buffer, const std::uint8_t value)
+{
+  buffer.push_back(value);
+}
+
+
+void writeU16(ByteBuffer& buffer, const std::uint16_t value)
+{
+  buffer.push_back(static_cast<std::uint8_t>(value & 0xFF));
+  buffer.push_back(static_cast<std::uint8_t>(value >> 8));
+}
+
+
+void writeU24(ByteBuffer& buffer, const std::uint32_t value)
+{
+  assert(value <= 0xFFFFFF);
+  writeU16(buffer, static_cast<std::uint16_t>(value & 0xFFFF));
+  writeU8(buffer, static_cast<std::uint8_t>(value >> 16));
+}
+
+
+void writeU32(ByteBuffer& buffer, const std::uint32_t value)
+{
+  writeU16(buffer, static_cast<std::uint16_t>(value & 0xFFFF));
+  writeU16(buffer, static_cast<std::uint16_t>(value >> 16));
+}
+
+
+void patchU32(ByteBuffer& buffer, const std::size_t offset, std::uint32_t value)
+{
+  for (auto i = 0u; i < 4u; ++i)
+  {
+    buffer[offset + i] = static_cast<std::uint8_t>(value & 0xFF);
+    value >>= 8;
+  }
+}
+
+
+void writeFixedSizeString(
+  ByteBuffer& buffer,
+  const std::string& text,
+  const std::size_t length)
+{
+  assert(text.size() <= length);
+  buffer.insert(buffer.end(), text.begin(), text.end());
+  buffer.insert(buffer.end(), length - text.size(), 0);
+}
+
+
+void writeRandomBytes(
+  ByteBuffer& buffer,
+  const std::size_t count,
+  RandomGenerator& rng)
+{
+  std::generate_n(
+    std::back_inserter(buffer), count, [&]() { return randomByte(rng); });
+}
+
+
+/** Writes a sequence of RLE copy words, without terminating marker */
+void writeRleCopyRuns(
+  ByteBuffer& buffer,
+  std::size_t numBytes,
+  RandomGenerator& rng)
+{
+  while (numBytes > 0)
+  {
+    const auto runLength =
+      std::min(numBytes, std::size_t{MAX_RLE_RUN_LENGTH});
+    writeU8(buffer, static_cast<std::uint8_t>(-static_cast<int>(runLength)));
+    writeRandomBytes(buffer, runLength, rng);
+    numBytes -= runLength;
+  }
+}
+
+
+std::uint16_t randomTileSpec(RandomGenerator& rng)
+{
+  const auto numSolidTiles = int(GameTraits::CZone::numSolidTiles);
+  const auto numMaskedTiles = int(GameTraits::CZone::numMaskedTiles);
+
+  const auto kind = randomInt(rng, 0, 99);
+  if (kind < 70)
+  {
+    return static_cast<std::uint16_t>(
+      randomInt(rng, 0, numSolidTiles - 1) * 8);
+  }
+  else if (kind < 85)
+  {
+    const auto maskedIndex = randomInt(rng, 0, numMaskedTiles - 1);
+    return static_cast<std::uint16_t>((numSolidTiles + maskedIndex * 5) * 8);
+  }
+
+  // Extended tile spec, combining a solid and a masked tile. The upper two
+  // bits of the masked index come from the extra info section.
+  const auto solidIndex = randomInt(rng, 0, numSolidTiles - 1);
+  const auto maskedIndexLowBits = randomInt(rng, 0, 31);
+  return static_cast<std::uint16_t>(
+    0x8000 | (maskedIndexLowBits << 10) | solidIndex);
+}
+
+
+ByteBuffer makeMovieMainImage(
+  const int width,
+  const int height,
+  RandomGenerator& rng)
+{
+  ByteBuffer pixelData;
+
+  for (int row = 0; row < height; ++row)
+  {
+    ByteBuffer rowData;
+    auto numRleWords = 0;
+
+    for (auto col = 0; col < width;)
+    {
+      const auto runLength = std::min(
+        randomInt(rng, 8, MAX_RLE_RUN_LENGTH), width - col);
+
+      if (randomInt(rng, 0, 1) == 0)
+      {
+        writeU8(rowData, static_cast<std::uint8_t>(runLength));
+        writeU8(rowData, randomByte(rng));
+      }
+      else
+      {
+        writeU8(rowData, static_cast<std::uint8_t>(-runLength));
+        writeRandomBytes(rowData, runLength, rng);
+      }
+
+      col += runLength;
+      ++numRleWords;
+    }
+
+    assert(numRleWords <= 255);
+    writeU8(pixelData, static_cast<std::uint8_t>(numRleWords));
+    pixelData.insert(pixelData.end(), rowData.begin(), rowData.end());
+  }
+
+  return pixelData;
+}
+
+
+ByteBuffer makeMovieFrameRows(
+  const int width,
+  const int numRows,
+  RandomGenerator& rng)
+{
+  constexpr auto MAX_RUNS_PER_ROW = 4;
+  constexpr auto MAX_SKIP = 15;
+
+  ByteBuffer rowData;
+
+  for (int row = 0; row < numRows; ++row)
+  {
+    ByteBuffer runs;
+    auto numRuns = 0;
+
+    for (auto col = 0;
+         numRuns < MAX_RUNS_PER_ROW && col + MAX_SKIP < width;
+         ++numRuns)
+    {
+      const auto pixelsToSkip = randomInt(rng, 0, MAX_SKIP);
+      col += pixelsToSkip;
+
+      const auto runLength = randomInt(
+        rng, 1, std::min(MAX_RLE_RUN_LENGTH, width - col));
+      col += runLength;
+
+      // Animation frames store the RLE marker inverted, i.e. a positive
+      // value means copying.
+      writeU8(runs, static_cast<std::uint8_t>(pixelsToSkip));
+      writeU8(runs, static_cast<std::uint8_t>(runLength));
+      writeRandomBytes(runs, runLength, rng);
+    }
+
+    writeU8(rowData, static_cast<std::uint8_t>(numRuns));
+    rowData.insert(rowData.end(), runs.begin(), runs.end());
+  }
+
+  return rowData;
+}
+
+
+void writeMovieChunkHeader(ByteBuffer& buffer, const std::uint16_t numSubChunks)
+{
+  writeU32(buffer, 0); // size, patched later
+  writeU16(buffer, 0xF1FA);
+  writeU16(buffer, numSubChunks);
+  buffer.insert(buffer.end(), 8, 0);
+}
+
+} // namespace
+
+
+Sizes Sizes::scaled(const double factor) const
+{
+  auto scale = [factor](const int value, const int minimum, const int maximum) {
+    const auto scaledValue = static_cast<int>(std::lround(value * factor));
+    return std::clamp(scaledValue, minimum, maximum);
+  };
+
+  auto result = *this;
+  result.mLevelWidth = scale(mLevelWidth, 32, 1024);
+  result.mNumLevelActors = scale(mNumLevelActors, 0, 10000);
+  result.mFramesPerActor = scale(mFramesPerActor, 1, 16);
+  result.mNumSoundSamples = scale(mNumSoundSamples, 1, 0xFFFFFF);
+  result.mNumSongCommands = scale(mNumSongCommands, 1, 1 << 24);
+  result.mNumMovieFrames = scale(mNumMovieFrames, 1, 0xFFFF);
+  return result;
+}
+
+
+ByteBuffer makeCmpPackage(const FileList& files)
+{
+  constexpr auto DICT_ENTRY_SIZE = CMP_FILE_NAME_LENGTH + 2 * sizeof(uint32_t);
+
+  // One extra, all-zero, entry terminates the dictionary
+  const auto dictSize = (files.size() + 1) * DICT_ENTRY_SIZE;
+
+  ByteBuffer package;
+  auto fileOffset = dictSize;
+  for (const auto& [name, data] : files)
+  {
+    writeFixedSizeString(package, name, CMP_FILE_NAME_LENGTH);
+    writeU32(package, static_cast<std::uint32_t>(fileOffset));
+    writeU32(package, static_cast<std::uint32_t>(data.size()));
+    fileOffset += data.size();
+  }
+  package.insert(package.end(), DICT_ENTRY_SIZE, 0);
+
+  for (const auto& entry : files)
+  {
+    package.insert(package.end(), entry.second.begin(), entry.second.end());
+  }
+
+  return package;
+}
+
+
+ByteBuffer makeTileSet(const std::uint32_t seed)
+{
+  using CZone = GameTraits::CZone;
+
+  auto rng = RandomGenerator{seed};
+  ByteBuffer data;
+
+  // All attributes are zero, i.e. none of the tiles have any special
+  // behavior. Masked tiles have four additional unused words.
+  data.insert(data.end(), CZone::attributeBytesTotal, 0);
+
+  writeRandomBytes(
+    data,
+    CZone::numSolidTiles * CZone::tileBytes +
+      CZone::numMaskedTiles * CZone::tileBytesMasked,
+    rng);
+  return data;
+}
+
+
+ByteBuffer makeFullscreenImage(const std::uint32_t seed)
+{
+  auto rng = RandomGenerator{seed};
+  ByteBuffer data;
+  writeRandomBytes(
+    data,
+    GameTraits::viewPortWidthTiles * GameTraits::viewPortHeightTiles *
+      GameTraits::bytesPerTile(data::TileImageType::Unmasked),
+    rng);
+  return data;
+}
+
+
+ByteBuffer makeLevel(
+  const Sizes& sizes,
+  const std::string& tileSetName,
+  const std::string& backdropName,
+  const std::string& musicName,
+  const std::uint32_t seed)
+{
+  constexpr auto HEADER_SIZE = 2 + 3 * LEVEL_HEADER_NAME_LENGTH + 2 + 2 + 2;
+
+  // Switch to the alternative backdrop on reactor destruction
+  constexpr auto FLAGS = std::uint8_t{0x40};
+  constexpr auto ALTERNATIVE_BACKDROP_NUMBER = std::uint8_t{2};
+
+  auto rng = RandomGenerator{seed};
+
+  const auto width = sizes.mLevelWidth;
+  const auto height = int(GameTraits::mapHeightForWidth(width));
+
+  ByteBuffer actorData;
+  auto addActor = [&](const ActorID id, const int x, const int y) {
+    writeU16(actorData, static_cast<std::uint16_t>(id));
+    writeU16(actorData, static_cast<std::uint16_t>(x));
+    writeU16(actorData, static_cast<std::uint16_t>(y));
+  };
+
+  addActor(ActorID::Duke_LEFT, 2, 2);
+  for (int i = 0; i < sizes.mNumLevelActors; ++i)
+  {
+    const auto typeIndex =
+      randomInt(rng, 0, int(std::size(LEVEL_ACTOR_IDS)) - 1);
+    addActor(
+      LEVEL_ACTOR_IDS[typeIndex],
+      randomInt(rng, 0, width - 1),
+      randomInt(rng, 0, height - 1));
+  }
+
+  ByteBuffer level;
+  writeU16(
+    level, static_cast<std::uint16_t>(HEADER_SIZE + actorData.size() + 2));
+  writeFixedSizeString(level, tileSetName, LEVEL_HEADER_NAME_LENGTH);
+  writeFixedSizeString(level, backdropName, LEVEL_HEADER_NAME_LENGTH);
+  writeFixedSizeString(level, musicName, LEVEL_HEADER_NAME_LENGTH);
+  writeU8(level, FLAGS);
+  writeU8(level, ALTERNATIVE_BACKDROP_NUMBER);
+  writeU16(level, 0);
+  writeU16(level, static_cast<std::uint16_t>(actorData.size() / 2));
+  level.insert(level.end(), actorData.begin(), actorData.end());
+
+  writeU16(level, static_cast<std::uint16_t>(width));
+  for (auto i = 0u; i < GameTraits::mapDataWords; ++i)
+  {
+    writeU16(level, randomTileSpec(rng));
+  }
+
+  // Extra info: 2 bits per tile, RLE compressed
+  ByteBuffer extraInfo;
+  writeRleCopyRuns(extraInfo, (GameTraits::mapDataWords + 3) / 4, rng);
+  writeU8(extraInfo, 0);
+
+  writeU16(level, static_cast<std::uint16_t>(extraInfo.size()));
+  level.insert(level.end(), extraInfo.begin(), extraInfo.end());
+  return level;
+}
+
+
+FileList makeActorPackage(const Sizes& sizes, const std::uint32_t seed)
+{
+  constexpr auto WORDS_PER_ENTRY_HEADER = 2;
+  constexpr auto WORDS_PER_FRAME_HEADER = 8;
+
+  auto rng = RandomGenerator{seed};
+
+  const auto frameDataSize = std::size_t(sizes.mActorFrameWidth) *
+    sizes.mActorFrameHeight *
+    GameTraits::bytesPerTile(data::TileImageType::Masked);
+  const auto wordsPerEntry =
+    WORDS_PER_ENTRY_HEADER + sizes.mFramesPerActor * WORDS_PER_FRAME_HEADER;
+  assert(NUM_ACTOR_IDS + NUM_ACTOR_IDS * wordsPerEntry <= 0xFFFF);
+
+  ByteBuffer actorInfo;
+  for (int id = 0; id < NUM_ACTOR_IDS; ++id)
+  {
+    writeU16(
+      actorInfo,
+      static_cast<std::uint16_t>(NUM_ACTOR_IDS + id * wordsPerEntry));
+  }
+
+  ByteBuffer imageData;
+  for (int id = 0; id < NUM_ACTOR_IDS; ++id)
+  {
+    writeU16(actorInfo, static_cast<std::uint16_t>(sizes.mFramesPerActor));
+    writeU16(actorInfo, static_cast<std::uint16_t>(randomInt(rng, 0, 3)));
+
+    for (int frame = 0; frame < sizes.mFramesPerActor; ++frame)
+    {
+      writeU16(actorInfo, 0); // draw offset x
+      writeU16(actorInfo, 0); // draw offset y
+      writeU16(actorInfo, static_cast<std::uint16_t>(sizes.mActorFrameHeight));
+      writeU16(actorInfo, static_cast<std::uint16_t>(sizes.mActorFrameWidth));
+      writeU32(actorInfo, static_cast<std::uint32_t>(imageData.size()));
+      writeU32(actorInfo, 0); // padding
+
+      writeRandomBytes(imageData, frameDataSize, rng);
+    }
+  }
+
+  return {
+    {"ACTORS.MNI", std::move(imageData)},
+    {"ACTRINFO.MNI", std::move(actorInfo)}};
+}
+
+
+FileList makeAudioPackage(const std::uint32_t seed)
+{
+  constexpr auto PC_SPEAKER_SOUND_SIZE = 32;
+  constexpr auto NUM_INSTRUMENT_BYTES = 16;
+
+  auto rng = RandomGenerator{seed};
+
+  ByteBuffer dict;
+  ByteBuffer data;
+  for (int chunk = 0; chunk < NUM_AUDIO_CHUNKS; ++chunk)
+  {
+    writeU32(dict, static_cast<std::uint32_t>(data.size()));
+
+    if (chunk < FIRST_ADLIB_SOUND_CHUNK)
+    {
+      writeRandomBytes(data, PC_SPEAKER_SOUND_SIZE, rng);
+    }
+    else
+    {
+      writeU32(data, ADLIB_SOUND_DATA_SIZE);
+      writeU16(data, 0); // priority
+      writeRandomBytes(data, NUM_INSTRUMENT_BYTES, rng);
+      writeU8(data, static_cast<std::uint8_t>(randomInt(rng, 0, 7)));
+      writeRandomBytes(data, ADLIB_SOUND_DATA_SIZE, rng);
+    }
+  }
+
+  // The final offset marks the end of the last chunk
+  writeU32(dict, static_cast<std::uint32_t>(data.size()));
+
+  return {{"AUDIOHED.MNI", std::move(dict)}, {"AUDIOT.MNI", std::move(data)}};
+}
+
+
+ByteBuffer
+  makeVoc(const int numSamples, const VocCodec codec, const std::uint32_t seed)
+{
+  constexpr auto VERSION = std::uint16_t{0x010A};
+  constexpr auto HEADER_SIZE = std::uint16_t{0x1A};
+  constexpr auto SOUND_DATA_CHUNK_TYPE = std::uint8_t{1};
+  constexpr auto TERMINATOR_CHUNK_TYPE = std::uint8_t{0};
+
+  assert(numSamples > 0);
+
+  auto rng = RandomGenerator{seed};
+
+  // 4-bit ADPCM starts with one full 8-bit reference sample, followed by
+  // two samples per byte.
+  const auto encodedSize =
+    codec == VocCodec::Adpcm4Bits ? 1 + numSamples / 2 : numSamples;
+
+  ByteBuffer voc;
+  writeFixedSizeString(voc, "Creative Voice File", 19);
+  writeU8(voc, 0x1A);
+  writeU16(voc, HEADER_SIZE);
+  writeU16(voc, VERSION);
+  writeU16(voc, static_cast<std::uint16_t>(~VERSION + 0x1234));
+
+  writeU8(voc, SOUND_DATA_CHUNK_TYPE);
+  writeU24(voc, static_cast<std::uint32_t>(encodedSize + 2));
+  writeU8(voc, VOC_FREQUENCY_DIVISOR);
+  writeU8(voc, static_cast<std::uint8_t>(codec));
+  writeRandomBytes(voc, encodedSize, rng);
+
+  writeU8(voc, TERMINATOR_CHUNK_TYPE);
+  return voc;
+}
+
+
+ByteBuffer makeSong(const int numCommands, const std::uint32_t seed)
+{
+  auto rng = RandomGenerator{seed};
+
+  ByteBuffer song;
+  for (int i = 0; i < numCommands; ++i)
+  {
+    writeU8(song, randomByte(rng)); // register
+    writeU8(song, randomByte(rng)); // value
+
+    // Most commands in real songs are grouped, with no delay in between
+    const auto delay = randomInt(rng, 0, 3) == 0 ? randomInt(rng, 1, 20) : 0;
+    writeU16(song, static_cast<std::uint16_t>(delay));
+  }
+
+  return song;
+}
+
+
+ByteBuffer makeMovie(
+  const int width,
+  const int height,
+  const int numFrames,
+  const std::uint32_t seed)
+{
+  constexpr auto FILE_TYPE = std::uint16_t{0xAF11};
+  constexpr auto PALETTE_SUB_CHUNK_TYPE = std::uint16_t{0xB};
+  constexpr auto PALETTE_SUB_CHUNK_SIZE = std::uint32_t{778};
+  constexpr auto MAIN_IMAGE_SUB_CHUNK_TYPE = std::uint16_t{0xF};
+  constexpr auto FRAME_SUB_CHUNK_TYPE = std::uint16_t{0xC};
+  constexpr auto SUB_CHUNK_HEADER_SIZE = 4 + 2;
+
+  assert(width > 0 && width <= 0xFFFF && height > 0 && height <= 0xFFFF);
+
+  auto rng = RandomGenerator{seed};
+
+  ByteBuffer movie;
+  writeU32(movie, 0); // file size, patched at the end
+  writeU16(movie, FILE_TYPE);
+  writeU16(movie, static_cast<std::uint16_t>(numFrames));
+  writeU16(movie, static_cast<std::uint16_t>(width));
+  writeU16(movie, static_cast<std::uint16_t>(height));
+  movie.insert(movie.end(), 8 + 108, 0); // unknown fields and padding
+
+  const auto mainChunkStart = movie.size();
+  writeMovieChunkHeader(movie, 2);
+
+  writeU32(movie, PALETTE_SUB_CHUNK_SIZE);
+  writeU16(movie, PALETTE_SUB_CHUNK_TYPE);
+  writeU32(movie, 1);
+  std::generate_n(std::back_inserter(movie), 768, [&]() {
+    return static_cast<std::uint8_t>(randomInt(rng, 0, 63));
+  });
+
+  const auto mainImage = makeMovieMainImage(width, height, rng);
+  writeU32(
+    movie,
+    static_cast<std::uint32_t>(SUB_CHUNK_HEADER_SIZE + mainImage.size()));
+  writeU16(movie, MAIN_IMAGE_SUB_CHUNK_TYPE);
+  movie.insert(movie.end(), mainImage.begin(), mainImage.end());
+  patchU32(
+    movie,
+    mainChunkStart,
+    static_cast<std::uint32_t>(movie.size() - mainChunkStart));
+
+  for (int frame = 0; frame < numFrames; ++frame)
+  {
+    const auto numRows = std::max(1, height / 4);
+    const auto yOffset = randomInt(rng, 0, height - numRows);
+    const auto rows = makeMovieFrameRows(width, numRows, rng);
+
+    const auto chunkStart = movie.size();
+    writeMovieChunkHeader(movie, 1);
+    writeU32(
+      movie,
+      static_cast<std::uint32_t>(SUB_CHUNK_HEADER_SIZE + 4 + rows.size()));
+    writeU16(movie, FRAME_SUB_CHUNK_TYPE);
+    writeU16(movie, static_cast<std::uint16_t>(yOffset));
+    writeU16(movie, static_cast<std::uint16_t>(numRows));
+    movie.insert(movie.end(), rows.begin(), rows.end());
+    patchU32(
+      movie, chunkStart, static_cast<std::uint32_t>(movie.size() - chunkStart));
+  }
+
+  patchU32(movie, 0, static_cast<std::uint32_t>(movie.size()));
+  return movie;
+}
+
+
+void writeGameDirectory(
+  const std::filesystem::path& directory,
+  const Sizes& sizes)
+{
+  auto files = makeActorPackage(sizes, 1);
+
+  auto audioFiles = makeAudioPackage(2);
+  std::move(audioFiles.begin(), audioFiles.end(), std::back_inserter(files));
+
+  files.emplace_back(
+    LEVEL_FILE, makeLevel(sizes, TILESET_FILE, BACKDROP_FILE, SONG_FILE, 3));
+  files.emplace_back(TILESET_FILE, makeTileSet(4));
+  files.emplace_back(BACKDROP_FILE, makeFullscreenImage(5));
+  files.emplace_back(ALTERNATIVE_BACKDROP_FILE, makeFullscreenImage(6));
+  files.emplace_back(SONG_FILE, makeSong(sizes.mNumSongCommands, 7));
+  files.emplace_back(
+    SOUND_FILE, makeVoc(sizes.mNumSoundSamples, VocCodec::Adpcm4Bits, 8));
+
+  std::filesystem::create_directories(directory);
+  loader::saveToFile(makeCmpPackage(files), directory / "NUKEM2.CMP");
+  loader::saveToFile(
+    makeMovie(
+      sizes.mMovieWidth, sizes.mMovieHeight, sizes.mNumMovieFrames, 9),
+    directory / MOVIE_FILE);
+}
+
+
+data::GameSessionId levelSessionId()
+{
+  return data::GameSessionId{0, 0, data::Difficulty::Medium};
+}
+
+
+game_logic::RecordingSegment
+  makeTestSegment(const int numFrames, const int phase)
+{
+  auto segment = game_logic::RecordingSegment{};
+  segment.mSessionId = levelSessionId();
+
+  for (int i = phase; i < numFrames + phase; ++i)
+  {
+    auto frame = game_logic::RecordedFrame{};
+    frame.mInput.mRight = (i / 60) % 2 == 0;
+    frame.mInput.mLeft = !frame.mInput.mRight;
+    frame.mInput.mJump.mIsPressed = i % 20 < 8;
+    frame.mInput.mJump.mWasTriggered = i % 20 == 0;
+    frame.mInput.mFire.mIsPressed = i % 6 < 3;
+    frame.mInput.mFire.mWasTriggered = i % 6 == 0;
+    segment.mFrames.push_back(frame);
+  }
+
+  return segment;
+}
+
+
+const std::filesystem::path& benchmarkGameDirectory()
+{
+  static const auto path = []() {
+    const auto directory =
+      std::filesystem::temp_directory_path() / "rigel_synthetic_game_data";
+    writeGameDirectory(directory);
+    return directory;
+  }();
+
+  return path;
+}
+
+} // namespace rigel::synthetic_data
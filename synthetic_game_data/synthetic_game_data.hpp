@@ -0,0 +1,137 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "data/game_session_data.hpp"
+#include "game_logic/input_recording.hpp"
+#include "loader/byte_buffer.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+/* Generator for synthetic Duke Nukem II game data
+ *
+ * Tests and benchmarks can't rely on the original game files being present,
+ * since we can't distribute them. The functions here produce files in the
+ * same formats, filled with pseudo-random (but deterministic) content, which
+ * the loaders accept as valid. The content is meaningless, but the sizes and
+ * structure are configurable, so that loading cost is representative.
+ */
+
+namespace rigel::synthetic_data
+{
+
+struct Sizes
+{
+  int mLevelWidth = 128;
+  int mNumLevelActors = 400;
+  int mFramesPerActor = 4;
+  int mActorFrameWidth = 4;
+  int mActorFrameHeight = 4;
+  int mNumSoundSamples = 22050;
+  int mNumSongCommands = 16000;
+  int mMovieWidth = 320;
+  int mMovieHeight = 200;
+  int mNumMovieFrames = 16;
+
+  /** Multiply all size parameters by the given factor
+   *
+   * Level width is clamped to what the level format allows.
+   */
+  Sizes scaled(double factor) const;
+};
+
+
+enum class VocCodec : std::uint8_t
+{
+  Unsigned8BitPcm = 0,
+  Adpcm4Bits = 1
+};
+
+
+using FileList = std::vector<std::pair<std::string, loader::ByteBuffer>>;
+
+// Names of the files written by writeGameDirectory()
+constexpr auto LEVEL_FILE = "L1.MNI";
+constexpr auto TILESET_FILE = "CZONE1.MNI";
+constexpr auto BACKDROP_FILE = "DROP1.MNI";
+constexpr auto ALTERNATIVE_BACKDROP_FILE = "DROP2.MNI";
+constexpr auto SONG_FILE = "SONG1.IMF";
+constexpr auto SOUND_FILE = "SB_1.MNI";
+constexpr auto MOVIE_FILE = "NUKEM2.F1";
+
+
+loader::ByteBuffer makeCmpPackage(const FileList& files);
+loader::ByteBuffer makeTileSet(std::uint32_t seed);
+loader::ByteBuffer makeFullscreenImage(std::uint32_t seed);
+loader::ByteBuffer makeLevel(
+  const Sizes& sizes,
+  const std::string& tileSetName,
+  const std::string& backdropName,
+  const std::string& musicName,
+  std::uint32_t seed);
+
+/** Returns ACTORS.MNI and ACTRINFO.MNI, in that order
+ *
+ * Contains frames for every actor ID, so that any actor can be loaded.
+ */
+FileList makeActorPackage(const Sizes& sizes, std::uint32_t seed);
+
+/** Returns AUDIOHED.MNI and AUDIOT.MNI, in that order */
+FileList makeAudioPackage(std::uint32_t seed);
+
+loader::ByteBuffer
+  makeVoc(int numSamples, VocCodec codec, std::uint32_t seed);
+loader::ByteBuffer makeSong(int numCommands, std::uint32_t seed);
+loader::ByteBuffer
+  makeMovie(int width, int height, int numFrames, std::uint32_t seed);
+
+
+/** Write a complete game directory
+ *
+ * Writes a NUKEM2.CMP containing everything a ResourceLoader needs, plus one
+ * level with its tileset, backdrops, music and a sound effect, as well as a
+ * movie file next to it. Existing files in the directory are overwritten.
+ */
+void writeGameDirectory(
+  const std::filesystem::path& directory,
+  const Sizes& sizes = {});
+
+
+/** Session for playing the level written by writeGameDirectory() */
+data::GameSessionId levelSessionId();
+
+
+/** Walk back and forth while jumping and shooting
+ *
+ * Makes the player interact with the level instead of idling at the spawn
+ * position. Different phases give different, but still deterministic inputs.
+ */
+game_logic::RecordingSegment makeTestSegment(int numFrames, int phase = 0);
+
+
+/** Game directory with default sizes, for use by benchmarks
+ *
+ * Written to the system's temp directory on first use.
+ */
+const std::filesystem::path& benchmarkGameDirectory();
+
+} // namespace rigel::synthetic_data
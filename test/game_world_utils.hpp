@@ -0,0 +1,174 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <synthetic_game_data.hpp>
+
+#include <common/command_line_options.hpp>
+#include <common/game_mode.hpp>
+#include <common/game_service_provider.hpp>
+#include <common/memory_accounting.hpp>
+#include <common/user_profile.hpp>
+#include <data/game_session_data.hpp>
+#include <data/game_traits.hpp>
+#include <data/image.hpp>
+#include <data/sound_ids.hpp>
+#include <engine/sprite_factory.hpp>
+#include <engine/tiled_texture.hpp>
+#include <game_logic/input_recording.hpp>
+#include <loader/resource_loader.hpp>
+#include <renderer/renderer.hpp>
+#include <ui/menu_element_renderer.hpp>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+
+/* Utilities for tests which run a complete GameWorld
+ *
+ * The original game files can't be used in tests, so these tests run on
+ * synthetic game data instead (see synthetic_game_data.hpp). The
+ * level's contents are random, but deterministic.
+ */
+
+namespace rigel
+{
+
+/** Game directory with synthetic data, written on first use */
+inline const std::filesystem::path& testGameDirectory()
+{
+  static const auto path = []() {
+    const auto directory =
+      std::filesystem::temp_directory_path() / "rigel_test_game_data";
+
+    auto sizes = synthetic_data::Sizes{};
+    sizes.mNumLevelActors = 100;
+    synthetic_data::writeGameDirectory(directory, sizes);
+    return directory;
+  }();
+
+  return path;
+}
+
+
+/** Session for the level contained in testGameDirectory() */
+inline data::GameSessionId testSessionId()
+{
+  return synthetic_data::levelSessionId();
+}
+
+
+struct SoundCall
+{
+  data::SoundId mId;
+  bool mIsStop;
+
+  bool operator==(const SoundCall& other) const
+  {
+    return mId == other.mId && mIsStop == other.mIsStop;
+  }
+};
+
+
+/** Service provider which records all sound effect requests */
+struct RecordingServiceProvider : public IGameServiceProvider
+{
+  void fadeOutScreen() override { }
+  void fadeInScreen() override { }
+  void playSound(const data::SoundId id) override
+  {
+    mSoundCalls.push_back(SoundCall{id, false});
+  }
+  void stopSound(const data::SoundId id) override
+  {
+    mSoundCalls.push_back(SoundCall{id, true});
+  }
+  void stopAllSounds() override { }
+  void playMusic(const std::string&) override { }
+  void stopMusic() override { }
+  void scheduleGameQuit() override { }
+  void switchGamePath(const std::filesystem::path&) override { }
+  void markCurrentFrameAsWidescreen() override { }
+  bool isSharewareVersion() const override { return false; }
+
+  const CommandLineOptions& commandLineOptions() const override
+  {
+    return mCommandLineOptions;
+  }
+
+  CommandLineOptions mCommandLineOptions;
+  std::vector<SoundCall> mSoundCalls;
+};
+
+
+/** Everything a GameWorld needs, without audio or video output
+ *
+ * Rendering goes to a headless renderer. Like in SimulationHost, the UI
+ * sprite sheet is blank, since it's never drawn.
+ */
+struct TestGameContext
+{
+  explicit TestGameContext(const CommandLineOptions& commandLineOptions = {})
+    : mResources((testGameDirectory() / "").u8string())
+    , mRenderer(base::Size<int>{
+        data::GameTraits::viewPortWidthPx,
+        data::GameTraits::viewPortHeightPx})
+    , mSpriteFactory(&mRenderer, &mResources.mActorImagePackage)
+    , mUiSpriteSheet(
+        renderer::Texture{
+          &mRenderer,
+          data::Image{
+            data::GameTraits::viewPortWidthPx,
+            data::GameTraits::viewPortHeightPx}},
+        &mRenderer)
+    , mTextRenderer(&mUiSpriteSheet, &mRenderer, mResources)
+  {
+    mServiceProvider.mCommandLineOptions = commandLineOptions;
+  }
+
+  GameMode::Context context(
+    game_logic::InputRecorder* pInputRecorder = nullptr)
+  {
+    return GameMode::Context{
+      &mResources,
+      &mRenderer,
+      &mServiceProvider,
+      nullptr,
+      nullptr,
+      &mTextRenderer,
+      &mUiSpriteSheet,
+      &mSpriteFactory,
+      &mUserProfile,
+      pInputRecorder,
+      &mMemoryRegistry};
+  }
+
+  loader::ResourceLoader mResources;
+  renderer::Renderer mRenderer;
+  engine::SpriteFactory mSpriteFactory;
+  engine::TiledTexture mUiSpriteSheet;
+  ui::MenuElementRenderer mTextRenderer;
+  RecordingServiceProvider mServiceProvider;
+  UserProfile mUserProfile;
+  MemoryRegistry mMemoryRegistry;
+};
+
+
+using synthetic_data::makeTestSegment;
+
+} // namespace rigel
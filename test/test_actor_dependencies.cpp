@@ -0,0 +1,84 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <game_logic/actor_dependencies.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <algorithm>
+
+
+using namespace rigel;
+using namespace game_logic;
+
+using data::ActorID;
+using Actors = std::vector<data::map::LevelData::Actor>;
+
+
+namespace
+{
+
+bool contains(const std::vector<ActorID>& ids, const ActorID id)
+{
+  return std::binary_search(ids.begin(), ids.end(), id);
+}
+
+} // namespace
+
+
+TEST_CASE("Actors needed for level")
+{
+  SECTION("Player and common effects are always needed")
+  {
+    const auto ids = actorsNeededForLevel({});
+
+    CHECK(contains(ids, ActorID::Duke_LEFT));
+    CHECK(contains(ids, ActorID::Duke_rocket_up));
+    CHECK(contains(ids, ActorID::Explosion_FX_1));
+    CHECK(!contains(ids, ActorID::Hoverbot));
+  }
+
+  SECTION("Level actors and what they spawn are included transitively")
+  {
+    const auto actors = Actors{
+      {{0, 0}, ActorID::Sentry_robot_generator, std::nullopt},
+      {{5, 0}, ActorID::Spider, std::nullopt},
+    };
+    const auto ids = actorsNeededForLevel(actors);
+
+    CHECK(contains(ids, ActorID::Sentry_robot_generator));
+    CHECK(contains(ids, ActorID::Hoverbot));
+    CHECK(contains(ids, ActorID::Hoverbot_debris_2));
+    CHECK(contains(ids, ActorID::Spider));
+    CHECK(contains(ids, ActorID::Spider_shaken_off));
+  }
+
+  SECTION("Result is sorted and free of duplicates")
+  {
+    const auto actors = Actors{
+      {{0, 0}, ActorID::Hoverbot, std::nullopt},
+      {{1, 0}, ActorID::Hoverbot, std::nullopt},
+      {{2, 0}, ActorID::Duke_LEFT, std::nullopt},
+    };
+    auto ids = actorsNeededForLevel(actors);
+
+    CHECK(std::is_sorted(ids.begin(), ids.end()));
+    CHECK(std::adjacent_find(ids.begin(), ids.end()) == ids.end());
+  }
+}
@@ -0,0 +1,101 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <base/warnings.hpp>
+#include <game_logic/actor_tag_index.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <vector>
+
+
+using namespace rigel;
+using namespace game_logic;
+
+using components::ActorTag;
+
+using Entities = std::vector<entityx::Entity>;
+
+
+namespace
+{
+
+Entities entitiesOfType(
+  const ActorTagIndex& index,
+  const ActorTag::Type type)
+{
+  const auto view = index.entitiesOfType(type);
+  return Entities(view.begin(), view.end());
+}
+
+} // namespace
+
+
+TEST_CASE("Actor tag index")
+{
+  using T = ActorTag::Type;
+
+  entityx::EventManager events;
+  entityx::EntityManager entities{events};
+  ActorTagIndex index{events};
+
+  auto door1 = entities.create();
+  auto water = entities.create();
+  auto door2 = entities.create();
+  auto untagged = entities.create();
+
+  door2.assign<ActorTag>(T::Door);
+  water.assign<ActorTag>(T::WaterArea);
+  door1.assign<ActorTag>(T::Door);
+
+  SECTION("Entities are grouped by type, in entity order")
+  {
+    const auto expectedDoors = Entities{door1, door2};
+    CHECK(entitiesOfType(index, T::Door) == expectedDoors);
+    CHECK(entitiesOfType(index, T::WaterArea) == Entities{water});
+    CHECK(index.count(T::Door) == 2);
+    CHECK(index.count(T::Reactor) == 0);
+    CHECK(index.entitiesOfType(T::Reactor).empty());
+  }
+
+  SECTION("Removing the tag removes the entity from the index")
+  {
+    door1.remove<ActorTag>();
+
+    CHECK(entitiesOfType(index, T::Door) == Entities{door2});
+  }
+
+  SECTION("Destroying an entity removes it from the index")
+  {
+    water.destroy();
+
+    CHECK(index.count(T::WaterArea) == 0);
+  }
+
+  SECTION("Re-tagging an entity moves it to the new type")
+  {
+    untagged.assign<ActorTag>(T::Reactor);
+    door2.remove<ActorTag>();
+    door2.assign<ActorTag>(T::ActiveElevator);
+
+    CHECK(entitiesOfType(index, T::Door) == Entities{door1});
+    CHECK(entitiesOfType(index, T::Reactor) == Entities{untagged});
+    CHECK(entitiesOfType(index, T::ActiveElevator) == Entities{door2});
+  }
+}
@@ -0,0 +1,105 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <renderer/blend_mode.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstdlib>
+
+
+using namespace rigel;
+using namespace renderer;
+
+
+namespace
+{
+
+const auto TRANSPARENT = base::Color{0, 0, 0, 0};
+
+
+// Render targets have 8 bits per channel, so results of different ways of
+// compositing can differ by rounding.
+bool isClose(const base::Color& lhs, const base::Color& rhs)
+{
+  auto isClose = [](const int a, const int b) { return std::abs(a - b) <= 1; };
+
+  return isClose(lhs.r, rhs.r) && isClose(lhs.g, rhs.g) &&
+    isClose(lhs.b, rhs.b) && isClose(lhs.a, rhs.a);
+}
+
+} // namespace
+
+
+TEST_CASE("Blending a cached layer matches drawing directly")
+{
+  // An auto-scrolling backdrop pixel, and two partially transparent pixels
+  // on top, e.g. an anti-aliased edge of a high-res tile and a sprite.
+  const auto backdrop = base::Color{40, 160, 220, 255};
+  const auto tile = base::Color{250, 200, 10, 128};
+  const auto sprite = base::Color{90, 20, 200, 64};
+
+  const auto direct = blend(
+    BlendMode::Normal, sprite, blend(BlendMode::Normal, tile, backdrop));
+
+  // GameWorld's frame cache for RenderPass::AllButBackdrop
+  const auto cached = blend(
+    BlendMode::Normal, sprite, blend(BlendMode::Normal, tile, TRANSPARENT));
+  CHECK(cached.a > 128);
+  CHECK(cached.a < 255);
+
+  SECTION("Blitting with premultiplied alpha gives the same result")
+  {
+    const auto composed =
+      blend(BlendMode::PremultipliedAlpha, cached, backdrop);
+    CHECK(isClose(composed, direct));
+  }
+
+  SECTION("Blitting with straight alpha applies alpha twice")
+  {
+    const auto wrong = blend(BlendMode::Normal, cached, backdrop);
+    CHECK(!isClose(wrong, direct));
+    CHECK(wrong.r + wrong.g + wrong.b < direct.r + direct.g + direct.b);
+  }
+
+  SECTION("Opaque layers look the same with either mode")
+  {
+    const auto opaqueCache = blend(
+      BlendMode::Normal, sprite, blend(BlendMode::Normal, tile, backdrop));
+
+    CHECK(
+      blend(BlendMode::PremultipliedAlpha, opaqueCache, TRANSPARENT) ==
+      blend(BlendMode::Normal, opaqueCache, TRANSPARENT));
+    CHECK(opaqueCache.a == 255);
+  }
+}
+
+
+TEST_CASE("Blending accumulates alpha with the over operator")
+{
+  const auto opaque = base::Color{10, 20, 30, 255};
+  const auto translucent = base::Color{200, 100, 50, 100};
+
+  CHECK(blend(BlendMode::Normal, translucent, opaque).a == 255);
+  CHECK(blend(BlendMode::Normal, translucent, TRANSPARENT).a == 100);
+  CHECK(
+    blend(BlendMode::Normal, translucent, TRANSPARENT) ==
+    (base::Color{78, 39, 20, 100}));
+  CHECK(blend(BlendMode::Normal, TRANSPARENT, opaque) == opaque);
+}
@@ -0,0 +1,203 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <base/math_tools.hpp>
+#include <base/warnings.hpp>
+#include <data/map.hpp>
+#include <engine/collision_checker.hpp>
+#include <engine/movement.hpp>
+#include <engine/physical_components.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <random>
+
+
+using namespace rigel;
+using namespace engine;
+using namespace engine::components;
+
+namespace ex = entityx;
+
+
+namespace
+{
+
+// Reference implementation: Move one unit at a time, testing for collision
+// before each step.
+template <typename TestFunc>
+int freeDistanceByStepping(
+  BoundingBox bbox,
+  const base::Vector step,
+  const int maxDistance,
+  TestFunc isBlocked)
+{
+  for (int i = 0; i < maxDistance; ++i)
+  {
+    if (isBlocked(bbox))
+    {
+      return i;
+    }
+
+    bbox.topLeft += step;
+  }
+
+  return maxDistance;
+}
+
+} // namespace
+
+
+TEST_CASE("Collision sweeps match unit-step collision tests")
+{
+  ex::EntityX entityx;
+
+  // Tile index N has collision bits N, so we get all combinations of solid
+  // edges.
+  data::map::TileAttributeDict::AttributeArray attributes;
+  for (std::uint16_t i = 0; i < 16; ++i)
+  {
+    attributes.push_back(i);
+  }
+
+  data::map::Map map{40, 30, data::map::TileAttributeDict{attributes}};
+  CollisionChecker collisionChecker{&map, entityx.entities, entityx.events};
+
+  auto rng = std::minstd_rand{42};
+  auto randomInt = [&rng](const int min, const int max) {
+    return std::uniform_int_distribution<int>{min, max}(rng);
+  };
+
+  for (int y = 0; y < map.height(); ++y)
+  {
+    for (int x = 0; x < map.width(); ++x)
+    {
+      if (randomInt(0, 9) == 0)
+      {
+        map.setTileAt(0, x, y, randomInt(1, 15));
+      }
+    }
+  }
+
+  for (int i = 0; i < 12; ++i)
+  {
+    auto body = entityx.entities.create();
+    body.assign<BoundingBox>(
+      BoundingBox{{0, 0}, {randomInt(0, 4), randomInt(0, 4)}});
+    body.assign<WorldPosition>(randomInt(-2, 41), randomInt(-2, 31));
+    body.assign<SolidBody>();
+  }
+
+  auto mismatches = 0;
+  for (int i = 0; i < 2000; ++i)
+  {
+    const auto bbox = BoundingBox{
+      {randomInt(-3, 42), randomInt(-3, 32)},
+      {randomInt(0, 5), randomInt(0, 5)}};
+    const auto maxDistance = randomInt(0, 20);
+
+    const auto left = collisionChecker.freeDistanceToLeftWall(bbox, maxDistance);
+    const auto right =
+      collisionChecker.freeDistanceToRightWall(bbox, maxDistance);
+    const auto up = collisionChecker.freeDistanceToCeiling(bbox, maxDistance);
+    const auto down = collisionChecker.freeDistanceToGround(bbox, maxDistance);
+
+    const auto expectedLeft =
+      freeDistanceByStepping(bbox, {-1, 0}, maxDistance, [&](const auto& b) {
+        return collisionChecker.isTouchingLeftWall(b);
+      });
+    const auto expectedRight =
+      freeDistanceByStepping(bbox, {1, 0}, maxDistance, [&](const auto& b) {
+        return collisionChecker.isTouchingRightWall(b);
+      });
+    const auto expectedUp =
+      freeDistanceByStepping(bbox, {0, -1}, maxDistance, [&](const auto& b) {
+        return collisionChecker.isTouchingCeiling(b);
+      });
+    const auto expectedDown =
+      freeDistanceByStepping(bbox, {0, 1}, maxDistance, [&](const auto& b) {
+        return collisionChecker.isOnSolidGround(b);
+      });
+
+    if (
+      left != expectedLeft || right != expectedRight || up != expectedUp ||
+      down != expectedDown)
+    {
+      ++mismatches;
+    }
+  }
+
+  CHECK(mismatches == 0);
+
+
+  SECTION("Movement helpers stop at the same positions")
+  {
+    auto entity = entityx.entities.create();
+    entity.assign<BoundingBox>(BoundingBox{{0, 0}, {2, 3}});
+    entity.assign<WorldPosition>(20, 15);
+
+    auto& position = *entity.component<WorldPosition>();
+    const auto& bbox = *entity.component<BoundingBox>();
+
+    auto movementMismatches = 0;
+    for (int i = 0; i < 500; ++i)
+    {
+      const auto startPosition =
+        WorldPosition{randomInt(0, 39), randomInt(0, 29)};
+      const auto amount = randomInt(-12, 12);
+      const auto step = base::sgn(amount);
+
+      const auto expectedX = startPosition.x +
+        step *
+          freeDistanceByStepping(
+            toWorldSpace(bbox, startPosition),
+            {step, 0},
+            std::abs(amount),
+            [&](const auto& b) {
+              return amount < 0 ? collisionChecker.isTouchingLeftWall(b)
+                                : collisionChecker.isTouchingRightWall(b);
+            });
+      const auto expectedY = startPosition.y +
+        step *
+          freeDistanceByStepping(
+            toWorldSpace(bbox, startPosition),
+            {0, step},
+            std::abs(amount),
+            [&](const auto& b) {
+              return amount < 0 ? collisionChecker.isTouchingCeiling(b)
+                                : collisionChecker.isOnSolidGround(b);
+            });
+
+      position = startPosition;
+      moveHorizontally(collisionChecker, entity, amount);
+      const auto actualX = position.x;
+
+      position = startPosition;
+      moveVertically(collisionChecker, entity, amount);
+      const auto actualY = position.y;
+
+      if (actualX != expectedX || actualY != expectedY)
+      {
+        ++movementMismatches;
+      }
+    }
+
+    CHECK(movementMismatches == 0);
+  }
+}
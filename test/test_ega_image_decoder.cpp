@@ -0,0 +1,137 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <base/warnings.hpp>
+#include <loader/ega_image_decoder.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <algorithm>
+#include <array>
+#include <random>
+
+
+using namespace rigel;
+using namespace loader;
+
+
+namespace
+{
+
+ByteBuffer makeRandomTileData(
+  const std::size_t numTiles,
+  const data::TileImageType type)
+{
+  std::mt19937 generator(1234);
+  std::uniform_int_distribution<int> distribution(0, 255);
+
+  ByteBuffer result(numTiles * data::GameTraits::bytesPerTile(type));
+  for (auto& byte : result)
+  {
+    byte = static_cast<std::uint8_t>(distribution(generator));
+  }
+
+  return result;
+}
+
+
+int countMismatches(const data::Image& lhs, const data::Image& rhs)
+{
+  auto mismatches = 0;
+  for (auto i = 0u; i < lhs.pixelData().size(); ++i)
+  {
+    const auto& lhsPixel = lhs.pixelData()[i];
+    const auto& rhsPixel = rhs.pixelData()[i];
+
+    // Transparent pixels are considered equal regardless of their color
+    const auto bothTransparent = lhsPixel.a == 0 && rhsPixel.a == 0;
+    if (!bothTransparent && lhsPixel != rhsPixel)
+    {
+      ++mismatches;
+    }
+  }
+
+  return mismatches;
+}
+
+} // namespace
+
+
+TEST_CASE("Indexed EGA images match the RGBA ones")
+{
+  const auto widthInTiles = std::size_t{4};
+  const auto numTiles = std::size_t{12};
+
+  SECTION("Unmasked")
+  {
+    const auto type = data::TileImageType::Unmasked;
+    const auto tileData = makeRandomTileData(numTiles, type);
+
+    const auto image =
+      loadTiledImage(tileData, widthInTiles, INGAME_PALETTE, type);
+    const auto indexedImage =
+      loadTiledIndexedImage(tileData, widthInTiles, type);
+
+    REQUIRE(indexedImage.width() == image.width());
+    REQUIRE(indexedImage.height() == image.height());
+
+    const auto converted = indexedImage.toRgba(INGAME_PALETTE);
+    CHECK(countMismatches(converted, image) == 0);
+    CHECK(converted.pixelData() == image.pixelData());
+  }
+
+  SECTION("Masked")
+  {
+    const auto type = data::TileImageType::Masked;
+    const auto tileData = makeRandomTileData(numTiles, type);
+
+    const auto image =
+      loadTiledImage(tileData, widthInTiles, INGAME_PALETTE, type);
+    const auto indexedImage =
+      loadTiledIndexedImage(tileData, widthInTiles, type);
+
+    REQUIRE(indexedImage.width() == image.width());
+    REQUIRE(indexedImage.height() == image.height());
+
+    const auto converted = indexedImage.toRgba(INGAME_PALETTE);
+    CHECK(countMismatches(converted, image) == 0);
+
+    const auto& indices = indexedImage.indexData();
+    const auto numTransparent =
+      std::count(indices.begin(), indices.end(), EGA_TRANSPARENT_INDEX);
+    CHECK(numTransparent > 0);
+  }
+}
+
+
+TEST_CASE("Indices outside of the palette are transparent")
+{
+  const auto palette = std::array<data::Pixel, 2>{
+    data::Pixel{255, 0, 0, 255}, data::Pixel{0, 255, 0, 255}};
+  const auto image = data::IndexedImage({0, 1, 2, 255}, 2, 2);
+
+  const auto converted = image.toRgba(palette);
+
+  const auto expected = data::PixelBuffer{
+    data::Pixel{255, 0, 0, 255},
+    data::Pixel{0, 255, 0, 255},
+    data::Pixel{},
+    data::Pixel{}};
+  CHECK(converted.pixelData() == expected);
+}
@@ -131,7 +131,7 @@ TEST_CASE("Rocket elevator")
     entityFactory.spawnActor(data::ActorID::Rocket_elevator, {2, 103});
 
   base::Vector cameraPosition{0, 0};
-  engine::ParticleSystem particleSystem{&randomGenerator, nullptr};
+  engine::ParticleSystem particleSystem{&randomGenerator};
   PhysicsSystem physicsSystem{&collisionChecker, &map, &entityx.events};
   BehaviorControllerSystem behaviorControllerSystem{
     GlobalDependencies{
@@ -168,6 +168,8 @@ TEST_CASE("Rocket elevator")
     engine::markActiveEntities(entityx.entities, {0, 0}, viewPortSize);
     behaviorControllerSystem.update(entityx.entities, perFrameState);
     physicsSystem.update(entityx.entities);
+    behaviorControllerSystem.handleCollisions(physicsSystem.collisionEvents());
+    physicsSystem.clearCollisionEvents();
     perFrameState.mIsOddFrame = !perFrameState.mIsOddFrame;
   };
 
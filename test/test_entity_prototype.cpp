@@ -0,0 +1,254 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game_world_utils.hpp"
+
+#include <base/warnings.hpp>
+#include <data/game_options.hpp>
+#include <engine/base_components.hpp>
+#include <engine/life_time_components.hpp>
+#include <engine/physical_components.hpp>
+#include <engine/random_number_generator.hpp>
+#include <engine/visual_components.hpp>
+#include <game_logic/actor_tag.hpp>
+#include <game_logic/collectable_components.hpp>
+#include <game_logic/damage_components.hpp>
+#include <game_logic/effect_components.hpp>
+#include <game_logic/entity_factory.hpp>
+#include <game_logic/interactive/item_container.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+#include <entityx/entityx.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstddef>
+
+
+using namespace rigel;
+using namespace game_logic;
+
+using namespace engine::components;
+using namespace game_logic::components;
+
+using data::ActorID;
+
+
+namespace
+{
+
+// Level actors of the synthetic game data, except for Wall_walker (its
+// configuration consumes random numbers, so it never uses a prototype), plus
+// a few more which cover item containers and destruction effects.
+constexpr ActorID ACTOR_IDS[] = {
+  ActorID::Hoverbot,
+  ActorID::Nuclear_waste_can_empty,
+  ActorID::Blue_bonus_globe_1,
+  ActorID::Red_box_bomb,
+  ActorID::Red_box_cola,
+  ActorID::Blue_box_N,
+  ActorID::Green_box_empty,
+  ActorID::Watchbot,
+  ActorID::Rocket_launcher_turret,
+  ActorID::Green_slime_blob,
+  ActorID::Snake,
+  ActorID::Camera_on_ceiling,
+  ActorID::Skeleton,
+  ActorID::Spider,
+  ActorID::Blue_guard_RIGHT,
+  ActorID::Sliding_door_vertical,
+  ActorID::Laser_turret,
+  ActorID::Missile_intact,
+};
+
+
+template <typename T, typename Compare>
+void checkSameValue(
+  entityx::Entity expected,
+  entityx::Entity actual,
+  const char* componentName,
+  Compare isSame)
+{
+  if (expected.has_component<T>() && actual.has_component<T>())
+  {
+    INFO(componentName);
+    CHECK(isSame(*expected.component<const T>(), *actual.component<const T>()));
+  }
+}
+
+
+// Compares all data members of the components that the configuration
+// code sets up. BehaviorController is type-erased, so only its presence is
+// checked, via the component mask.
+void checkEquivalent(
+  entityx::EntityManager& entities,
+  entityx::Entity expected,
+  entityx::Entity actual)
+{
+  REQUIRE(expected.component_mask() == actual.component_mask());
+
+  checkSameValue<WorldPosition>(
+    expected, actual, "WorldPosition", [](const auto& a, const auto& b) {
+      return a == b;
+    });
+  checkSameValue<BoundingBox>(
+    expected, actual, "BoundingBox", [](const auto& a, const auto& b) {
+      return a == b;
+    });
+  checkSameValue<Orientation>(
+    expected, actual, "Orientation", [](const auto& a, const auto& b) {
+      return a == b;
+    });
+  checkSameValue<Sprite>(
+    expected, actual, "Sprite", [](const auto& a, const auto& b) {
+      return a.mpDrawData == b.mpDrawData &&
+        a.mFramesToRender == b.mFramesToRender &&
+        a.mFlashingWhiteStates == b.mFlashingWhiteStates &&
+        a.mTranslucent == b.mTranslucent && a.mShow == b.mShow;
+    });
+  checkSameValue<AnimationLoop>(
+    expected, actual, "AnimationLoop", [](const auto& a, const auto& b) {
+      return a.mDelayInFrames == b.mDelayInFrames &&
+        a.mFramesElapsed == b.mFramesElapsed &&
+        a.mStartFrame == b.mStartFrame && a.mEndFrame == b.mEndFrame &&
+        a.mRenderSlot == b.mRenderSlot;
+    });
+  checkSameValue<MovingBody>(
+    expected, actual, "MovingBody", [](const auto& a, const auto& b) {
+      return a.mVelocity == b.mVelocity &&
+        a.mGravityAffected == b.mGravityAffected &&
+        a.mIgnoreCollisions == b.mIgnoreCollisions &&
+        a.mIsActive == b.mIsActive;
+    });
+  checkSameValue<ActivationSettings>(
+    expected, actual, "ActivationSettings", [](const auto& a, const auto& b) {
+      return a.mPolicy == b.mPolicy &&
+        a.mHasBeenActivated == b.mHasBeenActivated;
+    });
+  checkSameValue<AutoDestroy>(
+    expected, actual, "AutoDestroy", [](const auto& a, const auto& b) {
+      return a.mConditionFlags == b.mConditionFlags &&
+        a.mFramesToLive == b.mFramesToLive;
+    });
+  checkSameValue<ActorTag>(
+    expected, actual, "ActorTag", [](const auto& a, const auto& b) {
+      return a.mType == b.mType && a.mSpawnIndex == b.mSpawnIndex;
+    });
+  checkSameValue<Shootable>(
+    expected, actual, "Shootable", [](const auto& a, const auto& b) {
+      return a.mHealth == b.mHealth && a.mGivenScore == b.mGivenScore &&
+        a.mInvincible == b.mInvincible &&
+        a.mEnableHitFeedback == b.mEnableHitFeedback &&
+        a.mDestroyWhenKilled == b.mDestroyWhenKilled &&
+        a.mAlwaysConsumeInflictor == b.mAlwaysConsumeInflictor &&
+        a.mCanBeHitWhenOffscreen == b.mCanBeHitWhenOffscreen;
+    });
+  checkSameValue<PlayerDamaging>(
+    expected, actual, "PlayerDamaging", [](const auto& a, const auto& b) {
+      return a.mAmount == b.mAmount && a.mIsFatal == b.mIsFatal &&
+        a.mDestroyOnContact == b.mDestroyOnContact;
+    });
+  checkSameValue<DamageInflicting>(
+    expected, actual, "DamageInflicting", [](const auto& a, const auto& b) {
+      return a.mAmount == b.mAmount &&
+        a.mDestroyOnContact == b.mDestroyOnContact &&
+        a.mHasCausedDamage == b.mHasCausedDamage;
+    });
+  checkSameValue<DestructionEffects>(
+    expected, actual, "DestructionEffects", [](const auto& a, const auto& b) {
+      return a.mEffectSpecs.data() == b.mEffectSpecs.data() &&
+        a.mEffectSpecs.size() == b.mEffectSpecs.size() &&
+        a.mTriggerCondition == b.mTriggerCondition &&
+        a.mCascadePlacementBox == b.mCascadePlacementBox &&
+        a.mFramesElapsed == b.mFramesElapsed &&
+        a.mActivated == b.mActivated;
+    });
+  checkSameValue<CollectableItem>(
+    expected, actual, "CollectableItem", [](const auto& a, const auto& b) {
+      return a.mGivenScore == b.mGivenScore &&
+        a.mGivenScoreAtFullHealth == b.mGivenScoreAtFullHealth &&
+        a.mGivenHealth == b.mGivenHealth && a.mGivenItem == b.mGivenItem &&
+        a.mGivenWeapon == b.mGivenWeapon &&
+        a.mGivenCollectableLetter == b.mGivenCollectableLetter &&
+        a.mShownTutorialMessage == b.mShownTutorialMessage &&
+        a.mSpawnScoreNumbers == b.mSpawnScoreNumbers;
+    });
+
+  if (expected.has_component<ItemContainer>())
+  {
+    const auto& expectedContainer = *expected.component<const ItemContainer>();
+    const auto& actualContainer = *actual.component<const ItemContainer>();
+
+    CHECK(expectedContainer.mStyle == actualContainer.mStyle);
+    CHECK(expectedContainer.mFramesElapsed == actualContainer.mFramesElapsed);
+    CHECK(expectedContainer.mHasBeenShot == actualContainer.mHasBeenShot);
+
+    const auto& expectedContents = expectedContainer.mContainedComponents;
+    const auto& actualContents = actualContainer.mContainedComponents;
+    REQUIRE(expectedContents.size() == actualContents.size());
+
+    // Contained components are type-erased as well, so release them into
+    // entities of their own to compare them.
+    auto expectedItem = entities.create();
+    auto actualItem = entities.create();
+    for (auto i = std::size_t{0}; i < expectedContents.size(); ++i)
+    {
+      expectedContents[i].assignToEntity(expectedItem);
+      actualContents[i].assignToEntity(actualItem);
+    }
+
+    INFO("Contents of item container");
+    checkEquivalent(entities, expectedItem, actualItem);
+  }
+}
+
+} // namespace
+
+
+TEST_CASE("Entities spawned from prototypes match configured ones")
+{
+  auto context = TestGameContext{};
+  auto options = data::GameOptions{};
+  auto randomGenerator = engine::RandomNumberGenerator{};
+
+  entityx::EventManager events;
+  entityx::EntityManager entities{events};
+
+  EntityFactory entityFactory{
+    &context.mSpriteFactory,
+    &entities,
+    &context.mServiceProvider,
+    &randomGenerator,
+    &options,
+    data::Difficulty::Medium};
+
+  const auto position = base::Vector{10, 20};
+
+  for (const auto id : ACTOR_IDS)
+  {
+    INFO("Actor ID " << static_cast<int>(id));
+
+    const auto configured =
+      entityFactory.spawnActorWithoutPrototype(id, position);
+
+    // The first spawn creates the prototype, the second one reuses it
+    const auto fromNewPrototype = entityFactory.spawnActor(id, position);
+    const auto fromExistingPrototype = entityFactory.spawnActor(id, position);
+
+    checkEquivalent(entities, configured, fromNewPrototype);
+    checkEquivalent(entities, configured, fromExistingPrototype);
+  }
+}
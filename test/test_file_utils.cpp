@@ -0,0 +1,113 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <base/warnings.hpp>
+#include <loader/file_utils.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <array>
+#include <cstdint>
+
+
+using namespace rigel::loader;
+
+
+TEST_CASE("LeStreamReader bulk reads")
+{
+  const auto data = ByteBuffer{
+    0x01, 0x02, 0x03, 0x04, 0xFF, 0xFF, 0x78, 0x56, 0x34, 0x12};
+
+  SECTION("Bytes are copied as-is")
+  {
+    LeStreamReader reader(data);
+    std::array<std::uint8_t, 3> values{};
+    reader.readU8Array(values.data(), values.size());
+
+    const auto expected = std::array<std::uint8_t, 3>{0x01, 0x02, 0x03};
+    CHECK(values == expected);
+    CHECK(reader.bytesRemaining() == 7);
+  }
+
+  SECTION("16-bit words are decoded as little-endian")
+  {
+    LeStreamReader reader(data);
+    std::array<std::uint16_t, 3> values{};
+    reader.readU16Array(values.data(), values.size());
+
+    const auto expected = std::array<std::uint16_t, 3>{0x0201, 0x0403, 0xFFFF};
+    CHECK(values == expected);
+  }
+
+  SECTION("Signed 16-bit words are decoded as two's complement")
+  {
+    LeStreamReader reader(data);
+    reader.skipBytes(4);
+    std::array<std::int16_t, 1> values{};
+    reader.readS16Array(values.data(), values.size());
+
+    CHECK(values[0] == -1);
+  }
+
+  SECTION("32-bit words are decoded as little-endian")
+  {
+    LeStreamReader reader(data);
+    reader.skipBytes(2);
+    std::array<std::uint32_t, 2> values{};
+    reader.readU32Array(values.data(), values.size());
+
+    const auto expected =
+      std::array<std::uint32_t, 2>{0xFFFF0403u, 0x12345678u};
+    CHECK(values == expected);
+    CHECK(!reader.hasData());
+  }
+
+  SECTION("Bulk reads match individual reads")
+  {
+    LeStreamReader bulkReader(data);
+    std::array<std::uint16_t, 5> values{};
+    bulkReader.readU16Array(values.data(), values.size());
+
+    LeStreamReader reader(data);
+    for (const auto value : values)
+    {
+      CHECK(value == reader.readU16());
+    }
+  }
+
+  SECTION("Reading zero values is allowed at the end of the data")
+  {
+    LeStreamReader reader(data);
+    reader.skipBytes(data.size());
+    reader.readU16Array(nullptr, 0);
+
+    CHECK(!reader.hasData());
+  }
+
+  SECTION("Throws without consuming anything if there is not enough data")
+  {
+    LeStreamReader reader(data);
+    reader.skipBytes(4);
+    std::array<std::uint32_t, 2> values{};
+
+    CHECK_THROWS(reader.readU32Array(values.data(), values.size()));
+    CHECK(reader.bytesRemaining() == 6);
+    CHECK(reader.readU16() == 0xFFFF);
+  }
+}
@@ -0,0 +1,245 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <renderer/frame_pacer.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+
+using namespace rigel;
+using namespace std::chrono;
+
+using renderer::FramePacer;
+using renderer::FrameTimeStatistics;
+
+
+namespace
+{
+
+/** Simulated clock and sleep, for measuring pacing accuracy headlessly
+ *
+ * Sleeping behaves like on a typical desktop OS with a 1 ms timer: The
+ * requested duration is truncated to whole milliseconds, and the actual
+ * wake up happens somewhere within the following timer period. Reading
+ * the clock takes a small amount of time, like a real spin loop would.
+ */
+struct SimulatedPlatform
+{
+  static constexpr auto CLOCK_READ_COST =
+    base::Clock::duration{nanoseconds{50}};
+
+  FramePacer::TimeSource timeSource()
+  {
+    return {
+      [this]() {
+        mNow += CLOCK_READ_COST;
+        return mNow;
+      },
+      [this](const base::Clock::duration duration) {
+        const auto requestedMs = duration_cast<milliseconds>(duration);
+        mNow += requestedMs;
+        mNow += microseconds{100 + (mNumSleeps * 337) % 900};
+        ++mNumSleeps;
+      }};
+  }
+
+  void doWork(const base::Clock::duration duration) { mNow += duration; }
+
+  base::Clock::time_point mNow{};
+  int mNumSleeps = 0;
+};
+
+
+struct PacingResult
+{
+  FrameTimeStatistics mStats;
+  base::Clock::duration mLongestFrameStartToPresentation{};
+};
+
+
+template <typename WorkFunc>
+PacingResult runFrames(
+  SimulatedPlatform& platform,
+  FramePacer& pacer,
+  const int numFrames,
+  WorkFunc work)
+{
+  PacingResult result;
+  base::Clock::time_point lastPresentationTime;
+
+  for (int i = 0; i < numFrames; ++i)
+  {
+    const auto frameStart = platform.mNow;
+    platform.doWork(work(i));
+
+    pacer.waitForPresentation();
+    const auto presentationTime = platform.mNow;
+    pacer.waitForNextFrame();
+
+    // The first frame is started before the pacer had a chance to wait
+    if (i > 0)
+    {
+      result.mStats.addSample(
+        duration<double>(presentationTime - lastPresentationTime).count());
+      result.mLongestFrameStartToPresentation = std::max(
+        result.mLongestFrameStartToPresentation,
+        presentationTime - frameStart);
+    }
+
+    lastPresentationTime = presentationTime;
+  }
+
+  return result;
+}
+
+} // namespace
+
+
+TEST_CASE("Frame time statistics")
+{
+  FrameTimeStatistics stats;
+
+  SECTION("Empty statistics report zero")
+  {
+    CHECK(stats.numSamples() == 0);
+    CHECK(stats.meanFrameTime() == 0.0);
+    CHECK(stats.jitter() == 0.0);
+  }
+
+  SECTION("Mean, min, max and jitter are computed from samples")
+  {
+    stats.addSample(0.010);
+    stats.addSample(0.020);
+    stats.addSample(0.010);
+    stats.addSample(0.020);
+
+    CHECK(stats.numSamples() == 4);
+    CHECK(stats.meanFrameTime() == Approx(0.015));
+    CHECK(stats.minFrameTime() == Approx(0.010));
+    CHECK(stats.maxFrameTime() == Approx(0.020));
+    CHECK(stats.jitter() == Approx(0.005));
+  }
+
+  SECTION("Samples are sorted into histogram buckets")
+  {
+    stats.addSample(0.0);
+    stats.addSample(FrameTimeStatistics::HISTOGRAM_BUCKET_WIDTH * 2.5);
+    stats.addSample(10.0);
+
+    const auto& histogram = stats.histogram();
+    CHECK(histogram[0] == 1);
+    CHECK(histogram[2] == 1);
+    CHECK(histogram.back() == 1);
+  }
+
+  SECTION("Only the most recent samples are kept")
+  {
+    for (auto i = std::size_t{0}; i < FrameTimeStatistics::WINDOW_SIZE; ++i)
+    {
+      stats.addSample(0.0);
+    }
+
+    for (auto i = std::size_t{0}; i < FrameTimeStatistics::WINDOW_SIZE; ++i)
+    {
+      stats.addSample(0.001);
+    }
+
+    const auto& histogram = stats.histogram();
+    CHECK(stats.numSamples() == FrameTimeStatistics::WINDOW_SIZE);
+    CHECK(stats.meanFrameTime() == Approx(0.001));
+    CHECK(histogram[0] == 0);
+    CHECK(histogram[2] == FrameTimeStatistics::WINDOW_SIZE);
+  }
+}
+
+
+TEST_CASE("Frame pacer accuracy")
+{
+  SimulatedPlatform platform;
+
+  auto varyingWork = [](const int frame) {
+    return base::Clock::duration{microseconds{1000 + (frame % 7) * 500}};
+  };
+
+  for (const auto targetFps : {60, 144, 240})
+  {
+    const auto targetFrameTime = 1.0 / targetFps;
+
+    SECTION(
+      "Frames are presented at target rate - " + std::to_string(targetFps))
+    {
+      FramePacer pacer{targetFps, false, platform.timeSource()};
+      const auto result = runFrames(platform, pacer, 600, varyingWork);
+
+      CHECK(
+        result.mStats.meanFrameTime() ==
+        Approx(targetFrameTime).epsilon(0.001));
+      CHECK(result.mStats.jitter() < 0.00001);
+      CHECK(
+        std::abs(result.mStats.maxFrameTime() - targetFrameTime) < 0.00001);
+    }
+
+    SECTION(
+      "Render cost prediction keeps accuracy - " + std::to_string(targetFps))
+    {
+      FramePacer pacer{targetFps, true, platform.timeSource()};
+      const auto result = runFrames(platform, pacer, 600, varyingWork);
+
+      CHECK(
+        result.mStats.meanFrameTime() ==
+        Approx(targetFrameTime).epsilon(0.001));
+      CHECK(result.mStats.jitter() < 0.00001);
+    }
+  }
+
+  SECTION("Render cost prediction reduces latency")
+  {
+    auto constantWork = [](int) {
+      return base::Clock::duration{milliseconds{2}};
+    };
+
+    FramePacer regularPacer{60, false, platform.timeSource()};
+    const auto regularResult =
+      runFrames(platform, regularPacer, 100, constantWork);
+
+    FramePacer predictingPacer{60, true, platform.timeSource()};
+    const auto predictingResult =
+      runFrames(platform, predictingPacer, 100, constantWork);
+
+    CHECK(
+      regularResult.mLongestFrameStartToPresentation >= milliseconds{16});
+    CHECK(
+      predictingResult.mLongestFrameStartToPresentation < milliseconds{4});
+  }
+
+  SECTION("Missed deadlines re-align instead of catching up")
+  {
+    FramePacer pacer{60, false, platform.timeSource()};
+    const auto result = runFrames(platform, pacer, 20, [](const int frame) {
+      return frame == 10 ? base::Clock::duration{milliseconds{50}}
+                         : base::Clock::duration{milliseconds{1}};
+    });
+
+    CHECK(result.mStats.minFrameTime() > 1.0 / 60 - 0.00001);
+  }
+}
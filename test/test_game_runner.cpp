@@ -0,0 +1,197 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game_world_utils.hpp"
+
+#include <base/warnings.hpp>
+#include <frontend/game_runner.hpp>
+#include <loader/file_utils.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+#include <SDL.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+
+using namespace rigel;
+using namespace game_logic;
+
+
+namespace
+{
+
+constexpr auto NUM_FRAMES = 450;
+constexpr auto QUICK_SAVE_FRAME = 150;
+constexpr auto QUICK_LOAD_FRAME = 300;
+
+
+struct RunResult
+{
+  InputRecording mRecording;
+  std::vector<std::uint32_t> mStateHashPerFrame;
+  std::vector<std::vector<SoundCall>> mSoundCallsPerFrame;
+};
+
+
+void sendKey(GameRunner& runner, const SDL_Keycode key, const bool pressed)
+{
+  auto event = SDL_Event{};
+  event.type = pressed ? SDL_KEYDOWN : SDL_KEYUP;
+  event.key.keysym.sym = key;
+  runner.handleEvent(event);
+}
+
+
+void sendInputChanges(
+  GameRunner& runner,
+  const data::GameOptions& options,
+  const PlayerInput& previous,
+  const PlayerInput& input)
+{
+  auto update = [&](const SDL_Keycode key, const bool was, const bool is) {
+    if (was != is)
+    {
+      sendKey(runner, key, is);
+    }
+  };
+
+  update(options.mLeftKeybinding, previous.mLeft, input.mLeft);
+  update(options.mRightKeybinding, previous.mRight, input.mRight);
+  update(
+    options.mJumpKeybinding,
+    previous.mJump.mIsPressed,
+    input.mJump.mIsPressed);
+  update(
+    options.mFireKeybinding,
+    previous.mFire.mIsPressed,
+    input.mFire.mIsPressed);
+}
+
+
+// Runs the same fixed sequence of inputs (plus a quick save and quick load)
+// through a GameRunner, one logic update per rendered frame.
+RunResult run(const bool pipelined)
+{
+  auto commandLineOptions = CommandLineOptions{};
+  commandLineOptions.mPipelinedGameLogic = pipelined;
+
+  auto context = TestGameContext{commandLineOptions};
+  const auto& options = context.mUserProfile.mOptions;
+
+  const auto recordingFile = std::filesystem::temp_directory_path() /
+    (pipelined ? "rigel_test_pipelined.rec" : "rigel_test_inline.rec");
+
+  auto result = RunResult{};
+
+  {
+    auto recorder = InputRecorder{recordingFile};
+    auto playerModel = data::PlayerModel{};
+    GameRunner runner{
+      &playerModel, testSessionId(), context.context(&recorder)};
+
+    const auto segment = makeTestSegment(NUM_FRAMES);
+    auto previousInput = PlayerInput{};
+    for (auto i = 0; i < NUM_FRAMES; ++i)
+    {
+      if (i == QUICK_SAVE_FRAME || i == QUICK_LOAD_FRAME)
+      {
+        const auto key = i == QUICK_SAVE_FRAME ? options.mQuickSaveKeybinding
+                                               : options.mQuickLoadKeybinding;
+        sendKey(runner, key, true);
+        sendKey(runner, key, false);
+      }
+
+      const auto& input = segment.mFrames[i].mInput;
+      sendInputChanges(runner, options, previousInput, input);
+      previousInput = input;
+
+      runner.updateAndRender(GAME_LOGIC_UPDATE_DELAY);
+
+      // In pipelined mode, the logic update is still running on the worker
+      // thread at this point. Getting the state hash waits for it to finish
+      // and publishes its results, including deferred sound calls.
+      result.mStateHashPerFrame.push_back(runner.stateHash());
+      result.mSoundCallsPerFrame.push_back(
+        std::exchange(context.mServiceProvider.mSoundCalls, {}));
+    }
+  }
+
+  result.mRecording =
+    deserializeInputRecording(loader::loadFile(recordingFile));
+  return result;
+}
+
+} // namespace
+
+
+TEST_CASE("Pipelined game logic gives the same results as inline logic")
+{
+  const auto inlineResult = run(false);
+  const auto pipelinedResult = run(true);
+
+  REQUIRE(inlineResult.mRecording.mSegments.size() == 1);
+  REQUIRE(pipelinedResult.mRecording.mSegments.size() == 1);
+
+  const auto& inlineSegment = inlineResult.mRecording.mSegments.front();
+  const auto& pipelinedSegment = pipelinedResult.mRecording.mSegments.front();
+
+  REQUIRE(inlineSegment.mFrames.size() == std::size_t{NUM_FRAMES});
+  REQUIRE(pipelinedSegment.mFrames.size() == std::size_t{NUM_FRAMES});
+  REQUIRE(
+    inlineSegment.mStateHashes.size() ==
+    std::size_t{NUM_FRAMES / STATE_HASH_INTERVAL});
+  REQUIRE(
+    pipelinedSegment.mStateHashes.size() == inlineSegment.mStateHashes.size());
+
+  for (auto i = std::size_t{0}; i < std::size_t{NUM_FRAMES}; ++i)
+  {
+    INFO("Frame " << i);
+
+    const auto& inlineFrame = inlineSegment.mFrames[i];
+    const auto& pipelinedFrame = pipelinedSegment.mFrames[i];
+    CHECK(inlineFrame.mQuickSave == pipelinedFrame.mQuickSave);
+    CHECK(inlineFrame.mQuickLoad == pipelinedFrame.mQuickLoad);
+    CHECK(inlineFrame.mEndOfFrameActions == pipelinedFrame.mEndOfFrameActions);
+
+    CHECK(
+      inlineResult.mStateHashPerFrame[i] ==
+      pipelinedResult.mStateHashPerFrame[i]);
+    CHECK(
+      inlineResult.mSoundCallsPerFrame[i] ==
+      pipelinedResult.mSoundCallsPerFrame[i]);
+  }
+
+  // In pipelined mode, these are taken on the worker thread
+  for (auto i = std::size_t{0}; i < inlineSegment.mStateHashes.size(); ++i)
+  {
+    const auto& inlineHash = inlineSegment.mStateHashes[i];
+    const auto& pipelinedHash = pipelinedSegment.mStateHashes[i];
+
+    INFO("Frame " << inlineHash.mFrame);
+    CHECK(inlineHash.mFrame == pipelinedHash.mFrame);
+    CHECK(inlineHash.mHash == pipelinedHash.mHash);
+  }
+
+  // Make sure the comparison above covers the quick save/load path
+  CHECK(inlineSegment.mFrames[QUICK_SAVE_FRAME].mQuickSave);
+  CHECK(inlineSegment.mFrames[QUICK_LOAD_FRAME].mQuickLoad);
+}
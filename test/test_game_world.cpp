@@ -0,0 +1,109 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game_world_utils.hpp"
+
+#include <base/heap_allocation_counter.hpp>
+#include <base/warnings.hpp>
+#include <game_logic/game_world.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstddef>
+
+
+using namespace rigel;
+using namespace game_logic;
+
+
+TEST_CASE("Parallel logic stages give the same results as serial ones")
+{
+  auto serialOptions = CommandLineOptions{};
+  auto parallelOptions = CommandLineOptions{};
+  parallelOptions.mParallelSystems = true;
+
+  auto serialContext = TestGameContext{serialOptions};
+  auto parallelContext = TestGameContext{parallelOptions};
+
+  const auto segment = makeTestSegment(600);
+
+  auto serialPlayerModel = initialPlayerModel(segment);
+  auto parallelPlayerModel = initialPlayerModel(segment);
+  GameWorld serialWorld{
+    &serialPlayerModel, segment.mSessionId, serialContext.context()};
+  GameWorld parallelWorld{
+    &parallelPlayerModel, segment.mSessionId, parallelContext.context()};
+
+  REQUIRE(serialWorld.stateHash() == parallelWorld.stateHash());
+
+  for (auto i = std::size_t{0}; i < segment.mFrames.size(); ++i)
+  {
+    const auto& input = segment.mFrames[i].mInput;
+    serialWorld.updateGameLogic(input);
+    parallelWorld.updateGameLogic(input);
+
+    INFO("Frame " << i);
+    REQUIRE(serialWorld.stateHash() == parallelWorld.stateHash());
+  }
+
+  // Sound effects are emitted by stages as well, so their order needs to
+  // match, too.
+  CHECK(
+    serialContext.mServiceProvider.mSoundCalls ==
+    parallelContext.mServiceProvider.mSoundCalls);
+}
+
+
+#ifdef RIGEL_TRACK_HEAP_ALLOCATIONS
+
+TEST_CASE("Logic updates don't allocate once the world has warmed up")
+{
+  auto context = TestGameContext{};
+  auto& soundCalls = context.mServiceProvider.mSoundCalls;
+
+  // Pools, queues and caches grow during the first few hundred frames, as
+  // the player walks into new parts of the level and shoots at things.
+  const auto warmUp = makeTestSegment(600);
+  const auto steadyState = makeTestSegment(300, 600);
+
+  auto playerModel = initialPlayerModel(warmUp);
+  GameWorld world{&playerModel, warmUp.mSessionId, context.context()};
+
+  for (const auto& frame : warmUp.mFrames)
+  {
+    world.updateGameLogic(frame.mInput);
+    soundCalls.clear();
+  }
+
+  // The recording service provider isn't part of what's being tested
+  soundCalls.reserve(256);
+
+  const auto allocationsAfterWarmUp = base::heapAllocationCount();
+  REQUIRE(allocationsAfterWarmUp);
+
+  for (auto i = std::size_t{0}; i < steadyState.mFrames.size(); ++i)
+  {
+    world.updateGameLogic(steadyState.mFrames[i].mInput);
+    soundCalls.clear();
+
+    INFO("Frame " << i);
+    REQUIRE(*base::heapAllocationCount() == *allocationsAfterWarmUp);
+  }
+}
+
+#endif
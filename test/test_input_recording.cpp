@@ -0,0 +1,220 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <game_logic/input_recording.hpp>
+#include <loader/file_utils.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstddef>
+#include <filesystem>
+
+using namespace rigel;
+using namespace game_logic;
+
+
+namespace
+{
+
+RecordedFrame makeFrame(const bool left, const bool jumpTriggered)
+{
+  RecordedFrame frame;
+  frame.mInput.mLeft = left;
+  frame.mInput.mJump = Button{jumpTriggered, jumpTriggered};
+  return frame;
+}
+
+} // namespace
+
+
+namespace rigel::game_logic
+{
+
+bool operator==(const Button& lhs, const Button& rhs)
+{
+  return lhs.mIsPressed == rhs.mIsPressed &&
+    lhs.mWasTriggered == rhs.mWasTriggered;
+}
+
+
+bool operator==(const RecordedFrame& lhs, const RecordedFrame& rhs)
+{
+  const auto& a = lhs.mInput;
+  const auto& b = rhs.mInput;
+
+  // clang-format off
+  return
+    a.mLeft == b.mLeft &&
+    a.mRight == b.mRight &&
+    a.mUp == b.mUp &&
+    a.mDown == b.mDown &&
+    a.mInteract == b.mInteract &&
+    a.mJump == b.mJump &&
+    a.mFire == b.mFire &&
+    lhs.mQuickSave == rhs.mQuickSave &&
+    lhs.mQuickLoad == rhs.mQuickLoad &&
+    lhs.mEndOfFrameActions == rhs.mEndOfFrameActions;
+  // clang-format on
+}
+
+} // namespace rigel::game_logic
+
+
+TEST_CASE("Input recordings survive a serialization round trip")
+{
+  RecordingSegment segment;
+  segment.mSessionId = data::GameSessionId{1, 4, data::Difficulty::Hard};
+  segment.mWeapon = data::WeaponType::Laser;
+  segment.mAmmo = 17;
+  segment.mHealth = 5;
+  segment.mScore = 123456;
+  segment.mInventory = {
+    data::InventoryItemType::BlueKey, data::InventoryItemType::RapidFire};
+  segment.mCollectedLetters = {
+    data::CollectableLetterType::N, data::CollectableLetterType::U};
+  segment.mTutorialMessages.markAsShown(data::TutorialMessageId::FoundLaser);
+  segment.mTutorialMessages.markAsShown(data::TutorialMessageId::FoundDoor);
+  segment.mPlayerPositionOverride = base::Vector{20, 101};
+
+  for (auto i = 0; i < 100; ++i)
+  {
+    segment.mFrames.push_back(makeFrame(i > 40, i % 30 == 0));
+  }
+
+  segment.mFrames[50].mQuickSave = true;
+  segment.mFrames[70].mQuickLoad = true;
+  segment.mFrames[71].mEndOfFrameActions = true;
+  segment.mStateHashes = {{15, 0xDEADBEEF}, {30, 0x12345678}};
+
+  auto secondSegment = RecordingSegment{};
+  secondSegment.mFrames.push_back(makeFrame(false, true));
+
+  InputRecording recording;
+  recording.mSegments = {segment, secondSegment};
+
+  const auto data = serialize(recording);
+  const auto result = deserializeInputRecording(data);
+
+  REQUIRE(result.mSegments.size() == 2);
+
+  const auto& first = result.mSegments[0];
+  CHECK(first.mSessionId.mEpisode == 1);
+  CHECK(first.mSessionId.mLevel == 4);
+  CHECK(first.mSessionId.mDifficulty == data::Difficulty::Hard);
+  CHECK(first.mWeapon == data::WeaponType::Laser);
+  CHECK(first.mAmmo == 17);
+  CHECK(first.mHealth == 5);
+  CHECK(first.mScore == 123456);
+  CHECK(first.mInventory == segment.mInventory);
+  CHECK(first.mCollectedLetters == segment.mCollectedLetters);
+  CHECK(first.mTutorialMessages.hasBeenShown(
+    data::TutorialMessageId::FoundLaser));
+  CHECK(
+    first.mTutorialMessages.hasBeenShown(data::TutorialMessageId::FoundDoor));
+  CHECK(!first.mTutorialMessages.hasBeenShown(
+    data::TutorialMessageId::FoundBlueKey));
+  REQUIRE(first.mPlayerPositionOverride);
+  CHECK(*first.mPlayerPositionOverride == base::Vector(20, 101));
+
+  REQUIRE(first.mFrames.size() == segment.mFrames.size());
+  CHECK(std::equal(
+    first.mFrames.begin(), first.mFrames.end(), segment.mFrames.begin()));
+
+  REQUIRE(first.mStateHashes.size() == 2);
+  CHECK(first.mStateHashes[0].mFrame == 15);
+  CHECK(first.mStateHashes[0].mHash == 0xDEADBEEF);
+  CHECK(first.mStateHashes[1].mFrame == 30);
+  CHECK(first.mStateHashes[1].mHash == 0x12345678);
+
+  const auto& second = result.mSegments[1];
+  CHECK(!second.mPlayerPositionOverride);
+  REQUIRE(second.mFrames.size() == 1);
+  CHECK(second.mFrames[0] == secondSegment.mFrames[0]);
+
+  SECTION("Repeated input is stored compactly")
+  {
+    RecordingSegment longSegment;
+    longSegment.mFrames.resize(10000, makeFrame(true, false));
+
+    const auto longData = serialize(InputRecording{{longSegment}});
+    CHECK(longData.size() < 64);
+    CHECK(
+      deserializeInputRecording(longData).mSegments[0].mFrames.size() ==
+      10000);
+  }
+
+  SECTION("Initial player model is restored")
+  {
+    const auto model = initialPlayerModel(first);
+    CHECK(model.weapon() == data::WeaponType::Laser);
+    CHECK(model.ammo() == 17);
+    CHECK(model.health() == 5);
+    CHECK(model.score() == 123456);
+    CHECK(model.inventory() == segment.mInventory);
+    CHECK(model.collectedLetters() == segment.mCollectedLetters);
+    CHECK(model.tutorialMessages().hasBeenShown(
+      data::TutorialMessageId::FoundLaser));
+    CHECK(model.tutorialMessages().hasBeenShown(
+      data::TutorialMessageId::FoundDoor));
+    CHECK(!model.tutorialMessages().hasBeenShown(
+      data::TutorialMessageId::FoundBlueKey));
+  }
+}
+
+
+TEST_CASE("Input recorder writes partial segments periodically")
+{
+  const auto file =
+    std::filesystem::temp_directory_path() / "rigel_test_partial.rec";
+  std::filesystem::remove(file);
+
+  auto playerModel = data::PlayerModel{};
+  playerModel.giveItem(data::InventoryItemType::CircuitBoard);
+
+  InputRecorder recorder{file};
+  recorder.beginSegment(
+    data::GameSessionId{0, 2, data::Difficulty::Easy}, playerModel, {});
+
+  for (auto i = 0; i < RECORDING_FLUSH_INTERVAL - 1; ++i)
+  {
+    recorder.recordFrame(makeFrame(true, false).mInput);
+  }
+
+  CHECK(!std::filesystem::exists(file));
+
+  // No endSegment() call, like when the game crashes
+  recorder.recordFrame(makeFrame(false, true).mInput);
+
+  REQUIRE(std::filesystem::exists(file));
+  const auto recording = deserializeInputRecording(loader::loadFile(file));
+
+  REQUIRE(recording.mSegments.size() == 1);
+  const auto& segment = recording.mSegments.front();
+  CHECK(segment.mSessionId.mLevel == 2);
+  CHECK(segment.mInventory == playerModel.inventory());
+  CHECK(segment.mFrames.size() == std::size_t{RECORDING_FLUSH_INTERVAL});
+  CHECK(segment.mFrames.back() == makeFrame(false, true));
+}
+
+
+TEST_CASE("Invalid input recordings are rejected")
+{
+  CHECK_THROWS(deserializeInputRecording({'R', 'I', 'F', 'F', 1, 0, 0, 0}));
+  CHECK_THROWS(deserializeInputRecording({'R', 'G', 'L', 'R', 1, 0, 1}));
+}
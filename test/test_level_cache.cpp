@@ -0,0 +1,238 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <synthetic_game_data.hpp>
+
+#include <base/warnings.hpp>
+#include <data/game_traits.hpp>
+#include <loader/file_utils.hpp>
+#include <loader/level_cache.hpp>
+#include <loader/resource_loader.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <variant>
+
+using namespace rigel;
+using namespace data;
+using namespace data::map;
+
+
+namespace
+{
+
+Image makeImage(
+  const std::size_t width,
+  const std::size_t height,
+  const std::uint8_t seed)
+{
+  PixelBuffer pixels;
+  for (auto i = std::size_t{0}; i < width * height; ++i)
+  {
+    pixels.push_back(Pixel{static_cast<std::uint8_t>(seed + i), seed, 0, 255});
+  }
+
+  return Image{std::move(pixels), width, height};
+}
+
+
+IndexedImage makeIndexedImage(
+  const std::size_t width,
+  const std::size_t height,
+  const std::uint8_t seed)
+{
+  IndexBuffer indices;
+  for (auto i = std::size_t{0}; i < width * height; ++i)
+  {
+    indices.push_back(static_cast<std::uint8_t>(seed + i));
+  }
+
+  return IndexedImage{std::move(indices), width, height};
+}
+
+
+LevelData makeLevel()
+{
+  auto attributes = TileAttributeDict::AttributeArray(
+    GameTraits::CZone::numTilesTotal, 0);
+  attributes[1] = 0x0F;
+
+  Map map(4, 3, TileAttributeDict{attributes});
+  map.setTileAt(0, 0, 0, 1);
+  map.setTileAt(0, 3, 2, 5);
+  map.setTileAt(1, 2, 1, GameTraits::CZone::numSolidTiles + 2);
+
+  return LevelData{
+    makeImage(3, 2, 10),
+    makeIndexedImage(2, 2, 20),
+    makeImage(1, 1, 30),
+    std::move(map),
+    {{{1, 2}, ActorID::Hoverbot, std::nullopt},
+     {{3, 0}, ActorID::Dynamic_geometry_1, base::Rect<int>{{0, 0}, {2, 1}}}},
+    {2, 1},
+    true,
+    BackdropScrollMode::AutoHorizontal,
+    BackdropSwitchCondition::OnTeleportation,
+    true,
+    "SONG.IMF"};
+}
+
+} // namespace
+
+
+TEST_CASE("Level cache serialization")
+{
+  const auto original = makeLevel();
+  const auto serialized = loader::serializeLevelData(original, 1234);
+
+  SECTION("Level survives a round trip unchanged")
+  {
+    const auto level = loader::deserializeLevelData(serialized, 1234);
+    REQUIRE(level);
+
+    const auto pixelsOf = [](const AnyImage& image) {
+      return std::get<Image>(image).pixelData();
+    };
+
+    REQUIRE(std::holds_alternative<Image>(level->mTileSetImage));
+    CHECK(pixelsOf(level->mTileSetImage) == pixelsOf(original.mTileSetImage));
+
+    REQUIRE(std::holds_alternative<IndexedImage>(level->mBackdropImage));
+    const auto& backdrop = std::get<IndexedImage>(level->mBackdropImage);
+    const auto& originalBackdrop =
+      std::get<IndexedImage>(original.mBackdropImage);
+    CHECK(backdrop.width() == originalBackdrop.width());
+    CHECK(backdrop.indexData() == originalBackdrop.indexData());
+
+    REQUIRE(level->mSecondaryBackdropImage);
+    REQUIRE(std::holds_alternative<Image>(*level->mSecondaryBackdropImage));
+    CHECK(
+      pixelsOf(*level->mSecondaryBackdropImage) ==
+      pixelsOf(*original.mSecondaryBackdropImage));
+
+    CHECK(level->mMap.width() == 4);
+    CHECK(level->mMap.height() == 3);
+    for (auto layer = 0; layer < 2; ++layer)
+    {
+      for (auto y = 0; y < 3; ++y)
+      {
+        for (auto x = 0; x < 4; ++x)
+        {
+          CHECK(
+            level->mMap.tileAt(layer, x, y) ==
+            original.mMap.tileAt(layer, x, y));
+        }
+      }
+    }
+    CHECK(
+      level->mMap.attributeDict().bitPacks() ==
+      original.mMap.attributeDict().bitPacks());
+
+    REQUIRE(level->mActors.size() == 2);
+    const auto expectedArea = base::Rect<int>{{0, 0}, {2, 1}};
+    const auto expectedSpawnPosition = base::Vector{2, 1};
+
+    CHECK(level->mActors[0].mPosition.x == 1);
+    CHECK(level->mActors[0].mPosition.y == 2);
+    CHECK(level->mActors[0].mID == ActorID::Hoverbot);
+    CHECK(!level->mActors[0].mAssignedArea);
+    CHECK(level->mActors[1].mID == ActorID::Dynamic_geometry_1);
+    CHECK(level->mActors[1].mAssignedArea == expectedArea);
+
+    CHECK(level->mPlayerSpawnPosition == expectedSpawnPosition);
+    CHECK(level->mPlayerFacingLeft);
+    CHECK(level->mBackdropScrollMode == BackdropScrollMode::AutoHorizontal);
+    CHECK(
+      level->mBackdropSwitchCondition ==
+      BackdropSwitchCondition::OnTeleportation);
+    CHECK(level->mEarthquake);
+    CHECK(level->mMusicFile == "SONG.IMF");
+  }
+
+  SECTION("Data from different sources is rejected")
+  {
+    CHECK(!loader::deserializeLevelData(serialized, 4321));
+  }
+
+  SECTION("Truncated data causes an exception")
+  {
+    const auto truncated =
+      loader::ByteBuffer(serialized.begin(), serialized.end() - 10);
+    CHECK_THROWS(loader::deserializeLevelData(truncated, 1234));
+  }
+}
+
+
+TEST_CASE("Level source hash")
+{
+  namespace fs = std::filesystem;
+
+  const auto directory =
+    fs::temp_directory_path() / "rigel_level_cache_test_data";
+  synthetic_data::writeGameDirectory(directory);
+
+  const auto replacementsDirectory = directory / "asset_replacements";
+  fs::remove_all(replacementsDirectory);
+
+  const auto resources = loader::ResourceLoader{(directory / "").u8string()};
+  const auto hash = [&](const Difficulty difficulty = Difficulty::Medium) {
+    return loader::levelSourceHash(
+      synthetic_data::LEVEL_FILE, resources, difficulty);
+  };
+
+  const auto originalHash = hash();
+
+  SECTION("Hash is stable")
+  {
+    CHECK(hash() == originalHash);
+  }
+
+  SECTION("Difficulty is covered")
+  {
+    CHECK(hash(Difficulty::Hard) != originalHash);
+  }
+
+  SECTION("Replacement images are covered by size and modification time")
+  {
+    fs::create_directories(replacementsDirectory);
+    const auto replacement = replacementsDirectory / "tileset1.png";
+
+    loader::saveToFile(loader::ByteBuffer{1, 2, 3, 4}, replacement);
+    const auto modificationTime = fs::last_write_time(replacement);
+    const auto hashWithReplacement = hash();
+    CHECK(hashWithReplacement != originalHash);
+
+    // Same size and time, different content: Not read, so not detected
+    loader::saveToFile(loader::ByteBuffer{5, 6, 7, 8}, replacement);
+    fs::last_write_time(replacement, modificationTime);
+    CHECK(hash() == hashWithReplacement);
+
+    fs::last_write_time(replacement, modificationTime + std::chrono::hours{1});
+    CHECK(hash() != hashWithReplacement);
+
+    loader::saveToFile(loader::ByteBuffer{1, 2, 3}, replacement);
+    fs::last_write_time(replacement, modificationTime);
+    CHECK(hash() != hashWithReplacement);
+
+    fs::remove_all(replacementsDirectory);
+  }
+}
@@ -0,0 +1,194 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <base/warnings.hpp>
+#include <data/map.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+
+using namespace rigel;
+using data::map::Map;
+using data::map::TileIndex;
+
+
+namespace
+{
+
+Map makeNumberedMap(const int width, const int height)
+{
+  Map map{width, height, data::map::TileAttributeDict{{0x0, 0xF}}};
+  for (auto y = 0; y < height; ++y)
+  {
+    for (auto x = 0; x < width; ++x)
+    {
+      map.setTileAt(0, x, y, static_cast<TileIndex>(1 + x + y * width));
+      map.setTileAt(1, x, y, static_cast<TileIndex>(100 + x + y * width));
+    }
+  }
+
+  return map;
+}
+
+
+bool mapsEqual(const Map& lhs, const Map& rhs)
+{
+  for (auto layer = 0; layer < 2; ++layer)
+  {
+    for (auto y = 0; y < lhs.height(); ++y)
+    {
+      for (auto x = 0; x < lhs.width(); ++x)
+      {
+        if (lhs.tileAt(layer, x, y) != rhs.tileAt(layer, x, y))
+        {
+          return false;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+} // namespace
+
+
+TEST_CASE("Map section operations")
+{
+  auto map = makeNumberedMap(8, 6);
+
+  SECTION("Moving a section down by one row")
+  {
+    const auto section = base::Rect<int>{{2, 1}, {3, 3}};
+
+    // Reference: what dynamic geometry used to do tile by tile
+    auto expected = map;
+    for (auto layer = 0; layer < 2; ++layer)
+    {
+      for (auto row = 0; row < 3; ++row)
+      {
+        for (auto col = 0; col < 3; ++col)
+        {
+          const auto sourceY = 1 + (3 - row - 1);
+          const auto tile = expected.tileAt(layer, 2 + col, sourceY);
+          expected.setTileAt(layer, 2 + col, sourceY + 1, tile);
+        }
+      }
+    }
+    expected.clearSection(2, 1, 3, 1);
+
+    const auto previousRevision = map.revision();
+    map.moveSection(section, {2, 2});
+
+    CHECK(mapsEqual(map, expected));
+    CHECK(map.previousRevision() == previousRevision);
+
+    const auto expectedDirtySection = base::Rect<int>{{2, 1}, {3, 4}};
+    CHECK(map.lastModifiedSection() == expectedDirtySection);
+  }
+
+  SECTION("Moving a section up and to the left")
+  {
+    map.moveSection({{3, 3}, {2, 2}}, {2, 2});
+
+    CHECK(map.tileAt(0, 2, 2) == 1 + 3 + 3 * 8);
+    CHECK(map.tileAt(0, 3, 2) == 1 + 4 + 3 * 8);
+    CHECK(map.tileAt(0, 2, 3) == 1 + 3 + 4 * 8);
+    CHECK(map.tileAt(1, 3, 3) == 100 + 4 + 4 * 8);
+
+    // Uncovered parts of the source
+    CHECK(map.tileAt(0, 4, 3) == 0);
+    CHECK(map.tileAt(0, 3, 4) == 0);
+    CHECK(map.tileAt(1, 4, 4) == 0);
+
+    // Outside of the source and destination
+    CHECK(map.tileAt(0, 5, 3) == 1 + 5 + 3 * 8);
+    CHECK(map.tileAt(0, 2, 4) == 1 + 2 + 4 * 8);
+  }
+
+  SECTION("Filling a section only affects the given layer")
+  {
+    map.fillSection(1, {{1, 1}, {2, 3}}, 7);
+
+    CHECK(map.tileAt(1, 1, 1) == 7);
+    CHECK(map.tileAt(1, 2, 3) == 7);
+    CHECK(map.tileAt(1, 3, 3) == 100 + 3 + 3 * 8);
+    CHECK(map.tileAt(0, 1, 1) == 1 + 1 + 1 * 8);
+
+    const auto expectedDirtySection = base::Rect<int>{{1, 1}, {2, 3}};
+    CHECK(map.lastModifiedSection() == expectedDirtySection);
+  }
+
+  SECTION("Clearing a section affects both layers")
+  {
+    map.clearSection(0, 0, 2, 2);
+
+    CHECK(map.tileAt(0, 1, 1) == 0);
+    CHECK(map.tileAt(1, 1, 1) == 0);
+    CHECK(map.tileAt(0, 2, 1) == 1 + 2 + 1 * 8);
+  }
+
+  SECTION("Copying overlapping row spans")
+  {
+    map.copyRowSpan(0, {0, 2}, {1, 2}, 4);
+
+    CHECK(map.tileAt(0, 0, 2) == 1 + 0 + 2 * 8);
+    CHECK(map.tileAt(0, 1, 2) == 1 + 0 + 2 * 8);
+    CHECK(map.tileAt(0, 4, 2) == 1 + 3 + 2 * 8);
+    CHECK(map.tileAt(0, 5, 2) == 1 + 5 + 2 * 8);
+  }
+
+  SECTION("Each operation creates a single new revision")
+  {
+    const auto revisionBefore = map.revision();
+    map.clearSection(0, 0, 8, 6);
+
+    CHECK(map.previousRevision() == revisionBefore);
+    CHECK(map.revision() != revisionBefore);
+  }
+
+  SECTION("Copies can be brought up to date from modified sections")
+  {
+    auto current = map;
+    auto spare = map;
+
+    map.fillSection(1, {{1, 1}, {2, 2}}, 7);
+    REQUIRE(map.previousRevision() == current.revision());
+    spare.updateFrom(map, {map.lastModifiedSection()});
+
+    CHECK(mapsEqual(spare, map));
+    CHECK(spare.revision() == map.revision());
+
+    // The older copy is now two modifications behind, and needs both sections
+    const auto firstSection = map.lastModifiedSection();
+    map.setTileAt(0, 6, 4, 9);
+    current.updateFrom(map, {firstSection, map.lastModifiedSection()});
+
+    CHECK(mapsEqual(current, map));
+    CHECK(current.revision() == map.revision());
+    CHECK(current.previousRevision() == map.previousRevision());
+  }
+
+  SECTION("Out of bounds sections are rejected")
+  {
+    CHECK_THROWS(map.moveSection({{0, 4}, {2, 2}}, {0, 5}));
+    CHECK_THROWS(map.fillSection(0, {{7, 0}, {2, 1}}, 1));
+    CHECK_THROWS(map.copyRowSpan(0, {0, 0}, {6, 0}, 3));
+  }
+}
@@ -0,0 +1,116 @@
+/* Copyright (C) 2016, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <common/memory_accounting.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <optional>
+#include <string>
+#include <vector>
+
+
+using namespace rigel;
+
+
+TEST_CASE("Memory report")
+{
+  MemoryReport report;
+  report.add("GPU", "Textures", 1024, 3);
+  report.add("World", "Entities", 0, 42);
+  report.add("GPU", "Render targets", 512, 1);
+
+  SECTION("Categories are listed in order of first appearance")
+  {
+    const auto expected = std::vector<std::string>{"GPU", "World"};
+    CHECK(report.categories() == expected);
+  }
+
+  SECTION("Totals are computed per category")
+  {
+    CHECK(report.totalBytes("GPU") == 1536);
+    CHECK(report.totalBytes("World") == 0);
+    CHECK(report.totalBytes("Audio") == 0);
+  }
+
+  SECTION("JSON output groups entries by category")
+  {
+    const auto json = toJson(report);
+
+    CHECK(json.size() == 2);
+    CHECK(json["GPU"]["totalBytes"] == 1536);
+    REQUIRE(json["GPU"]["entries"].size() == 2);
+    CHECK(json["GPU"]["entries"][0]["name"] == "Textures");
+    CHECK(json["GPU"]["entries"][0]["bytes"] == 1024);
+    CHECK(json["GPU"]["entries"][0]["count"] == 3);
+    CHECK(json["GPU"]["entries"][1]["name"] == "Render targets");
+    CHECK(json["World"]["entries"][0]["count"] == 42);
+  }
+}
+
+
+TEST_CASE("Memory registry")
+{
+  MemoryRegistry registry;
+
+  auto first = registry.add(
+    [](MemoryReport& report) { report.add("Test", "First", 10); });
+
+  SECTION("Reporters run in order of registration")
+  {
+    auto second = registry.add(
+      [](MemoryReport& report) { report.add("Test", "Second", 20); });
+
+    const auto report = registry.collect();
+    REQUIRE(report.entries().size() == 2);
+    CHECK(report.entries()[0].mName == "First");
+    CHECK(report.entries()[1].mName == "Second");
+  }
+
+  SECTION("Destroying the registration removes the reporter")
+  {
+    {
+      auto second = registry.add(
+        [](MemoryReport& report) { report.add("Test", "Second", 20); });
+    }
+
+    const auto report = registry.collect();
+    REQUIRE(report.entries().size() == 1);
+    CHECK(report.entries()[0].mName == "First");
+  }
+
+  SECTION("Registrations can be moved")
+  {
+    std::optional<MemoryRegistry::Registration> moved{std::move(first)};
+    CHECK(registry.collect().entries().size() == 1);
+
+    moved.reset();
+    CHECK(registry.collect().entries().empty());
+  }
+
+  SECTION("Assigning a registration replaces the previous one")
+  {
+    first = registry.add(
+      [](MemoryReport& report) { report.add("Test", "Replaced", 30); });
+
+    const auto report = registry.collect();
+    REQUIRE(report.entries().size() == 1);
+    CHECK(report.entries()[0].mName == "Replaced");
+  }
+}
@@ -0,0 +1,109 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <base/memory_arena.hpp>
+#include <base/warnings.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+
+using namespace rigel::base;
+
+
+TEST_CASE("Memory arena")
+{
+  MemoryArena arena;
+
+  SECTION("Freed memory is reused for allocations of the same size class")
+  {
+    auto pFirst = arena.allocate(24, 8);
+    arena.deallocate(pFirst, 24, 8);
+
+    auto pSecond = arena.allocate(32, 8);
+    CHECK(pSecond == pFirst);
+    CHECK(arena.numBlocks() == 1);
+    CHECK(arena.numLiveAllocations() == 1);
+
+    arena.deallocate(pSecond, 32, 8);
+    CHECK(arena.numLiveAllocations() == 0);
+  }
+
+  SECTION("Different size classes don't share memory")
+  {
+    auto pSmall = arena.allocate(8, 8);
+    arena.deallocate(pSmall, 8, 8);
+
+    auto pLarge = arena.allocate(64, 8);
+    CHECK(pLarge != pSmall);
+    arena.deallocate(pLarge, 64, 8);
+  }
+
+  SECTION("Large allocations bypass the pool")
+  {
+    auto pMemory = arena.allocate(MemoryArena::MAX_POOLED_SIZE + 1, 8);
+    CHECK(arena.numBlocks() == 0);
+    CHECK(arena.numLiveAllocations() == 0);
+    arena.deallocate(pMemory, MemoryArena::MAX_POOLED_SIZE + 1, 8);
+  }
+
+  SECTION("Containers use the arena active at construction time")
+  {
+    ArenaVector<int> outside;
+
+    {
+      const auto scope = ArenaScope{&arena};
+      ArenaVector<int> inside{1, 2, 3};
+
+      CHECK(inside.get_allocator().arena() == &arena);
+      CHECK(arena.numLiveAllocations() == 1);
+
+      outside = inside;
+    }
+
+    CHECK(outside.get_allocator().arena() == nullptr);
+    CHECK(activeArena() == nullptr);
+  }
+
+  SECTION("Copies go to the arena active at the time of copying")
+  {
+    MemoryArena otherArena;
+
+    const auto scope = ArenaScope{&arena};
+    const auto original = ArenaVector<int>{1, 2, 3};
+
+    const auto innerScope = ArenaScope{&otherArena};
+    const auto copy = original;
+
+    CHECK(copy.get_allocator().arena() == &otherArena);
+    CHECK(otherArena.numLiveAllocations() == 1);
+  }
+
+  SECTION("Unique pointers return memory to their arena")
+  {
+    const auto scope = ArenaScope{&arena};
+
+    {
+      auto pValue = makeArenaUnique<int>(42);
+      CHECK(*pValue == 42);
+      CHECK(arena.numLiveAllocations() == 1);
+    }
+
+    CHECK(arena.numLiveAllocations() == 0);
+  }
+}
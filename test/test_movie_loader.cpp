@@ -0,0 +1,115 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <synthetic_game_data.hpp>
+
+#include <base/warnings.hpp>
+#include <data/movie.hpp>
+#include <loader/movie_loader.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <algorithm>
+#include <array>
+
+using namespace rigel;
+using namespace data;
+
+
+TEST_CASE("Movie loading")
+{
+  constexpr auto WIDTH = 320;
+  constexpr auto HEIGHT = 200;
+  constexpr auto NUM_FRAMES = 8;
+
+  // The synthetic movie uses random indices, so all 256 palette entries are
+  // in use
+  const auto movie = loader::loadMovie(
+    synthetic_data::makeMovie(WIDTH, HEIGHT, NUM_FRAMES, 5));
+
+  REQUIRE(movie.mBaseImage.width() == WIDTH);
+  REQUIRE(movie.mBaseImage.height() == HEIGHT);
+  REQUIRE(movie.mFrames.size() == NUM_FRAMES);
+
+  SECTION("All palette entries remain available for colors")
+  {
+    REQUIRE(movie.mPalette.size() == 256);
+    CHECK(std::all_of(
+      movie.mPalette.begin(), movie.mPalette.end(), [](const Pixel& color) {
+        return color.a == 255;
+      }));
+
+    auto usedIndices = std::array<bool, 256>{};
+    for (const auto index : movie.mBaseImage.indexData())
+    {
+      usedIndices[index] = true;
+    }
+
+    CHECK(std::all_of(usedIndices.begin(), usedIndices.end(), [](bool used) {
+      return used;
+    }));
+  }
+
+  SECTION("Frames mark which pixels change")
+  {
+    for (const auto& frame : movie.mFrames)
+    {
+      const auto& image = frame.mReplacementImage;
+      CHECK(image.width() == WIDTH);
+      CHECK(frame.mStartRow + image.height() <= HEIGHT);
+      REQUIRE(frame.mChangedPixels.size() == image.indexData().size());
+
+      const auto numChanged = std::count(
+        frame.mChangedPixels.begin(), frame.mChangedPixels.end(), true);
+      CHECK(numChanged > 0);
+      CHECK(numChanged < std::ptrdiff_t(frame.mChangedPixels.size()));
+    }
+  }
+}
+
+
+TEST_CASE("Masked indexed image insertion")
+{
+  auto target = IndexedImage{4, 3, 7};
+  const auto source = IndexedImage{IndexBuffer{1, 2, 3, 4}, 2, 2};
+
+  SECTION("Only masked pixels are copied")
+  {
+    target.insertImage(1, 1, source, {true, false, false, true});
+
+    // clang-format off
+    const auto expected = IndexBuffer{
+      7, 7, 7, 7,
+      7, 1, 7, 7,
+      7, 7, 4, 7,
+    };
+    // clang-format on
+    CHECK(target.indexData() == expected);
+  }
+
+  SECTION("Mask must match the source image")
+  {
+    CHECK_THROWS(target.insertImage(0, 0, source, {true, false}));
+  }
+
+  SECTION("Source must fit")
+  {
+    CHECK_THROWS(target.insertImage(3, 0, source, {true, true, true, true}));
+  }
+}
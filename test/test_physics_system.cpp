@@ -27,6 +27,8 @@ RIGEL_DISABLE_WARNINGS
 #include <catch.hpp>
 RIGEL_RESTORE_WARNINGS
 
+#include <vector>
+
 
 using namespace rigel;
 using namespace engine;
@@ -58,6 +60,7 @@ TEST_CASE("Physics system works as expected")
 
   const auto runOneFrame = [&physicsSystem, &entityx]() {
     physicsSystem.update(entityx.entities);
+    physicsSystem.clearCollisionEvents();
   };
 
 
@@ -427,3 +430,99 @@ TEST_CASE("Physics system works as expected")
     }
   }
 }
+
+
+TEST_CASE("Physics system queues collision events")
+{
+  ex::EntityX entityx;
+  auto& entities = entityx.entities;
+
+  data::map::Map map{100, 100, data::map::TileAttributeDict{{0x0, 0xF}}};
+
+  CollisionChecker collisionChecker{&map, entityx.entities, entityx.events};
+  PhysicsSystem physicsSystem{&collisionChecker, &map, &entityx.events};
+
+  auto floor = entities.create();
+  floor.assign<BoundingBox>(BoundingBox{{0, 0}, {100, 1}});
+  floor.assign<WorldPosition>(0, 10);
+  floor.assign<SolidBody>();
+
+  auto createFallingObject = [&](const int x) {
+    auto entity = entities.create();
+    entity.assign<BoundingBox>(BoundingBox{{0, 0}, {1, 1}});
+    entity.assign<MovingBody>(MovingBody{{0.0f, 2.0f}, false});
+    entity.assign<WorldPosition>(x, 8);
+    entity.assign<Active>();
+    return entity;
+  };
+
+  const auto& events = physicsSystem.collisionEvents();
+
+  SECTION("Collisions are queued in order, after all entities have moved")
+  {
+    auto first = createFallingObject(2);
+    auto second = createFallingObject(6);
+
+    physicsSystem.update(entities);
+
+    REQUIRE(events.size() == 2);
+    CHECK(events[0].mEntity == first);
+    CHECK(events[1].mEntity == second);
+    CHECK(events[0].mCollidedBottom);
+    CHECK(!events[0].mCollidedTop);
+    CHECK(*first.component<WorldPosition>() == (WorldPosition{2, 9}));
+    CHECK(*second.component<WorldPosition>() == (WorldPosition{6, 9}));
+
+    physicsSystem.clearCollisionEvents();
+    CHECK(events.empty());
+  }
+
+  SECTION("Collisions of both phases end up in the queue")
+  {
+    auto first = createFallingObject(2);
+
+    physicsSystem.update(entities);
+    physicsSystem.startCollectingForPhase2();
+
+    // Entities created after phase 1 are moved in phase 2
+    auto second = createFallingObject(6);
+    physicsSystem.updatePhase2(entities);
+
+    REQUIRE(events.size() == 2);
+    CHECK(events[0].mEntity == first);
+    CHECK(events[1].mEntity == second);
+    CHECK(*second.component<WorldPosition>() == (WorldPosition{6, 9}));
+  }
+
+  SECTION("Entities spawned after phase 2 start moving in the next frame")
+  {
+    physicsSystem.update(entities);
+    physicsSystem.startCollectingForPhase2();
+    physicsSystem.updatePhase2(entities);
+
+    // Like a consumer of the queue spawning something
+    auto spawned = createFallingObject(14);
+    physicsSystem.clearCollisionEvents();
+
+    physicsSystem.update(entities);
+    CHECK(*spawned.component<WorldPosition>() == (WorldPosition{14, 9}));
+  }
+
+  SECTION("Collisions exceeding the queue's capacity are kept in order")
+  {
+    const auto numObjects = 150;
+    std::vector<ex::Entity> objects;
+    for (auto i = 0; i < numObjects; ++i)
+    {
+      objects.push_back(createFallingObject(i % 100));
+    }
+
+    physicsSystem.update(entities);
+
+    REQUIRE(events.size() == objects.size());
+    for (auto i = std::size_t{0}; i < objects.size(); ++i)
+    {
+      CHECK(events[i].mEntity == objects[i]);
+    }
+  }
+}
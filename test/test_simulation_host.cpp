@@ -0,0 +1,174 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game_world_utils.hpp"
+
+#include <base/warnings.hpp>
+#include <data/game_options.hpp>
+#include <game_logic/entity_prototype.hpp>
+#include <game_logic/game_world.hpp>
+#include <game_logic/simulation_host.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+#include <entityx/entityx.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace rigel;
+using namespace game_logic;
+
+
+namespace
+{
+
+constexpr auto NUM_FRAMES = 300;
+
+
+// entityx keeps the next type id in protected counters
+struct ComponentFamilyCounter : entityx::BaseComponent
+{
+  static Family value() { return family_counter_; }
+};
+
+
+struct EventFamilyCounter : entityx::BaseEvent
+{
+  static Family value() { return family_counter_; }
+};
+
+
+struct FamilyCounts
+{
+  std::size_t mComponents;
+  std::size_t mEvents;
+};
+
+
+// Taken during static initialization, i.e. before any test runs. A type
+// that's missing from the registration functions gets its id later on,
+// no matter which tests have used it first.
+const auto FAMILY_COUNTS_AFTER_REGISTRATION = []() {
+  registerComponentTypes();
+  registerEventTypes();
+  return FamilyCounts{
+    ComponentFamilyCounter::value(), EventFamilyCounter::value()};
+}();
+
+
+// Plays the segment on a world of its own, outside of the simulation host,
+// and stores state hashes like InputRecorder does.
+void recordStateHashes(TestGameContext& context, RecordingSegment& segment)
+{
+  auto playerModel = initialPlayerModel(segment);
+  GameWorld world{&playerModel, segment.mSessionId, context.context()};
+
+  auto frameNumber = std::uint32_t{0};
+  for (const auto& frame : segment.mFrames)
+  {
+    world.updateGameLogic(frame.mInput);
+    ++frameNumber;
+
+    if (frameNumber % STATE_HASH_INTERVAL == 0)
+    {
+      segment.mStateHashes.push_back({frameNumber, world.stateHash()});
+    }
+  }
+}
+
+} // namespace
+
+
+TEST_CASE("Simulation host results don't depend on the number of threads")
+{
+  auto context = TestGameContext{};
+
+  auto segments = std::vector<RecordingSegment>{
+    makeTestSegment(NUM_FRAMES, 0),
+    makeTestSegment(NUM_FRAMES, 37),
+    makeTestSegment(NUM_FRAMES, 90),
+    makeTestSegment(NUM_FRAMES, 0)};
+
+  for (auto& segment : segments)
+  {
+    recordStateHashes(context, segment);
+  }
+
+  // Make the last segment desync, so that detecting that is covered as well
+  auto& corruptedHash = segments.back().mStateHashes[5];
+  corruptedHash.mHash ^= 1;
+
+  auto simulate = [&](const std::size_t numThreads) {
+    SimulationHost host{
+      &context.mResources,
+      data::GameOptions{},
+      CommandLineOptions{},
+      numThreads};
+    return host.run(segments);
+  };
+
+  const auto serialResults = simulate(0);
+  const auto parallelResults = simulate(3);
+
+  REQUIRE(serialResults.size() == segments.size());
+  REQUIRE(parallelResults.size() == segments.size());
+
+  for (auto i = std::size_t{0}; i < segments.size(); ++i)
+  {
+    const auto& serial = serialResults[i];
+    const auto& parallel = parallelResults[i];
+
+    CHECK(serial.mNumFramesSimulated == std::size_t{NUM_FRAMES});
+    CHECK(parallel.mNumFramesSimulated == std::size_t{NUM_FRAMES});
+    CHECK(serial.mFinalStateHash == parallel.mFinalStateHash);
+    CHECK(serial.mNumDesyncs == parallel.mNumDesyncs);
+    CHECK(serial.mFirstDesyncFrame == parallel.mFirstDesyncFrame);
+
+    // The last recorded hash is taken after the last frame
+    CHECK(serial.mFinalStateHash == segments[i].mStateHashes.back().mHash);
+  }
+
+  // Everything but the corrupted hash needs to match
+  for (auto i = std::size_t{0}; i < segments.size() - 1; ++i)
+  {
+    CHECK(serialResults[i].mNumDesyncs == 0);
+    CHECK(!serialResults[i].mFirstDesyncFrame);
+  }
+
+  CHECK(serialResults.back().mNumDesyncs == 1);
+  CHECK(serialResults.back().mFirstDesyncFrame == corruptedHash.mFrame);
+}
+
+
+TEST_CASE("Worlds only use registered component and event types")
+{
+  auto context = TestGameContext{};
+
+  SimulationHost host{
+    &context.mResources, data::GameOptions{}, CommandLineOptions{}, 0};
+  const auto results = host.run({makeTestSegment(NUM_FRAMES)});
+  REQUIRE(results.size() == 1);
+
+  // If these fail, extend registerComponentTypes() or registerEventTypes()
+  CHECK(
+    ComponentFamilyCounter::value() ==
+    FAMILY_COUNTS_AFTER_REGISTRATION.mComponents);
+  CHECK(
+    EventFamilyCounter::value() == FAMILY_COUNTS_AFTER_REGISTRATION.mEvents);
+}
@@ -0,0 +1,167 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <base/warnings.hpp>
+#include <engine/sound_mixer.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstdint>
+#include <vector>
+
+
+using namespace rigel;
+using engine::SoundMixer;
+
+
+namespace
+{
+
+std::vector<std::int16_t> mixOnce(SoundMixer& mixer, const std::size_t size)
+{
+  std::vector<std::int16_t> buffer(size, 0);
+  mixer.mix(buffer.data(), buffer.size());
+  return buffer;
+}
+
+} // namespace
+
+
+TEST_CASE("Sound mixer")
+{
+  const auto sound1 = std::vector<std::int16_t>(20, 1000);
+  const auto sound2 = std::vector<std::int16_t>{10, 20, 30};
+
+  SoundMixer mixer{4};
+  mixer.setSoundData(data::SoundId::DukeJumping, sound1.data(), sound1.size());
+  mixer.setSoundData(data::SoundId::DukePain, sound2.data(), sound2.size());
+
+  SECTION("Produces silence when nothing is playing")
+  {
+    const auto expected = std::vector<std::int16_t>(4, 0);
+    CHECK(mixOnce(mixer, 4) == expected);
+  }
+
+  SECTION("Plays sounds until they end")
+  {
+    mixer.play(data::SoundId::DukePain);
+
+    const auto expected = std::vector<std::int16_t>{10, 20, 30, 0, 0};
+    CHECK(mixOnce(mixer, 5) == expected);
+    CHECK(mixer.stats().mActiveVoices == 0);
+  }
+
+  SECTION("Continues playback across calls")
+  {
+    mixer.play(data::SoundId::DukePain);
+
+    const auto expectedFirst = std::vector<std::int16_t>{10, 20};
+    const auto expectedSecond = std::vector<std::int16_t>{30, 0};
+    CHECK(mixOnce(mixer, 2) == expectedFirst);
+    CHECK(mixer.stats().mActiveVoices == 1);
+    CHECK(mixOnce(mixer, 2) == expectedSecond);
+  }
+
+  SECTION("Adds up sounds playing at the same time")
+  {
+    mixer.play(data::SoundId::DukeJumping);
+    mixer.play(data::SoundId::DukePain);
+
+    const auto expected = std::vector<std::int16_t>{1010, 1020, 1030, 1000};
+    CHECK(mixOnce(mixer, 4) == expected);
+  }
+
+  SECTION("Playing a sound again restarts it")
+  {
+    mixer.play(data::SoundId::DukePain);
+    mixOnce(mixer, 2);
+    mixer.play(data::SoundId::DukePain);
+
+    const auto expected = std::vector<std::int16_t>{10, 20};
+    CHECK(mixOnce(mixer, 2) == expected);
+  }
+
+  SECTION("Stopping a sound silences it")
+  {
+    mixer.play(data::SoundId::DukeJumping);
+    mixer.play(data::SoundId::DukePain);
+    mixer.stop(data::SoundId::DukeJumping);
+
+    const auto expected = std::vector<std::int16_t>{10, 20, 30, 0};
+    CHECK(mixOnce(mixer, 4) == expected);
+  }
+
+  SECTION("Volume is applied")
+  {
+    mixer.setVolume(0.5f);
+    mixer.play(data::SoundId::DukeJumping);
+
+    const auto expected = std::vector<std::int16_t>(20, 500);
+    CHECK(mixOnce(mixer, 20) == expected);
+  }
+
+  SECTION("Mixing saturates instead of wrapping around")
+  {
+    const auto loud = std::vector<std::int16_t>(17, 30000);
+    const auto quiet = std::vector<std::int16_t>(17, -30000);
+    mixer.setSoundData(data::SoundId::BigExplosion, loud.data(), loud.size());
+    mixer.setSoundData(
+      data::SoundId::AlternateExplosion, quiet.data(), quiet.size());
+
+    mixer.play(data::SoundId::BigExplosion);
+    std::vector<std::int16_t> buffer(17, 30000);
+    mixer.mix(buffer.data(), buffer.size());
+
+    const auto expectedHigh = std::vector<std::int16_t>(17, 32767);
+    CHECK(buffer == expectedHigh);
+
+    mixer.play(data::SoundId::AlternateExplosion);
+    std::fill(buffer.begin(), buffer.end(), std::int16_t{-30000});
+    mixer.mix(buffer.data(), buffer.size());
+
+    const auto expectedLow = std::vector<std::int16_t>(17, -32768);
+    CHECK(buffer == expectedLow);
+  }
+
+  SECTION("Oldest voice is replaced when running out of voices")
+  {
+    SoundMixer smallMixer{1};
+    smallMixer.setSoundData(
+      data::SoundId::DukeJumping, sound1.data(), sound1.size());
+    smallMixer.setSoundData(
+      data::SoundId::DukePain, sound2.data(), sound2.size());
+
+    smallMixer.play(data::SoundId::DukeJumping);
+    smallMixer.play(data::SoundId::DukePain);
+
+    const auto expected = std::vector<std::int16_t>{10, 20, 30, 0};
+    CHECK(mixOnce(smallMixer, 4) == expected);
+  }
+
+  SECTION("Reset silences everything immediately")
+  {
+    mixer.play(data::SoundId::DukeJumping);
+    mixOnce(mixer, 2);
+    mixer.play(data::SoundId::DukePain);
+    mixer.reset();
+
+    const auto expected = std::vector<std::int16_t>(4, 0);
+    CHECK(mixOnce(mixer, 4) == expected);
+  }
+}
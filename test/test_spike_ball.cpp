@@ -114,7 +114,7 @@ TEST_CASE("Spike ball")
     &randomGenerator);
 
   base::Vector cameraPosition{0, 0};
-  engine::ParticleSystem particleSystem{&randomGenerator, nullptr};
+  engine::ParticleSystem particleSystem{&randomGenerator};
   BehaviorControllerSystem behaviorControllerSystem{
     GlobalDependencies{
       &collisionChecker,
@@ -138,6 +138,8 @@ TEST_CASE("Spike ball")
     engine::markActiveEntities(entityx.entities, {0, 0}, viewPortSize);
     behaviorControllerSystem.update(entityx.entities, perFrameState);
     physicsSystem.update(entityx.entities);
+    behaviorControllerSystem.handleCollisions(physicsSystem.collisionEvents());
+    physicsSystem.clearCollisionEvents();
     perFrameState.mIsOddFrame = !perFrameState.mIsOddFrame;
   };
 
@@ -0,0 +1,327 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <base/heap_allocation_counter.hpp>
+#include <base/memory_arena.hpp>
+#include <base/stage_scheduler.hpp>
+#include <base/thread_pool.hpp>
+#include <base/warnings.hpp>
+#include <engine/random_number_generator.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+
+using namespace rigel;
+using base::StageScheduler;
+
+
+namespace
+{
+
+using ResourceMask = StageScheduler::ResourceMask;
+
+constexpr auto ENTITIES = ResourceMask{1} << 0;
+constexpr auto EVENTS = ResourceMask{1} << 1;
+constexpr auto RANDOM_NUMBERS = ResourceMask{1} << 2;
+constexpr auto COUNTERS = ResourceMask{1} << 3;
+constexpr auto PARTICLES = ResourceMask{1} << 4;
+constexpr auto VISIBLE = ResourceMask{1} << 5;
+constexpr auto SNAPSHOT = ResourceMask{1} << 6;
+constexpr auto EVERYTHING = ~ResourceMask{0};
+
+
+/** Miniature version of a game world's logic update
+ *
+ * The stages mirror the ones used by GameWorld: Some of them draw random
+ * numbers and emit events, whose order matters. Others only touch their
+ * own data and can run alongside.
+ */
+struct World
+{
+  explicit World(base::ThreadPool* pPool)
+    : mStages(pPool)
+  {
+    mEntities.resize(64);
+    for (auto i = 0u; i < mEntities.size(); ++i)
+    {
+      mEntities[i] = static_cast<int>(i * 7);
+    }
+
+    mParticles.resize(4096);
+
+    mStages.addStage(0, EVENTS | RANDOM_NUMBERS, [this]() {
+      if (mRandomGenerator.gen() % 4 == 0)
+      {
+        mEvents.push_back(mRandomGenerator.gen());
+      }
+    });
+
+    mStages.addStage(0, COUNTERS, [this]() {
+      ++mFrameCounter;
+      mOddFrame = !mOddFrame;
+    });
+
+    mStages.addStage(0, ENTITIES | EVENTS, [this]() {
+      for (auto& entity : mEntities)
+      {
+        if (entity % 5 == 0)
+        {
+          mEvents.push_back(entity);
+        }
+      }
+    });
+
+    mStages.addStage(EVERYTHING, EVERYTHING, [this]() {
+      for (auto& entity : mEntities)
+      {
+        entity += mRandomGenerator.gen() % 3 - 1 + (mOddFrame ? 1 : 0);
+        if (entity > 512)
+        {
+          entity = mRandomGenerator.gen();
+          mEvents.push_back(-entity);
+        }
+      }
+    });
+
+    mStages.addStage(0, PARTICLES, [this]() {
+      for (auto i = 0u; i < mParticles.size(); ++i)
+      {
+        mParticles[i] = mParticles[i] * 31u + i;
+      }
+    });
+
+    mStages.addStage(ENTITIES, VISIBLE, [this]() {
+      mVisible.clear();
+      for (const auto entity : mEntities)
+      {
+        if (entity >= 100 && entity < 300)
+        {
+          mVisible.push_back(entity);
+        }
+      }
+    });
+
+    mStages.addStage(0, COUNTERS, [this]() { mFrameCounter += 2; });
+
+    mStages.addStage(EVERYTHING, SNAPSHOT, [this]() {
+      mHash = 2166136261u;
+      auto add = [this](const int value) {
+        mHash ^= static_cast<std::uint32_t>(value);
+        mHash *= 16777619u;
+      };
+
+      add(mRandomGenerator.nextNumberIndex());
+      add(mFrameCounter);
+      for (const auto value : mEntities)
+      {
+        add(value);
+      }
+      for (const auto value : mEvents)
+      {
+        add(value);
+      }
+      for (const auto value : mVisible)
+      {
+        add(value);
+      }
+      add(static_cast<int>(mParticles.back()));
+    });
+  }
+
+  std::uint32_t update()
+  {
+    mStages.run();
+    return mHash;
+  }
+
+  StageScheduler mStages;
+  engine::RandomNumberGenerator mRandomGenerator;
+  std::vector<int> mEntities;
+  std::vector<int> mEvents;
+  std::vector<int> mVisible;
+  std::vector<std::uint32_t> mParticles;
+  int mFrameCounter = 0;
+  bool mOddFrame = false;
+  std::uint32_t mHash = 0;
+};
+
+
+std::vector<std::uint32_t> runFrames(base::ThreadPool& pool)
+{
+  World world{&pool};
+
+  std::vector<std::uint32_t> hashes;
+  for (auto i = 0; i < 200; ++i)
+  {
+    hashes.push_back(world.update());
+  }
+
+  return hashes;
+}
+
+} // namespace
+
+
+TEST_CASE("Stage scheduler")
+{
+  SECTION("Non-conflicting stages share a batch")
+  {
+    base::ThreadPool pool{0};
+    World world{&pool};
+
+    // { random events, counters }, { entity events }, { everything },
+    // { particles, visible, counters }, { snapshot }
+    CHECK(world.mStages.numStages() == 8);
+    CHECK(world.mStages.numBatches() == 5);
+  }
+
+  SECTION("Readers run concurrently, writers wait for readers")
+  {
+    base::ThreadPool pool{0};
+    StageScheduler scheduler{&pool};
+
+    scheduler.addStage(ENTITIES, 0, []() {});
+    scheduler.addStage(ENTITIES, VISIBLE, []() {});
+    CHECK(scheduler.numBatches() == 1);
+
+    scheduler.addStage(0, ENTITIES, []() {});
+    CHECK(scheduler.numBatches() == 2);
+
+    scheduler.addStage(VISIBLE, 0, []() {});
+    CHECK(scheduler.numBatches() == 2);
+  }
+
+  SECTION("Results and event order match the serial schedule")
+  {
+    base::ThreadPool serialPool{0};
+    const auto expected = runFrames(serialPool);
+
+    base::ThreadPool pool{3};
+    for (auto run = 0; run < 10; ++run)
+    {
+      CHECK(runFrames(pool) == expected);
+    }
+  }
+
+  SECTION("Conflicting stages run in the order they were added")
+  {
+    base::ThreadPool pool{3};
+    StageScheduler scheduler{&pool};
+
+    std::mutex mutex;
+    std::vector<int> order;
+    auto record = [&](const int id) {
+      return [&, id]() {
+        std::lock_guard<std::mutex> lock{mutex};
+        order.push_back(id);
+      };
+    };
+
+    scheduler.addStage(0, EVENTS, record(1));
+    scheduler.addStage(0, PARTICLES, []() {});
+    scheduler.addStage(0, EVENTS, record(2));
+    scheduler.addStage(EVENTS, 0, record(3));
+    scheduler.addStage(0, EVENTS, record(4));
+
+    const auto expectedOrder = std::vector<int>{1, 2, 3, 4};
+    for (auto i = 0; i < 20; ++i)
+    {
+      order.clear();
+      scheduler.run();
+      CHECK(order == expectedOrder);
+    }
+  }
+
+  SECTION("Stages run with the caller's active arena")
+  {
+    base::ThreadPool pool{2};
+    StageScheduler scheduler{&pool};
+
+    base::MemoryArena arena;
+    base::MemoryArena* pSeenArena1 = nullptr;
+    base::MemoryArena* pSeenArena2 = nullptr;
+    scheduler.addStage(0, PARTICLES, [&]() {
+      pSeenArena1 = base::activeArena();
+    });
+    scheduler.addStage(0, VISIBLE, [&]() {
+      pSeenArena2 = base::activeArena();
+    });
+
+    {
+      const auto scope = base::ArenaScope{&arena};
+      scheduler.run();
+    }
+
+    CHECK(pSeenArena1 == &arena);
+    CHECK(pSeenArena2 == &arena);
+  }
+
+  SECTION("Running doesn't allocate once the pool's queue has grown")
+  {
+    base::ThreadPool pool{3};
+    StageScheduler scheduler{&pool};
+
+    auto counters = std::vector<int>(4);
+    scheduler.addStage(0, PARTICLES, [&]() { ++counters[0]; });
+    scheduler.addStage(0, VISIBLE, [&]() { ++counters[1]; });
+    scheduler.addStage(0, EVENTS, [&]() { ++counters[2]; });
+    scheduler.addStage(EVERYTHING, COUNTERS, [&]() { ++counters[3]; });
+    scheduler.run();
+
+    // Allocations can only be counted when building with
+    // TRACK_HEAP_ALLOCATIONS
+    const auto allocationsBefore = base::heapAllocationCount();
+    for (auto i = 0; i < 20; ++i)
+    {
+      scheduler.run();
+    }
+
+    const auto allocationsAfter = base::heapAllocationCount();
+
+    if (allocationsBefore)
+    {
+      CHECK(*allocationsAfter == *allocationsBefore);
+    }
+
+    CHECK(counters == std::vector<int>(4, 21));
+  }
+
+  SECTION("Exceptions are propagated after the batch has finished")
+  {
+    base::ThreadPool pool{2};
+    StageScheduler scheduler{&pool};
+
+    auto otherStageFinished = false;
+    auto laterBatchRan = false;
+    scheduler.addStage(0, PARTICLES, []() {});
+    scheduler.addStage(
+      0, EVENTS, []() { throw std::runtime_error("stage failed"); });
+    scheduler.addStage(0, VISIBLE, [&]() { otherStageFinished = true; });
+    scheduler.addStage(EVERYTHING, 0, [&]() { laterBatchRan = true; });
+
+    CHECK_THROWS(scheduler.run());
+    CHECK(otherStageFinished);
+    CHECK(!laterBatchRan);
+  }
+}
@@ -0,0 +1,101 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/startup_timeline.hpp>
+#include <base/warnings.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+
+using namespace rigel;
+using namespace base;
+
+
+TEST_CASE("Startup timeline")
+{
+  StartupTimeline timeline;
+
+  SECTION("Measuring returns the result and records the stage")
+  {
+    const auto result = timeline.measure("Compute", []() { return 42; });
+    CHECK(result == 42);
+
+    const auto stages = timeline.stages();
+    REQUIRE(stages.size() == 1);
+    CHECK(stages[0].mName == "Compute");
+    CHECK(stages[0].mThread == 0);
+    CHECK(stages[0].mStart <= stages[0].mEnd);
+  }
+
+  SECTION("Stages are recorded if the measured function throws")
+  {
+    CHECK_THROWS(timeline.measure(
+      "Failing", []() -> int { throw std::runtime_error{"failed"}; }));
+    CHECK(timeline.stages().size() == 1);
+  }
+
+  SECTION("Stages are ordered by start time")
+  {
+    timeline.measure("Outer", [&]() {
+      timeline.measure("Inner", []() {});
+    });
+
+    const auto stages = timeline.stages();
+    REQUIRE(stages.size() == 2);
+    CHECK(stages[0].mName == "Outer");
+    CHECK(stages[1].mName == "Inner");
+  }
+
+  SECTION("Threads are numbered in order of first use")
+  {
+    // The first thread stays alive while the second one runs, to make sure
+    // that they get different IDs
+    std::thread first{[&]() {
+      timeline.measure("First", []() {});
+
+      std::thread second{[&]() { timeline.measure("Second", []() {}); }};
+      second.join();
+    }};
+    first.join();
+
+    timeline.measure("Main", []() {});
+
+    const auto stages = timeline.stages();
+    REQUIRE(stages.size() == 3);
+    CHECK(stages[0].mThread == 1);
+    CHECK(stages[1].mThread == 2);
+    CHECK(stages[2].mThread == 0);
+  }
+
+  SECTION("Report lists all stages")
+  {
+    timeline.measure("Load data", []() {});
+    timeline.measure("Create window", []() {});
+
+    std::stringstream report;
+    timeline.writeReport(report);
+
+    const auto text = report.str();
+    CHECK(text.find("Startup took") == 0);
+    CHECK(text.find("Load data") < text.find("Create window"));
+  }
+}
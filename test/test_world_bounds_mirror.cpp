@@ -0,0 +1,231 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <engine/base_components.hpp>
+#include <engine/entity_activation_system.hpp>
+#include <engine/physical_components.hpp>
+#include <engine/world_bounds_mirror.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <random>
+#include <vector>
+
+
+using namespace rigel;
+using namespace engine;
+using namespace engine::components;
+
+using Entities = std::vector<entityx::Entity>;
+
+
+namespace
+{
+
+Entities trackedEntities(const WorldBoundsMirror& bounds)
+{
+  Entities result;
+  for (auto slot = std::size_t{0}; slot < bounds.size(); ++slot)
+  {
+    result.push_back(bounds.entity(slot));
+  }
+  return result;
+}
+
+} // namespace
+
+
+TEST_CASE("World bounds mirror")
+{
+  entityx::EventManager events;
+  entityx::EntityManager entities{events};
+  WorldBoundsMirror bounds{events};
+
+  const auto region = BoundingBox{{10, 10}, {20, 10}};
+
+  auto makeEntity = [&](const base::Vector& position, const BoundingBox& bbox) {
+    auto entity = entities.create();
+    entity.assign<WorldPosition>(position);
+    entity.assign<BoundingBox>(bbox);
+    return entity;
+  };
+
+  auto inside = makeEntity({12, 15}, BoundingBox{{0, 0}, {2, 2}});
+  auto outside = makeEntity({50, 15}, BoundingBox{{0, 0}, {2, 2}});
+  auto positionOnly = entities.create();
+  positionOnly.assign<WorldPosition>(12, 15);
+
+  SECTION("Only entities with position and bounding box are tracked")
+  {
+    bounds.cull(region);
+
+    const auto expected = Entities{inside, outside};
+    CHECK(trackedEntities(bounds) == expected);
+    CHECK(bounds.isInRegion(inside));
+    CHECK(!bounds.isInRegion(outside));
+    CHECK(!bounds.isTracked(positionOnly));
+  }
+
+  SECTION("Tracking follows component changes")
+  {
+    positionOnly.assign<BoundingBox>(BoundingBox{{0, 0}, {1, 1}});
+    inside.remove<BoundingBox>();
+    bounds.cull(region);
+
+    const auto expected = Entities{outside, positionOnly};
+    CHECK(trackedEntities(bounds) == expected);
+    CHECK(!bounds.isTracked(inside));
+    CHECK(bounds.isInRegion(positionOnly));
+  }
+
+  SECTION("Destroyed entities are no longer tracked")
+  {
+    bounds.cull(region);
+    outside.destroy();
+    auto reused = makeEntity({11, 11}, BoundingBox{{0, 0}, {1, 1}});
+    bounds.cull(region);
+
+    const auto expected = Entities{inside, reused};
+    CHECK(trackedEntities(bounds) == expected);
+    CHECK(bounds.isInRegion(reused));
+  }
+
+  SECTION("Results reflect position changes made after tracking started")
+  {
+    bounds.cull(region);
+    *outside.component<WorldPosition>() = {20, 15};
+    *inside.component<BoundingBox>() = BoundingBox{{0, 0}, {0, 2}};
+    bounds.cull(region);
+
+    CHECK(!bounds.isInRegion(inside));
+    CHECK(bounds.isInRegion(outside));
+  }
+
+  SECTION("Slots stay stable while destroying entities")
+  {
+    bounds.cull(region);
+
+    for (auto slot = std::size_t{0}; slot < bounds.size(); ++slot)
+    {
+      if (auto entity = bounds.entity(slot))
+      {
+        entity.destroy();
+      }
+    }
+
+    CHECK(bounds.size() == 2);
+    CHECK(!bounds.entity(0).valid());
+    CHECK(!bounds.entity(1).valid());
+
+    bounds.cull(region);
+    CHECK(bounds.size() == 0);
+  }
+}
+
+
+TEST_CASE("World bounds mirror culling matches per-entity intersection tests")
+{
+  entityx::EventManager events;
+  entityx::EntityManager entities{events};
+  WorldBoundsMirror bounds{events};
+
+  auto rng = std::minstd_rand{42};
+  auto randomInt = [&rng](const int min, const int max) {
+    return std::uniform_int_distribution<int>{min, max}(rng);
+  };
+
+  // Not a multiple of 4 or 32, to cover the scalar tail
+  for (int i = 0; i < 1003; ++i)
+  {
+    auto entity = entities.create();
+    entity.assign<WorldPosition>(randomInt(-20, 100), randomInt(-20, 100));
+    entity.assign<BoundingBox>(BoundingBox{
+      {randomInt(-2, 2), randomInt(-2, 2)},
+      {randomInt(0, 12), randomInt(0, 12)}});
+  }
+
+  const auto regions = std::vector<BoundingBox>{
+    {{0, 0}, {32, 20}},
+    {{-10, 40}, {5, 70}},
+    {{50, 50}, {1, 1}},
+    {{30, 30}, {0, 10}},
+  };
+
+  for (const auto& region : regions)
+  {
+    bounds.cull(region);
+
+    auto numMismatches = 0;
+    entities.each<WorldPosition, BoundingBox>(
+      [&](
+        entityx::Entity entity,
+        const WorldPosition& position,
+        const BoundingBox& bbox) {
+        const auto expected = toWorldSpace(bbox, position).intersects(region);
+        if (bounds.isInRegion(entity) != expected)
+        {
+          ++numMismatches;
+        }
+      });
+
+    CHECK(bounds.size() == 1003);
+    CHECK(numMismatches == 0);
+  }
+}
+
+
+TEST_CASE("Marking active entities via bounds mirror")
+{
+  using Policy = ActivationSettings::Policy;
+
+  entityx::EventManager events;
+  entityx::EntityManager entities{events};
+  WorldBoundsMirror bounds{events};
+
+  const auto viewPortSize = base::Extents{32, 20};
+
+  auto makeEntity = [&](const base::Vector& position, const Policy policy) {
+    auto entity = entities.create();
+    entity.assign<WorldPosition>(position);
+    entity.assign<BoundingBox>(BoundingBox{{0, 0}, {2, 2}});
+    entity.assign<ActivationSettings>(policy);
+    return entity;
+  };
+
+  auto onScreen = makeEntity({5, 5}, Policy::WhenOnScreen);
+  auto offScreen = makeEntity({50, 5}, Policy::WhenOnScreen);
+  auto always = makeEntity({50, 5}, Policy::Always);
+  auto sticky = makeEntity({5, 5}, Policy::AlwaysAfterFirstActivation);
+
+  markActiveEntities(bounds, {0, 0}, viewPortSize);
+
+  CHECK(onScreen.has_component<Active>());
+  CHECK(onScreen.component<Active>()->mIsOnScreen);
+  CHECK(!offScreen.has_component<Active>());
+  CHECK(always.has_component<Active>());
+  CHECK(!always.component<Active>()->mIsOnScreen);
+  CHECK(sticky.has_component<Active>());
+
+  markActiveEntities(bounds, {100, 0}, viewPortSize);
+
+  CHECK(!onScreen.has_component<Active>());
+  CHECK(always.has_component<Active>());
+  CHECK(sticky.has_component<Active>());
+  CHECK(!sticky.component<Active>()->mIsOnScreen);
+}